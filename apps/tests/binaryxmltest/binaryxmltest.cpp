@@ -0,0 +1,153 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/io/serialization/xmlbinaryformat.h"
+#include "voreen/core/io/serialization/xmlserializationconstants.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace voreen;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+std::string toText(const TiXmlDocument& document) {
+    TiXmlPrinter printer;
+    document.Accept(&printer);
+    return printer.Str();
+}
+
+std::string number(int i) {
+    std::ostringstream stream;
+    stream << i;
+    return stream.str();
+}
+
+/// Round trip of a document with many distinct attribute names and values.
+void testRoundTrip() {
+    TiXmlDocument document;
+    TiXmlElement* root = new TiXmlElement("VoreenData");
+    document.LinkEndChild(root);
+
+    std::set<std::string> expectedIds;
+    std::set<std::string> expectedReferences;
+    for (int i = 0; i < 50; i++) {
+        TiXmlElement* element = new TiXmlElement("Processor");
+        root->LinkEndChild(element);
+
+        // all names and values are distinct, so that each of them introduces a new string
+        for (int j = 0; j < 200; j++)
+            element->SetAttribute("attribute" + number(i) + "_" + number(j), "value" + number(i) + "_" + number(j));
+
+        element->SetAttribute(XmlSerializationConstants::IDATTRIBUTE, "ref" + number(i));
+        expectedIds.insert("ref" + number(i));
+        if (i > 0) {
+            TiXmlElement* link = new TiXmlElement("Link");
+            link->SetAttribute(XmlSerializationConstants::REFERENCEATTRIBUTE, "ref" + number(i - 1));
+            expectedReferences.insert("ref" + number(i - 1));
+            element->LinkEndChild(link);
+        }
+        element->LinkEndChild(new TiXmlText("text of processor " + number(i)));
+    }
+    root->LinkEndChild(new TiXmlComment("end of processors"));
+
+    std::stringstream stream;
+    XmlBinaryFormat::write(document, stream);
+
+    check(XmlBinaryFormat::isBinary(stream), "written document is not recognized as binary");
+
+    TiXmlDocument result;
+    std::set<std::string> ids;
+    std::set<std::string> references;
+    try {
+        XmlBinaryFormat::read(stream, result, &ids, &references);
+    }
+    catch (SerializationException& e) {
+        check(false, std::string("reading the written document failed: ") + e.what());
+        return;
+    }
+
+    // the reader adds the XML declaration that the writer omits
+    result.RemoveChild(result.FirstChild());
+    check(toText(result) == toText(document), "document changed by the round trip");
+    check(ids == expectedIds, "reference ids differ");
+    check(references == expectedReferences, "references differ");
+}
+
+/// A string length beyond the end of the stream must be reported as format error.
+void testCorruptLength() {
+    TiXmlDocument document;
+    document.LinkEndChild(new TiXmlElement("VoreenData"));
+    std::stringstream written;
+    XmlBinaryFormat::write(document, written);
+
+    // signature and version, element tag, new string with a length of about 2^62
+    std::string data = written.str().substr(0, 9);
+    data += static_cast<char>(1);
+    data += static_cast<char>(0);
+    for (int i = 0; i < 8; i++)
+        data += static_cast<char>(0xFF);
+    data += static_cast<char>(0x3F);
+    data += "VoreenData";
+
+    std::istringstream stream(data);
+    TiXmlDocument result;
+    bool formatError = false;
+    try {
+        XmlBinaryFormat::read(stream, result);
+    }
+    catch (XmlSerializationFormatException&) {
+        formatError = true;
+    }
+    catch (std::bad_alloc&) {
+    }
+    check(formatError, "corrupt string length not reported as format error");
+}
+
+} // namespace
+
+int main(int /*argc*/, char** /*argv*/) {
+    testRoundTrip();
+    testCorruptLength();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,30 @@
+####################################################
+# Project file for the binary XML round-trip test
+####################################################
+TARGET = binaryxmltest
+TEMPLATE = app
+LANGUAGE = C++
+
+CONFIG += console
+CONFIG -= qt
+
+# include config
+!exists(../../../config.txt) {
+  error("config.txt not found! copy config-default.txt to config.txt and edit!")
+}
+include(../../../config.txt)
+
+# Include common configuration
+include(../../../commonconf.pri)
+
+# Set output directory of the executable
+VRN_APP_DIRECTORY = "$${VRN_HOME}/bin"
+
+# Include generic app configuration
+include(../../voreenapp.pri)
+
+SOURCES += binaryxmltest.cpp
+
+### Local Variables:
+### mode:conf-unix
+### End:
@@ -0,0 +1,311 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "commands_bench.h"
+#include "voreen/core/datastructures/volume/gradient.h"
+#include "voreen/core/datastructures/volume/histogram.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/volumehash.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorhalfsample.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatormedian.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorminmax.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatormorphology.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorresample.h"
+#include "voreen/core/processors/profiling.h"
+
+#include "tgt/exception.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace voreen {
+
+namespace {
+
+const char* const KERNELS[] = { "halfsample", "resample", "median", "erosion", "dilation",
+                                "gradient", "histogram", "minmax", "hash" };
+const size_t NUM_KERNELS = sizeof(KERNELS) / sizeof(KERNELS[0]);
+
+/// Prevents the compiler from discarding results that are not used otherwise.
+volatile float resultSink;
+
+/// Returns the peak resident set size of the process in bytes, or 0 if unavailable.
+size_t getPeakMemoryUsage() {
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/**
+ * Creates a volume of concentric shells overlaid with noise. The voxel values
+ * only depend on the position and the seed, so that runs are reproducible.
+ */
+template<typename T>
+VolumeAtomic<T>* createSyntheticVolume(const tgt::svec3& dimensions, uint32_t seed) {
+    VolumeAtomic<T>* volume = new VolumeAtomic<T>(dimensions);
+    const tgt::ivec3 center = tgt::ivec3(dimensions) / 2;
+
+    #pragma omp parallel for
+    for (int z = 0; z < static_cast<int>(dimensions.z); z++) {
+        for (size_t y = 0; y < dimensions.y; y++) {
+            for (size_t x = 0; x < dimensions.x; x++) {
+                size_t index = (static_cast<size_t>(z) * dimensions.y + y) * dimensions.x + x;
+                tgt::ivec3 d = tgt::ivec3(static_cast<int>(x), static_cast<int>(y), z) - center;
+                uint32_t shell = (static_cast<uint32_t>(tgt::dot(d, d)) >> 6) & 0xFF;
+
+                // integer hash of position and seed
+                uint32_t h = static_cast<uint32_t>(index) ^ seed;
+                h ^= h >> 16;
+                h *= 0x85EBCA6Bu;
+                h ^= h >> 13;
+                h *= 0xC2B2AE35u;
+                h ^= h >> 16;
+
+                float value = 0.75f * (shell / 255.f) + 0.25f * ((h & 0xFFFF) / 65535.f);
+                volume->setVoxelFloat(value, index);
+            }
+        }
+    }
+    return volume;
+}
+
+/// Runs a single iteration of the given kernel.
+template<typename T>
+void runKernel(const std::string& kernel, const VolumeHandle* handle) {
+    const VolumeAtomic<T>* volume = static_cast<const VolumeAtomic<T>*>(handle->getRepresentation<Volume>());
+
+    if (kernel == "halfsample")
+        delete VolumeOperatorHalfsampleGeneric<T>().apply(handle);
+    else if (kernel == "resample")
+        delete VolumeOperatorResampleGeneric<T>().apply(handle, tgt::max(tgt::ivec3(volume->getDimensions()) * 3 / 4, tgt::ivec3(1)), Volume::LINEAR);
+    else if (kernel == "median")
+        delete VolumeOperatorMedianGeneric<T>().apply(handle, 3);
+    else if (kernel == "erosion")
+        delete VolumeOperatorErosionGeneric<T>().apply(handle, 3);
+    else if (kernel == "dilation")
+        delete VolumeOperatorDilationGeneric<T>().apply(handle, 3);
+    else if (kernel == "gradient")
+        delete calcGradientsCentralDifferences<uint8_t>(handle);
+    else if (kernel == "histogram")
+        resultSink = static_cast<float>(HistogramIntensity(volume, 256).getMaxValue());
+    else if (kernel == "minmax")
+        resultSink = static_cast<float>(VolumeOperatorMinValue::apply(volume)) + static_cast<float>(VolumeOperatorMaxValue::apply(volume));
+    else if (kernel == "hash")
+        delete VolumeHash().createFrom(handle);
+    else
+        throw tgt::Exception("Unknown kernel: " + kernel);
+}
+
+/// Timings of one kernel.
+struct KernelResult {
+    std::string name_;
+    std::vector<double> times_;   ///< seconds per iteration
+    size_t peakMemory_;
+};
+
+template<typename T>
+std::vector<KernelResult> runBenchmark(const tgt::svec3& dimensions, const std::vector<std::string>& kernels,
+                                       int iterations, const std::string& loggerCat_)
+{
+    VolumeHandle handle(createSyntheticVolume<T>(dimensions, 0x5EED), tgt::vec3(1.f), tgt::vec3(0.f));
+
+    std::vector<KernelResult> results;
+    for (size_t k = 0; k < kernels.size(); k++) {
+        KernelResult result;
+        result.name_ = kernels[k];
+
+        // warm-up run, not measured
+        runKernel<T>(kernels[k], &handle);
+        for (int i = 0; i < iterations; i++) {
+            uint64_t start = ProfilingBlock::getTimestamp();
+            runKernel<T>(kernels[k], &handle);
+            result.times_.push_back(static_cast<double>(ProfilingBlock::getTimestamp() - start) * 1.0e-9);
+        }
+        result.peakMemory_ = getPeakMemoryUsage();
+
+        double mean = 0.0;
+        for (size_t i = 0; i < result.times_.size(); i++)
+            mean += result.times_[i] / result.times_.size();
+        LINFO(kernels[k] << ": " << mean * 1000.0 << " ms");
+
+        results.push_back(result);
+    }
+    return results;
+}
+
+} // namespace
+
+CommandBench::CommandBench() :
+    Command("--bench", "", "Benchmark volume operators on a synthetic volume and write the timings as JSON.\n\
+\t\tTYPE: uint8, uint16 or float\n\
+\t\tKERNELS: comma-separated list of halfsample, resample, median, erosion, dilation,\n\
+\t\tgradient, histogram, minmax, hash, or all\n\
+\t\tOUT: JSON file, - for the standard output",
+        "<TYPE DX DY DZ ITERATIONS KERNELS OUT>", 7)
+{
+    loggerCat_ += "." + name_;
+}
+
+bool CommandBench::checkParameters(const std::vector<std::string>& parameters) {
+    std::set<std::string> types;
+    types.insert("uint8");
+    types.insert("uint16");
+    types.insert("float");
+    if (parameters.size() != 7 || !isValueInSet(parameters[0], types)) {
+        errorMsg_ = "unknown volume type";
+        return false;
+    }
+    for (size_t i = 1; i <= 4; i++) {
+        if (!is<int>(parameters[i]) || cast<int>(parameters[i]) < 1) {
+            errorMsg_ = "dimensions and iterations must be positive integers";
+            return false;
+        }
+    }
+
+    if (parameters[5] != "all") {
+        std::set<std::string> kernels(KERNELS, KERNELS + NUM_KERNELS);
+        std::istringstream kernelList(parameters[5]);
+        std::string kernel;
+        while (std::getline(kernelList, kernel, ',')) {
+            if (!isValueInSet(kernel, kernels)) {
+                errorMsg_ = "unknown kernel: " + kernel;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool CommandBench::execute(const std::vector<std::string>& parameters) {
+    const std::string& type = parameters[0];
+    tgt::svec3 dimensions(cast<size_t>(parameters[1]), cast<size_t>(parameters[2]), cast<size_t>(parameters[3]));
+    int iterations = cast<int>(parameters[4]);
+
+    std::vector<std::string> kernels;
+    if (parameters[5] == "all") {
+        kernels.assign(KERNELS, KERNELS + NUM_KERNELS);
+    }
+    else {
+        std::istringstream kernelList(parameters[5]);
+        std::string kernel;
+        while (std::getline(kernelList, kernel, ','))
+            kernels.push_back(kernel);
+    }
+
+    LINFO("Benchmarking " << kernels.size() << " kernels on " << type << " volume " << dimensions
+          << ", " << iterations << " iterations");
+
+    std::vector<KernelResult> results;
+    size_t bytesPerVoxel;
+    if (type == "uint8") {
+        results = runBenchmark<uint8_t>(dimensions, kernels, iterations, loggerCat_);
+        bytesPerVoxel = 1;
+    }
+    else if (type == "uint16") {
+        results = runBenchmark<uint16_t>(dimensions, kernels, iterations, loggerCat_);
+        bytesPerVoxel = 2;
+    }
+    else {
+        results = runBenchmark<float>(dimensions, kernels, iterations, loggerCat_);
+        bytesPerVoxel = 4;
+    }
+
+    const double numVoxels = static_cast<double>(tgt::hmul(dimensions));
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"volume\": { \"type\": \"" << type << "\", \"dimensions\": [" << dimensions.x << ", "
+         << dimensions.y << ", " << dimensions.z << "], \"voxels\": " << static_cast<uint64_t>(numVoxels)
+         << ", \"bytes\": " << static_cast<uint64_t>(numVoxels * bytesPerVoxel) << " },\n";
+    json << "  \"iterations\": " << iterations << ",\n";
+    json << "  \"threads\": " << numThreads << ",\n";
+    json << "  \"kernels\": [\n";
+    for (size_t k = 0; k < results.size(); k++) {
+        const std::vector<double>& times = results[k].times_;
+        double mean = 0.0;
+        for (size_t i = 0; i < times.size(); i++)
+            mean += times[i] / times.size();
+        double minTime = *std::min_element(times.begin(), times.end());
+        double maxTime = *std::max_element(times.begin(), times.end());
+
+        json << "    { \"name\": \"" << results[k].name_ << "\""
+             << ", \"mean_s\": " << mean
+             << ", \"min_s\": " << minTime
+             << ", \"max_s\": " << maxTime
+             << ", \"voxels_per_s\": " << numVoxels / mean
+             << ", \"bytes_per_s\": " << numVoxels * bytesPerVoxel / mean
+             << ", \"peak_rss_bytes\": " << results[k].peakMemory_ << " }"
+             << (k + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "  ],\n";
+    json << "  \"peak_rss_bytes\": " << getPeakMemoryUsage() << "\n";
+    json << "}\n";
+
+    if (parameters[6] == "-") {
+        std::cout << json.str();
+    }
+    else {
+        std::ofstream out(parameters[6].c_str());
+        out << json.str();
+        if (!out.good())
+            throw tgt::IOException("Failed to write benchmark results", parameters[6]);
+    }
+    return true;
+}
+
+}   //namespace voreen
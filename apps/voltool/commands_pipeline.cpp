@@ -0,0 +1,717 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "commands_pipeline.h"
+#include "voreen/core/io/datvolumereader.h"
+#include "voreen/core/io/datvolumewriter.h"
+#include "voreen/core/io/textfilereader.h"
+#include "voreen/core/datastructures/volume/gradient.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/volumecollection.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorconvert.h"
+
+#include "tgt/exception.h"
+#include "tgt/vector.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+namespace voreen {
+
+namespace {
+
+/// Takes the volume out of the passed handle and deletes the handle.
+Volume* releaseVolume(VolumeHandle* handle) {
+    Volume* volume = const_cast<Volume*>(handle->getRepresentation<Volume>());
+    handle->releaseVolumes();
+    delete handle;
+    return volume;
+}
+
+/**
+ * A stage of a slab pipeline. Each stage produces its output volume slab by slab
+ * and requests the input slices it needs for a slab from the preceding stage.
+ * Only the first stage reads from disk.
+ */
+class SlabStage {
+public:
+    /// Takes ownership of the input stage.
+    SlabStage(SlabStage* input)
+        : input_(input)
+    {}
+
+    virtual ~SlabStage() {
+        delete input_;
+    }
+
+    /// Returns the dimensions of the complete output volume.
+    virtual tgt::svec3 getDimensions() const {
+        return input_->getDimensions();
+    }
+
+    /// Returns the voxel spacing of the output volume.
+    virtual tgt::vec3 getSpacing() const {
+        return input_->getSpacing();
+    }
+
+    /// Returns the size of an output voxel in bytes.
+    virtual size_t getBytesPerVoxel() const {
+        return input_->getBytesPerVoxel();
+    }
+
+    /// Determines the input slices [inFirst, inLast) needed for the output slices [first, last).
+    virtual void getInputRange(size_t first, size_t last, size_t& inFirst, size_t& inLast) const {
+        inFirst = first;
+        inLast = last;
+    }
+
+    /// Returns the number of bytes held in memory while the output slices [first, last) are computed.
+    virtual size_t getPeakMemory(size_t first, size_t last) const {
+        size_t inFirst, inLast;
+        getInputRange(first, last, inFirst, inLast);
+        return std::max(input_->getPeakMemory(inFirst, inLast),
+                        input_->getSlabBytes(inFirst, inLast) + getSlabBytes(first, last));
+    }
+
+    /// Returns the size of the output slices [first, last) in bytes.
+    size_t getSlabBytes(size_t first, size_t last) const {
+        tgt::svec3 dim = getDimensions();
+        return dim.x * dim.y * (last - first) * getBytesPerVoxel();
+    }
+
+    /// Computes the output slices [first, last). The caller takes ownership of the returned volume.
+    virtual Volume* getSlab(size_t first, size_t last) = 0;
+
+protected:
+    SlabStage* input_;
+};
+
+/**
+ * Reads slabs from a .dat/.raw volume.
+ */
+class DatSlabSource : public SlabStage {
+public:
+    DatSlabSource(const std::string& filename)
+        : SlabStage(0)
+        , filename_(filename)
+        , spacing_(1.f)
+        , bytesPerVoxel_(0)
+    {
+        TextFileReader reader(filename);
+        if (!reader)
+            throw tgt::FileNotFoundException("reading dat file", filename);
+
+        tgt::ivec3 dimensions(0);
+        std::string type;
+        std::istringstream args;
+        while (reader.getNextLine(type, args, false)) {
+            if (type == "Resolution:")
+                args >> dimensions.x >> dimensions.y >> dimensions.z;
+            else if (type == "SliceThickness:")
+                args >> spacing_.x >> spacing_.y >> spacing_.z;
+        }
+        if (tgt::hor(tgt::lessThanEqual(dimensions, tgt::ivec3(0))))
+            throw tgt::CorruptedFileException("Invalid resolution or resolution not specified", filename);
+        dimensions_ = tgt::svec3(dimensions);
+
+        // the voxel type is only known after reading data
+        Volume* slice = getSlab(0, 1);
+        bytesPerVoxel_ = slice->getBytesPerVoxel();
+        delete slice;
+    }
+
+    virtual tgt::svec3 getDimensions() const {
+        return dimensions_;
+    }
+
+    virtual tgt::vec3 getSpacing() const {
+        return spacing_;
+    }
+
+    virtual size_t getBytesPerVoxel() const {
+        return bytesPerVoxel_;
+    }
+
+    virtual size_t getPeakMemory(size_t first, size_t last) const {
+        return getSlabBytes(first, last);
+    }
+
+    virtual Volume* getSlab(size_t first, size_t last) {
+        DatVolumeReader reader;
+        VolumeCollection* collection = reader.readSlices(filename_, first, last, 0);
+        if (!collection || collection->empty()) {
+            delete collection;
+            throw tgt::CorruptedFileException("Failed to read slices", filename_);
+        }
+        VolumeHandle* handle = static_cast<VolumeHandle*>(collection->first());
+        delete collection;
+        return releaseVolume(handle);
+    }
+
+private:
+    std::string filename_;
+    tgt::svec3 dimensions_;
+    tgt::vec3 spacing_;
+    size_t bytesPerVoxel_;
+};
+
+/**
+ * Cuts a sub-volume out of the input volume, see CommandSubSet.
+ */
+class SubsetStage : public SlabStage {
+public:
+    SubsetStage(SlabStage* input, const tgt::svec3& offset, const tgt::svec3& dimensions)
+        : SlabStage(input)
+        , offset_(offset)
+        , dimensions_(dimensions)
+    {
+        if (tgt::hor(tgt::greaterThan(offset + dimensions, input->getDimensions())))
+            throw tgt::Exception("subset exceeds the input volume");
+    }
+
+    virtual tgt::svec3 getDimensions() const {
+        return dimensions_;
+    }
+
+    virtual void getInputRange(size_t first, size_t last, size_t& inFirst, size_t& inLast) const {
+        inFirst = first + offset_.z;
+        inLast = last + offset_.z;
+    }
+
+    virtual Volume* getSlab(size_t first, size_t last) {
+        size_t inFirst, inLast;
+        getInputRange(first, last, inFirst, inLast);
+        Volume* input = input_->getSlab(inFirst, inLast);
+        Volume* output = input->getSubVolume(tgt::svec3(dimensions_.x, dimensions_.y, last - first),
+                                             tgt::svec3(offset_.x, offset_.y, 0));
+        delete input;
+        return output;
+    }
+
+private:
+    tgt::svec3 offset_;
+    tgt::svec3 dimensions_;
+};
+
+/**
+ * Mirrors the input volume on the z axis, see CommandMirrorZ.
+ */
+class MirrorZStage : public SlabStage {
+public:
+    MirrorZStage(SlabStage* input)
+        : SlabStage(input)
+    {}
+
+    virtual void getInputRange(size_t first, size_t last, size_t& inFirst, size_t& inLast) const {
+        size_t depth = getDimensions().z;
+        inFirst = depth - last;
+        inLast = depth - first;
+    }
+
+    virtual Volume* getSlab(size_t first, size_t last) {
+        size_t inFirst, inLast;
+        getInputRange(first, last, inFirst, inLast);
+        Volume* slab = input_->getSlab(inFirst, inLast);
+
+        // reverse the slice order in place
+        size_t sliceBytes = getSlabBytes(0, 1);
+        char* data = static_cast<char*>(slab->getData());
+        for (size_t z = 0; z < (last - first) / 2; z++) {
+            char* front = data + z * sliceBytes;
+            char* back = data + (last - first - 1 - z) * sliceBytes;
+            std::swap_ranges(front, front + sliceBytes, back);
+        }
+        return slab;
+    }
+};
+
+/**
+ * Resamples a slab of the input volume with the same sample positions as
+ * VolumeOperatorResample uses for the whole volume.
+ *
+ * @param input input slices starting at slice inFirst
+ * @param inDepth number of slices of the complete input volume
+ * @param output output slices starting at slice outFirst
+ */
+template<typename T>
+bool resampleSlabGeneric(const Volume* input, size_t inFirst, size_t inDepth, Volume* output, size_t outFirst,
+                         const tgt::vec3& ratio, Volume::Filter filter)
+{
+    const VolumeAtomic<T>* in = dynamic_cast<const VolumeAtomic<T>*>(input);
+    VolumeAtomic<T>* out = dynamic_cast<VolumeAtomic<T>*>(output);
+    if (!in || !out)
+        return false;
+
+    typedef typename VolumeElement<T>::DoubleType Double;
+    const tgt::ivec3 inDims(static_cast<int>(in->getDimensions().x), static_cast<int>(in->getDimensions().y),
+                            static_cast<int>(inDepth));
+    const tgt::ivec3 outDims(out->getDimensions());
+    const int zOffset = static_cast<int>(inFirst);
+
+    #pragma omp parallel for
+    for (int z = 0; z < outDims.z; ++z) {
+        tgt::ivec3 pos(0, 0, z);
+        tgt::vec3 nearest;
+        nearest.z = static_cast<float>(outFirst + z) * ratio.z;
+
+        for (pos.y = 0; pos.y < outDims.y; ++pos.y) {
+            nearest.y = static_cast<float>(pos.y) * ratio.y;
+
+            for (pos.x = 0; pos.x < outDims.x; ++pos.x) {
+                nearest.x = static_cast<float>(pos.x) * ratio.x;
+
+                if (filter == Volume::NEAREST) {
+                    tgt::ivec3 index = tgt::ivec3(tgt::clamp(tgt::svec3(nearest + 0.5f), tgt::svec3(0, 0, 0),
+                                                             tgt::svec3(inDims - 1)));
+                    out->voxel(pos) = in->voxel(index.x, index.y, index.z - zOffset);
+                }
+                else {
+                    tgt::vec3 p = nearest - floor(nearest); // get decimal part
+                    tgt::ivec3 llb = tgt::ivec3(nearest);
+                    tgt::ivec3 urf = tgt::ivec3(ceil(nearest));
+                    urf = tgt::min(urf, inDims - 1);
+                    llb.z -= zOffset;
+                    urf.z -= zOffset;
+
+                    out->voxel(pos) =
+                        T(  Double(in->voxel(llb.x, llb.y, llb.z)) * static_cast<double>((1.f-p.x)*(1.f-p.y)*(1.f-p.z))  // llB
+                          + Double(in->voxel(urf.x, llb.y, llb.z)) * static_cast<double>((    p.x)*(1.f-p.y)*(1.f-p.z))  // lrB
+                          + Double(in->voxel(urf.x, urf.y, llb.z)) * static_cast<double>((    p.x)*(    p.y)*(1.f-p.z))  // urB
+                          + Double(in->voxel(llb.x, urf.y, llb.z)) * static_cast<double>((1.f-p.x)*(    p.y)*(1.f-p.z))  // ulB
+                          + Double(in->voxel(llb.x, llb.y, urf.z)) * static_cast<double>((1.f-p.x)*(1.f-p.y)*(    p.z))  // llF
+                          + Double(in->voxel(urf.x, llb.y, urf.z)) * static_cast<double>((    p.x)*(1.f-p.y)*(    p.z))  // lrF
+                          + Double(in->voxel(urf.x, urf.y, urf.z)) * static_cast<double>((    p.x)*(    p.y)*(    p.z))  // urF
+                          + Double(in->voxel(llb.x, urf.y, urf.z)) * static_cast<double>((1.f-p.x)*(    p.y)*(    p.z)));// ulF
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool resampleSlab(const Volume* input, size_t inFirst, size_t inDepth, Volume* output, size_t outFirst,
+                  const tgt::vec3& ratio, Volume::Filter filter)
+{
+    return resampleSlabGeneric<uint8_t>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<int8_t>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<uint16_t>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<int16_t>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<uint32_t>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<int32_t>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<float>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<double>(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<tgt::Vector3<uint8_t> >(input, inFirst, inDepth, output, outFirst, ratio, filter)
+        || resampleSlabGeneric<tgt::Vector4<uint8_t> >(input, inFirst, inDepth, output, outFirst, ratio, filter);
+}
+
+/**
+ * Resamples the input volume to the given dimensions, see CommandScale.
+ */
+class ScaleStage : public SlabStage {
+public:
+    ScaleStage(SlabStage* input, const tgt::svec3& dimensions, Volume::Filter filter)
+        : SlabStage(input)
+        , dimensions_(dimensions)
+        , ratio_(tgt::vec3(input->getDimensions()) / tgt::vec3(dimensions))
+        , filter_(filter)
+    {}
+
+    virtual tgt::svec3 getDimensions() const {
+        return dimensions_;
+    }
+
+    virtual tgt::vec3 getSpacing() const {
+        return input_->getSpacing() * ratio_;
+    }
+
+    virtual void getInputRange(size_t first, size_t last, size_t& inFirst, size_t& inLast) const {
+        // covers both the rounded (nearest) and the floor/ceil (linear) sample positions
+        inFirst = static_cast<size_t>(static_cast<float>(first) * ratio_.z);
+        inLast = static_cast<size_t>(ceil(static_cast<float>(last - 1) * ratio_.z + 0.5f)) + 1;
+        inLast = std::min(inLast, input_->getDimensions().z);
+    }
+
+    virtual Volume* getSlab(size_t first, size_t last) {
+        size_t inFirst, inLast;
+        getInputRange(first, last, inFirst, inLast);
+        Volume* input = input_->getSlab(inFirst, inLast);
+
+        Volume* output = 0;
+        try {
+            output = input->createNew(tgt::svec3(dimensions_.x, dimensions_.y, last - first),
+                                      VolumeRepresentation::VolumeBorders(), true);
+        }
+        catch (std::bad_alloc&) {
+            delete input;
+            throw;
+        }
+
+        bool success = resampleSlab(input, inFirst, input_->getDimensions().z, output, first, ratio_, filter_);
+        delete input;
+        if (!success) {
+            delete output;
+            throw tgt::Exception("scale: unsupported volume type");
+        }
+        return output;
+    }
+
+private:
+    tgt::svec3 dimensions_;
+    tgt::vec3 ratio_;
+    Volume::Filter filter_;
+};
+
+/**
+ * Calculates gradients of the input volume, see CommandGrad. One neighboring
+ * slice on each side of a slab is read as halo.
+ */
+class GradientStage : public SlabStage {
+public:
+    GradientStage(SlabStage* input, const std::string& method)
+        : SlabStage(input)
+        , method_(method)
+    {}
+
+    virtual size_t getBytesPerVoxel() const {
+        // the 26 neighborhood gradients are stored with an additional channel
+        return (method_ == "26" ? 4 : 3);
+    }
+
+    virtual void getInputRange(size_t first, size_t last, size_t& inFirst, size_t& inLast) const {
+        inFirst = (first > 0 ? first - 1 : 0);
+        inLast = std::min(last + 1, getDimensions().z);
+    }
+
+    virtual size_t getPeakMemory(size_t first, size_t last) const {
+        size_t inFirst, inLast;
+        getInputRange(first, last, inFirst, inLast);
+        return std::max(input_->getPeakMemory(inFirst, inLast),
+                        input_->getSlabBytes(inFirst, inLast) + getSlabBytes(inFirst, inLast) + getSlabBytes(first, last));
+    }
+
+    virtual Volume* getSlab(size_t first, size_t last) {
+        size_t inFirst, inLast;
+        getInputRange(first, last, inFirst, inLast);
+        VolumeHandle input(input_->getSlab(inFirst, inLast), input_->getSpacing(), tgt::vec3(0.f));
+
+        VolumeHandle* gradients = 0;
+        if (method_ == "simple")
+            gradients = calcGradientsCentralDifferences<uint8_t>(&input);
+        else if (method_ == "26")
+            gradients = calcGradients26(&input);
+        else if (method_ == "sobel")
+            gradients = calcGradientsSobel<uint8_t>(&input);
+        if (!gradients)
+            throw tgt::Exception("grad: failed to calculate gradients");
+
+        // strip the halo
+        Volume* halo = releaseVolume(gradients);
+        Volume* output = halo->getSubVolume(tgt::svec3(getDimensions().x, getDimensions().y, last - first),
+                                            tgt::svec3(0, 0, first - inFirst));
+        delete halo;
+        return output;
+    }
+
+private:
+    std::string method_;
+};
+
+/**
+ * Converts the input volume to 8, 12 or 16 bit, see CommandConvert. Since float
+ * volumes are normalized by their intensity range, the range of the complete
+ * input volume is determined in an additional pass before the first slab is converted.
+ */
+class ConvertStage : public SlabStage {
+public:
+    ConvertStage(SlabStage* input, int bits)
+        : SlabStage(input)
+        , bits_(bits)
+        , rangeDetermined_(false)
+    {}
+
+    virtual size_t getBytesPerVoxel() const {
+        return (bits_ == 8 ? 1 : 2);
+    }
+
+    virtual Volume* getSlab(size_t first, size_t last) {
+        VolumeHandle input(input_->getSlab(first, last), input_->getSpacing(), tgt::vec3(0.f));
+
+        VolumeOperatorConvert converter;
+        const Volume* inputVolume = input.getRepresentation<Volume>();
+        if (dynamic_cast<const VolumeFloat*>(inputVolume) || dynamic_cast<const VolumeDouble*>(inputVolume)) {
+            if (!rangeDetermined_)
+                determineRange(last - first);
+            converter.setInputIntensityRange(range_);
+        }
+
+        VolumeHandle* output;
+        if (bits_ == 8)
+            output = converter.apply<uint8_t>(&input);
+        else
+            output = converter.apply<uint16_t>(&input);
+
+        Volume* outputVolume = releaseVolume(output);
+        if (bits_ == 12)
+            outputVolume->setBitsStored(12);
+        return outputVolume;
+    }
+
+private:
+    void determineRange(size_t slabDepth) {
+        LINFOC("voreen.voltool.pipeline", "Determining intensity range of float input");
+        range_ = tgt::dvec2(std::numeric_limits<double>::max(), -std::numeric_limits<double>::max());
+        size_t depth = input_->getDimensions().z;
+        for (size_t z = 0; z < depth; z += slabDepth) {
+            Volume* slab = input_->getSlab(z, std::min(z + slabDepth, depth));
+            size_t numVoxels = slab->getNumVoxels();
+            for (size_t i = 0; i < numVoxels; i++) {
+                double value = slab->getVoxelFloat(i);
+                range_.x = std::min(range_.x, value);
+                range_.y = std::max(range_.y, value);
+            }
+            delete slab;
+        }
+        if (range_.x >= range_.y)
+            range_.y = range_.x + 1.0;
+        rangeDetermined_ = true;
+    }
+
+    int bits_;
+    bool rangeDetermined_;
+    tgt::dvec2 range_;
+};
+
+/// Returns the number of arguments of the passed pipeline stage, or -1 for unknown stages.
+int getStageArgumentNumber(const std::string& stage) {
+    if (stage == "subset")
+        return 6;
+    else if (stage == "scale")
+        return 4;
+    else if (stage == "mirrorz")
+        return 0;
+    else if (stage == "grad" || stage == "convert")
+        return 1;
+    else
+        return -1;
+}
+
+/// Returns the peak memory for slabs of the given depth, sampled at the start, middle and end of the volume.
+size_t estimatePeakMemory(const SlabStage* pipeline, size_t slabDepth) {
+    size_t depth = pipeline->getDimensions().z;
+    size_t middle = std::min(depth / 2, depth - slabDepth);
+    return std::max(pipeline->getPeakMemory(0, slabDepth),
+                    std::max(pipeline->getPeakMemory(middle, middle + slabDepth),
+                             pipeline->getPeakMemory(depth - slabDepth, depth)));
+}
+
+} // namespace
+
+CommandPipeline::CommandPipeline() :
+    Command("--pipeline", "", "Execute a chain of operations slab by slab with bounded memory.\n\
+\t\tReads and writes dat/raw volumes, holds at most about MEMORY megabytes in memory.\n\
+\t\tMust be the last command. Stages are executed in the given order:\n\
+\t\tsubset X Y Z DX DY DZ: cut out sub-volume (see --subset)\n\
+\t\tscale [n|nearest|l|linear] DX DY DZ: resample (see --scale)\n\
+\t\tmirrorz: mirror on z axis (see --mirrorz)\n\
+\t\tgrad [simple|26|sobel]: calculate gradients (see --grad)\n\
+\t\tconvert [8|12|16]: convert bit depth (see --convert)",
+        "<MEMORY IN.dat OUT.dat [STAGE ARGS]...>", -1)
+{
+    loggerCat_ += "." + name_;
+}
+
+bool CommandPipeline::checkParameters(const std::vector<std::string>& parameters) {
+    if (parameters.size() < 3 || !is<int>(parameters[0]) || cast<int>(parameters[0]) < 1) {
+        errorMsg_ = "expected memory limit in MB, input and output file";
+        return false;
+    }
+
+    for (size_t i = 1; i <= 2; i++) {
+        std::string::size_type dot = parameters[i].rfind(".");
+        if (dot == std::string::npos || parameters[i].substr(dot) != ".dat") {
+            errorMsg_ = "dat file expected: " + parameters[i];
+            return false;
+        }
+    }
+
+    std::set<std::string> filters;
+    filters.insert("n");
+    filters.insert("nearest");
+    filters.insert("l");
+    filters.insert("linear");
+    std::set<std::string> methods;
+    methods.insert("simple");
+    methods.insert("26");
+    methods.insert("sobel");
+    std::set<std::string> bits;
+    bits.insert("8");
+    bits.insert("12");
+    bits.insert("16");
+
+    size_t i = 3;
+    while (i < parameters.size()) {
+        const std::string& stage = parameters[i];
+        int numArguments = getStageArgumentNumber(stage);
+        if (numArguments < 0) {
+            errorMsg_ = "unknown stage: " + stage;
+            return false;
+        }
+        if (i + numArguments >= parameters.size()) {
+            errorMsg_ = "missing arguments for stage " + stage;
+            return false;
+        }
+
+        bool valid = true;
+        if (stage == "subset") {
+            for (int j = 1; j <= 6; j++)
+                valid &= is<int>(parameters[i + j]);
+        }
+        else if (stage == "scale") {
+            valid = isValueInSet(parameters[i + 1], filters);
+            for (int j = 2; j <= 4; j++)
+                valid &= is<int>(parameters[i + j]) && cast<int>(parameters[i + j]) > 0;
+        }
+        else if (stage == "grad") {
+            valid = isValueInSet(parameters[i + 1], methods);
+        }
+        else if (stage == "convert") {
+            valid = isValueInSet(parameters[i + 1], bits);
+        }
+        if (!valid) {
+            errorMsg_ = "invalid arguments for stage " + stage;
+            return false;
+        }
+
+        i += numArguments + 1;
+    }
+    return true;
+}
+
+bool CommandPipeline::execute(const std::vector<std::string>& parameters) {
+    size_t maxMemory = cast<size_t>(parameters[0]) << 20;
+    const std::string& outputFile = parameters[2];
+
+    // build pipeline
+    SlabStage* pipeline = new DatSlabSource(parameters[1]);
+    try {
+        size_t i = 3;
+        while (i < parameters.size()) {
+            const std::string& stage = parameters[i];
+            if (stage == "subset") {
+                tgt::svec3 offset(cast<size_t>(parameters[i+1]), cast<size_t>(parameters[i+2]), cast<size_t>(parameters[i+3]));
+                tgt::svec3 dimensions(cast<size_t>(parameters[i+4]), cast<size_t>(parameters[i+5]), cast<size_t>(parameters[i+6]));
+                pipeline = new SubsetStage(pipeline, offset, dimensions);
+            }
+            else if (stage == "scale") {
+                Volume::Filter filter = (parameters[i+1][0] == 'n' ? Volume::NEAREST : Volume::LINEAR);
+                tgt::svec3 dimensions(cast<size_t>(parameters[i+2]), cast<size_t>(parameters[i+3]), cast<size_t>(parameters[i+4]));
+                pipeline = new ScaleStage(pipeline, dimensions, filter);
+            }
+            else if (stage == "mirrorz") {
+                pipeline = new MirrorZStage(pipeline);
+            }
+            else if (stage == "grad") {
+                pipeline = new GradientStage(pipeline, parameters[i+1]);
+            }
+            else if (stage == "convert") {
+                pipeline = new ConvertStage(pipeline, cast<int>(parameters[i+1]));
+            }
+            LINFO("Stage " << stage << ": " << pipeline->getDimensions());
+            i += getStageArgumentNumber(stage) + 1;
+        }
+    }
+    catch (...) {
+        delete pipeline;
+        throw;
+    }
+
+    // choose the slab depth so that the memory limit is met
+    tgt::svec3 dimensions = pipeline->getDimensions();
+    size_t slabDepth = dimensions.z;
+    while (slabDepth > 1 && estimatePeakMemory(pipeline, slabDepth) > maxMemory)
+        slabDepth = (slabDepth + 1) / 2;
+    size_t peakMemory = estimatePeakMemory(pipeline, slabDepth);
+    if (peakMemory > maxMemory)
+        LWARNING("Memory limit too low, single slices require " << (peakMemory >> 20) << " MB");
+    LINFO("Processing " << dimensions.z << " slices in slabs of " << slabDepth
+          << " slices (~" << (peakMemory >> 20) << " MB)");
+
+    std::string rawFile = outputFile.substr(0, outputFile.rfind(".")) + ".raw";
+    FILE* fout = fopen(rawFile.c_str(), "wb");
+    if (!fout) {
+        delete pipeline;
+        throw tgt::IOException("Unable to open raw file for writing", rawFile);
+    }
+
+    // stream slabs to the raw file, keep one slice for generating the dat file
+    Volume* firstSlice = 0;
+    try {
+        for (size_t z = 0; z < dimensions.z; z += slabDepth) {
+            size_t last = std::min(z + slabDepth, dimensions.z);
+            LINFO("Slices " << z << " - " << (last - 1));
+
+            Volume* slab = pipeline->getSlab(z, last);
+            if (!firstSlice)
+                firstSlice = slab->getSubVolume(tgt::svec3(dimensions.x, dimensions.y, 1));
+            size_t written = fwrite(slab->getData(), 1, slab->getNumBytes(), fout);
+            size_t numBytes = slab->getNumBytes();
+            delete slab;
+            if (written != numBytes)
+                throw tgt::IOException("Failed to write raw file", rawFile);
+        }
+    }
+    catch (...) {
+        fclose(fout);
+        delete firstSlice;
+        delete pipeline;
+        throw;
+    }
+    fclose(fout);
+
+    // write dat file with the resolution of the complete volume
+    VolumeHandle header(firstSlice, pipeline->getSpacing(), tgt::vec3(0.f));
+    delete pipeline;
+    std::istringstream datStream(DatVolumeWriter().getDatFileString(&header, rawFile));
+    std::ofstream datout(outputFile.c_str());
+    std::string line;
+    while (std::getline(datStream, line)) {
+        if (line.find("Resolution:") == 0)
+            datout << "Resolution:\t" << dimensions.x << " " << dimensions.y << " " << dimensions.z << std::endl;
+        else if (line.find("Checksum:") != 0)
+            datout << line << std::endl;
+    }
+    if (datout.bad())
+        throw tgt::IOException("Failed to write dat file", outputFile);
+
+    return true;
+}
+
+}   //namespace voreen
@@ -0,0 +1,54 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_COMMANDS_PIPELINE_H
+#define VRN_COMMANDS_PIPELINE_H
+
+#include "voreen/core/utils/cmdparser/command.h"
+
+namespace voreen {
+
+/**
+ * Chains several volume operations and executes them slab by slab, so that
+ * volumes larger than the main memory can be processed. The input is read from
+ * and the result is written to .dat/.raw files, only a bounded number of slices
+ * of each intermediate volume is held in memory at a time.
+ *
+ * Since the command consumes the remainder of the command line, it has to be the
+ * last command.
+ */
+class CommandPipeline : public Command {
+public:
+    CommandPipeline();
+    bool checkParameters(const std::vector<std::string>& parameters);
+    bool execute(const std::vector<std::string>& parameters);
+};
+
+}   //namespace voreen
+
+#endif //VRN_COMMANDS_PIPELINE_H
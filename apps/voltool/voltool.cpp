@@ -31,12 +31,16 @@
 #include <conio.h>
 #endif
 
+#include "commands_bench.h"
 #include "commands_grad.h"
 #include "commands_convert.h"
 #include "commands_create.h"
 #include "commands_modify.h"
+#include "commands_pipeline.h"
 
 #include "voreen/core/utils/cmdparser/commandlineparser.h"
+#include "voreen/core/utils/cmdparser/singlecommand.h"
+#include "voreen/core/datastructures/volume/diskrepresentation.h"
 
 #include "tgt/init.h"
 #include "tgt/exception.h"
@@ -87,9 +91,22 @@ int main(int argc, char** argv) {
     cmdparser.addCommand(new CommandMirrorZ());
     cmdparser.addCommand(new CommandSubSet());
 
+    cmdparser.addCommand(new CommandPipeline());
+
+    cmdparser.addCommand(new CommandBench());
+
 
     //cmdparser.addCommand(new CommandStretchHisto());
 
+    // the commands are executed in no particular order, so the option is applied before executing them
+    bool useMemoryMapping = false;
+    cmdparser.addCommand(new SingleCommandZeroArguments(&useMemoryMapping, "--useMemoryMapping", "",
+        "Maps volume files into memory instead of reading them (files must not be changed while in use)"));
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--useMemoryMapping")
+            RepresentationConverterLoadFromDisk::setUseMemoryMapping(true);
+    }
+
 #ifdef _OPENMP
     LINFO("OpenMP Supported.");
     LINFO("Number of processors: " << omp_get_num_procs());
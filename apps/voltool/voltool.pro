@@ -34,6 +34,8 @@ win32 {
  contains(DEFINES, VRN_WITH_DEVIL) {
      LIBS += "$${DEVIL_DIR}/lib/ILU.lib"
   }
+  # peak memory usage for --bench
+  LIBS += -lpsapi
 }
 
 unix {
@@ -43,16 +45,20 @@ unix {
 }
 
 SOURCES	+= voltool.cpp \
+           commands_bench.cpp \
            commands_grad.cpp \
            commands_convert.cpp \
            commands_create.cpp \
            commands_modify.cpp \
+           commands_pipeline.cpp \
            commands_registration.cpp
 
-HEADERS +=  commands_grad.h \
+HEADERS +=  commands_bench.h \
+            commands_grad.h \
             commands_convert.h \
             commands_create.h \
             commands_modify.h \
+            commands_pipeline.h \
             commands_registration.h
 
 exists(voltool-internal.pri) : include(voltool-internal.pri)
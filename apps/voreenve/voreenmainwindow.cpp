@@ -1382,6 +1382,7 @@ void VoreenMainWindow::openWorkspace() {
 
     QStringList filters;
     filters << "Voreen workspaces (*.vws)";
+    filters << "Binary Voreen workspaces (*.vwb)";
 #ifdef VRN_MODULE_ZIP
     filters << "Voreen workspace archives (*.zip)";
 #endif
@@ -1449,6 +1450,7 @@ bool VoreenMainWindow::saveWorkspaceAs() {
 
     QStringList filters;
     filters << "Voreen workspaces (*.vws)";
+    filters << "Binary Voreen workspaces (*.vwb)";
 #ifdef VRN_MODULE_ZIP
     filters << "Voreen workspace archives (*.zip)";
 #endif
@@ -1472,6 +1474,12 @@ bool VoreenMainWindow::saveWorkspaceAs() {
             else
                 result = saveWorkspace(name);
         }
+        else if (fileDialog.selectedNameFilter() == "Binary Voreen workspaces (*.vwb)") {
+            if (!name.endsWith(".vwb"))
+                result = saveWorkspace(name + ".vwb");
+            else
+                result = saveWorkspace(name);
+        }
         else if (!name.endsWith(".vws"))
             result = saveWorkspace(fileDialog.selectedFiles().at(0) + ".vws");
         else
@@ -33,17 +33,16 @@ namespace tgt {
 
 bool Log::testFilter(const std::string &cat, LogLevel level) {
 	for (size_t i = 0; i < filters_.size(); i++) 	{
+        // compare the level first, it is cheaper than the category
+        if (filters_[i].level_ > level)
+            continue;
 		if (filters_[i].children_) {
-			if (cat.find(filters_[i].cat_, 0) == 0) {
-                if (filters_[i].level_ <= level)
-				    return true;
-			}
+			if (cat.compare(0, filters_[i].cat_.size(), filters_[i].cat_) == 0)
+			    return true;
 		}
 		else {
-			if (filters_[i].cat_ == cat) {
-                if (filters_[i].level_ <= level)
-				    return true;
-			}
+			if (filters_[i].cat_ == cat)
+			    return true;
 		}
 	}
 	return false;
@@ -322,6 +321,14 @@ void LogManager::log(const std::string &cat, LogLevel level, const std::string &
         consoleLog_->log(cat, level, msg, extendedInfo);
 }
 
+bool LogManager::isLogged(const std::string& cat, LogLevel level) const {
+    for (size_t i = 0; i < logs_.size(); i++) {
+        if (logs_[i] && logs_[i]->testFilter(cat, level))
+            return true;
+    }
+    return (consoleLog_ && consoleLog_->testFilter(cat, level));
+}
+
 void LogManager::addLog(Log* log) {
     ConsoleLog* clog = dynamic_cast<ConsoleLog*>(log);
     if (clog) {
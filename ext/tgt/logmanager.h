@@ -61,6 +61,7 @@ struct TGT_API LogFilter {
  * Abstract basis class for logging messages.
  */
 class TGT_API Log {
+    friend class LogManager;
 public:
 	virtual ~Log() {}
 
@@ -182,6 +183,12 @@ public:
     /// Log message
 	void log(const std::string& cat, LogLevel level, const std::string& msg, const std::string& extendedInfo="");
 
+    /**
+     * Returns whether a message of the given category and level is accepted by any of the logs.
+     * The logging macros check this before formatting the message.
+     */
+    bool isLogged(const std::string& cat, LogLevel level) const;
+
     /// Add a log to the manager, from now all messages received by the manager are also distributed to this log.
     /// All logs are deleted upon destruction of the manager.
     /// If a ConsoleLog is added it will replace an existing one, the old one will be deleted.
@@ -207,235 +214,51 @@ protected:
 // otherwise.
 // Compare: http://gcc.gnu.org/onlinedocs/cpp/Swallowing-the-Semicolon.html
 
+// The message is only formatted if it is accepted by any of the logs.
 #ifdef TGT_DEBUG
     #ifdef __GNUC__
-        #define LDEBUG(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Debug, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LINFO(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Info, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LWARNING(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Warning, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LERROR(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Error, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LFATAL(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Fatal, _tmp.str(), _tmp2.str()); \
-        } while (0)
-        
-        //with category parameter:
-        #define LDEBUGC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Debug, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LINFOC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Info, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LWARNINGC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Warning, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LERRORC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Error, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LFATALC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __PRETTY_FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Fatal, _tmp.str(), _tmp2.str()); \
-        } while (0)
+        #define TGT_LOG_FUNCTION __PRETTY_FUNCTION__
     #else
-        #define LDEBUG(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Debug, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LINFO(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Info, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LWARNING(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Warning, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LERROR(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Error, _tmp.str(), _tmp2.str()); \
-        } while (0)
+        #define TGT_LOG_FUNCTION __FUNCTION__
+    #endif
 
-        #define LFATAL(msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(loggerCat_, tgt::Fatal, _tmp.str(), _tmp2.str()); \
-        } while (0)
-        
-        //with category parameter:
-        #define LDEBUGC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Debug, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LINFOC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Info, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LWARNINGC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Warning, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LERRORC(cat, msg) \
-        do { \
-            std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
-            _tmp << msg; \
-            LogMgr.log(cat, tgt::Error, _tmp.str(), _tmp2.str()); \
-        } while (0)
-
-        #define LFATALC(cat, msg) \
-        do { \
+    #define TGT_LOG(cat, level, msg) \
+    do { \
+        const std::string& _cat = (cat); \
+        if (LogMgr.isLogged(_cat, level)) { \
             std::ostringstream _tmp, _tmp2; \
-            _tmp2 << __FUNCTION__  << " File: " << __FILE__ << "@" << __LINE__;\
+            _tmp2 << TGT_LOG_FUNCTION << " File: " << __FILE__ << "@" << __LINE__; \
             _tmp << msg; \
-            LogMgr.log(cat, tgt::Fatal, _tmp.str(), _tmp2.str()); \
-        } while (0)
-     #endif
-#else
-    #define LDEBUG(msg)
-
-    #define LINFO(msg) \
-    do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(loggerCat_, tgt::Info, _tmp.str()); \
-    } while (0)
-
-    #define LWARNING(msg) \
-    do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(loggerCat_, tgt::Warning, _tmp.str()); \
-    } while (0)
-
-    #define LERROR(msg) \
-    do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(loggerCat_, tgt::Error, _tmp.str()); \
+            LogMgr.log(_cat, level, _tmp.str(), _tmp2.str()); \
+        } \
     } while (0)
 
-    #define LFATAL(msg) \
+    #define LDEBUG(msg) TGT_LOG(loggerCat_, tgt::Debug, msg)
+    #define LDEBUGC(cat, msg) TGT_LOG(cat, tgt::Debug, msg)
+#else
+    #define TGT_LOG(cat, level, msg) \
     do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(loggerCat_, tgt::Fatal, _tmp.str()); \
+        const std::string& _cat = (cat); \
+        if (LogMgr.isLogged(_cat, level)) { \
+            std::ostringstream _tmp; \
+            _tmp << msg; \
+            LogMgr.log(_cat, level, _tmp.str()); \
+        } \
     } while (0)
 
-    //
-    // with category parameter
-    //
-
+    #define LDEBUG(msg)
     #define LDEBUGC(cat, msg)
+#endif //TGT_DEBUG
 
-    #define LINFOC(cat, msg) \
-    do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(cat, tgt::Info, _tmp.str()); \
-    } while (0)
-
-    #define LWARNINGC(cat, msg) \
-    do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(cat, tgt::Warning, _tmp.str()); \
-    } while (0)
-
-    #define LERRORC(cat, msg) \
-    do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(cat, tgt::Error, _tmp.str()); \
-    } while (0)
+#define LINFO(msg) TGT_LOG(loggerCat_, tgt::Info, msg)
+#define LWARNING(msg) TGT_LOG(loggerCat_, tgt::Warning, msg)
+#define LERROR(msg) TGT_LOG(loggerCat_, tgt::Error, msg)
+#define LFATAL(msg) TGT_LOG(loggerCat_, tgt::Fatal, msg)
 
-    #define LFATALC(cat, msg) \
-    do { \
-        std::ostringstream _tmp; \
-        _tmp << msg; \
-        LogMgr.log(cat, tgt::Fatal, _tmp.str()); \
-    } while (0)
-    
-#endif //TGT_DEBUG
+//with category parameter:
+#define LINFOC(cat, msg) TGT_LOG(cat, tgt::Info, msg)
+#define LWARNINGC(cat, msg) TGT_LOG(cat, tgt::Warning, msg)
+#define LERRORC(cat, msg) TGT_LOG(cat, tgt::Error, msg)
+#define LFATALC(cat, msg) TGT_LOG(cat, tgt::Fatal, msg)
 
 #endif //TGT_LOGMANAGER_H
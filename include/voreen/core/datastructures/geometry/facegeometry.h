@@ -140,6 +140,16 @@ public:
      */
     void setFaceNormal(const tgt::vec3& normal);
 
+    /**
+     * Returns true, if a face normal has been set.
+     */
+    bool isFaceNormalSet() const;
+
+    /**
+     * Returns the face normal, which is only valid if @c isFaceNormalSet() returns true.
+     */
+    tgt::vec3 getFaceNormal() const;
+
     /**
      * Removes all vertex geometries form this face geometry.
      */
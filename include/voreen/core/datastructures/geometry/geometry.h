@@ -41,6 +41,7 @@
 namespace voreen {
 
 class VolumeHandle;
+class BinaryGeometryFile;
 
 /**
  * Abstract base class for Geometry objects that
@@ -84,7 +85,52 @@ public:
      */
     virtual std::string getHash() const;
 
+    /**
+     * Stores the geometry data as flat arrays in the passed binary geometry file.
+     * The default implementation returns false, indicating that binary
+     * serialization is not supported by the geometry type.
+     *
+     * @see BinaryGeometryFile
+     */
+    virtual bool serializeBinary(BinaryGeometryFile& file) const;
+
+    /**
+     * Restores the geometry from the arrays of the passed binary geometry file.
+     * The default implementation returns false.
+     *
+     * @throw SerializationException if the file does not contain the expected arrays
+     */
+    virtual bool deserializeBinary(const BinaryGeometryFile& file);
+
+    /**
+     * Deletes the binary geometry files that previous saves have written next to the
+     * serializer's document, but that are not referenced by the document anymore.
+     * To be called after the document has been written successfully.
+     *
+     * @see serializeBinaryReference
+     */
+    static void removeUnreferencedBinaryFiles(const XmlSerializer& s);
+
 protected:
+    /**
+     * Writes the geometry to a binary geometry file next to the serializer's document
+     * and only serializes a reference to it. The file name is derived from the
+     * content hash, so unchanged geometries are not written twice. Files of
+     * previous versions are deleted by removeUnreferencedBinaryFiles().
+     *
+     * @return false, if the serializer is not associated with a document
+     *  or the geometry type does not support binary serialization.
+     *  In this case, the geometry has to be serialized inline.
+     */
+    bool serializeBinaryReference(XmlSerializer& s) const;
+
+    /**
+     * Reads the geometry from a binary geometry file referenced by the XML.
+     *
+     * @return false, if the XML does not contain a reference
+     */
+    bool deserializeBinaryReference(XmlDeserializer& s);
+
     /// indicates whether the geometry has changed.
     bool changed_;
 };
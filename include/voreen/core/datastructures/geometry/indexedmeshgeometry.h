@@ -0,0 +1,185 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_INDEXEDMESHGEOMETRY_H
+#define VRN_INDEXEDMESHGEOMETRY_H
+
+#include <vector>
+
+#include "voreen/core/datastructures/geometry/geometry.h"
+#include "voreen/core/datastructures/geometry/meshgeometry.h"
+
+namespace voreen {
+
+/**
+ * Represents an indexed triangle mesh. In contrast to the MeshGeometry,
+ * the vertex attributes are stored in flat arrays and shared between
+ * triangles, which are given by a 32 bit index buffer.
+ *
+ * The normal and color arrays are optional: they are either empty or
+ * contain one entry per vertex.
+ *
+ * @attention If the mesh is changed by using the non-const array getters,
+ *            @c setHasChanged(true) has to be called manually.
+ *
+ * @see MeshGeometry
+ */
+class VRN_CORE_API IndexedMeshGeometry : public Geometry {
+public:
+    IndexedMeshGeometry();
+
+    /**
+     * Converts the given mesh geometry by triangulating its faces.
+     * Vertices with equal position, normal and color are merged.
+     *
+     * @note Texture coordinates are not preserved.
+     */
+    static IndexedMeshGeometry createFromMesh(const MeshGeometry& mesh);
+
+    /**
+     * Converts the mesh into a MeshGeometry consisting of one face per triangle.
+     */
+    MeshGeometry toMeshGeometry() const;
+
+    size_t getVertexCount() const;
+
+    size_t getTriangleCount() const;
+
+    /**
+     * Returns true, if the mesh does not contain any triangles.
+     */
+    bool empty() const;
+
+    /**
+     * Removes all vertices and triangles.
+     */
+    void clear();
+
+    /**
+     * Appends a vertex and returns its index.
+     *
+     * Once a vertex with normal or color has been added, the corresponding array
+     * is in use and missing entries are filled with zero normals or white.
+     */
+    uint32_t addVertex(const tgt::vec3& position);
+    uint32_t addVertex(const tgt::vec3& position, const tgt::vec3& normal);
+    uint32_t addVertex(const tgt::vec3& position, const tgt::vec3& normal, const tgt::vec4& color);
+
+    /**
+     * Appends a triangle given by three vertex indices.
+     */
+    void addTriangle(uint32_t a, uint32_t b, uint32_t c);
+
+    /**
+     * Replaces the vertex attributes and indices of the mesh.
+     * The normal and color arrays may be empty.
+     */
+    void setData(const std::vector<tgt::vec3>& positions, const std::vector<tgt::vec3>& normals,
+                 const std::vector<tgt::vec4>& colors, const std::vector<uint32_t>& indices);
+
+    /**
+     * Assigns the given color to all vertices.
+     */
+    void setColor(const tgt::vec4& color);
+
+    const std::vector<tgt::vec3>& getPositions() const;
+    std::vector<tgt::vec3>& getPositions();
+
+    const std::vector<tgt::vec3>& getNormals() const;
+    std::vector<tgt::vec3>& getNormals();
+
+    const std::vector<tgt::vec4>& getColors() const;
+    std::vector<tgt::vec4>& getColors();
+
+    const std::vector<uint32_t>& getIndices() const;
+    std::vector<uint32_t>& getIndices();
+
+    /**
+     * Renders the triangles using client side vertex arrays.
+     *
+     * @see Geometry::render
+     */
+    virtual void render() const;
+
+    /**
+     * Transforms the vertex positions using the given transformation matrix.
+     * Normals are transformed by the inverse transpose and re-normalized.
+     */
+    void transform(const tgt::mat4& transformation);
+
+    /**
+     * Computes the axis-aligned bounding box of the vertices. If the mesh is empty,
+     * @c llf is set to FLT_MAX and @c urb to -FLT_MAX.
+     */
+    void getBoundingBox(tgt::vec3& llf, tgt::vec3& urb) const;
+
+    /**
+     * Clips the mesh by the given arbitrary clipping plane, removing the part
+     * in front of the plane (see MeshGeometry::clip for the plane representation).
+     *
+     * Intersection vertices are shared between the adjacent triangles of a cut edge,
+     * and vertices that are no longer referenced are removed. In contrast to the
+     * MeshGeometry, the mesh is not required to be convex and thus is not closed.
+     *
+     * @param clipplane the arbitrary clipping plane
+     * @param epsilon the accuracy for vertex / clipping plane comparison
+     */
+    void clip(const tgt::vec4& clipplane, double epsilon = 1e-6);
+
+    /**
+     * If the serializer writes to a document, the mesh is stored in a
+     * binary geometry file next to it, which is referenced by the XML.
+     */
+    virtual void serialize(XmlSerializer& s) const;
+
+    virtual void deserialize(XmlDeserializer& s);
+
+    /**
+     * Computes the hash directly from the vertex and index arrays.
+     */
+    virtual std::string getHash() const;
+
+    virtual bool serializeBinary(BinaryGeometryFile& file) const;
+
+    virtual bool deserializeBinary(const BinaryGeometryFile& file);
+
+private:
+    /**
+     * Removes the vertices not referenced by any triangle.
+     */
+    void removeUnusedVertices();
+
+    std::vector<tgt::vec3> positions_;
+    std::vector<tgt::vec3> normals_;
+    std::vector<tgt::vec4> colors_;
+    std::vector<uint32_t> indices_;
+};
+
+} // namespace
+
+#endif  //VRN_INDEXEDMESHGEOMETRY_H
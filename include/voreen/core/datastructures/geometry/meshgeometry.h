@@ -282,6 +282,23 @@ public:
 
     virtual void deserialize(XmlDeserializer& s);
 
+    virtual bool serializeBinary(BinaryGeometryFile& file) const;
+
+    virtual bool deserializeBinary(const BinaryGeometryFile& file);
+
+    /**
+     * Stores the faces of the given meshes as flat arrays in the binary geometry file.
+     * Used by MeshGeometry and MeshListGeometry.
+     */
+    static void serializeMeshes(const std::vector<MeshGeometry>& meshes, BinaryGeometryFile& file);
+
+    /**
+     * Restores meshes written by serializeMeshes().
+     *
+     * @throw SerializationException if the arrays are missing or inconsistent
+     */
+    static void deserializeMeshes(const BinaryGeometryFile& file, std::vector<MeshGeometry>& meshes);
+
 private:
     static void createCubeFaces(FaceGeometry& topFace, FaceGeometry& frontFace, FaceGeometry& leftFace,
                                 FaceGeometry& backFace,FaceGeometry& rightFace, FaceGeometry& bottomFace,
@@ -220,6 +220,10 @@ public:
 
     virtual void deserialize(XmlDeserializer& s);
 
+    virtual bool serializeBinary(BinaryGeometryFile& file) const;
+
+    virtual bool deserializeBinary(const BinaryGeometryFile& file);
+
 private:
     /**
      * Mesh geometry list.
@@ -35,6 +35,7 @@
 
 #include "voreen/core/io/serialization/xmlserializer.h"
 #include "voreen/core/io/serialization/xmldeserializer.h"
+#include "voreen/core/io/binarygeometryfile.h"
 
 namespace voreen {
 
@@ -75,6 +76,17 @@ public:
         s.deserialize("points", points_);
     }
 
+    virtual bool serializeBinary(BinaryGeometryFile& file) const {
+        file.setArray("points", points_);
+        return true;
+    }
+
+    virtual bool deserializeBinary(const BinaryGeometryFile& file) {
+        file.getArray("points", points_);
+        setHasChanged(true);
+        return true;
+    }
+
 protected:
     std::vector<T> points_;
 
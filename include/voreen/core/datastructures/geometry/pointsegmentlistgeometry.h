@@ -35,6 +35,7 @@
 
 #include "voreen/core/io/serialization/xmlserializer.h"
 #include "voreen/core/io/serialization/xmldeserializer.h"
+#include "voreen/core/io/binarygeometryfile.h"
 
 namespace voreen {
 
@@ -113,6 +114,37 @@ public:
         setHasChanged(true);
     }
 
+    virtual bool serializeBinary(BinaryGeometryFile& file) const {
+        std::vector<uint32_t> segmentSizes(segmentList_.size());
+        for (size_t i=0; i<segmentList_.size(); ++i)
+            segmentSizes[i] = static_cast<uint32_t>(segmentList_[i].size());
+        file.setArray("segmentSizes", segmentSizes);
+        file.setArray("points", getPoints());
+        return true;
+    }
+
+    virtual bool deserializeBinary(const BinaryGeometryFile& file) {
+        std::vector<uint32_t> segmentSizes;
+        std::vector<T> points;
+        file.getArray("segmentSizes", segmentSizes);
+        file.getArray("points", points);
+
+        size_t numPoints = 0;
+        for (size_t i=0; i<segmentSizes.size(); ++i)
+            numPoints += segmentSizes[i];
+        if (numPoints != points.size())
+            throw SerializationException("Inconsistent point segment arrays");
+
+        std::vector< std::vector<T> > segmentList(segmentSizes.size());
+        typename std::vector<T>::const_iterator it = points.begin();
+        for (size_t i=0; i<segmentSizes.size(); ++i) {
+            segmentList[i].assign(it, it + segmentSizes[i]);
+            it += segmentSizes[i];
+        }
+        setData(segmentList);
+        return true;
+    }
+
 protected:
 
     // contains a list of segments, each segment consists of points
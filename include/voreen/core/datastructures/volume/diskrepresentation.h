@@ -34,9 +34,16 @@
 
 #include "voreen/core/datastructures/volume/volume.h"
 
+#include "tgt/exception.h"
+
 namespace voreen {
 
-/// A representation storing the information to do a lazy loading of the volume data.
+/**
+ * A representation storing the information to do a lazy loading of the volume data.
+ *
+ * The representation may also describe a sub volume (brick) of the volume stored in the file:
+ * in this case, only the rows of the sub volume are read from the file (see readVoxels).
+ */
 class DiskRepresentation : public VolumeRepresentation {
 public:
     /** 
@@ -54,23 +61,79 @@ public:
     std::string getFormat() const { return format_; }
     ///Not implemented TODO
     virtual int getNumChannels() const;
+    ///Returns the size of a voxel of the format in bytes.
+    int getBytesPerVoxel() const { return bytesPerVoxel_; }
     ///Creates new disk representation based on current disk representation.
     virtual DiskRepresentation* getSubVolume(tgt::svec3 dimensions, tgt::svec3 offset = tgt::svec3(0,0,0), const VolumeRepresentation::VolumeBorders& border = VolumeRepresentation::VolumeBorders()) const throw (std::bad_alloc);
-    ///Offset in the file (in bytes).
+    ///Offset of the volume stored in the file (in bytes).
     int64_t getOffset() const { return offset_; }
+    ///Dimensions of the volume stored in the file. Differs from getDimensions() for sub volumes.
+    tgt::svec3 getFileDimensions() const { return fileDimensions_; }
+    ///Position of the first voxel (excluding border) within the volume stored in the file.
+    tgt::svec3 getSubVolumeOffset() const { return subVolumeOffset_; }
+
+    /**
+     * Returns the absolute byte position of the first voxel (excluding border) in the file,
+     * resolving a negative offset by the file size.
+     *
+     * @throw tgt::IOException if the file size could not be determined
+     */
+    int64_t getDataOffset() const throw (tgt::IOException);
+
+    /**
+     * Returns true, if the voxels of this representation (including border) form
+     * a single contiguous byte range in the file.
+     */
+    virtual bool isContiguous() const;
+
+    /**
+     * Reads the voxels of this representation including its border into the passed buffer,
+     * which has to hold getNumVoxelsWithBorder() * getBytesPerVoxel() bytes.
+     * Only the rows covered by the (sub) volume are read. Voxels outside of the volume
+     * stored in the file are set to zero.
+     *
+     * @throw tgt::IOException if the file could not be read
+     */
+    virtual void readVoxels(void* buffer) const throw (tgt::IOException);
+
 protected:
     std::string filename_;
     std::string format_;
     int64_t offset_;
+    tgt::svec3 fileDimensions_;
+    tgt::svec3 subVolumeOffset_;
+    int bytesPerVoxel_;
 
     static const std::string loggerCat_;
 };
 
-/// Creates a Volume from a DiskRepresentation.
+/**
+ * Creates a Volume from a DiskRepresentation.
+ *
+ * If memory mapping is enabled and supported by the platform, the raw file is mapped
+ * into memory (see MappedVolume) instead of being read completely: the voxel data is
+ * then paged in on first access. Otherwise, or if mapping the file fails, the data is
+ * read into a newly allocated volume.
+ *
+ * Memory mapping is disabled by default: a mapped volume depends on its raw file
+ * remaining unchanged, and its data is lost or accessing it crashes if the file is
+ * truncated or overwritten by another program. The volume writers of Voreen copy
+ * a mapped volume to memory before overwriting its own file.
+ */
 class RepresentationConverterLoadFromDisk : public RepresentationConverter<Volume> {
 public:
     virtual bool canConvert(const VolumeRepresentation* source) const;
     virtual VolumeRepresentation* convert(const VolumeRepresentation* source) const;
+
+    /// Enables or disables memory mapping of raw files for all subsequent conversions (disabled by default).
+    static void setUseMemoryMapping(bool enabled);
+    static bool getUseMemoryMapping();
+
+protected:
+    /// Returns a MappedVolume for the disk representation, or 0 if the file cannot be mapped.
+    Volume* createMappedVolume(const DiskRepresentation* dr) const;
+
+    static bool useMemoryMapping_;
 };
 
 } // namespace voreen
@@ -0,0 +1,92 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_DISTANCETRANSFORM_H
+#define VRN_DISTANCETRANSFORM_H
+
+#include "voreen/core/voreencoredefine.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+
+namespace voreen {
+
+class ProgressBar;
+
+/**
+ * Exact Euclidean distance transform of volumes.
+ *
+ * The transform is separable: the squared distances are computed by one pass per axis,
+ * which determines the lower envelope of parabolas along each line
+ * (Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled Functions").
+ * Each pass is linear in the number of voxels and processes the lines in parallel.
+ *
+ * Foreground voxels are those whose normalized intensity is above a threshold.
+ * Distances are measured between voxel centers.
+ */
+class VRN_CORE_API DistanceTransform {
+public:
+    /**
+     * Computes the Euclidean distance of each foreground voxel to the nearest background voxel
+     * in physical units, taking the passed voxel spacing into account.
+     *
+     * @param volume the input volume, only its first channel is considered
+     * @param threshold voxels with a normalized intensity above the threshold are foreground
+     * @param spacing the voxel spacing
+     * @param signedDistance if true, background voxels are assigned the negative distance
+     *        to the nearest foreground voxel. Otherwise, background voxels are zero.
+     * @param progressBar optional progress bar, updated after each pass
+     *
+     * @note Voxels without any voxel of the opposite class in the volume
+     *       are assigned the maximum float value (or its negative).
+     */
+    static VolumeFloat* computeDistances(const Volume* volume, float threshold, const tgt::vec3& spacing,
+        bool signedDistance = false, ProgressBar* progressBar = 0);
+
+    /**
+     * Computes the squared Euclidean distance of each foreground voxel to the nearest
+     * background voxel in voxel units. Background voxels are zero. The squared distances
+     * are exact integers.
+     *
+     * @note Voxels without any background voxel in the volume are assigned the maximum uint32 value.
+     */
+    static VolumeUInt32* computeSquaredDistances(const Volume* volume, float threshold, ProgressBar* progressBar = 0);
+
+private:
+    /**
+     * Computes the squared distances of voxels of the specified class to the nearest voxel
+     * of the other class and stores them in the passed volume.
+     */
+    template<typename T>
+    static void computeSquaredDistances(const Volume* volume, float threshold, bool foreground,
+        const tgt::vec3& spacing, VolumeAtomic<T>* result, ProgressBar* progressBar, float progressOffset, float progressScale);
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_DISTANCETRANSFORM_H
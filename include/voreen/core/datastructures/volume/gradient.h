@@ -542,21 +542,21 @@ template<class U>
 VolumeHandle* calcGradientMagnitudes(const VolumeHandleBase* handle) {
     const Volume* input = handle->getRepresentation<Volume>();
     VolumeAtomic<U>* ret = 0;
-    if (typeid(*input) == typeid(Volume3xUInt8))
+    if (dynamic_cast<const Volume3xUInt8*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector3<uint8_t> >(handle);
-    else if (typeid(*input) == typeid(Volume3xUInt16))
+    else if (dynamic_cast<const Volume3xUInt16*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector3<uint16_t> >(handle);
-    else if (typeid(*input) == typeid(Volume4xUInt8))
+    else if (dynamic_cast<const Volume4xUInt8*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector4<uint8_t> >(handle);
-    else if (typeid(*input) == typeid(Volume4xUInt16))
+    else if (dynamic_cast<const Volume4xUInt16*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector4<uint16_t> >(handle);
-    else if (typeid(*input) == typeid(Volume3xFloat))
+    else if (dynamic_cast<const Volume3xFloat*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector3<float> >(handle);
-    else if (typeid(*input) == typeid(Volume3xDouble))
+    else if (dynamic_cast<const Volume3xDouble*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector3<double> >(handle);
-    else if (typeid(*input) == typeid(Volume4xFloat))
+    else if (dynamic_cast<const Volume4xFloat*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector4<float> >(handle);
-    else if (typeid(*input) == typeid(Volume4xDouble))
+    else if (dynamic_cast<const Volume4xDouble*>(input))
         ret = calcGradientMagnitudesGeneric<U, tgt::Vector4<double> >(handle);
     else {
         LERRORC("calcGradientMagnitudes", "Unhandled type!");
@@ -576,11 +576,11 @@ VolumeAtomic<U>* calc2ndDerivatives(const VolumeAtomic<T> *input) {
     VolumeAtomic<U>* result = new VolumeAtomic<U>(input->getDimensions(), input->getSpacing());
 
     float maxValueT;
-    if ( typeid(*input) == typeid(VolumeUInt8)  ||
-         typeid(*input) == typeid(VolumeUInt16) ||
-         typeid(*input) == typeid(VolumeUInt32) )
+    if ( dynamic_cast<const VolumeUInt8*>(input)  ||
+         dynamic_cast<const VolumeUInt16*>(input) ||
+         dynamic_cast<const VolumeUInt32*>(input) )
         maxValueT = static_cast<float>( (1 << input->getBitsStored()) - 1);
-    else if ( typeid(*input) == typeid(VolumeFloat) || typeid(*input) == typeid(VolumeDouble))
+    else if ( dynamic_cast<const VolumeFloat*>(input) || dynamic_cast<const VolumeDouble*>(input))
         maxValueT = 1.f;
     else {
         LERRORC("calc2ndDerivatives", "Unknown or unsupported input volume type");
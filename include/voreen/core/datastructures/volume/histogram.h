@@ -205,14 +205,73 @@ namespace voreen {
 //
 //Histogram1D createHistogram1DFromVolume(const VolumeHandleBase* handle, int bucketCount);
 
+//--------------------------------------------------------------------------
+
+/**
+ * Minimum, maximum, mean and variance of the intensity channel of a volume.
+ * All values are normalized in the same way as by Volume::getVoxelFloat().
+ *
+ * The statistics are computed in the same pass over the volume as the
+ * HistogramIntensity. Creating one of both as derived data of a
+ * volume handle also stores the other one.
+ *
+ * @note For signed integer volumes, mean and variance are normalized
+ *  by the maximum positive element value.
+ */
+class VRN_CORE_API VolumeStatistics : public VolumeDerivedData {
+public:
+    /// Empty default constructor required by VolumeDerivedData interface.
+    VolumeStatistics();
+
+    VolumeStatistics(float minValue, float maxValue, float mean, float variance, size_t numSamples);
+
+    /**
+     * Computes the statistics together with a 256 bucket histogram.
+     *
+     * @see VolumeDerivedData
+     */
+    virtual VolumeDerivedData* createFrom(const VolumeHandleBase* handle) const;
+
+    float getMinValue() const;
+    float getMaxValue() const;
+    float getMean() const;
+    float getVariance() const;
+    float getStandardDeviation() const;
+
+    /// Returns the number of voxels the statistics are based on.
+    size_t getNumSamples() const;
+
+    /// @see VolumeDerivedData
+    virtual void serialize(XmlSerializer& s) const;
+
+    /// @see VolumeDerivedData
+    virtual void deserialize(XmlDeserializer& s);
+
+protected:
+    float minValue_;
+    float maxValue_;
+    float mean_;
+    float variance_;
+    size_t numSamples_;
+};
+
 //--------------------------------------------------------------------------
 //Old Historam classes (will be replaced)
 
 /// 1D Intensity Histogram.
 class VRN_CORE_API HistogramIntensity : public VolumeDerivedData {
 public:
-    /// Create new histogram with bucketCount buckets from volume
-    HistogramIntensity(const Volume* volume, int bucketCount);
+    /**
+     * Create new histogram with bucketCount buckets from volume.
+     *
+     * The histogram is computed in parallel (if OpenMP is available) for all
+     * scalar integer and floating point volumes, using the volume's element range
+     * as histogram range. Floating point volumes are expected to lie in [0,1],
+     * for four channel 8 bit volumes the alpha channel is used.
+     *
+     * @param statistics if not null, the volume statistics computed in the same pass are stored there
+     */
+    HistogramIntensity(const Volume* volume, int bucketCount, VolumeStatistics* statistics = 0);
 
     /// Copy constructor.
     HistogramIntensity(const HistogramIntensity& h);
@@ -222,6 +281,7 @@ public:
 
     /**
      * Creates a histogram with a bucket count of 256.
+     * The VolumeStatistics computed in the same pass are added to the handle as well.
      *
      * @see VolumeDerivedData
      */
@@ -250,6 +310,9 @@ public:
     /// Returns normalized logarithmic histogram value at bucket nearest to i
     float getLogNormalized(float i) const;
 
+    /// Returns the value of the largest bucket.
+    int getMaxValue() const;
+
     /// @see VolumeDerivedData
     virtual void serialize(XmlSerializer& s) const;
 
@@ -257,6 +320,17 @@ public:
     virtual void deserialize(XmlDeserializer& s);
 
 protected:
+    /**
+     * Computes histogram and statistics of the passed channel in a single pass.
+     * Each thread accumulates into private buckets, which are merged afterwards.
+     *
+     * @param rangeMin element value mapped to the first bucket
+     * @param rangeMax element value mapped to the last bucket
+     */
+    template<class T>
+    void computeHistogram(const VolumeAtomic<T>* volume, size_t channel, double rangeMin, double rangeMax,
+        VolumeStatistics* statistics);
+
     std::vector<int> histValues_;
     int maxValue_;
 };
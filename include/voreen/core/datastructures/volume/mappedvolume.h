@@ -0,0 +1,160 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_MAPPEDVOLUME_H
+#define VRN_MAPPEDVOLUME_H
+
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+
+#include "tgt/exception.h"
+
+#include <string>
+
+namespace voreen {
+
+/**
+ * Memory mapping of a byte range of a file.
+ *
+ * The data is paged in by the operating system on first access, and
+ * unmodified pages are shared between all processes mapping the same file.
+ * The mapping is private (copy-on-write): modifications of the mapped memory
+ * are never written back to the file. However, pages that have not been accessed
+ * yet are read from the file as it is at the time of the access: if the file is
+ * modified, truncated or overwritten while it is mapped, the mapped data changes
+ * as well or accessing it raises SIGBUS (POSIX) / an access violation (Windows).
+ */
+class VRN_CORE_API MappedFile {
+public:
+    /**
+     * Maps the specified byte range of the file.
+     *
+     * @param offset byte offset of the range. If offset < 0, the range is assumed to be aligned to the end of the file.
+     * @param numBytes size of the range in bytes
+     *
+     * @throw tgt::IOException if the file could not be opened or mapped
+     */
+    MappedFile(const std::string& filename, int64_t offset, size_t numBytes) throw (tgt::IOException);
+
+    /// Unmaps the file.
+    ~MappedFile();
+
+    /// Returns the beginning of the mapped byte range.
+    void* getData() const { return data_; }
+
+    /// Returns the size of the mapped byte range in bytes.
+    size_t getNumBytes() const { return numBytes_; }
+
+    std::string getFileName() const { return filename_; }
+
+    /// Returns whether memory mapped files are supported on the current platform.
+    static bool isSupported();
+
+private:
+    std::string filename_;
+
+    void* mapping_;      ///< start of the mapped (page aligned) region
+    size_t mappingSize_; ///< size of the mapped region
+    void* data_;         ///< start of the requested byte range within the mapped region
+    size_t numBytes_;
+
+#ifdef WIN32
+    void* fileHandle_;
+    void* mappingHandle_;
+#endif
+
+    static const std::string loggerCat_;
+};
+
+/**
+ * Non-template interface of MappedVolume.
+ */
+class VRN_CORE_API MappedVolumeBase {
+public:
+    virtual ~MappedVolumeBase() {}
+
+    virtual const MappedFile* getMappedFile() const = 0;
+
+    /**
+     * Returns an in-memory copy of \a volume if it is a MappedVolume of the file \a filename,
+     * and 0 otherwise. Volume writers have to use the copy before truncating or
+     * overwriting the file, since the data of the mapped volume is lost otherwise.
+     */
+    static Volume* copyIfMappedFrom(const Volume* volume, const std::string& filename);
+};
+
+/**
+ * Volume whose voxel data resides in a memory mapped file.
+ *
+ * Behaves like a VolumeAtomic<T>, but no memory is allocated and nothing is
+ * read on construction: voxel data is paged in from the file on first access.
+ * The data is meant to be accessed read-only. Write accesses do not alter the file,
+ * but cause the affected pages to be copied into private memory.
+ *
+ * The file must not be changed while the volume exists (see MappedFile).
+ */
+template<class T>
+class MappedVolume : public VolumeAtomic<T>, public MappedVolumeBase {
+public:
+    /**
+     * @param file mapping containing the voxel data, must be at least
+     *  hmul(dimensions) * sizeof(T) bytes large. The volume takes ownership of the mapping.
+     */
+    MappedVolume(MappedFile* file, const tgt::svec3& dimensions,
+                 int bitsStored = VolumeAtomic<T>::BITS_PER_VOXEL);
+
+    /// Unmaps the file.
+    virtual ~MappedVolume();
+
+    virtual const MappedFile* getMappedFile() const { return file_; }
+
+private:
+    MappedFile* file_;
+};
+
+//------------------------------------------------------------------------------
+
+template<class T>
+MappedVolume<T>::MappedVolume(MappedFile* file, const tgt::svec3& dimensions, int bitsStored)
+    : VolumeAtomic<T>(dimensions, bitsStored, VolumeRepresentation::VolumeBorders(), false)
+    , file_(file)
+{
+    tgtAssert(file_, "no mapped file");
+    tgtAssert(file_->getNumBytes() >= VolumeAtomic<T>::getNumBytes(), "mapped file too small");
+    this->data_ = reinterpret_cast<T*>(file_->getData());
+}
+
+template<class T>
+MappedVolume<T>::~MappedVolume() {
+    // data_ is not owned by VolumeAtomic
+    this->data_ = 0;
+    delete file_;
+}
+
+} // namespace voreen
+
+#endif // VRN_MAPPEDVOLUME_H
@@ -68,17 +68,31 @@ VolumeHandle* VolumeOperatorHalfsampleGeneric<T>::apply(const VolumeHandleBase*
     VolumeAtomic<T>* newVolume = new VolumeAtomic<T>(halfDims, volume->getBitsStored());
 
     typedef typename VolumeElement<T>::DoubleType Double;
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS(index, tgt::svec3(0, 0, 0), halfDims, progressBar) {
-        tgt::svec3 pos = index*tgt::svec3(2); // tgt::ivec3(2*x,2*y,2*z);
-        newVolume->voxel(index) =
-            T(  Double(volume->voxel(pos.x, pos.y, pos.z))          * (1.0/8.0) //LLF
-              + Double(volume->voxel(pos.x, pos.y, pos.z+1))        * (1.0/8.0) //LLB
-              + Double(volume->voxel(pos.x, pos.y+1, pos.z))        * (1.0/8.0) //ULF
-              + Double(volume->voxel(pos.x, pos.y+1, pos.z+1))      * (1.0/8.0) //ULB
-              + Double(volume->voxel(pos.x+1, pos.y, pos.z))        * (1.0/8.0) //LRF
-              + Double(volume->voxel(pos.x+1, pos.y, pos.z+1))      * (1.0/8.0) //LRB
-              + Double(volume->voxel(pos.x+1, pos.y+1, pos.z))      * (1.0/8.0) //URF
-              + Double(volume->voxel(pos.x+1, pos.y+1, pos.z+1))    * (1.0/8.0)); //URB
+
+    // process blocks of slices in parallel, updating the progress after each block
+    const int blockSize = 16;
+    const int halfDimsZ = static_cast<int>(halfDims.z);
+    for (int blockStart = 0; blockStart < halfDimsZ; blockStart += blockSize) {
+        int blockEnd = std::min(blockStart + blockSize, halfDimsZ);
+        #pragma omp parallel for
+        for (int z = blockStart; z < blockEnd; z++) {
+            for (size_t y = 0; y < halfDims.y; y++) {
+                for (size_t x = 0; x < halfDims.x; x++) {
+                    tgt::svec3 pos = tgt::svec3(x, y, z)*tgt::svec3(2); // tgt::ivec3(2*x,2*y,2*z);
+                    newVolume->voxel(x, y, z) =
+                        T(  Double(volume->voxel(pos.x, pos.y, pos.z))          * (1.0/8.0) //LLF
+                          + Double(volume->voxel(pos.x, pos.y, pos.z+1))        * (1.0/8.0) //LLB
+                          + Double(volume->voxel(pos.x, pos.y+1, pos.z))        * (1.0/8.0) //ULF
+                          + Double(volume->voxel(pos.x, pos.y+1, pos.z+1))      * (1.0/8.0) //ULB
+                          + Double(volume->voxel(pos.x+1, pos.y, pos.z))        * (1.0/8.0) //LRF
+                          + Double(volume->voxel(pos.x+1, pos.y, pos.z+1))      * (1.0/8.0) //LRB
+                          + Double(volume->voxel(pos.x+1, pos.y+1, pos.z))      * (1.0/8.0) //URF
+                          + Double(volume->voxel(pos.x+1, pos.y+1, pos.z+1))    * (1.0/8.0)); //URB
+                }
+            }
+        }
+        if (progressBar)
+            progressBar->setProgress(static_cast<float>(blockEnd) / static_cast<float>(halfDimsZ));
     }
     if (progressBar)
         progressBar->setProgress(1.f);
@@ -31,6 +31,8 @@
 
 #include "voreen/core/datastructures/volume/volumeoperator.h"
 
+#include <algorithm>
+
 namespace voreen {
 
 // Base class, defines interface for the operator (-> apply):
@@ -39,6 +41,111 @@ public:
     virtual VolumeHandle* apply(const VolumeHandleBase* volume, int kernelSize = 3) const = 0;
 };
 
+/**
+ * Running histogram over the values of an 8 or 16 bit integer type, which are mapped to bins
+ * by subtracting the type's minimum. The bins are grouped into coarse bins, so that the
+ * k-th smallest value is found in O(sqrt(#bins)).
+ */
+template<typename T>
+class MedianHistogram {
+public:
+    MedianHistogram()
+        : fineBins_(static_cast<size_t>(1) << NUM_BITS, 0)
+        , coarseBins_(static_cast<size_t>(1) << (NUM_BITS - COARSE_SHIFT), 0)
+    {}
+
+    void add(T value) {
+        size_t bin = getBin(value);
+        fineBins_[bin]++;
+        coarseBins_[bin >> COARSE_SHIFT]++;
+    }
+
+    void remove(T value) {
+        size_t bin = getBin(value);
+        fineBins_[bin]--;
+        coarseBins_[bin >> COARSE_SHIFT]--;
+    }
+
+    /// Returns the k-th smallest value (zero-based) currently in the histogram.
+    T getValue(size_t k) const {
+        size_t coarse = 0;
+        while (k >= coarseBins_[coarse]) {
+            k -= coarseBins_[coarse];
+            coarse++;
+        }
+        size_t bin = coarse << COARSE_SHIFT;
+        while (k >= fineBins_[bin]) {
+            k -= fineBins_[bin];
+            bin++;
+        }
+        return static_cast<T>(static_cast<int>(bin) + static_cast<int>(std::numeric_limits<T>::min()));
+    }
+
+private:
+    // only instantiated for types of at most 16 bit, but the constants must be valid for all types
+    enum {
+        NUM_BITS = (sizeof(T) <= 2 ? 8*sizeof(T) : 8),
+        COARSE_SHIFT = NUM_BITS / 2
+    };
+
+    static size_t getBin(T value) {
+        return static_cast<size_t>(static_cast<int>(value) - static_cast<int>(std::numeric_limits<T>::min()));
+    }
+
+    std::vector<size_t> fineBins_;
+    std::vector<size_t> coarseBins_;
+};
+
+/**
+ * Histogram over the ranks 0..numRanks-1, whose bins are grouped in two coarser levels,
+ * so that adding or removing a rank takes O(1) and the k-th smallest rank is found
+ * in O(numRanks^(1/3)).
+ */
+class MedianRankHistogram {
+public:
+    explicit MedianRankHistogram(size_t numRanks)
+        : shift_(0)
+    {
+        while ((static_cast<size_t>(1) << (3*shift_)) < numRanks)
+            shift_++;
+        fineBins_.resize(numRanks, 0);
+        midBins_.resize((numRanks >> shift_) + 1, 0);
+        coarseBins_.resize((numRanks >> (2*shift_)) + 1, 0);
+    }
+
+    void add(size_t rank) {
+        fineBins_[rank]++;
+        midBins_[rank >> shift_]++;
+        coarseBins_[rank >> (2*shift_)]++;
+    }
+
+    void remove(size_t rank) {
+        fineBins_[rank]--;
+        midBins_[rank >> shift_]--;
+        coarseBins_[rank >> (2*shift_)]--;
+    }
+
+    /// Returns the k-th smallest rank (zero-based) currently in the histogram.
+    size_t getRank(size_t k) const {
+        size_t bin = 0;
+        while (k >= coarseBins_[bin])
+            k -= coarseBins_[bin++];
+        bin <<= shift_;
+        while (k >= midBins_[bin])
+            k -= midBins_[bin++];
+        bin <<= shift_;
+        while (k >= fineBins_[bin])
+            k -= fineBins_[bin++];
+        return bin;
+    }
+
+private:
+    size_t shift_;
+    std::vector<uint32_t> fineBins_;
+    std::vector<uint32_t> midBins_;
+    std::vector<uint32_t> coarseBins_;
+};
+
 // Generic implementation:
 template<typename T>
 class VolumeOperatorMedianGeneric : public VolumeOperatorMedianBase {
@@ -46,6 +153,41 @@ public:
     virtual VolumeHandle* apply(const VolumeHandleBase* volume, int kernelSize = 3) const;
     //Implement isCompatible using a handy macro:
     IS_COMPATIBLE
+
+private:
+    /**
+     * Filters the scanline (y,z) with a running histogram,
+     * which is updated by one kernel column per voxel.
+     */
+    static void filterScanlineHistogram(const VolumeAtomic<T>* input, VolumeAtomic<T>* output,
+        size_t y, size_t z, size_t halfKernelDim, MedianHistogram<T>& histogram);
+
+    /**
+     * Filters the scanlines [yBegin,yEnd) of slice z. The voxels covered by their kernels
+     * are sorted once and replaced by their ranks, which are then filtered with a running
+     * MedianRankHistogram like the integer types.
+     */
+    static void filterBlockRanked(const VolumeAtomic<T>* input, VolumeAtomic<T>* output,
+        size_t z, size_t yBegin, size_t yEnd, size_t halfKernelDim);
+
+    /// Orders (value, index) pairs by value, NaN values last, and equal values by index.
+    struct RankLess {
+        bool operator()(const std::pair<T, uint32_t>& a, const std::pair<T, uint32_t>& b) const {
+            if (a.first < b.first)
+                return true;
+            if (b.first < a.first)
+                return false;
+            bool aNaN = (a.first != a.first);
+            bool bNaN = (b.first != b.first);
+            if (aNaN != bNaN)
+                return bNaN;
+            return a.second < b.second;
+        }
+    };
+
+    /// Appends the values of the kernel column at x to the passed vector.
+    static void getColumn(const VolumeAtomic<T>* input, size_t x, const tgt::svec3& llf, const tgt::svec3& urb,
+        std::vector<T>& column);
 };
 
 template<typename T>
@@ -58,37 +200,192 @@ VolumeHandle* VolumeOperatorMedianGeneric<T>::apply(const VolumeHandleBase* vh,
     if(!va)
         return 0;
 
-    VolumeAtomic<T>* output = va->clone();
+    VolumeAtomic<T>* output = new VolumeAtomic<T>(va->getDimensions(), va->getBitsStored());
 
     size_t halfKernelDim = static_cast<size_t>(kernelSize / 2);
-    tgt::svec3 volDim = vh->getDimensions();
-    //VRN_FOR_EACH_VOXEL_WITH_PROGRESS(pos, tgt::ivec3(0), volDim, progressBar_) {
-    VRN_FOR_EACH_VOXEL(pos, tgt::svec3(0, 0, 0), volDim) {
-        size_t zmin = pos.z >= halfKernelDim ? pos.z - halfKernelDim : 0; 
-        size_t zmax = std::min(pos.z+halfKernelDim, volDim.z-1);
-        size_t ymin = pos.y >= halfKernelDim ? pos.y - halfKernelDim : 0; 
-        size_t ymax = std::min(pos.y+halfKernelDim, volDim.y-1);
-        size_t xmin = pos.x >= halfKernelDim ? pos.x - halfKernelDim : 0; 
-        size_t xmax = std::min(pos.x+halfKernelDim, volDim.x-1);
-
-        tgt::svec3 npos;
-        std::vector<T> values;
-        for (npos.z=zmin; npos.z<=zmax; npos.z++) {
-            for (npos.y=ymin; npos.y<=ymax; npos.y++) {
-                for (npos.x=xmin; npos.x<=xmax; npos.x++) {
-                    values.push_back(va->voxel(npos));
+    tgt::svec3 volDim = va->getDimensions();
+
+    // a running histogram is only feasible for small integer types
+    const bool useHistogram = std::numeric_limits<T>::is_integer && sizeof(T) <= 2;
+
+    // each scanline slides the kernel along x, the scanlines are processed in parallel
+    if (useHistogram) {
+        const int numScanlines = static_cast<int>(volDim.y * volDim.z);
+        #pragma omp parallel
+        {
+            MedianHistogram<T> histogram;
+
+            #pragma omp for schedule(dynamic, 16)
+            for (int line = 0; line < numScanlines; line++) {
+                size_t y = static_cast<size_t>(line) % volDim.y;
+                size_t z = static_cast<size_t>(line) / volDim.y;
+                filterScanlineHistogram(va, output, y, z, halfKernelDim, histogram);
+            }
+        }
+    }
+    else {
+        // blocks of scanlines share the ranking of the voxels covered by their kernels
+        const size_t blockSize = 32;
+        const size_t numBlocksY = (volDim.y + blockSize - 1) / blockSize;
+        const int numBlocks = static_cast<int>(numBlocksY * volDim.z);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int block = 0; block < numBlocks; block++) {
+            size_t yBegin = (static_cast<size_t>(block) % numBlocksY) * blockSize;
+            size_t z = static_cast<size_t>(block) / numBlocksY;
+            filterBlockRanked(va, output, z, yBegin, std::min(yBegin + blockSize, volDim.y), halfKernelDim);
+        }
+    }
+
+    return new VolumeHandle(output, vh);
+}
+
+template<typename T>
+void VolumeOperatorMedianGeneric<T>::getColumn(const VolumeAtomic<T>* input, size_t x,
+        const tgt::svec3& llf, const tgt::svec3& urb, std::vector<T>& column)
+{
+    for (size_t z = llf.z; z <= urb.z; z++) {
+        for (size_t y = llf.y; y <= urb.y; y++)
+            column.push_back(input->voxel(x, y, z));
+    }
+}
+
+template<typename T>
+void VolumeOperatorMedianGeneric<T>::filterScanlineHistogram(const VolumeAtomic<T>* input, VolumeAtomic<T>* output,
+        size_t y, size_t z, size_t halfKernelDim, MedianHistogram<T>& histogram)
+{
+    tgt::svec3 volDim = input->getDimensions();
+
+    // the kernel is clamped to the volume (x range is set per column)
+    tgt::svec3 llf(0, y >= halfKernelDim ? y - halfKernelDim : 0, z >= halfKernelDim ? z - halfKernelDim : 0);
+    tgt::svec3 urb(0, std::min(y+halfKernelDim, volDim.y-1), std::min(z+halfKernelDim, volDim.z-1));
+    size_t columnSize = (urb.y - llf.y + 1) * (urb.z - llf.z + 1);
+
+    std::vector<T> column;
+    column.reserve(columnSize);
+    size_t count = 0;
+
+    // initial window for x = 0
+    for (size_t x = 0; x <= std::min(halfKernelDim, volDim.x-1); x++) {
+        column.clear();
+        getColumn(input, x, llf, urb, column);
+        for (size_t i = 0; i < column.size(); i++)
+            histogram.add(column[i]);
+        count += column.size();
+    }
+
+    for (size_t x = 0; x < volDim.x; x++) {
+        output->voxel(x, y, z) = histogram.getValue(count / 2);
+
+        // slide window: remove leftmost column, add next column on the right
+        if (x >= halfKernelDim) {
+            column.clear();
+            getColumn(input, x - halfKernelDim, llf, urb, column);
+            for (size_t i = 0; i < column.size(); i++)
+                histogram.remove(column[i]);
+            count -= column.size();
+        }
+        if (x + halfKernelDim + 1 < volDim.x) {
+            column.clear();
+            getColumn(input, x + halfKernelDim + 1, llf, urb, column);
+            for (size_t i = 0; i < column.size(); i++)
+                histogram.add(column[i]);
+            count += column.size();
+        }
+    }
+
+    // the remaining columns are removed, so that the histogram is empty for the next scanline
+    size_t xmin = volDim.x > halfKernelDim ? volDim.x - halfKernelDim : 0;
+    for (size_t x = xmin; x < volDim.x; x++) {
+        column.clear();
+        getColumn(input, x, llf, urb, column);
+        for (size_t i = 0; i < column.size(); i++)
+            histogram.remove(column[i]);
+    }
+}
+
+template<typename T>
+void VolumeOperatorMedianGeneric<T>::filterBlockRanked(const VolumeAtomic<T>* input, VolumeAtomic<T>* output,
+        size_t z, size_t yBegin, size_t yEnd, size_t halfKernelDim)
+{
+    tgt::svec3 volDim = input->getDimensions();
+
+    // region covered by the kernels of all scanlines of the block
+    tgt::svec3 regionLlf(0, yBegin >= halfKernelDim ? yBegin - halfKernelDim : 0, z >= halfKernelDim ? z - halfKernelDim : 0);
+    tgt::svec3 regionUrb(volDim.x-1, std::min(yEnd-1+halfKernelDim, volDim.y-1), std::min(z+halfKernelDim, volDim.z-1));
+    tgt::svec3 regionDim = regionUrb - regionLlf + tgt::svec3(1, 1, 1);
+    size_t numVoxels = tgt::hmul(regionDim);
+
+    // sort the region once and replace each voxel by its rank, equal values get distinct ranks
+    std::vector<T> sortedValues(numVoxels);
+    std::vector<uint32_t> ranks(numVoxels);
+    {
+        std::vector<std::pair<T, uint32_t> > sorted;
+        sorted.reserve(numVoxels);
+        for (size_t rz = 0; rz < regionDim.z; rz++) {
+            for (size_t ry = 0; ry < regionDim.y; ry++) {
+                for (size_t x = 0; x < regionDim.x; x++) {
+                    sorted.push_back(std::make_pair(input->voxel(x, regionLlf.y + ry, regionLlf.z + rz),
+                        static_cast<uint32_t>(sorted.size())));
                 }
             }
         }
-        size_t len = values.size();
-        nth_element(values.begin(), values.begin()+(len/2), values.end());
-        output->voxel(pos) = values[len / 2];
+        std::sort(sorted.begin(), sorted.end(), RankLess());
+        for (size_t r = 0; r < numVoxels; r++) {
+            sortedValues[r] = sorted[r].first;
+            ranks[sorted[r].second] = static_cast<uint32_t>(r);
+        }
     }
 
-    //if (progressBar_) //FIXME
-        //progressBar_->setProgress(1.f);
+    MedianRankHistogram histogram(numVoxels);
 
-    return new VolumeHandle(output, vh);
+    for (size_t y = yBegin; y < yEnd; y++) {
+        // kernel rows and slices of the scanline, relative to the region
+        size_t ryMin = (y >= halfKernelDim ? y - halfKernelDim : 0) - regionLlf.y;
+        size_t ryMax = std::min(y+halfKernelDim, volDim.y-1) - regionLlf.y;
+        size_t rzMax = regionDim.z - 1;
+        size_t columnSize = (ryMax - ryMin + 1) * regionDim.z;
+        size_t count = 0;
+
+        // initial window for x = 0
+        for (size_t x = 0; x <= std::min(halfKernelDim, volDim.x-1); x++) {
+            for (size_t rz = 0; rz <= rzMax; rz++) {
+                for (size_t ry = ryMin; ry <= ryMax; ry++)
+                    histogram.add(ranks[(rz * regionDim.y + ry) * regionDim.x + x]);
+            }
+            count += columnSize;
+        }
+
+        for (size_t x = 0; x < volDim.x; x++) {
+            output->voxel(x, y, z) = sortedValues[histogram.getRank(count / 2)];
+
+            // slide window: remove leftmost column, add next column on the right
+            if (x >= halfKernelDim) {
+                size_t xOut = x - halfKernelDim;
+                for (size_t rz = 0; rz <= rzMax; rz++) {
+                    for (size_t ry = ryMin; ry <= ryMax; ry++)
+                        histogram.remove(ranks[(rz * regionDim.y + ry) * regionDim.x + xOut]);
+                }
+                count -= columnSize;
+            }
+            if (x + halfKernelDim + 1 < volDim.x) {
+                size_t xIn = x + halfKernelDim + 1;
+                for (size_t rz = 0; rz <= rzMax; rz++) {
+                    for (size_t ry = ryMin; ry <= ryMax; ry++)
+                        histogram.add(ranks[(rz * regionDim.y + ry) * regionDim.x + xIn]);
+                }
+                count += columnSize;
+            }
+        }
+
+        // the remaining columns are removed, so that the histogram is empty for the next scanline
+        size_t xmin = volDim.x > halfKernelDim ? volDim.x - halfKernelDim : 0;
+        for (size_t x = xmin; x < volDim.x; x++) {
+            for (size_t rz = 0; rz <= rzMax; rz++) {
+                for (size_t ry = ryMin; ry <= ryMax; ry++)
+                    histogram.remove(ranks[(rz * regionDim.y + ry) * regionDim.x + x]);
+            }
+        }
+    }
 }
 
 typedef UniversalUnaryVolumeOperatorGeneric<VolumeOperatorMedianBase> VolumeOperatorMedian;
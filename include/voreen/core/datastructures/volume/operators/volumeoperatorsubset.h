@@ -30,11 +30,18 @@
 #define VRN_VOLUMEOPERATORSUBSET_H
 
 #include "voreen/core/datastructures/volume/volumeoperator.h"
+#include "voreen/core/datastructures/volume/diskrepresentation.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
+
+#include <cstring>
 
 namespace voreen {
 
 /**
  * Returns a volume containing the subset [pos, pos+size[ of the passed input volume.
+ *
+ * If the input volume has not been loaded into RAM yet, but has a DiskRepresentation,
+ * only the subset is read from disk.
  */
 class VolumeOperatorSubsetBase : public UnaryVolumeOperatorBase {
 public:
@@ -46,12 +53,115 @@ template<typename T>
 class VolumeOperatorSubsetGeneric : public VolumeOperatorSubsetBase {
 public:
     virtual VolumeHandle* apply(const VolumeHandleBase* volume, tgt::ivec3 pos, tgt::ivec3 size, ProgressBar* progressBar = 0) const;
-    //Implement isCompatible using a handy macro:
-    IS_COMPATIBLE
+
+    /// In contrast to IS_COMPATIBLE, does not load a volume that is only available on disk.
+    bool isCompatible(const VolumeHandleBase* volume) const;
+
+private:
+    /// Returns the volume stored in the disk representation of the handle, if it is not loaded yet and has type T.
+    const DiskRepresentation* getDiskRepresentation(const VolumeHandleBase* volume) const;
 };
 
+template<typename T>
+const DiskRepresentation* VolumeOperatorSubsetGeneric<T>::getDiskRepresentation(const VolumeHandleBase* vh) const {
+    if (vh->hasRepresentation<Volume>() || !vh->hasRepresentation<DiskRepresentation>())
+        return 0;
+
+    const DiskRepresentation* disk = vh->getRepresentation<DiskRepresentation>();
+    VolumeFactory vf;
+    Volume* voxel = vf.create(disk->getFormat(), tgt::svec3(1,1,1));
+    bool matches = (dynamic_cast<VolumeAtomic<T>*>(voxel) != 0);
+    delete voxel;
+    return (matches ? disk : 0);
+}
+
+template<typename T>
+bool VolumeOperatorSubsetGeneric<T>::isCompatible(const VolumeHandleBase* volume) const {
+    if (getDiskRepresentation(volume))
+        return true;
+
+    const Volume* v = volume->getRepresentation<Volume>();
+    if(!v)
+        return false;
+    const VolumeAtomic<T>* va = dynamic_cast<const VolumeAtomic<T>*>(v);
+    if(!va)
+        return false;
+    return true;
+}
+
 template<typename T>
 VolumeHandle* VolumeOperatorSubsetGeneric<T>::apply(const VolumeHandleBase* vh, tgt::ivec3 pos, tgt::ivec3 size, ProgressBar* progressBar) const {
+    if (const DiskRepresentation* disk = getDiskRepresentation(vh)) {
+        LINFOC("voreen.VolumeOperatorCreateSubset", "Reading subset " << size << " from position " << pos << " from disk");
+
+        // as in the in-memory path, the voxels inside the volume are placed at index 0
+        // and the remaining voxels are set to zero
+        tgt::ivec3 dims = tgt::ivec3(vh->getDimensions());
+        tgt::ivec3 start = tgt::clamp(pos, tgt::ivec3::zero, dims);
+        tgt::ivec3 end = tgt::clamp(pos + size, start, dims);
+        tgt::svec3 inside(end - start);
+        tgt::svec3 subsetDims(size);
+        DiskRepresentation* subDisk = disk->getSubVolume(inside, tgt::svec3(start));
+
+        VolumeAtomic<T>* subset = 0;
+        if (inside == subsetDims) {
+            RepresentationConverterLoadFromDisk converter;
+            subset = dynamic_cast<VolumeAtomic<T>*>(static_cast<Volume*>(converter.convert(subDisk)));
+        }
+        else {
+            try {
+                subset = new VolumeAtomic<T>(subsetDims, vh->getBitsStored());
+                if (tgt::hor(tgt::equal(inside, tgt::svec3::zero))) {
+                    subset->clear();
+                }
+                else {
+                    // read the rows compactly and move them to their place in the subset,
+                    // starting with the last row so that no row is overwritten before it is moved
+                    T* data = subset->voxel();
+                    subDisk->readVoxels(data);
+                    size_t rowBytes = inside.x * sizeof(T);
+                    for (size_t z = inside.z; z-- > 0;) {
+                        for (size_t y = inside.y; y-- > 0;) {
+                            T* src = data + (z * inside.y + y) * inside.x;
+                            T* dst = data + (z * subsetDims.y + y) * subsetDims.x;
+                            if (dst != src)
+                                memmove(dst, src, rowBytes);
+                        }
+                    }
+                    // clear what is left of the compact rows outside of their new places
+                    for (size_t z = 0; z < subsetDims.z; z++) {
+                        for (size_t y = 0; y < subsetDims.y; y++) {
+                            T* row = data + (z * subsetDims.y + y) * subsetDims.x;
+                            if (z < inside.z && y < inside.y)
+                                memset(row + inside.x, 0, (subsetDims.x - inside.x) * sizeof(T));
+                            else
+                                memset(row, 0, subsetDims.x * sizeof(T));
+                        }
+                    }
+                }
+            }
+            catch (std::bad_alloc) {
+                LERRORC("voreen.VolumeOperatorCreateSubset", "Failed to create subset: bad allocation");
+                delete subDisk;
+                throw; // throw it to the caller
+            }
+            catch (tgt::IOException& e) {
+                LERRORC("voreen.VolumeOperatorCreateSubset", "Failed to read subset: " << e.what());
+                delete subset;
+                subset = 0;
+            }
+        }
+        delete subDisk;
+        if (progressBar)
+            progressBar->setProgress(1.f);
+        if (!subset)
+            return 0;
+
+        VolumeHandle* newvh = new VolumeHandle(subset, vh);
+        newvh->setOffset(vh->getOffset() + (tgt::vec3(tgt::max(pos, tgt::ivec3::zero)) * vh->getSpacing()));
+        return newvh;
+    }
+
     const Volume* vol = vh->getRepresentation<Volume>();
     if(!vol)
         return 0;
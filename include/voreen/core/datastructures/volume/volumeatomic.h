@@ -463,7 +463,7 @@ bool voreen::VolumeAtomic<T>::isInteger() {
 
 template<class T>
 void voreen::VolumeAtomic<T>::setBitsStored(int bits) {
-    setBitsStored(bits);
+    Volume::setBitsStored(bits);
 
     // special treatment for 12 bit volumes stored in 16 bit
     if (typeid(T) == typeid(uint16_t) && getBitsStored() == 12)
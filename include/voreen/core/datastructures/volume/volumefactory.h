@@ -30,6 +30,7 @@
 #define VRN_VOLUMEFACTORY_H
 
 #include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/mappedvolume.h"
 #include <algorithm>
 #include <cctype>
 #include <typeinfo> 
@@ -46,6 +47,8 @@ class VRN_CORE_API VolumeGeneratorBase {
 public:
     virtual std::string getType() const = 0;
     virtual Volume* create(tgt::svec3 dimensions) const = 0;
+    /// Creates a volume on the passed mapping, which is owned by the volume afterwards.
+    virtual Volume* createMapped(MappedFile* file, tgt::svec3 dimensions) const = 0;
     virtual bool isType(const Volume* v) const = 0;
     virtual int getNumChannels() const = 0;
 };
@@ -74,6 +77,24 @@ public:
         return 0;
     }
 
+    /**
+     * Creates a volume of the passed type whose data resides in the passed file mapping.
+     * The volume takes ownership of the mapping. If the type is unknown, 0 is returned
+     * and the mapping is left untouched.
+     *
+     * @see MappedVolume
+     */
+    Volume* createMapped(const std::string& type, MappedFile* file, tgt::svec3 dimensions) const {
+        std::string smallType = type;
+        std::transform(type.begin(), type.end(), smallType.begin(), ToLower());
+        for (size_t i = 0; i < generators_.size(); ++i) {
+            if ((generators_[i]->getType() == type) || (generators_[i]->getType() == smallType))
+                return generators_[i]->createMapped(file, dimensions);
+        }
+        LERROR("Failed to create mapped volume of type '" << type << "'");
+        return 0;
+    }
+
     int getNumChannels(const std::string& type) const {
         std::string smallType = type;
         std::transform(type.begin(), type.end(), smallType.begin(), ToLower());
@@ -100,8 +121,12 @@ public:
         return new VolumeAtomic<T>(dimensions);
     }
 
+    virtual Volume* createMapped(MappedFile* file, tgt::svec3 dimensions) const {
+        return new MappedVolume<T>(file, dimensions);
+    }
+
     virtual bool isType(const Volume* v) const {
-        if(typeid(*v) == typeid(VolumeAtomic<T>))
+        if(typeid(*v) == typeid(VolumeAtomic<T>) || typeid(*v) == typeid(MappedVolume<T>))
             return true;
         else
             return false;
@@ -250,7 +250,7 @@ public:
     void clearDerivedData();
 
     /**
-     * Computes the MD5 hash of the raw volume data.
+     * Computes the hash of the raw volume data (see VolumeHash).
      * The result is cached, Use VolumeAtomic::invalidate to mark cached hash as invalid.
      */
     virtual std::string getHash() const;
@@ -535,8 +535,12 @@ public:
      */
     bool reloadVolume();
 
-    ///Set the MD5 hash. Should only be called by a reader.
-    virtual void setHash(const std::string& hash) const;
+    /**
+     * Set the hash. Should only be called by a reader.
+     *
+     * @param version version of the hash algorithm, see VolumeHash::Version
+     */
+    virtual void setHash(const std::string& hash, int version = 1) const;
 
     /**
      * @see Serializable::serialize
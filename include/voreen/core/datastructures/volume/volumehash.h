@@ -39,11 +39,28 @@
 
 namespace voreen {
 
+/**
+ * Content hash of the voxel data of a volume, used for identifying
+ * volumes, e.g., by the processor cache.
+ *
+ * The hash algorithm is versioned: hashes of an outdated version
+ * (e.g., read from a legacy file) are not used by VolumeHandleBase::getHash(),
+ * but replaced by a recomputed hash.
+ */
 class VRN_CORE_API VolumeHash : public VolumeDerivedData {
 public:
+    /// Versions of the hash algorithm.
+    enum Version {
+        VERSION_MD5 = 1,            ///< MD5 over the entire voxel data (legacy, no version serialized)
+        VERSION_CHUNKED_MURMUR3 = 2 ///< parallel chunked MurmurHash3 tree hash, see VoreenHash::getChunkedHash
+    };
+
+    /// Version used for newly computed hashes.
+    static const Version CURRENT_VERSION = VERSION_CHUNKED_MURMUR3;
+
     /// Empty default constructor required by VolumeDerivedData interface.
     VolumeHash();
-    VolumeHash(const std::string& hash);
+    VolumeHash(const std::string& hash, int version = VERSION_MD5);
 
     virtual VolumeDerivedData* createFrom(const VolumeHandleBase* handle) const;
 
@@ -57,6 +74,11 @@ public:
         return hash_;
     }
 
+    /// Returns the version of the algorithm the hash has been computed with.
+    int getVersion() const {
+        return version_;
+    }
+
     void setHash(const std::string& hash) {
         if(hash.length() == 32) 
             hash_ = hash;
@@ -66,6 +88,7 @@ public:
 
 protected:
     std::string hash_;
+    int version_;
 };
 
 } // namespace voreen
@@ -0,0 +1,97 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMEMINMAXOCTREE_H
+#define VRN_VOLUMEMINMAXOCTREE_H
+
+#include "voreen/core/datastructures/volume/volume.h"
+#include "voreen/core/datastructures/volume/volumederiveddata.h"
+
+#include <vector>
+
+namespace voreen {
+
+/**
+ * Stores the minimum and maximum normalized intensity (first channel)
+ * of cubic bricks of a volume together with a min/max pyramid over these
+ * bricks, i.e., an implicit octree. Level 0 holds the bricks, each node
+ * of level i+1 covers 2x2x2 nodes of level i.
+ *
+ * Each brick also covers the first voxel layer of its upper neighbors,
+ * so that the range of a brick bounds all values that can be obtained by
+ * trilinear interpolation within the brick.
+ *
+ * Used for empty space skipping: a node whose intensity range is mapped
+ * to zero opacity by the transfer function can be skipped entirely.
+ */
+class VRN_CORE_API VolumeMinMaxOctree : public VolumeDerivedData {
+public:
+    /// Empty default constructor required by VolumeDerivedData interface.
+    VolumeMinMaxOctree();
+
+    /**
+     * Computes the octree for the passed volume.
+     *
+     * @param volume the volume to compute the octree for
+     * @param brickSize edge length of the leaf bricks in voxels
+     */
+    VolumeMinMaxOctree(const Volume* volume, size_t brickSize = 8);
+
+    /// Creates an octree with the default brick size.
+    virtual VolumeDerivedData* createFrom(const VolumeHandleBase* handle) const;
+
+    /// @see VolumeDerivedData
+    virtual void serialize(XmlSerializer& s) const;
+
+    /// @see VolumeDerivedData
+    virtual void deserialize(XmlDeserializer& s);
+
+    /// Returns the edge length of the leaf bricks in voxels.
+    size_t getBrickSize() const;
+
+    /// Returns the number of levels including the leaf level.
+    size_t getNumLevels() const;
+
+    /// Returns the number of nodes per dimension of the specified level.
+    tgt::svec3 getLevelDimensions(size_t level) const;
+
+    /// Returns the min/max intensity of all nodes of a level in x-y-z order.
+    const std::vector<tgt::vec2>& getLevel(size_t level) const;
+
+    /// Returns the min (x) and max (y) normalized intensity of the specified node.
+    tgt::vec2 getMinMax(size_t level, const tgt::svec3& node) const;
+
+protected:
+    size_t brickSize_;
+    std::vector<tgt::ivec3> levelDims_;
+    std::vector<std::vector<tgt::vec2> > levels_;
+};
+
+} // namespace voreen
+
+#endif
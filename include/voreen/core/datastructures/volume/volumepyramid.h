@@ -0,0 +1,110 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMEPYRAMID_H
+#define VRN_VOLUMEPYRAMID_H
+
+#include "voreen/core/datastructures/volume/volumederiveddata.h"
+
+#include "tgt/vector.h"
+
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+class VolumeHandle;
+
+/**
+ * Multiresolution pyramid of a volume: level i is the volume halfsampled
+ * i+1 times (see VolumeOperatorHalfsample), down to the coarsest level
+ * whose smallest dimension can not be halved anymore.
+ *
+ * When serialized into a file (e.g., as derived data of a .vvd file),
+ * the voxel data of each level is written into a raw file next to it.
+ * Deserialized levels are loaded lazily, so that a coarse level can be
+ * used as preview before the full resolution volume is loaded.
+ *
+ * The VvdVolumeWriter stores a pyramid with each volume by default, and the
+ * VvdVolumeReader returns a single level on request (see VvdVolumeReader::read).
+ */
+class VRN_CORE_API VolumePyramid : public VolumeDerivedData {
+public:
+    /// Empty default constructor required by VolumeDerivedData interface.
+    VolumePyramid();
+
+    /**
+     * Computes all levels of the passed volume.
+     *
+     * @param maxLevels maximum number of levels to compute, 0 for no limit
+     */
+    VolumePyramid(const VolumeHandleBase* handle, size_t maxLevels = 0);
+
+    /// Deletes the level volumes.
+    virtual ~VolumePyramid();
+
+    virtual VolumeDerivedData* createFrom(const VolumeHandleBase* handle) const;
+
+    /**
+     * Writes the level volumes into raw files next to the document,
+     * if the serializer has a document path.
+     *
+     * @see VolumeDerivedData
+     */
+    virtual void serialize(XmlSerializer& s) const;
+
+    /// @see VolumeDerivedData
+    virtual void deserialize(XmlDeserializer& s);
+
+    /// Returns the number of levels, excluding the full resolution.
+    size_t getNumLevels() const;
+
+    /**
+     * Returns the volume halfsampled level+1 times. Its spacing is scaled accordingly,
+     * all other meta data is taken from the original volume.
+     */
+    const VolumeHandle* getLevel(size_t level) const;
+
+    /// Returns the level with the lowest resolution, or 0 if the pyramid is empty.
+    const VolumeHandle* getCoarsestLevel() const;
+
+private:
+    // not copyable
+    VolumePyramid(const VolumePyramid&);
+    VolumePyramid& operator=(const VolumePyramid&);
+
+    void clear();
+
+    std::vector<VolumeHandle*> levels_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_VOLUMEPYRAMID_H
@@ -0,0 +1,218 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOXELEXPRESSION_H
+#define VRN_VOXELEXPRESSION_H
+
+#include "voreen/core/voreencoredefine.h"
+#include "voreen/core/utils/exception.h"
+#include "tgt/matrix.h"
+
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+class Volume;
+class VolumeHandleBase;
+class ProgressBar;
+
+/**
+ * Voxel-wise arithmetic expression over up to four input volumes.
+ *
+ * The expression is compiled once into a linear program of operations, which
+ * is then evaluated over blocks of voxels instead of interpreting it per voxel.
+ * Since an expression may combine arbitrarily many operations, several voxel-wise
+ * processing stages (e.g. combination, masking and inversion) can be computed
+ * in a single pass without intermediate volumes.
+ *
+ * Syntax:
+ *  - the inputs are referenced as A, B, C and D, evaluating to the normalized
+ *    voxel values (see Volume::getVoxelFloat) of the respective input channel
+ *  - number literals and named parameters (any other identifier, see setParameter)
+ *  - the operators + - * / ^ (power), unary - and !, the comparisons
+ *    < <= > >= == != and the logical operators && ||, which yield 1 or 0
+ *  - the conditional operator cond ? a : b, where any non-zero cond is true
+ *  - the functions min(a,b), max(a,b), pow(a,b), clamp(x,min,max), mix(a,b,t),
+ *    abs(x), sqrt(x), exp(x), log(x), floor(x) and ceil(x)
+ *
+ * Example: "B > 0 ? clamp(1 - c*A, 0, 1) : 0"
+ */
+class VRN_CORE_API VoxelExpression {
+public:
+    /// Filtering used for sampling the inputs when resampling is necessary.
+    enum Filtering {
+        FILTER_NEAREST,
+        FILTER_LINEAR,
+        FILTER_CUBIC
+    };
+
+    /// Maximum number of input volumes that can be referenced by an expression.
+    static const size_t MAX_INPUTS = 4;
+
+    /// Creates an expression that always evaluates to zero.
+    VoxelExpression();
+
+    /**
+     * Compiles the passed expression.
+     *
+     * @throw VoreenException if the expression contains a syntax error
+     */
+    explicit VoxelExpression(const std::string& expression) throw (VoreenException);
+
+    /**
+     * Compiles the passed expression and replaces the current one.
+     * Parameters values of the current expression are retained.
+     *
+     * @throw VoreenException if the expression contains a syntax error,
+     *        the current expression is not modified in this case
+     */
+    void compile(const std::string& expression) throw (VoreenException);
+
+    /// Returns the source of the compiled expression.
+    const std::string& getExpression() const;
+
+    /// Returns true if the expression references the input with the passed index (0 for A).
+    bool usesInput(size_t index) const;
+
+    /// Returns one plus the highest index of the referenced inputs.
+    size_t getNumInputs() const;
+
+    /// Returns the names of the parameters referenced by the expression.
+    std::vector<std::string> getParameterNames() const;
+
+    /// Sets the value of a named parameter. Parameters that have not been set evaluate to zero.
+    void setParameter(const std::string& name, float value);
+
+    /**
+     * Evaluates the expression for a block of voxels.
+     *
+     * @param inputs values of the inputs, one array of numVoxels values for each referenced input
+     * @param result array of numVoxels values receiving the results
+     * @param numVoxels number of voxels in the block
+     * @param scratch temporary storage of at least getScratchSize(numVoxels) values
+     */
+    void evaluate(const float* const* inputs, float* result, size_t numVoxels, float* scratch) const;
+
+    /// Returns the number of temporary values required for evaluating a block of the passed size.
+    size_t getScratchSize(size_t numVoxels) const;
+
+    /**
+     * Evaluates the expression for each voxel and channel of the output volume,
+     * with inputs that share the grid of the output. Neither resampling nor coordinate
+     * transformations are performed, and the voxels are read in storage order.
+     *
+     * If an input has as many channels as the output, the respective channel is used
+     * for each output channel, otherwise its first channel.
+     *
+     * @param inputs the input volumes, their dimensions have to match the output's
+     */
+    void apply(const std::vector<const Volume*>& inputs, Volume* output, ProgressBar* progressBar = 0) const;
+
+    /**
+     * Evaluates the expression for each voxel and channel of the output volume,
+     * by sampling the inputs at the transformed output voxel positions.
+     * Positions outside an input volume evaluate to zero for this input.
+     *
+     * @param inputs the input volumes
+     * @param outputToInput for each input, the transformation from the output's voxel
+     *        coordinates to the input's voxel coordinates
+     * @param filtering the filtering used for sampling the inputs
+     */
+    void apply(const std::vector<const Volume*>& inputs, const std::vector<tgt::mat4>& outputToInput,
+        Volume* output, Filtering filtering, ProgressBar* progressBar = 0) const;
+
+    /**
+     * Returns true if the two volumes share a common grid in world space,
+     * i.e., the voxels can be combined without resampling.
+     */
+    static bool onCommonGrid(const VolumeHandleBase* first, const VolumeHandleBase* second);
+
+private:
+    /// Operation of the compiled program. Each instruction writes one register.
+    enum OpCode {
+        OP_INPUT,
+        OP_PARAMETER,
+        OP_CONSTANT,
+        OP_NEG,
+        OP_NOT,
+        OP_ABS,
+        OP_SQRT,
+        OP_EXP,
+        OP_LOG,
+        OP_FLOOR,
+        OP_CEIL,
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        OP_POW,
+        OP_MIN,
+        OP_MAX,
+        OP_LESS,
+        OP_LESS_EQUAL,
+        OP_GREATER,
+        OP_GREATER_EQUAL,
+        OP_EQUAL,
+        OP_NOT_EQUAL,
+        OP_AND,
+        OP_OR,
+        OP_SELECT,
+        OP_CLAMP,
+        OP_MIX
+    };
+
+    struct Instruction {
+        OpCode op_;
+        size_t operands_[3];   ///< registers of the operands, or input/parameter index
+        float value_;          ///< value of constants
+    };
+
+    class Parser;
+    friend class Parser;
+
+    /// Appends an instruction, folding it into a constant if all operands are constant.
+    size_t emit(OpCode op, size_t a = 0, size_t b = 0, size_t c = 0, float value = 0.f);
+
+    /// Evaluates a single instruction for a block of voxels, given the values of its operands.
+    static void execute(const Instruction& instr, const float* a, const float* b, const float* c,
+        const float* parameters, float* out, size_t numVoxels);
+
+    static size_t getNumOperands(OpCode op);
+
+    std::string expression_;
+    std::vector<Instruction> program_;
+    std::vector<std::string> parameterNames_;
+    std::vector<float> parameterValues_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_VOXELEXPRESSION_H
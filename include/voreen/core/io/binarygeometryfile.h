@@ -0,0 +1,200 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_BINARYGEOMETRYFILE_H
+#define VRN_BINARYGEOMETRYFILE_H
+
+#include "voreen/core/voreencoredefine.h"
+#include "voreen/core/io/serialization/serializationexceptions.h"
+
+#include "tgt/exception.h"
+#include "tgt/vector.h"
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace voreen {
+
+class Geometry;
+class MappedFile;
+
+/**
+ * Binary container for geometry data (.vgb), used as a compact alternative
+ * to the XML serialization of large geometries.
+ *
+ * The file consists of a header with the geometry type and a table of named,
+ * typed flat arrays, followed by the array data. Arrays are aligned to 16 bytes
+ * and may be compressed by zlib, if Voreen is built with the zip module.
+ * When a file is read, the data section is memory mapped, so uncompressed arrays
+ * are directly copied from the page cache without any parsing.
+ *
+ * Geometry types support the format by implementing Geometry::serializeBinary()
+ * and Geometry::deserializeBinary().
+ */
+class VRN_CORE_API BinaryGeometryFile {
+public:
+    /// Data type of the array elements.
+    enum ElementType {
+        UINT8   = 0,
+        INT32   = 1,
+        UINT32  = 2,
+        FLOAT32 = 3
+    };
+
+    /// File name extension of binary geometry files.
+    static const std::string FILE_EXTENSION;
+
+    BinaryGeometryFile();
+    ~BinaryGeometryFile();
+
+    /// Sets the type string of the contained geometry, as used by the GeometryFactory.
+    void setGeometryType(const std::string& type);
+    std::string getGeometryType() const;
+
+    /**
+     * Adds a copy of the given array to the file. An existing array with the same name is replaced.
+     *
+     * Supported element types are uint8_t, int32_t, uint32_t, float and the float vectors tgt::vec2-4.
+     */
+    template<typename T>
+    void setArray(const std::string& name, const std::vector<T>& data);
+
+    /**
+     * Copies the array with the given name into \p data.
+     *
+     * @throw SerializationException if the array does not exist, its element type does not match
+     *  or its data could not be decompressed
+     */
+    template<typename T>
+    void getArray(const std::string& name, std::vector<T>& data) const throw (SerializationException);
+
+    /// Returns whether the file contains an array with the given name.
+    bool hasArray(const std::string& name) const;
+
+    /**
+     * Returns a 128 bit content hash of the geometry type and all arrays.
+     */
+    std::string getHash() const;
+
+    /**
+     * Writes the file.
+     *
+     * @param compress compress the arrays with zlib. Ignored, if Voreen is built without the zip module.
+     */
+    void write(const std::string& filename, bool compress = false) const throw (tgt::FileException);
+
+    /**
+     * Reads the header of the given file and maps its data section.
+     * Any previously contained arrays are discarded.
+     */
+    void read(const std::string& filename) throw (tgt::FileException);
+
+    /// Returns whether the file starts with the binary geometry file signature.
+    static bool isBinaryGeometryFile(const std::string& filename);
+
+    /**
+     * Serializes the given geometry into a binary geometry file.
+     *
+     * @throw tgt::FileException if the geometry type does not support binary serialization
+     *  or the file could not be written
+     */
+    static void writeGeometry(const Geometry* geometry, const std::string& filename, bool compress = false)
+        throw (tgt::FileException);
+
+    /**
+     * Reads a geometry from a binary geometry file, which is instantiated by the GeometryFactory.
+     * The caller takes ownership of the returned geometry.
+     *
+     * @throw tgt::FileException if the file could not be read or the geometry type is unknown
+     */
+    static Geometry* readGeometry(const std::string& filename) throw (tgt::FileException);
+
+private:
+    template<typename T>
+    struct ElementTraits;
+
+    struct Array {
+        std::string name_;
+        ElementType type_;
+        size_t components_;
+        size_t count_;
+        size_t elementSize_;
+
+        std::vector<char> data_;     ///< uncompressed data of arrays added by setArray()
+        size_t offset_;              ///< offset of the stored data within the data section of a read file
+        size_t storedBytes_;         ///< number of stored bytes in a read file
+        bool compressed_;
+
+        size_t getNumBytes() const { return count_ * elementSize_; }
+    };
+
+    void setArray(const std::string& name, ElementType type, size_t components, size_t elementSize,
+                  const void* data, size_t count);
+    const Array& getArray(const std::string& name, ElementType type, size_t components) const
+        throw (SerializationException);
+    void copyArray(const Array& array, void* dest) const throw (SerializationException);
+
+    BinaryGeometryFile(const BinaryGeometryFile&);
+    BinaryGeometryFile& operator=(const BinaryGeometryFile&);
+
+    std::string geometryType_;
+    std::vector<Array> arrays_;
+
+    std::string filename_;
+    MappedFile* mapping_;            ///< mapped data section of a read file
+    std::vector<char> fileData_;     ///< data section of a read file, if memory mapping is not supported
+
+    static const std::string loggerCat_;
+};
+
+template<> struct BinaryGeometryFile::ElementTraits<uint8_t>    { static const ElementType type = UINT8;   static const size_t components = 1; };
+template<> struct BinaryGeometryFile::ElementTraits<int32_t>    { static const ElementType type = INT32;   static const size_t components = 1; };
+template<> struct BinaryGeometryFile::ElementTraits<uint32_t>   { static const ElementType type = UINT32;  static const size_t components = 1; };
+template<> struct BinaryGeometryFile::ElementTraits<float>      { static const ElementType type = FLOAT32; static const size_t components = 1; };
+template<> struct BinaryGeometryFile::ElementTraits<tgt::vec2>  { static const ElementType type = FLOAT32; static const size_t components = 2; };
+template<> struct BinaryGeometryFile::ElementTraits<tgt::vec3>  { static const ElementType type = FLOAT32; static const size_t components = 3; };
+template<> struct BinaryGeometryFile::ElementTraits<tgt::vec4>  { static const ElementType type = FLOAT32; static const size_t components = 4; };
+
+template<typename T>
+void BinaryGeometryFile::setArray(const std::string& name, const std::vector<T>& data) {
+    setArray(name, ElementTraits<T>::type, ElementTraits<T>::components, sizeof(T),
+             data.empty() ? 0 : &data[0], data.size());
+}
+
+template<typename T>
+void BinaryGeometryFile::getArray(const std::string& name, std::vector<T>& data) const throw (SerializationException) {
+    const Array& array = getArray(name, ElementTraits<T>::type, ElementTraits<T>::components);
+    data.resize(array.count_);
+    if (!data.empty())
+        copyArray(array, &data[0]);
+}
+
+} // namespace voreen
+
+#endif // VRN_BINARYGEOMETRYFILE_H
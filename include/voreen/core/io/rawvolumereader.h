@@ -76,6 +76,7 @@ public:
         tgt::mat4 transformation_;    ///< 4x4-matrix for affine transformation of volume
         Modality modality_;
         std::string hash_;
+        int hashVersion_;             ///< version of the hash algorithm, see VolumeHash::Version
         float timeStep_;
         float spreadMin_;             ///< minimum value in the volume to use for spreading data range to [0; 1]
         float spreadMax_;             ///< maximum value in the volume to use for spreading data range to [0; 1]
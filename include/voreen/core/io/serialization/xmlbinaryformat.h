@@ -0,0 +1,89 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_XMLBINARYFORMAT_H
+#define VRN_XMLBINARYFORMAT_H
+
+#include "tinyxml/tinyxml.h"
+
+#include "voreen/core/voreencoredefine.h"
+#include "voreen/core/io/serialization/serializationexceptions.h"
+
+#include <iostream>
+#include <set>
+#include <string>
+
+namespace voreen {
+
+/**
+ * Compact binary encoding of the XML documents built by the XmlSerializer.
+ *
+ * The document tree is written as a stream of tagged tokens (element begin/end, text, comment).
+ * All element names, attribute names and values are interned: each distinct string is stored
+ * once on its first occurrence and afterwards referenced by its index. Reading such a stream
+ * rebuilds the TinyXML tree without parsing any XML text, so binary documents are deserialized
+ * through the regular XmlDeserializer interface.
+ *
+ * @see XmlSerializer::writeBinary
+ * @see XmlDeserializer::read
+ */
+class VRN_CORE_API XmlBinaryFormat {
+public:
+    /**
+     * Writes the elements, texts and comments of the given document.
+     * The XML declaration is omitted.
+     */
+    static void write(const TiXmlDocument& document, std::ostream& stream);
+
+    /**
+     * Appends the nodes read from the stream to the given document.
+     *
+     * @param ids if not null, receives the values of all reference id attributes
+     * @param references if not null, receives the values of all reference attributes
+     *
+     * @throws XmlSerializationFormatException if the stream is not a valid binary document
+     */
+    static void read(std::istream& stream, TiXmlDocument& document,
+                     std::set<std::string>* ids = 0, std::set<std::string>* references = 0)
+        throw (SerializationException);
+
+    /**
+     * Returns whether the stream starts with the binary document signature.
+     * The read position of the stream is not changed.
+     */
+    static bool isBinary(std::istream& stream);
+
+private:
+    class StringTable;
+
+    static void writeNode(const TiXmlNode* node, std::ostream& stream, StringTable& strings);
+};
+
+} // namespace
+
+#endif // VRN_XMLBINARYFORMAT_H
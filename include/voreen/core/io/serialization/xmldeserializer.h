@@ -736,6 +736,9 @@ public:
     /**
      * Reads the XML document from the given input stream after an optional XML preprocessor is applied.
      *
+     * Documents written by XmlSerializer::writeBinary are detected automatically.
+     * In that case, the stream has to be opened in binary mode.
+     *
      * @param stream the input stream
      * @param xmlProcessor XML preprocessor
      *
@@ -1330,6 +1333,13 @@ private:
     TiXmlElement* getNextXmlElement(const std::string& key)
         throw (SerializationException);
 
+    /**
+     * Marks the given XML node as not visited, so that it is returned
+     * again by @c getNextXmlElement. The search for the next element with the
+     * same key is moved back to the node, if necessary.
+     */
+    void markUnvisited(TiXmlNode* element);
+
     /**
      * Type definition for set of visited XML nodes.
      */
@@ -1340,6 +1350,18 @@ private:
      */
     VisitedNodesSetType visitedNodes_;
 
+    /**
+     * Type definition for map of the last element returned by @c getNextXmlElement
+     * for a parent node and key.
+     */
+    typedef std::map<std::pair<TiXmlNode*, std::string>, TiXmlElement*> LastVisitedElementMapType;
+
+    /**
+     * Last element returned for each parent node/key pair. All preceding siblings with
+     * the same key have been visited, so the search for the next element starts behind it.
+     */
+    LastVisitedElementMapType lastVisitedElements_;
+
     /**
      * Type definition for pointer address look up map.
      */
@@ -1595,7 +1617,7 @@ void XmlDeserializer::deserialize(const std::string& key, T*& data)
             data = allocateMemory<T>(data, type);
 
             // ATTENTION: We have to set element unvisited in order to deserialize it.
-            visitedNodes_.erase(visitedNodes_.find(element));
+            markUnvisited(element);
 
             deserialize(key, *data);
         }
@@ -1879,7 +1901,7 @@ inline void XmlDeserializer::deserializeAttributeFromNode(const std::string& nod
     deserialize(key, data);
 
     if (!markVisited)
-        visitedNodes_.erase(node_);
+        markUnvisited(node_);
 }
 
 template<class T>
@@ -127,6 +127,17 @@ public:
      */
     std::string getDocumentPath() const;
 
+    /**
+     * Registers a file written next to the document and referenced by it,
+     * e.g., the binary data of a large geometry.
+     */
+    void addReferencedFile(const std::string& filename);
+
+    /**
+     * Returns the names of the files registered by @c addReferencedFile.
+     */
+    const std::set<std::string>& getReferencedFiles() const;
+
     /**
      * Serialize the given @c key/data pair if data != defaultValue.
      */
@@ -634,6 +645,18 @@ public:
      */
     void write(std::ostream& stream);
 
+    /**
+     * Writes the serialized data to the given stream in the compact binary encoding
+     * of XmlBinaryFormat. The stream has to be opened in binary mode.
+     *
+     * @attention The same restrictions as for @c write apply.
+     *
+     * @param stream the output stream
+     *
+     * @see XmlDeserializer::read
+     */
+    void writeBinary(std::ostream& stream);
+
 protected:
     /**
      * Category for logging.
@@ -895,6 +918,9 @@ private:
     /// Path to the target XML document
     std::string documentPath_;
 
+    /// Files written next to the document and referenced by it
+    std::set<std::string> referencedFiles_;
+
 };
 
 template<class T>
@@ -60,12 +60,23 @@ public:
     VvdObject() {}
     VvdObject(const VolumeHandleBase* vh, std::string rawFilename);
 
+    virtual ~VvdObject() {}
+
     ///Because the filename is relative to the vvd file we need the directory
-    VolumeHandle* createVolume(std::string directory);
+    virtual VolumeHandle* createVolume(std::string directory);
+
+    ///Adds derived data to be written with the volume. The object is not taken over.
+    void addDerivedData(VolumeDerivedData* data);
 
     virtual void serialize(XmlSerializer& s) const;
     virtual void deserialize(XmlDeserializer& s);
-private:
+protected:
+    ///Copies the meta data of the volume handle that differs from the defaults.
+    void copyMetaData(const VolumeHandleBase* vh);
+
+    ///Renames legacy meta data keys after deserialization.
+    void renameLegacyMetaData();
+
     VvdRawDataObject rawData_;
     MetaDataContainer metaData_;
     std::set<VolumeDerivedData*> derivedData_;
@@ -41,10 +41,26 @@ public:
     virtual std::string getClassName() const   { return "VvdVolumeReader"; }
     virtual std::string getFormatDescription() const { return "New Voreen volume format"; }
 
+    /**
+     * Reads the volumes of a .vvd file.
+     *
+     * A level of the stored VolumePyramid can be requested by the search parameter
+     * "level" for a quick preview, e.g. "volume.vvd?level=coarsest": 0 denotes the
+     * full resolution, n the volume halfsampled n times, and "coarsest" the
+     * lowest resolution stored. The full resolution volume can be read afterwards
+     * without the parameter.
+     */
     virtual VolumeCollection* read(const std::string& url)
         throw (tgt::FileException, std::bad_alloc);
 
 private:
+    /**
+     * Returns a volume referring to the stored pyramid level of the passed volume,
+     * or 0 if the full resolution is requested or no pyramid is available.
+     */
+    VolumeHandle* createLevelVolume(const VolumeHandle* volume, const std::string& level) const
+        throw (tgt::FileException);
+
     static const std::string loggerCat_;
 };
 
@@ -53,7 +53,18 @@ public:
      */
     virtual void write(const std::string& filename, const VolumeHandleBase* volumeHandle)
         throw (tgt::IOException);
+
+    /**
+     * If enabled (default), a VolumePyramid is stored next to the volume, so that readers
+     * can provide a coarse preview (see VvdVolumeReader). A pyramid already attached
+     * to the volume is written in any case.
+     */
+    void setWritePyramid(bool enabled);
+    bool getWritePyramid() const;
+
 private:
+    bool writePyramid_;
+
     static const std::string loggerCat_;
 };
 
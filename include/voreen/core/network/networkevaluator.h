@@ -96,6 +96,19 @@ public:
      */
     void process();
 
+    /**
+     * Enables or disables the concurrent processing of independent network branches.
+     * If enabled, processors that declare themselves thread-safe (\sa Processor::isThreadSafe)
+     * are processed on worker threads, as long as the network does not contain loops.
+     * All other processors are processed on the main thread. Enabled by default.
+     */
+    void setParallelProcessing(bool enabled);
+
+    /**
+     * Returns whether the concurrent processing of independent network branches is enabled.
+     */
+    bool getParallelProcessing() const;
+
     /**
      * Performs all necessary updates whenever the network has changed. Call this
      * method carefully and only if the NETWORK changed, not the connections. I.e.,
@@ -253,6 +266,49 @@ private:
      */
     void defineRenderingOrder();
 
+    /**
+     * Returns true, if the passed processor is initialized, invalid and ready.
+     * Logs a warning for uninitialized processors.
+     */
+    bool needsProcessing(Processor* processor) const;
+
+    /**
+     * Processes the passed processor on the main thread and inserts it
+     * into the set of processed processors, if processing has succeeded.
+     */
+    void processSingle(Processor* processor, std::set<Processor*>& processed);
+
+    /**
+     * Processes the passed mutually independent processors concurrently on worker threads.
+     * Only Processor::computeResults() is called on the worker threads, the results
+     * are published on the main thread by Processor::publishResults() afterwards.
+     * The available OpenMP threads are split among the processors, so that
+     * parallelized computations still use all of them.
+     */
+    void processConcurrently(const std::vector<Processor*>& processors, std::set<Processor*>& processed);
+
+    /**
+     * Prepares the inports of the passed processor for being processed on a worker thread:
+     * input volumes are made available in main memory, since representations must not be
+     * converted concurrently and conversions from OpenGL textures require the context.
+     */
+    void prepareConcurrentProcessing(Processor* processor);
+
+    /**
+     * Processes the processors in rendering order on the main thread.
+     *
+     * @return false, if processing has been aborted due to invalid ports
+     */
+    bool processSequential(std::set<Processor*>& processed);
+
+    /**
+     * Processes the processing stages one after another, processing
+     * the thread-safe processors of each stage concurrently.
+     *
+     * @return false, if processing has been aborted due to invalid ports
+     */
+    bool processStages(std::set<Processor*>& processed);
+
     /**
      * Creates and assigns the RenderTargets to the RenderPorts,
      * if render target sharing is enabled.
@@ -279,6 +335,10 @@ private:
      * by sorting netGraph_ topological. */
     std::vector<Processor*> renderingOrder_;
 
+    /** The processors of the rendering order grouped into stages, such that the processors of
+     * a stage only depend on processors of previous stages. Empty, if the network contains loops. */
+    std::vector< std::vector<Processor*> > processingStages_;
+
     /** Vector holding all processor wrappers which might have been added. */
     std::vector<ProcessWrapper*> processWrappers_;
 
@@ -305,6 +365,8 @@ private:
 
     bool processPending_;
 
+    bool parallelProcessing_;
+
     /// Used for performance profiling (experimental).
     PerformanceRecord performanceRecord_;
 };
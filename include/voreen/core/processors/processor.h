@@ -209,6 +209,16 @@ public:
     /// @todo more doc
     virtual bool isEndProcessor() const;
 
+    /**
+     * Returns true, if the processor may be processed concurrently to processors
+     * of independent network branches. Instead of process(), the NetworkEvaluator then calls
+     * computeResults() on a worker thread and publishResults() on the main thread afterwards.
+     * beforeProcess() and afterProcess() are still called on the main thread.
+     *
+     * The default implementation returns false.
+     */
+    virtual bool isThreadSafe() const;
+
     /**
      * @brief Returns the processor's data flow inports.
      * This does not include its co-processor inports.
@@ -362,6 +372,25 @@ protected:
      */
     virtual void process() = 0;
 
+    /**
+     * Computing part of process() for thread-safe processors (@see isThreadSafe),
+     * called on a worker thread. It may only read the inports and properties and must
+     * keep its results and messages in the processor: it must not use OpenGL, assign
+     * data to ports, log, or modify any state outside of the processor, since each of
+     * these may reach GUI elements.
+     *
+     * The default implementation does nothing.
+     */
+    virtual void computeResults();
+
+    /**
+     * Publishing part of process() for thread-safe processors, called on the main thread
+     * after computeResults(): assigns the results to the outports and logs the messages.
+     *
+     * The default implementation does nothing.
+     */
+    virtual void publishResults();
+
     /**
      * Initializes the processor, its properties and its processor widget.
      *
@@ -525,6 +554,9 @@ private:
      */
     void setName(const std::string& name);
 
+    /// Performs the actual invalidation, called by invalidate() while holding the invalidation lock.
+    void invalidateInternal(int inv);
+
     /**
      * Causes the processor to give up ownership of its GUI widget without deleting it.
      * This is called by the ProcessorWidget's destructor and prevents the processor
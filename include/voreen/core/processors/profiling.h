@@ -37,9 +37,10 @@
 #include <string>
 #include <vector>
 #include <stack>
-#include <time.h>
+#include <ostream>
 
 #include "voreen/core/voreencoredefine.h"
+#include "tgt/types.h"
 
 namespace voreen {
 
@@ -56,6 +57,14 @@ public:
     void setTime(float time);
     float getTime() const;
 
+    /// Start of the measurement in nanoseconds, @see ProfilingBlock::getTimestamp
+    void setStartTime(uint64_t startTime);
+    uint64_t getStartTime() const;
+
+    /// Index of the thread that recorded the sample.
+    void setThreadId(int threadId);
+    int getThreadId() const;
+
     std::string getName() const;
 
     float getChildTime(std::string) const;
@@ -78,6 +87,8 @@ protected:
     std::vector<PerformanceSample> children_;
     std::string name_;
     float time_;
+    uint64_t startTime_;
+    int threadId_;
     int measurements_;
 
     static const std::string loggerCat_;
@@ -87,19 +98,35 @@ class ProfilingBlock;
 
 /**
  * @brief Holds profiling info for an object.
+ *
+ * The history of top-level samples is kept in a ring buffer of fixed capacity,
+ * so that the oldest samples are discarded during long sessions.
+ * A record must only be used by one thread at a time.
  */
 class VRN_CORE_API PerformanceRecord {
     friend class ProfilingBlock;
 public:
-    PerformanceRecord();
+    PerformanceRecord(size_t capacity = 1024);
     ~PerformanceRecord();
 
+    /// Returns the samples in chronological order.
     const std::vector<PerformanceSample*> getSamples() const;
     PerformanceSample* getLastSample() const;
     void deleteSamples();
     void setName(std::string);
     std::string getName() const;
 
+    /// Sets the maximum number of top-level samples to keep. Older samples are deleted.
+    void setCapacity(size_t capacity);
+    size_t getCapacity() const;
+
+    /**
+     * Writes the samples of the given records in the Chrome trace event format
+     * (JSON), which can be loaded by chrome://tracing. Each record name is
+     * used as category and prefix of the event names.
+     */
+    static void writeChromeTrace(const std::vector<const PerformanceRecord*>& records, std::ostream& stream);
+
 protected:
     void startBlock(const ProfilingBlock* const pb);
     void endBlock(const ProfilingBlock* const pb);
@@ -107,8 +134,10 @@ protected:
     PerformanceSample* current_;
     std::string name_;
 
-    //history:
+    //history (ring buffer, samples_[firstSample_] is the oldest sample):
     std::vector<PerformanceSample*> samples_;
+    size_t firstSample_;
+    size_t capacity_;
 };
 
 /**
@@ -122,20 +151,21 @@ public:
     ~ProfilingBlock();
 
     float getTime() const;
+    uint64_t getStartTime() const;
     std::string getName() const;
+
+    /**
+     * Returns the current value of a monotonic wall clock in nanoseconds.
+     * Only differences between two values are meaningful.
+     */
+    static uint64_t getTimestamp();
+
 protected:
     std::string name_;
     PerformanceRecord& pr_;
 
-    clock_t start_;
-    clock_t end_;
-
-#ifdef _MSC_VER  // use high-performance counter on windows systems
-    bool useHpf_;
-    LARGE_INTEGER hpfTicksPerSecond_;
-    LARGE_INTEGER hpfStart_;
-    LARGE_INTEGER hpfEnd_;
-#endif
+    uint64_t start_;
+    uint64_t end_;
 
     //static const std::string loggerCat_;
 };
@@ -32,15 +32,36 @@
 #include "voreen/core/properties/link/linkevaluatorbase.h"
 #include "voreen/core/voreencoredefine.h"
 
+#include <typeinfo>
+
 namespace voreen {
 
+/**
+ * Assigns the value of the source property to the destination property.
+ *
+ * If both properties are of the same core property type, the value is assigned
+ * directly. Otherwise it is converted via Variant.
+ */
 class VRN_CORE_API LinkEvaluatorId : public LinkEvaluatorBase {
 public:
+    LinkEvaluatorId();
+
     void eval(Property* src, Property* dst) throw (VoreenException);
     std::string getClassName() const;
 
+    /// Selects the direct assignment for the property types.
+    void propertiesChanged(Property* src, Property* dst);
+
     bool arePropertiesLinkable(const Property* src, const Property* dst) const;
     LinkEvaluatorBase* create() const;
+
+private:
+    typedef void (*AssignFunction)(Property* src, Property* dst);
+
+    /// Returns the direct assignment for two properties of the given type, or null if there is none.
+    static AssignFunction getAssignFunction(const std::type_info& type);
+
+    AssignFunction assign_;
 };
 
 } // namespace
@@ -32,6 +32,7 @@
 #include "voreen/core/io/serialization/serialization.h"
 #include <vector>
 #include <map>
+#include <set>
 
 namespace voreen {
 
@@ -127,7 +128,7 @@ private:
     LinkEvaluatorBase* evaluator_;  ///< Evaluator responsible for actually executing the link.
 
     /// Used for cycle prevention during link execution.
-    static std::vector<Property*> visitedProperties_;
+    static std::set<Property*> visitedProperties_;
     /// Category used in logging
     static const std::string loggerCat_;
 };
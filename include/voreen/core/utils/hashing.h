@@ -29,17 +29,41 @@
 #ifndef VRN_HASHING_H
 #define VRN_HASHING_H
 
+#include "voreen/core/voreencoredefine.h"
+
 #include <string>
 
 namespace voreen {
 
-class VoreenHash {
+class VRN_CORE_API VoreenHash {
 public:
+    /// Hash functions supported by getHash(const void*, size_t, Algorithm).
+    enum Algorithm {
+        MD5,                ///< MD5 over the entire data, sequential
+        CHUNKED_MURMUR3     ///< MurmurHash3 (x64, 128 bit) tree hash over fixed-size chunks, parallel
+    };
+
+    /// Chunk size in bytes used by getChunkedHash() by default.
+    static const size_t DEFAULT_CHUNK_SIZE = 4 << 20;
+
     /// Compute md5 hash.
     static std::string getHash(const void* data, size_t size);
 
     /// Compute md5 hash.
     static std::string getHash(const std::string& s);
+
+    /// Compute hash with the specified algorithm. All algorithms return 32 hex digits (128 bit).
+    static std::string getHash(const void* data, size_t size, Algorithm algorithm);
+
+    /**
+     * Computes a fast, non-cryptographic 128 bit content hash suitable for large data.
+     *
+     * The data is split into chunks of chunkSize bytes, which are hashed in parallel
+     * (if OpenMP is available) by MurmurHash3. The result is the MurmurHash3 of the
+     * sequence of chunk hashes and the data size. It is independent of the number
+     * of threads, but depends on the chunk size.
+     */
+    static std::string getChunkedHash(const void* data, size_t size, size_t chunkSize = DEFAULT_CHUNK_SIZE);
 };
 
 }  // namespace voreen
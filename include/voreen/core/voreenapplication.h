@@ -384,6 +384,7 @@ protected:
 
     tgt::LogLevel logLevel_;
     std::string logFile_;
+    bool useMemoryMapping_; ///< cmdparser sets this, if volume files are to be mapped into memory
 
     bool initialized_;
     bool initializedGL_;
@@ -92,6 +92,7 @@ protected:
     QAction* clearTreeWhenRecordsUpdate_; // clear the tree when new updates are added
 
     QAction* resetPerformanceRecords_;  // reset performance records
+    QAction* exportTrace_;              // export performance records as Chrome trace
 
     LineEditResetWidget* edit_;
 
@@ -102,6 +103,7 @@ protected:
 protected slots:
     void sortMenu();
     void saveSettings();
+    void exportTrace();
 
 signals:
     void sort(int);
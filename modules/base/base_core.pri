@@ -119,6 +119,7 @@ SOURCES += \
     $${VRN_MODULE_DIR}/base/processors/volume/volumecurvature.cpp \
     $${VRN_MODULE_DIR}/base/processors/volume/volumedecomposer.cpp \
     $${VRN_MODULE_DIR}/base/processors/volume/volumedistancetransform.cpp \
+    $${VRN_MODULE_DIR}/base/processors/volume/volumeexpression.cpp \
     $${VRN_MODULE_DIR}/base/processors/volume/volumefiltering.cpp \
     $${VRN_MODULE_DIR}/base/processors/volume/volumeformatconversion.cpp \
     $${VRN_MODULE_DIR}/base/processors/volume/volumegradient.cpp \
@@ -151,7 +152,8 @@ SOURCES += \
     $${VRN_MODULE_DIR}/base/io/quadhidacvolumereader.cpp \
     $${VRN_MODULE_DIR}/base/io/synth2dreader.cpp \
     $${VRN_MODULE_DIR}/base/io/rawvoxvolumereader.cpp \
-    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.cpp  
+    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.cpp \
+    $${VRN_MODULE_DIR}/base/io/volumedatadecoder.cpp
 
 # 
 # Processor headers
@@ -270,6 +272,7 @@ HEADERS += \
     $${VRN_MODULE_DIR}/base/processors/volume/volumecurvature.h \
     $${VRN_MODULE_DIR}/base/processors/volume/volumedecomposer.h \
     $${VRN_MODULE_DIR}/base/processors/volume/volumedistancetransform.h \
+    $${VRN_MODULE_DIR}/base/processors/volume/volumeexpression.h \
     $${VRN_MODULE_DIR}/base/processors/volume/volumefiltering.h \
     $${VRN_MODULE_DIR}/base/processors/volume/volumeformatconversion.h \
     $${VRN_MODULE_DIR}/base/processors/volume/volumegradient.h \
@@ -302,7 +305,8 @@ HEADERS += \
     $${VRN_MODULE_DIR}/base/io/quadhidacvolumereader.h \
     $${VRN_MODULE_DIR}/base/io/synth2dreader.h \
     $${VRN_MODULE_DIR}/base/io/rawvoxvolumereader.h \
-    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.h 
+    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.h \
+    $${VRN_MODULE_DIR}/base/io/volumedatadecoder.h
     
 #
 # Processor shaders (only necessary for making them visible in Visual Studio)
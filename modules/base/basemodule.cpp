@@ -150,6 +150,7 @@
 #include "modules/base/processors/volume/volumecollectionsave.h"
 #include "modules/base/processors/volume/volumecrop.h"
 #include "modules/base/processors/volume/volumedistancetransform.h"
+#include "modules/base/processors/volume/volumeexpression.h"
 #include "modules/base/processors/volume/volumeinversion.h"
 #include "modules/base/processors/volume/volumecombine.h"
 #include "modules/base/processors/volume/volumecomposer.h"
@@ -323,6 +324,7 @@ BaseModule::BaseModule() : VoreenModule() {
     addProcessor(new VolumeCurvature());
     addProcessor(new VolumeDecomposer());
     addProcessor(new VolumeDistanceTransform());
+    addProcessor(new VolumeExpression());
     addProcessor(new VolumeFiltering());
     addProcessor(new VolumeFormatConversion());
     addProcessor(new VolumeGradient());
@@ -27,9 +27,11 @@
  **********************************************************************/
 
 #include "mhdvolumereader.h"
+#include "volumedatadecoder.h"
 
 #include <fstream>
 #include <iostream>
+#include <algorithm>
 
 #include "tgt/exception.h"
 #include "tgt/vector.h"
@@ -37,6 +39,7 @@
 #include "voreen/core/utils/stringconversion.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/diskrepresentation.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
 
 using tgt::vec3;
 using tgt::ivec3;
@@ -105,6 +108,10 @@ class MhdLineParser {
             return vec3(stof(data_[0]), stof(data_[1]), stof(data_[2]));
         }
 
+        const std::vector<string>& getData() const {
+            return data_;
+        }
+
     protected:
         string name_;
         string fileName_;
@@ -115,6 +122,7 @@ MhdVolumeReader::MhdVolumeReader(ProgressBar* progress)
     : VolumeReader(progress)
 {
     extensions_.push_back("mhd");
+    extensions_.push_back("mha");
 }
 
 VolumeCollection* MhdVolumeReader::read(const std::string &url)
@@ -132,6 +140,8 @@ VolumeCollection* MhdVolumeReader::read(const std::string &url)
     string voxelType = "";
     int numChannels = 1;
     int64_t headerSkip = 0;
+    bool compressed = false;
+    std::vector<string> dataFiles;
 
     tgt::File* file = FileSys.open(fileName);
     if ((!file) || (!file->isOpen())) {
@@ -166,14 +176,40 @@ VolumeCollection* MhdVolumeReader::read(const std::string &url)
                 voxelType = parsedLine.getDataString();
             }
             else if(parsedLine.getName() == "ElementDataFile") {
-                rawFilename = parsedLine.getDataString();
-
-                if(rawFilename == "LIST") 
-                    throw tgt::FileException("Slice-list mode not supported!");
-                if(rawFilename == "LOCAL") {
+                // ElementDataFile is the last field of the header
+                const std::vector<string>& data = parsedLine.getData();
+                if(data.empty())
+                    throw tgt::CorruptedFileException("Error parsing ElementDataFile: Expected arguments.", fileName);
+                rawFilename = data[0];
+
+                if(rawFilename == "LIST") {
+                    // one data file per line
+                    while(!file->eof()) {
+                        string dataFile = trim(strReplaceAll(file->getLine(), "\r", ""));
+                        if(!dataFile.empty())
+                            dataFiles.push_back(dataFile);
+                    }
+                }
+                else if(rawFilename == "LOCAL") {
+                    // the data follows the header in the same file
                     rawFilename = fileName;
-                    headerSkip = -1;
+                    headerSkip = (compressed ? static_cast<int64_t>(file->tell()) : -1);
+                }
+                else if(data.size() >= 4) {
+                    // printf pattern with first index, last index and step, at most one file per slice
+                    dataFiles = VolumeDataDecoder::expandFilePattern(rawFilename, stoi(data[1]), stoi(data[2]), stoi(data[3]),
+                        static_cast<size_t>(std::max(dimensions.z, 1)));
                 }
+                else {
+                    parsedLine.checkNumData(1);
+                }
+                break;
+            }
+            else if(parsedLine.getName() == "CompressedData") {
+                compressed = parsedLine.getDataBool();
+            }
+            else if(parsedLine.getName() == "CompressedDataSize") {
+                // not required, the data is inflated until the volume is filled
             }
             else if(parsedLine.getName() == "ElementByteOrderMSB") {
                 if(parsedLine.getDataBool())
@@ -245,11 +281,46 @@ VolumeCollection* MhdVolumeReader::read(const std::string &url)
 
     VolumeRepresentation* volume;
     string directory = tgt::FileSystem::dirName(fileName);
-    string fullRawFilename = directory+"/"+rawFilename;
-    if(!FileSys.fileExists(fullRawFilename))
-        throw tgt::FileException("Raw file '" + fullRawFilename + "' does not exist!");
 
-    volume = (Volume*) new DiskRepresentation(fullRawFilename , voreenVoxelType, dimensions, headerSkip);
+    if(compressed || !dataFiles.empty()) {
+        // decode compressed or split data directly into the volume
+        VolumeDataDecoder::Encoding encoding = (compressed ? VolumeDataDecoder::ENCODING_GZIP : VolumeDataDecoder::ENCODING_RAW);
+        if(!VolumeDataDecoder::isSupported(encoding))
+            throw tgt::FileException("Compressed data requires the zip module.", fileName);
+
+        VolumeFactory factory;
+        Volume* decoded = factory.create(voreenVoxelType, tgt::svec3(dimensions));
+        if(!decoded)
+            throw tgt::CorruptedFileException("Failed to create volume of type " + voreenVoxelType, fileName);
+
+        try {
+            if(dataFiles.empty()) {
+                string dataFile = (rawFilename == fileName ? fileName : directory+"/"+rawFilename);
+                VolumeDataDecoder::decode(dataFile, std::max<int64_t>(headerSkip, 0), encoding, 0,
+                                          static_cast<char*>(decoded->getData()), decoded->getNumBytes());
+            }
+            else {
+                for(size_t i=0; i<dataFiles.size(); i++)
+                    dataFiles[i] = directory+"/"+dataFiles[i];
+                if(decoded->getNumBytes() % dataFiles.size() != 0)
+                    throw tgt::CorruptedFileException("Data size is not divisible by the number of data files.", fileName);
+                VolumeDataDecoder::decode(dataFiles, encoding, decoded->getNumBytes() / dataFiles.size(), 0,
+                                          static_cast<char*>(decoded->getData()), decoded->getNumBytes());
+            }
+        }
+        catch(...) {
+            delete decoded;
+            throw;
+        }
+        volume = decoded;
+    }
+    else {
+        string fullRawFilename = (rawFilename == fileName ? fileName : directory+"/"+rawFilename);
+        if(!FileSys.fileExists(fullRawFilename))
+            throw tgt::FileException("Raw file '" + fullRawFilename + "' does not exist!");
+
+        volume = (Volume*) new DiskRepresentation(fullRawFilename , voreenVoxelType, dimensions, headerSkip);
+    }
 
     VolumeHandle* vh = new VolumeHandle(volume, spacing, offset);
     vh->setOrigin(origin);
@@ -28,11 +28,13 @@
 
 #include "mhdvolumewriter.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/mappedvolume.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
 
 #include "tgt/filesystem.h"
 #include "tgt/matrix.h"
 #include <iomanip>
+#include <memory>
 
 namespace voreen {
 
@@ -56,6 +58,11 @@ void MhdVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
     std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
     LINFO("saving " << mhdname << " and " << rawname);
 
+    // a volume mapped from the raw file would lose its data when the file is truncated
+    std::auto_ptr<Volume> volumeCopy(MappedVolumeBase::copyIfMappedFrom(volume, rawname));
+    if (volumeCopy.get())
+        volume = volumeCopy.get();
+
     std::fstream mhdout(mhdname.c_str(), std::ios::out);
     std::fstream rawout(rawname.c_str(), std::ios::out | std::ios::binary);
 
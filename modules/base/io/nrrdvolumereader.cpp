@@ -27,9 +27,11 @@
  **********************************************************************/
 
 #include "nrrdvolumereader.h"
+#include "volumedatadecoder.h"
 
 #include <fstream>
 #include <iostream>
+#include <algorithm>
 
 #include "tgt/exception.h"
 #include "tgt/vector.h"
@@ -38,10 +40,31 @@
 #include "voreen/core/io/textfilereader.h"
 #include "voreen/core/io/rawvolumereader.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorswapendianness.h"
 
 using tgt::vec3;
 using tgt::ivec3;
 
+namespace {
+
+// returns the path of a data file relative to the header file
+std::string resolveDataFile(const std::string& dataFile, const std::string& headerFile) {
+    if ((dataFile.substr(0,1) != "/")  && (dataFile.substr(0,1) != "\\") &&
+        (dataFile.substr(1,2) != ":/") && (dataFile.substr(1,2) != ":\\"))
+    {
+        size_t p = headerFile.find_last_of("\\");
+        if (p == std::string::npos)
+            p = headerFile.find_last_of("/");
+
+        // construct path relative to nhdr file
+        return headerFile.substr(0, p + 1) + dataFile;
+    }
+    return dataFile;
+}
+
+} // namespace
+
 namespace voreen {
 
 const std::string NrrdVolumeReader::loggerCat_ = "voreen.base.NrrdVolumeReader";
@@ -91,7 +114,7 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
     std::string fileName = origin.getPath();
 
     std::string objectFilename = "";
-    ivec3 resolution;
+    ivec3 resolution(0);
     vec3 sliceThickness(1.f);
     std::string format;
     std::string model;
@@ -105,14 +128,37 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
     vec3 dirY(0.f, 1.f, 0.f);
     vec3 dirZ(0.f, 0.f, 1.f);
 
+    // data file settings
+    VolumeDataDecoder::Encoding encoding = VolumeDataDecoder::ENCODING_RAW;
+    bool bigEndian = false;
+    int byteSkip = 0;
+    std::vector<std::string> dataFiles;
+    bool dataFileList = false;
+    bool dataFilePattern = false;
+    int patternFirst = 0, patternLast = 0, patternStep = 0;
+
     LINFO("NrrdVolumeReader: " << fileName);
-    TextFileReader reader(fileName);
-    reader.setSeparators(":\t\n\r");
-    if (!reader) {
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file) {
         LERROR("Unable to open " << fileName);
         return 0;
     }
 
+    // The header ends with an empty line, if the data is attached to it
+    std::string header;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line == "\r")
+            break;
+        header += line + "\n";
+    }
+    int64_t dataOffset = file.eof() ? -1 : static_cast<int64_t>(file.tellg());
+    file.close();
+
+    std::istringstream headerStream(header);
+    TextFileReader reader(&headerStream);
+    reader.setSeparators(":\t\n\r");
+
     std::string type;
     std::istringstream args;
     int bits = 0;
@@ -130,6 +176,40 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
         if (type == "datafile" || type == "data file") {
             args >> objectFilename;
             LINFO("Value: " << objectFilename);
+            if (objectFilename == "LIST") {
+                // the remaining lines of the header are the data files
+                dataFileList = true;
+                break;
+            }
+            // "<format> <min> <max> <step> [<subdim>]" describes multiple data files,
+            // which are expanded once the sizes are known
+            if (args >> patternFirst >> patternLast >> patternStep) {
+                dataFilePattern = true;
+            }
+            else {
+                dataFiles.push_back(objectFilename);
+                args.clear();
+            }
+        } else if (type == "encoding") {
+            std::string value;
+            args >> value;
+            LINFO("Value: " << value);
+            if (value == "raw")
+                encoding = VolumeDataDecoder::ENCODING_RAW;
+            else if (value == "gzip" || value == "gz")
+                encoding = VolumeDataDecoder::ENCODING_GZIP;
+            else if (value == "bzip2" || value == "bz2")
+                encoding = VolumeDataDecoder::ENCODING_BZIP2;
+            else {
+                LERROR("Unsupported encoding: " << value);
+                error = true;
+            }
+        } else if (type == "endian") {
+            std::string value;
+            args >> value;
+            bigEndian = (value == "big");
+        } else if (type == "byte skip" || type == "byteskip") {
+            args >> byteSkip;
         } else if (type == "dimension") {
             args >> dimension;
             LINFO("Value: " << dimension);
@@ -200,54 +280,121 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
         } else {
             LWARNING("Unknown type: " << type);
         }
-        //... "encoding:" and other value-types should be added
         if (args.fail()) {
             LERROR("Format error");
             error = true;
         }
     }
 
-    if (!error) {
-        RawVolumeReader rawReader(getProgressBar());
-        RawVolumeReader::ReadHints h(resolution, sliceThickness, bits, model, format);
-        
-        // TODO:  does not work as expected - fix
-        //        handle space orientation (RAS/LPS/etc.) as well
-        // calculate voxel to world matrix as described in 
-        // http://www.na-mic.org/Wiki/index.php/NAMIC_Wiki:DTI:Nrrd_format
-        /*h.transformation_ = tgt::mat4(dirX.x, dirY.x, dirZ.x, spaceOrigin.x,
-                                      dirX.y, dirY.y, dirZ.y, spaceOrigin.y,
-                                      dirX.z, dirY.z, dirZ.z, spaceOrigin.z,
-                                      0.f   , 0.f   , 0.f   , 1.f          );*/
-
-        // do we have a relative path?
-        if ((objectFilename.substr(0,1) != "/")  && (objectFilename.substr(0,1) != "\\") &&
-            (objectFilename.substr(1,2) != ":/") && (objectFilename.substr(1,2) != ":\\"))
-        {
-            size_t p = fileName.find_last_of("\\");
-            if (p == std::string::npos)
-                p = fileName.find_last_of("/");
-
-            // construct path relative to dat file
-            objectFilename = fileName.substr(0, p + 1) + objectFilename;
+    if (dataFilePattern) {
+        // there cannot be more data files than slices
+        size_t maxFiles = static_cast<size_t>(std::max(resolution.z, 1)) * static_cast<size_t>(std::max(numFrames, 1));
+        dataFiles = VolumeDataDecoder::expandFilePattern(objectFilename, patternFirst, patternLast, patternStep, maxFiles);
+    }
+
+    if (dataFileList) {
+        std::string dataFile;
+        while (reader.getNextLinePlain(dataFile, false)) {
+            dataFile = trim(dataFile);
+            if (!dataFile.empty())
+                dataFiles.push_back(dataFile);
         }
+    }
 
-        int start = 0;
-        int end = numFrames;
-        if (timeframe != -1) {
-            if (timeframe >= numFrames)
-                throw tgt::FileException("Specified time frame not in volume", fileName);
+    // data attached to the header
+    if (dataFiles.empty()) {
+        if (dataOffset < 0) {
+            LERROR("No data file specified and no data attached");
+            error = true;
+        }
+        dataFiles.push_back(fileName);
+    }
+    else {
+        dataOffset = 0;
+        for (size_t i = 0; i < dataFiles.size(); ++i)
+            dataFiles[i] = resolveDataFile(dataFiles[i], fileName);
+    }
+
+    if (byteSkip < 0 && (encoding != VolumeDataDecoder::ENCODING_RAW || dataFiles.size() > 1)) {
+        LERROR("Byte skip -1 is only supported for a single raw data file");
+        error = true;
+    }
+    if (!error && !VolumeDataDecoder::isSupported(encoding)) {
+        LERROR("Encoding not supported by this build (zip module required for gzip, bzip2 is not supported)");
+        error = true;
+    }
 
-            start = timeframe;
-            end = timeframe+1;
+    if (error)
+        return 0;
+
+    int start = 0;
+    int end = numFrames;
+    if (timeframe != -1) {
+        if (timeframe >= numFrames)
+            throw tgt::FileException("Specified time frame not in volume", fileName);
+
+        start = timeframe;
+        end = timeframe+1;
+    }
+
+    // TODO:  does not work as expected - fix
+    //        handle space orientation (RAS/LPS/etc.) as well
+    // calculate voxel to world matrix as described in
+    // http://www.na-mic.org/Wiki/index.php/NAMIC_Wiki:DTI:Nrrd_format
+    /*h.transformation_ = tgt::mat4(dirX.x, dirY.x, dirZ.x, spaceOrigin.x,
+                                  dirX.y, dirY.y, dirZ.y, spaceOrigin.y,
+                                  dirX.z, dirY.z, dirZ.z, spaceOrigin.z,
+                                  0.f   , 0.f   , 0.f   , 1.f          );*/
+
+    std::string volumeType;
+    size_t voxelBytes = 0;
+    if (model == "I" && format == "UCHAR") {
+        volumeType = "uint8";
+        voxelBytes = 1;
+    }
+    else if (model == "I" && format == "USHORT") {
+        volumeType = "uint16";
+        voxelBytes = 2;
+    }
+    else if (model == "I" && format == "SHORT") {
+        volumeType = "int16";
+        voxelBytes = 2;
+    }
+    else if (model == "I" && format == "FLOAT") {
+        volumeType = "float";
+        voxelBytes = 4;
+    }
+    else if (model == "RGBA" && format == "UCHAR") {
+        volumeType = "Vector4(uint8)";
+        voxelBytes = 4;
+    }
+
+    VolumeCollection* toReturn = new VolumeCollection();
+
+    if (encoding == VolumeDataDecoder::ENCODING_RAW && dataFiles.size() == 1) {
+        // uncompressed data in a single file
+        size_t headerSkip = static_cast<size_t>(dataOffset + std::max(byteSkip, 0));
+        if (byteSkip < 0) {
+            // the data is located at the end of the file
+            std::ifstream dataFile(dataFiles.front().c_str(), std::ios::in | std::ios::binary);
+            dataFile.seekg(0, std::ios::end);
+            size_t dataBytes = voxelBytes * tgt::hmul(tgt::svec3(resolution)) * numFrames;
+            size_t fileBytes = static_cast<size_t>(dataFile.tellg());
+            if (!dataFile || voxelBytes == 0 || fileBytes < dataBytes) {
+                delete toReturn;
+                throw tgt::CorruptedFileException("Unable to determine data position for byte skip -1", dataFiles.front());
+            }
+            headerSkip = fileBytes - dataBytes;
         }
 
-        VolumeCollection* toReturn = new VolumeCollection();
+        RawVolumeReader rawReader(getProgressBar());
+        RawVolumeReader::ReadHints h(resolution, sliceThickness, bits, model, format, 0, headerSkip, bigEndian);
+
         for (int frame = start; frame < end; ++frame) {
             h.timeframe_ = frame;
             rawReader.setReadHints(h);
 
-            VolumeCollection* collection = rawReader.read(objectFilename);
+            VolumeCollection* collection = rawReader.read(dataFiles.front());
             if (!collection->empty()) {
                 VolumeOrigin origin(fileName);
                 origin.addSearchParameter("timeframe", itos(frame));
@@ -260,9 +407,56 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
             delete collection;
         }
         return toReturn;
+    }
 
-    } else
-        return 0;
+    // compressed or split data is decoded directly into the volume
+    if (volumeType.empty()) {
+        delete toReturn;
+        throw tgt::UnsupportedFormatException(format, fileName);
+    }
+
+    VolumeFactory factory;
+    for (int frame = start; frame < end; ++frame) {
+        Volume* volume = factory.create(volumeType, tgt::svec3(resolution));
+        if (!volume) {
+            delete toReturn;
+            throw tgt::CorruptedFileException("Failed to create volume", fileName);
+        }
+        const size_t frameBytes = volume->getNumBytes();
+
+        try {
+            if (dataFiles.size() == 1) {
+                VolumeDataDecoder::decode(dataFiles.front(), dataOffset, encoding, byteSkip + frame * frameBytes,
+                                          static_cast<char*>(volume->getData()), frameBytes);
+            }
+            else {
+                if ((frameBytes * numFrames) % dataFiles.size() != 0)
+                    throw tgt::CorruptedFileException("Data size is not divisible by the number of data files", fileName);
+                if (byteSkip > 0)
+                    LWARNING("Byte skip is ignored for multiple data files");
+                VolumeDataDecoder::decode(dataFiles, encoding, frameBytes * numFrames / dataFiles.size(),
+                                          frame * frameBytes, static_cast<char*>(volume->getData()), frameBytes);
+            }
+        }
+        catch (...) {
+            delete volume;
+            delete toReturn;
+            throw;
+        }
+
+        VolumeHandle* vh = new VolumeHandle(volume, sliceThickness, vec3(0.f));
+        if (bigEndian)
+            VolumeOperatorSwapEndianness::APPLY_OP(vh);
+
+        VolumeOrigin origin(fileName);
+        origin.addSearchParameter("timeframe", itos(frame));
+        vh->setOrigin(origin);
+        vh->setTimestep(static_cast<float>(frame));
+        oldVolumePosition(vh);
+        toReturn->add(vh);
+    }
+
+    return toReturn;
 }
 
 VolumeReader* NrrdVolumeReader::create(ProgressBar* progress) const {
@@ -28,9 +28,12 @@
 
 #include "nrrdvolumewriter.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/mappedvolume.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
 #include "tgt/filesystem.h"
 
+#include <memory>
+
 namespace voreen {
 
 const std::string NrrdVolumeWriter::loggerCat_ = "voreen.base.NrrdVolumeWriter";
@@ -55,6 +58,11 @@ void NrrdVolumeWriter::write(const std::string& filename, const VolumeHandleBase
     std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
     LINFO("saving " << nhdrname << " and " << rawname);
 
+    // a volume mapped from the raw file would lose its data when the file is truncated
+    std::auto_ptr<Volume> volumeCopy(MappedVolumeBase::copyIfMappedFrom(volume, rawname));
+    if (volumeCopy.get())
+        volume = volumeCopy.get();
+
     std::fstream nhdrout(nhdrname.c_str(), std::ios::out);
     std::fstream rawout(rawname.c_str(), std::ios::out | std::ios::binary);
 
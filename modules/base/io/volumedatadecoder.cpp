@@ -0,0 +1,264 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "volumedatadecoder.h"
+
+#include "tgt/logmanager.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#ifdef VRN_MODULE_ZIP
+#include <zlib.h>
+#endif
+
+namespace voreen {
+
+const std::string VolumeDataDecoder::loggerCat_ = "voreen.base.VolumeDataDecoder";
+
+namespace {
+
+const size_t CHUNK_SIZE = 1 << 18;
+
+bool seekFile(FILE* file, int64_t offset) {
+#ifdef _MSC_VER
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+/// Closes the file when leaving the scope.
+class FileCloser {
+public:
+    FileCloser(FILE* file) : file_(file) {}
+    ~FileCloser() { fclose(file_); }
+private:
+    FILE* file_;
+};
+
+void decodeRaw(FILE* file, const std::string& filename, int64_t offset, size_t skip, char* buffer, size_t numBytes)
+    throw (tgt::FileException)
+{
+    if (!seekFile(file, offset + static_cast<int64_t>(skip)))
+        throw tgt::CorruptedFileException("Data offset beyond end of file", filename);
+    if (fread(buffer, 1, numBytes, file) != numBytes)
+        throw tgt::CorruptedFileException("Unexpected end of data", filename);
+}
+
+#ifdef VRN_MODULE_ZIP
+void decodeGzip(FILE* file, const std::string& filename, int64_t offset, size_t skip, char* buffer, size_t numBytes)
+    throw (tgt::FileException)
+{
+    if (!seekFile(file, offset))
+        throw tgt::CorruptedFileException("Data offset beyond end of file", filename);
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+    // 15 window bits + 32: detect gzip or zlib header
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+        throw tgt::CorruptedFileException("Failed to initialize zlib", filename);
+
+    std::vector<Bytef> input(CHUNK_SIZE);
+    std::vector<Bytef> discard(skip > 0 ? std::min(skip, CHUNK_SIZE) : 0);
+    size_t written = 0;
+    std::string error;
+
+    // the skipped bytes are inflated into a scratch buffer, the rest directly into the output buffer
+    while (written < skip + numBytes && error.empty()) {
+        if (stream.avail_in == 0) {
+            stream.avail_in = static_cast<uInt>(fread(&input[0], 1, input.size(), file));
+            stream.next_in = &input[0];
+            if (stream.avail_in == 0) {
+                error = "Unexpected end of compressed data";
+                break;
+            }
+        }
+
+        size_t available;
+        if (written < skip) {
+            available = std::min(skip - written, discard.size());
+            stream.next_out = &discard[0];
+        }
+        else {
+            available = std::min(skip + numBytes - written, static_cast<size_t>(1) << 30);
+            stream.next_out = reinterpret_cast<Bytef*>(buffer + (written - skip));
+        }
+        stream.avail_out = static_cast<uInt>(available);
+
+        int result = inflate(&stream, Z_NO_FLUSH);
+        written += available - stream.avail_out;
+
+        if (result == Z_STREAM_END) {
+            // gzip files may consist of several members
+            if (written < skip + numBytes && inflateReset(&stream) != Z_OK)
+                error = "Failed to reset zlib";
+        }
+        else if (result != Z_OK && result != Z_BUF_ERROR) {
+            error = std::string("Corrupted compressed data") + (stream.msg ? std::string(": ") + stream.msg : "");
+        }
+    }
+
+    inflateEnd(&stream);
+    if (!error.empty())
+        throw tgt::CorruptedFileException(error, filename);
+}
+#endif
+
+} // namespace
+
+bool VolumeDataDecoder::isSupported(Encoding encoding) {
+    switch (encoding) {
+        case ENCODING_RAW:
+            return true;
+        case ENCODING_GZIP:
+#ifdef VRN_MODULE_ZIP
+            return true;
+#else
+            return false;
+#endif
+        default:
+            // there is no bzip2 library among the external dependencies
+            return false;
+    }
+}
+
+void VolumeDataDecoder::decode(const std::string& filename, int64_t offset, Encoding encoding,
+                               size_t skip, char* buffer, size_t numBytes)
+    throw (tgt::FileException)
+{
+    if (!isSupported(encoding))
+        throw tgt::FileException(std::string("Unsupported data encoding: ")
+                                 + (encoding == ENCODING_GZIP ? "gzip (zip module disabled)" : "bzip2"), filename);
+
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (!file)
+        throw tgt::IOException("Unable to open data file", filename);
+    FileCloser closer(file);
+
+    if (encoding == ENCODING_RAW)
+        decodeRaw(file, filename, offset, skip, buffer, numBytes);
+#ifdef VRN_MODULE_ZIP
+    else
+        decodeGzip(file, filename, offset, skip, buffer, numBytes);
+#endif
+}
+
+void VolumeDataDecoder::decode(const std::vector<std::string>& filenames, Encoding encoding, size_t bytesPerFile,
+                               size_t begin, char* buffer, size_t numBytes)
+    throw (tgt::FileException)
+{
+    if (bytesPerFile == 0 || filenames.empty())
+        throw tgt::CorruptedFileException("No data files");
+    if (begin + numBytes > bytesPerFile * filenames.size())
+        throw tgt::CorruptedFileException("Data files too small", filenames.front());
+
+    const int firstFile = static_cast<int>(begin / bytesPerFile);
+    const int lastFile = static_cast<int>((begin + numBytes - 1) / bytesPerFile);
+
+    // exceptions must not leave the parallel region, so the message of the first error is rethrown afterwards
+    std::string error;
+    std::string errorFile;
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = firstFile; i <= lastFile; i++) {
+        size_t fileBegin = static_cast<size_t>(i) * bytesPerFile;
+        size_t rangeBegin = std::max(begin, fileBegin);
+        size_t rangeEnd = std::min(begin + numBytes, fileBegin + bytesPerFile);
+        try {
+            decode(filenames[i], 0, encoding, rangeBegin - fileBegin, buffer + (rangeBegin - begin), rangeEnd - rangeBegin);
+        }
+        catch (tgt::FileException& e) {
+            #pragma omp critical(VolumeDataDecoderError)
+            if (error.empty()) {
+                error = e.what();
+                errorFile = filenames[i];
+            }
+        }
+    }
+
+    if (!error.empty())
+        throw tgt::FileException(error, errorFile);
+}
+
+std::vector<std::string> VolumeDataDecoder::expandFilePattern(const std::string& pattern, int first, int last, int step,
+                                                              size_t maxFiles)
+    throw (tgt::CorruptedFileException)
+{
+    // the pattern is taken from the file header and used as format string,
+    // so it must not contain anything but a single integer conversion
+    int numConversions = 0;
+    int width = 0;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        if (pattern[i] != '%')
+            continue;
+        i++;
+        if (i < pattern.size() && pattern[i] == '%')
+            continue;
+
+        while (i < pattern.size() && pattern[i] != '\0' && strchr("-+ #0", pattern[i]))
+            i++;
+        size_t widthBegin = i;
+        while (i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9')
+            i++;
+        if (i - widthBegin > 2)
+            throw tgt::CorruptedFileException("Data file pattern with too large field width: " + pattern);
+        if (i > widthBegin)
+            width = atoi(pattern.substr(widthBegin, i - widthBegin).c_str());
+        if (i >= pattern.size() || pattern[i] == '\0' || !strchr("diu", pattern[i]))
+            throw tgt::CorruptedFileException("Unsupported conversion in data file pattern: " + pattern);
+        numConversions++;
+    }
+    if (numConversions != 1)
+        throw tgt::CorruptedFileException("Data file pattern must contain exactly one integer conversion: " + pattern);
+
+    std::vector<std::string> filenames;
+    if (step == 0 || (step > 0 ? first > last : first < last))
+        return filenames;
+
+    // computed in 64 bit, so that neither the count nor the loop index overflow
+    int64_t count = (static_cast<int64_t>(last) - first) / step + 1;
+    if (count > static_cast<int64_t>(maxFiles))
+        throw tgt::CorruptedFileException("Data file pattern describes more files than the volume has slices: " + pattern);
+
+    std::vector<char> name(pattern.size() + width + 32);
+    for (int64_t n = 0; n < count; n++) {
+        int i = static_cast<int>(first + n * step);
+        snprintf(&name[0], name.size(), pattern.c_str(), i);
+        filenames.push_back(std::string(&name[0]));
+    }
+    return filenames;
+}
+
+} // namespace voreen
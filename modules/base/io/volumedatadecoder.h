@@ -0,0 +1,110 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMEDATADECODER_H
+#define VRN_VOLUMEDATADECODER_H
+
+#include "tgt/exception.h"
+#include "tgt/types.h"
+
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+/**
+ * Decodes raw or compressed voxel data from one or more data files directly
+ * into a volume buffer, without intermediate files.
+ *
+ * Compressed data is inflated with zlib (gzip and zlib streams are detected
+ * automatically), if the zip module is enabled. Data split into several
+ * detached files is decoded in parallel.
+ */
+class VolumeDataDecoder {
+public:
+    enum Encoding {
+        ENCODING_RAW,
+        ENCODING_GZIP,
+        ENCODING_BZIP2
+    };
+
+    /// Returns whether data with the given encoding can be decoded in this build.
+    static bool isSupported(Encoding encoding);
+
+    /**
+     * Decodes @p numBytes bytes from the data file into the buffer.
+     *
+     * @param filename the data file
+     * @param offset position in the file at which the encoded data starts
+     * @param encoding encoding of the data
+     * @param skip number of decoded bytes to discard before the buffer is filled
+     * @param buffer the output buffer, at least @p numBytes large
+     * @param numBytes the number of decoded bytes to read
+     *
+     * @throws tgt::IOException if the file cannot be read
+     * @throws tgt::CorruptedFileException if the data cannot be decoded or is too short
+     */
+    static void decode(const std::string& filename, int64_t offset, Encoding encoding,
+                       size_t skip, char* buffer, size_t numBytes)
+        throw (tgt::FileException);
+
+    /**
+     * Decodes a range of the data that is split evenly into the given files.
+     * The files are decoded in parallel.
+     *
+     * @param filenames the data files in order, each containing @p bytesPerFile decoded bytes
+     * @param begin position in the concatenated decoded data at which the range starts
+     * @param buffer the output buffer, at least @p numBytes large
+     * @param numBytes the size of the range
+     */
+    static void decode(const std::vector<std::string>& filenames, Encoding encoding, size_t bytesPerFile,
+                       size_t begin, char* buffer, size_t numBytes)
+        throw (tgt::FileException);
+
+    /**
+     * Expands a data file pattern of the form used by NRRD and MetaImage headers:
+     * a printf format with a single integer, which runs from @p first to @p last
+     * (inclusive) in steps of @p step.
+     *
+     * @param maxFiles maximum number of files, i.e. the number of slices and time steps of the volume
+     *
+     * @throw tgt::CorruptedFileException if the pattern contains any conversion other than a single
+     *  integer conversion (%d, %i or %u with optional flags and width) and %%, or if it expands
+     *  to more than @p maxFiles files
+     */
+    static std::vector<std::string> expandFilePattern(const std::string& pattern, int first, int last, int step,
+                                                      size_t maxFiles)
+        throw (tgt::CorruptedFileException);
+
+private:
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_VOLUMEDATADECODER_H
@@ -32,6 +32,7 @@
 #include "voreen/core/datastructures/geometry/meshlistgeometry.h"
 #include "voreen/core/datastructures/geometry/pointlistgeometry.h"
 #include "voreen/core/datastructures/geometry/pointsegmentlistgeometry.h"
+#include "voreen/core/io/binarygeometryfile.h"
 
 #include "voreen/core/properties/callmemberaction.h"
 
@@ -55,7 +56,7 @@ GeometrySource::GeometrySource()
 {
     geometryType_.addOption("pointlist", "Pointlist");
     geometryType_.addOption("segmentlist", "Segmented Pointlist");
-    geometryType_.addOption("geometry", "Voreen geometry file (.vge)");
+    geometryType_.addOption("geometry", "Voreen geometry file (.vge, .vgb)");
 
     geometryFile_.onChange(CallMemberAction<GeometrySource>(this, &GeometrySource::readGeometry));
     geometryType_.onChange(CallMemberAction<GeometrySource>(this, &GeometrySource::readGeometry));
@@ -89,6 +90,16 @@ void GeometrySource::initialize() throw (tgt::Exception) {
 void GeometrySource::readGeometry() {
     if (geometryType_.get() == "pointlist" || geometryType_.get() == "segmentlist")
         readPointList();
+    else if (BinaryGeometryFile::isBinaryGeometryFile(geometryFile_.get())) {
+        LINFO("Reading binary geometry file " << geometryFile_.get());
+        try {
+            outport_.setData(BinaryGeometryFile::readGeometry(geometryFile_.get()));
+        }
+        catch (tgt::FileException& e) {
+            LERROR("Failed to read binary geometry file: " << e.what());
+            outport_.setData(0);
+        }
+    }
     else {
         // read Voreen geometry serialization (.vge)
         LINFO("Reading geometry file " << geometryFile_.get());
@@ -99,7 +110,7 @@ void GeometrySource::readGeometry() {
             LERROR("failed to read file " << geometryFile_.get());
         }
         else {
-            XmlDeserializer xmlDeserializer;
+            XmlDeserializer xmlDeserializer(geometryFile_.get());
             try {
                 xmlDeserializer.read(stream);
                 Geometry* geometry = 0;
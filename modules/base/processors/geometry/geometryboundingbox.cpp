@@ -30,6 +30,7 @@
 
 #include "voreen/core/datastructures/geometry/meshgeometry.h"
 #include "voreen/core/datastructures/geometry/meshlistgeometry.h"
+#include "voreen/core/datastructures/geometry/indexedmeshgeometry.h"
 
 using std::min;
 using std::max;
@@ -52,15 +53,19 @@ void GeometryBoundingBox::process() {
 
     const Geometry* geom = inport_.getData();
     const MeshListGeometry* meshGeom = dynamic_cast<const MeshListGeometry*>(geom);
+    const IndexedMeshGeometry* indexedMeshGeom = dynamic_cast<const IndexedMeshGeometry*>(geom);
 
-    if (meshGeom) {
-        meshGeom->getBoundingBox(llf, urb);
+    if (meshGeom || indexedMeshGeom) {
+        if (meshGeom)
+            meshGeom->getBoundingBox(llf, urb);
+        else
+            indexedMeshGeom->getBoundingBox(llf, urb);
         const MeshGeometry& mesh = MeshGeometry::createCube(llf, urb);
 
         outport_.setData(new MeshGeometry(mesh));
     }
     else {
-        LERRORC("GeometryBoundingBox", "Only MeshListGeometries are supported in this processor");
+        LERRORC("GeometryBoundingBox", "Only MeshListGeometries and IndexedMeshGeometries are supported in this processor");
     }
 
 }
@@ -28,19 +28,26 @@
 
 #include "geometrysave.h"
 
+#include "voreen/core/io/binarygeometryfile.h"
+
+#include "tgt/filesystem.h"
+
 namespace voreen {
 
 const std::string GeometrySave::loggerCat_("voreen.GeometrySave");
 
 GeometrySave::GeometrySave()
     : Processor()
-    , fileProp_("file", "Geometry file", "Save .vge file", "./", "Voreen geometry files (*.vge)", FileDialogProperty::SAVE_FILE)
+    , fileProp_("file", "Geometry file", "Save geometry file", "./",
+        "Voreen geometry files (*.vge);;Binary Voreen geometry files (*.vgb)", FileDialogProperty::SAVE_FILE)
+    , compress_("compress", "Compress binary file", false)
     , saveButton_("save", "Save")
     , inport_(Port::INPORT, "inport")
 {
     saveButton_.onChange(CallMemberAction<GeometrySave>(this, &GeometrySave::saveFile));
 
     addProperty(fileProp_);
+    addProperty(compress_);
     addProperty(saveButton_);
 
     addPort(inport_);
@@ -49,13 +56,36 @@ GeometrySave::GeometrySave()
 void GeometrySave::process() {}
 
 void GeometrySave::saveFile() {
-    XmlSerializer s;
     const Geometry* geometry = inport_.getData();
+    if (!geometry) {
+        LWARNING("No geometry to save");
+        return;
+    }
+
+    if (tgt::FileSystem::fileExtension(fileProp_.get(), true) == BinaryGeometryFile::FILE_EXTENSION) {
+        try {
+            BinaryGeometryFile::writeGeometry(geometry, fileProp_.get(), compress_.get());
+        }
+        catch (tgt::FileException& e) {
+            LERROR("Failed to save binary geometry file: " << e.what());
+        }
+        return;
+    }
+
+    // large geometries are written to a binary file referenced by the document
+    XmlSerializer s(fileProp_.get());
     s.serialize("Geometry", geometry);
 
     std::fstream stream(fileProp_.get().c_str(), std::ios::out);
     s.write(stream);
+    if (stream.fail()) {
+        LERROR("Failed to write geometry file: " << fileProp_.get());
+        return;
+    }
     stream.close();
+
+    // binary files written by earlier saves of this document are no longer referenced
+    Geometry::removeUnreferencedBinaryFiles(s);
 }
 
 } // namespace voreen
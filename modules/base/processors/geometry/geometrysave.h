@@ -32,6 +32,7 @@
 #include "voreen/core/processors/processor.h"
 
 #include "voreen/core/ports/geometryport.h"
+#include "voreen/core/properties/boolproperty.h"
 #include "voreen/core/properties/buttonproperty.h"
 #include "voreen/core/properties/filedialogproperty.h"
 
@@ -56,6 +57,7 @@ protected:
 
     // properties
     FileDialogProperty fileProp_;
+    BoolProperty compress_;
     ButtonProperty saveButton_;
 
     GeometryPort inport_;
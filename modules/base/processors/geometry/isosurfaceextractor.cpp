@@ -28,6 +28,11 @@
 
 #include "isosurfaceextractor.h"
 
+#include "voreen/core/datastructures/volume/volumeminmaxoctree.h"
+
+#include <limits>
+#include <algorithm>
+
 namespace voreen {
 
 const std::string IsosurfaceExtractor::loggerCat_("voreen.IsosurfaceExtractor");
@@ -36,7 +41,7 @@ IsosurfaceExtractor::IsosurfaceExtractor()
     : Processor()
     , inport_(Port::INPORT, "volume.inport")
     , outport_(Port::OUTPORT, "geometry.outport")
-    , isoValue_("isoValue", "ISO value", 128, 0, 256)
+    , isoValue_("isoValue", "ISO value", 0.5f, 0.f, 1.f)
     , isoColor_("isoColor", "ISO color", tgt::Color(0.5f,0.5f,0.5f,1.0f))
 {
     isoColor_.setViews(Property::COLOR);
@@ -55,200 +60,325 @@ Processor* IsosurfaceExtractor::create() const {
 }
 
 void IsosurfaceExtractor::process() {
+    const VolumeHandleBase* handle = inport_.getData();
+    const Volume* inputVolume = handle->getRepresentation<Volume>();
+    if (!inputVolume) {
+        LERROR("No volume representation available");
+        return;
+    }
 
-    const Volume* inputVolume = inport_.getData()->getRepresentation<Volume>();
-
-    std::vector<MarchingCubes<char>::Triangle> polygon =
-        MarchingCubes<char>::march(static_cast<const char*>(inputVolume->getData()), inputVolume->getDimensions(), isoValue_.get(), MarchingCubes<char>::XZY);
-
-    LINFOC("IsosurfaceExtractor", "number of polygons: " << polygon.size());
-
-    MeshGeometry mesh;
-    FaceGeometry face;
-
-    for (std::vector<MarchingCubes<char>::Triangle>::iterator it = polygon.begin(); it != polygon.end(); ++it) {
-        MarchingCubes<char>::Triangle& tri = *it;
-        tgt::vec3& a = tri.vertices_[0];
-        tgt::vec3& b = tri.vertices_[1];
-        tgt::vec3& c = tri.vertices_[2];
-
-        tgt::ivec3 volDim = inputVolume->getDimensions();
-        tgt::vec3 cubeSize = inport_.getData()->getCubeSize();
-        tgt::vec3 offset = inport_.getData()->getOffset();
-        // transform from voxel space into proxy geometry space
-        a = ((a / (static_cast<tgt::vec3>(volDim)) - tgt::vec3(0.5f)) * cubeSize) + offset;
-        b = ((b / (static_cast<tgt::vec3>(volDim)) - tgt::vec3(0.5f)) * cubeSize) + offset;
-        c = ((c / (static_cast<tgt::vec3>(volDim)) - tgt::vec3(0.5f)) * cubeSize) + offset;
-
-        tgt::vec3 e1(c - a), e2(b - a);
-        e1 = normalize(e1);
-        e2 = normalize(e2);
-        tgt::vec3 normal = cross(e1, e2);
-        normal = normalize(normal);
-
-        VertexGeometry v0 = VertexGeometry(a);
-        v0.setColor(isoColor_.get());
-        VertexGeometry v1 = VertexGeometry(b);
-        v1.setColor(isoColor_.get());
-        VertexGeometry v2 = VertexGeometry(c);
-        v2.setColor(isoColor_.get());
-
-        FaceGeometry face;
-        face.addVertex(v0);
-        face.addVertex(v1);
-        face.addVertex(v2);
-        mesh.addFace(face);
-
-        //glNormal3fv(normal.data_);
-        //glVertex3fv(a.data_);
-        //glVertex3fv(b.data_);
-        //glVertex3fv(c.data_);
+    // the octree is cached with the volume and used for skipping empty bricks
+    const VolumeMinMaxOctree* octree = handle->getDerivedData<VolumeMinMaxOctree>();
+
+    std::vector<tgt::vec3> vertices;
+    std::vector<tgt::vec3> normals;
+    std::vector<uint32_t> indices;
+    bool supported =
+        extractIsosurface<uint8_t>(inputVolume, octree, vertices, normals, indices)  ||
+        extractIsosurface<int8_t>(inputVolume, octree, vertices, normals, indices)   ||
+        extractIsosurface<uint16_t>(inputVolume, octree, vertices, normals, indices) ||
+        extractIsosurface<int16_t>(inputVolume, octree, vertices, normals, indices)  ||
+        extractIsosurface<uint32_t>(inputVolume, octree, vertices, normals, indices) ||
+        extractIsosurface<int32_t>(inputVolume, octree, vertices, normals, indices)  ||
+        extractIsosurface<uint64_t>(inputVolume, octree, vertices, normals, indices) ||
+        extractIsosurface<int64_t>(inputVolume, octree, vertices, normals, indices)  ||
+        extractIsosurface<float>(inputVolume, octree, vertices, normals, indices)    ||
+        extractIsosurface<double>(inputVolume, octree, vertices, normals, indices);
+    if (!supported) {
+        LERROR("Only single-channel volumes are supported");
+        return;
     }
 
-    geometry_.clear();
-    geometry_.addMesh(mesh);
+    LINFO("number of triangles: " << indices.size() / 3 << ", number of vertices: " << vertices.size());
+
+    geometry_.setData(vertices, normals, std::vector<tgt::vec4>(), indices);
+    geometry_.setColor(isoColor_.get());
 
     outport_.setData(&geometry_, false);
 }
 
 template<typename T>
-std::vector<typename MarchingCubes<T>::Triangle> MarchingCubes<T>::march(
-    const T* const texture, const tgt::ivec3& texDim,
-    const T isovalue, const VoxelOrder& voxelOrder)
+bool IsosurfaceExtractor::extractIsosurface(const Volume* volume, const VolumeMinMaxOctree* octree,
+        std::vector<tgt::vec3>& vertices, std::vector<tgt::vec3>& normals, std::vector<uint32_t>& indices)
 {
-    if ((texture == 0) || (texDim.x == 0) || (texDim.y == 0) || (texDim.z == 0))
-        return std::vector<Triangle>();
+    const VolumeAtomic<T>* typedVolume = dynamic_cast<const VolumeAtomic<T>*>(volume);
+    if (!typedVolume)
+        return false;
+
+    const VolumeHandleBase* handle = inport_.getData();
+    if (!MarchingCubes<T>::extract(typedVolume, isoValue_.get(), handle->getSpacing(), handle->getOffset(),
+            octree, vertices, normals, indices))
+    {
+        LERROR("Isosurface exceeds the maximum number of vertices");
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
 
-    const unsigned int numGridCells = (texDim.x - 1) * (texDim.y - 1) * (texDim.z - 1);
-    std::cout << "number of grid cells: " << numGridCells << "\n";
+template<typename T>
+const uint32_t MarchingCubes<T>::NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+template<typename T>
+const size_t MarchingCubes<T>::SLAB_SIZE = 16;
 
-    //std::ofstream ofs("defect.txt", std::ios_base::out);
-    std::vector<Triangle> polygons;
-    for (unsigned int i = 0; i < numGridCells; ++i)
+// corners: 0 (0,0,0), 1 (1,0,0), 2 (1,0,1), 3 (0,0,1), 4 (0,1,0), 5 (1,1,0), 6 (1,1,1), 7 (0,1,1)
+template<typename T>
+const int MarchingCubes<T>::edgeInfo[12][4] = {
+    {0, 0, 0, 0}, {1, 0, 0, 2}, {0, 0, 1, 0}, {0, 0, 0, 2},
+    {0, 1, 0, 0}, {1, 1, 0, 2}, {0, 1, 1, 0}, {0, 1, 0, 2},
+    {0, 0, 0, 1}, {1, 0, 0, 1}, {1, 0, 1, 1}, {0, 0, 1, 1}
+};
+
+template<typename T>
+bool MarchingCubes<T>::extract(const VolumeAtomic<T>* volume, float isoValue, const tgt::vec3& spacing,
+        const tgt::vec3& offset, const VolumeMinMaxOctree* octree,
+        std::vector<tgt::vec3>& vertices, std::vector<tgt::vec3>& normals, std::vector<uint32_t>& indices)
+{
+    vertices.clear();
+    normals.clear();
+    indices.clear();
+
+    const tgt::svec3 dims = volume->getDimensions();
+    if (dims.x < 2 || dims.y < 2 || dims.z < 2)
+        return true;
+
+    // extract slabs in parallel
+    const size_t numLayers = dims.z - 1;
+    const int numSlabs = static_cast<int>((numLayers + SLAB_SIZE - 1) / SLAB_SIZE);
+    std::vector<Slab> slabs(numSlabs);
+    #pragma omp parallel
     {
-        GridCell cell(i, texture, texDim, voxelOrder);
-        //cell.setValues( texDim);
-
-        std::vector<Triangle> tris = polygonise(cell, isovalue);
-        tgt::vec3 v1, v2;
-        for (typename std::vector<Triangle>::iterator it = tris.begin(); it != tris.end(); ++it)
-        {
-            const Triangle& tri = *it;
-            v1 = tri.vertices_[1] - tri.vertices_[0];
-            v2 = tri.vertices_[2] - tri.vertices_[0];
-            if ((length(v1) == 0.0f) || (length(v1) == 0.0f)) {
-                //ofs << tri.vertices_[0] << "\t\t" << tri.vertices_[1] << "\t\t" << tri.vertices_[2] << "\n";
-                continue;
+        EdgeCache cache;
+        #pragma omp for schedule(dynamic, 1)
+        for (int i = 0; i < numSlabs; i++) {
+            size_t zBegin = i * SLAB_SIZE;
+            size_t zEnd = std::min(zBegin + SLAB_SIZE, numLayers);
+            extractSlab(volume, isoValue, spacing, offset, octree, zBegin, zEnd, cache, slabs[i]);
+        }
+    }
+
+    // weld the vertices on the planes between adjacent slabs: the upper plane vertices of a slab
+    // are replaced by the lower plane vertices of the next slab
+    std::vector<std::vector<uint32_t> > globalIndices(numSlabs);
+    std::vector<std::vector<std::pair<uint32_t, uint32_t> > > aliases(numSlabs);
+    for (int i = 0; i < numSlabs; i++)
+        globalIndices[i].resize(slabs[i].vertices_.size(), 0);
+    for (int i = 0; i+1 < numSlabs; i++) {
+        const std::vector<std::pair<size_t, uint32_t> >& upper = slabs[i].upperPlane_;
+        const std::vector<std::pair<size_t, uint32_t> >& lower = slabs[i+1].lowerPlane_;
+        size_t l = 0;
+        for (size_t u = 0; u < upper.size(); u++) {
+            while (l < lower.size() && lower[l].first < upper[u].first)
+                l++;
+            if (l < lower.size() && lower[l].first == upper[u].first) {
+                aliases[i].push_back(std::make_pair(upper[u].second, lower[l].second));
+                globalIndices[i][upper[u].second] = NO_VERTEX;
             }
+        }
+    }
 
-            v1 = normalize(v1);
-            v2 = normalize(v2);
+    // assign global indices to the remaining vertices
+    std::vector<size_t> vertexOffsets(numSlabs + 1, 0);
+    std::vector<size_t> indexOffsets(numSlabs + 1, 0);
+    size_t numVertices = 0;
+    for (int i = 0; i < numSlabs; i++) {
+        vertexOffsets[i] = numVertices;
+        for (size_t j = 0; j < globalIndices[i].size(); j++) {
+            if (globalIndices[i][j] == NO_VERTEX)
+                continue;
+            if (numVertices >= NO_VERTEX)
+                return false;
+            globalIndices[i][j] = static_cast<uint32_t>(numVertices++);
+        }
+        indexOffsets[i+1] = indexOffsets[i] + slabs[i].indices_.size();
+    }
+    vertexOffsets[numSlabs] = numVertices;
+    for (int i = 0; i+1 < numSlabs; i++) {
+        for (size_t j = 0; j < aliases[i].size(); j++)
+            globalIndices[i][aliases[i][j].first] = globalIndices[i+1][aliases[i][j].second];
+    }
 
-            float f = dot(v1, v2);
-            if (fabsf(f) >= 0.99999) {
-                //ofs << tri.vertices_[0] << "\t\t" << tri.vertices_[1] << "\t\t" << tri.vertices_[2] << "\n";
+    // copy slabs into the output arrays
+    vertices.resize(numVertices);
+    normals.resize(numVertices);
+    indices.resize(indexOffsets[numSlabs]);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < numSlabs; i++) {
+        const Slab& slab = slabs[i];
+        size_t vertex = vertexOffsets[i];
+        for (size_t j = 0; j < slab.vertices_.size(); j++) {
+            if (globalIndices[i][j] != vertex)
                 continue;
-            }
+            vertices[vertex] = slab.vertices_[j];
+            normals[vertex] = slab.normals_[j];
+            vertex++;
+        }
+        for (size_t j = 0; j < slab.indices_.size(); j++)
+            indices[indexOffsets[i] + j] = globalIndices[i][slab.indices_[j]];
+    }
 
-            polygons.push_back(*it);
-        }   // for (it
-    }   // for(i
-    //ofs.close();
-    return polygons;
+    return true;
 }
 
 template<typename T>
-std::vector<typename MarchingCubes<T>::Triangle>
-MarchingCubes<T>::polygonise(const GridCell& grid, const T isovalue)
+void MarchingCubes<T>::extractSlab(const VolumeAtomic<T>* volume, float isoValue, const tgt::vec3& spacing,
+        const tgt::vec3& offset, const VolumeMinMaxOctree* octree, size_t zBegin, size_t zEnd,
+        EdgeCache& cache, Slab& slab)
 {
-    int cubeindex = 0;
-    for (int i = 0; i < 8; ++i) {
-        if (grid.values_[i] < isovalue)
-            cubeindex |= (1 << i);
+    const tgt::svec3 dims = volume->getDimensions();
+    const size_t planeSize = dims.x * dims.y;
+    cache.xEdges_[0].assign(planeSize, NO_VERTEX);
+    cache.yEdges_[0].assign(planeSize, NO_VERTEX);
+
+    // leaf bricks of the octree contain the first voxel layer of their upper neighbors,
+    // so each brick covers all cells starting within it
+    const std::vector<tgt::vec2>* bricks = (octree ? &octree->getLevel(0) : 0);
+    const tgt::svec3 brickDims = (octree ? octree->getLevelDimensions(0) : tgt::svec3(static_cast<size_t>(0)));
+    const size_t brickSize = (octree ? octree->getBrickSize() : 1);
+
+    for (size_t z = zBegin; z < zEnd; z++) {
+        cache.xEdges_[1].assign(planeSize, NO_VERTEX);
+        cache.yEdges_[1].assign(planeSize, NO_VERTEX);
+        cache.zEdges_.assign(planeSize, NO_VERTEX);
+
+        for (size_t y = 0; y < dims.y - 1; y++) {
+            for (size_t x = 0; x < dims.x - 1; x++) {
+                if (bricks) {
+                    const tgt::vec2& range = (*bricks)[((z / brickSize)*brickDims.y + y / brickSize)*brickDims.x + x / brickSize];
+                    if (!(range.x < isoValue && range.y >= isoValue)) {
+                        // skip to the next brick
+                        x = (x / brickSize + 1) * brickSize - 1;
+                        continue;
+                    }
+                }
+
+                // corners in the order expected by the tables
+                float values[8];
+                values[0] = getValue(volume, tgt::svec3(x,   y,   z));
+                values[1] = getValue(volume, tgt::svec3(x+1, y,   z));
+                values[2] = getValue(volume, tgt::svec3(x+1, y,   z+1));
+                values[3] = getValue(volume, tgt::svec3(x,   y,   z+1));
+                values[4] = getValue(volume, tgt::svec3(x,   y+1, z));
+                values[5] = getValue(volume, tgt::svec3(x+1, y+1, z));
+                values[6] = getValue(volume, tgt::svec3(x+1, y+1, z+1));
+                values[7] = getValue(volume, tgt::svec3(x,   y+1, z+1));
+
+                int cubeIndex = 0;
+                for (int i = 0; i < 8; ++i) {
+                    if (values[i] < isoValue)
+                        cubeIndex |= (1 << i);
+                }
+                if (edgeTable[cubeIndex] == 0)
+                    continue;
+
+                uint32_t edgeVertices[12];
+                for (int i = 0; i < 12; ++i) {
+                    if (edgeTable[cubeIndex] & (1 << i))
+                        edgeVertices[i] = getEdgeVertex(volume, isoValue, spacing, offset, tgt::svec3(x, y, z), i, z, cache, slab);
+                }
+
+                for (int i = 0; triTable[cubeIndex][i] != -1; i += 3) {
+                    uint32_t a = edgeVertices[triTable[cubeIndex][i]];
+                    uint32_t b = edgeVertices[triTable[cubeIndex][i + 1]];
+                    uint32_t c = edgeVertices[triTable[cubeIndex][i + 2]];
+
+                    // skip degenerated triangles, which occur if the isovalue equals voxel values
+                    tgt::vec3 e1 = slab.vertices_[b] - slab.vertices_[a];
+                    tgt::vec3 e2 = slab.vertices_[c] - slab.vertices_[a];
+                    if (a == b || b == c || a == c || tgt::lengthSq(tgt::cross(e1, e2)) == 0.f)
+                        continue;
+
+                    slab.indices_.push_back(a);
+                    slab.indices_.push_back(b);
+                    slab.indices_.push_back(c);
+                }
+            }
+        }
+
+        // the upper plane of the first layer is the lower plane of the slab
+        if (z == zBegin) {
+            for (size_t i = 0; i < planeSize; i++) {
+                if (cache.xEdges_[0][i] != NO_VERTEX)
+                    slab.lowerPlane_.push_back(std::make_pair(2*i, cache.xEdges_[0][i]));
+                if (cache.yEdges_[0][i] != NO_VERTEX)
+                    slab.lowerPlane_.push_back(std::make_pair(2*i + 1, cache.yEdges_[0][i]));
+            }
+        }
+
+        cache.xEdges_[0].swap(cache.xEdges_[1]);
+        cache.yEdges_[0].swap(cache.yEdges_[1]);
     }
 
-    if (edgeTable[cubeindex] == 0)
-        return std::vector<Triangle>();
-
-    // Find the vertices where the surface intersects the cube
-    //
-    tgt::vec3 vertlist[12];
-    if (edgeTable[cubeindex] & 1)
-        vertlist[0] = linIntVertex(isovalue, grid.vertices_[0], grid.vertices_[1],
-        grid.values_[0], grid.values_[1]);
-
-    if (edgeTable[cubeindex] & 2)
-        vertlist[1] = linIntVertex(isovalue, grid.vertices_[1], grid.vertices_[2],
-        grid.values_[1], grid.values_[2]);
-
-    if (edgeTable[cubeindex] & 4)
-        vertlist[2] = linIntVertex(isovalue, grid.vertices_[2], grid.vertices_[3],
-        grid.values_[2], grid.values_[3]);
-
-    if (edgeTable[cubeindex] & 8)
-        vertlist[3] = linIntVertex(isovalue, grid.vertices_[3], grid.vertices_[0],
-        grid.values_[3], grid.values_[0]);
-
-    if (edgeTable[cubeindex] & 16)
-        vertlist[4] = linIntVertex(isovalue, grid.vertices_[4], grid.vertices_[5],
-        grid.values_[4], grid.values_[5]);
-
-    if (edgeTable[cubeindex] & 32)
-        vertlist[5] = linIntVertex(isovalue, grid.vertices_[5], grid.vertices_[6],
-        grid.values_[5], grid.values_[6]);
-
-    if (edgeTable[cubeindex] & 64)
-        vertlist[6] = linIntVertex(isovalue, grid.vertices_[6], grid.vertices_[7],
-        grid.values_[6], grid.values_[7]);
-
-    if (edgeTable[cubeindex] & 128)
-        vertlist[7] = linIntVertex(isovalue, grid.vertices_[7], grid.vertices_[4],
-        grid.values_[7], grid.values_[4]);
-
-    if (edgeTable[cubeindex] & 256)
-        vertlist[8] = linIntVertex(isovalue, grid.vertices_[0], grid.vertices_[4],
-        grid.values_[0], grid.values_[4]);
-
-    if (edgeTable[cubeindex] & 512)
-        vertlist[9] = linIntVertex(isovalue, grid.vertices_[1], grid.vertices_[5],
-        grid.values_[1], grid.values_[5]);
-
-    if (edgeTable[cubeindex] & 1024)
-        vertlist[10] = linIntVertex(isovalue, grid.vertices_[2], grid.vertices_[6],
-        grid.values_[2], grid.values_[6]);
-
-    if (edgeTable[cubeindex] & 2048)
-        vertlist[11] = linIntVertex(isovalue, grid.vertices_[3], grid.vertices_[7],
-        grid.values_[3], grid.values_[7]);
-
-    // Create the triangle
-    //
-    std::vector<Triangle> triangles;
-    Triangle tri;
-    for (int i = 0; triTable[cubeindex][i] != -1; i += 3) {
-        tri.vertices_[0] = vertlist[triTable[cubeindex][i + 0]];
-        tri.vertices_[1] = vertlist[triTable[cubeindex][i + 1]];
-        tri.vertices_[2] = vertlist[triTable[cubeindex][i + 2]];
-        triangles.push_back(tri);
+    // after the last swap, the lower cache contains the upper plane of the slab
+    for (size_t i = 0; i < planeSize; i++) {
+        if (cache.xEdges_[0][i] != NO_VERTEX)
+            slab.upperPlane_.push_back(std::make_pair(2*i, cache.xEdges_[0][i]));
+        if (cache.yEdges_[0][i] != NO_VERTEX)
+            slab.upperPlane_.push_back(std::make_pair(2*i + 1, cache.yEdges_[0][i]));
     }
-    return triangles;
 }
 
-template <typename T>
-tgt::vec3 MarchingCubes<T>::linIntVertex(const int isolevel,
-                                         const tgt::vec3& p1, const tgt::vec3& p2,
-                                         const int value1, const int value2)
+template<typename T>
+uint32_t MarchingCubes<T>::getEdgeVertex(const VolumeAtomic<T>* volume, float isoValue, const tgt::vec3& spacing,
+        const tgt::vec3& offset, const tgt::svec3& cell, int edge, size_t layer, EdgeCache& cache, Slab& slab)
 {
-    tgt::vec3 p;
-    if ((isolevel == value1) || (value1 == value2))
-        return p1;
+    const tgt::svec3 dims = volume->getDimensions();
+    tgt::svec3 p1 = cell + tgt::svec3(edgeInfo[edge][0], edgeInfo[edge][1], edgeInfo[edge][2]);
+    int direction = edgeInfo[edge][3];
+    size_t planeIndex = p1.y * dims.x + p1.x;
+
+    uint32_t* cached;
+    if (direction == 0)
+        cached = &cache.xEdges_[p1.z - layer][planeIndex];
+    else if (direction == 1)
+        cached = &cache.yEdges_[p1.z - layer][planeIndex];
+    else
+        cached = &cache.zEdges_[planeIndex];
+    if (*cached != NO_VERTEX)
+        return *cached;
+
+    tgt::svec3 p2 = p1;
+    p2[direction]++;
+
+    // interpolate position and gradient along the edge
+    float value1 = getValue(volume, p1);
+    float value2 = getValue(volume, p2);
+    float mu = 0.f;
+    if (value1 != value2 && isoValue != value1)
+        mu = (isoValue == value2 ? 1.f : (isoValue - value1) / (value2 - value1));
+
+    tgt::vec3 position = tgt::vec3(p1) + (tgt::vec3(p2) - tgt::vec3(p1)) * mu;
+    tgt::vec3 gradient = getGradient(volume, p1, spacing) * (1.f - mu) + getGradient(volume, p2, spacing) * mu;
+    float gradientLength = tgt::length(gradient);
+
+    *cached = static_cast<uint32_t>(slab.vertices_.size());
+    slab.vertices_.push_back(position * spacing + offset);
+    slab.normals_.push_back(gradientLength > 0.f ? -gradient / gradientLength : tgt::vec3(0.f));
+    return *cached;
+}
 
-    if (isolevel == value2)
-        return p2;
+template<typename T>
+float MarchingCubes<T>::getValue(const VolumeAtomic<T>* volume, const tgt::svec3& pos) {
+    return getTypeAsFloat(volume->voxel(pos));
+}
 
-    float mu = static_cast<float>(isolevel - value1) / static_cast<float>(value2 - value1);
-    p = p1 + ((p2 - p1) * mu);
-    return p;
+template<typename T>
+tgt::vec3 MarchingCubes<T>::getGradient(const VolumeAtomic<T>* volume, const tgt::svec3& pos, const tgt::vec3& spacing) {
+    const tgt::svec3 dims = volume->getDimensions();
+    tgt::vec3 gradient;
+    for (int i = 0; i < 3; i++) {
+        // central differences, one-sided at the volume border
+        tgt::svec3 p1 = pos;
+        tgt::svec3 p2 = pos;
+        if (pos[i] > 0)
+            p1[i]--;
+        if (pos[i] + 1 < dims[i])
+            p2[i]++;
+        float distance = static_cast<float>(p2[i] - p1[i]) * spacing[i];
+        gradient[i] = (distance > 0.f ? (getValue(volume, p2) - getValue(volume, p1)) / distance : 0.f);
+    }
+    return gradient;
 }
 
 // The real black magic. Taken from http://local.wasp.uwa.edu.au/~pbourke/geometry/polygonise/
@@ -33,13 +33,16 @@
 
 #include "voreen/core/ports/geometryport.h"
 #include "voreen/core/ports/volumeport.h"
-#include "voreen/core/properties/intproperty.h"
+#include "voreen/core/properties/floatproperty.h"
 #include "voreen/core/properties/vectorproperty.h"
 
-#include "voreen/core/datastructures/geometry/meshlistgeometry.h"
+#include "voreen/core/datastructures/geometry/indexedmeshgeometry.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
 
 namespace voreen {
 
+class VolumeMinMaxOctree;
+
 class IsosurfaceExtractor : public Processor {
 public:
 
@@ -54,169 +57,102 @@ public:
 protected:
     virtual void process();
 
+    /**
+     * Extracts the isosurface, if the input volume is of type VolumeAtomic<T>.
+     *
+     * @return false, if the volume is of a different type
+     */
+    template<typename T>
+    bool extractIsosurface(const Volume* volume, const VolumeMinMaxOctree* octree,
+        std::vector<tgt::vec3>& vertices, std::vector<tgt::vec3>& normals, std::vector<uint32_t>& indices);
+
     VolumePort inport_;
     GeometryPort outport_;
 
-    IntProperty isoValue_;
+    FloatProperty isoValue_;
     FloatVec4Property isoColor_;
 
-    MeshListGeometry geometry_;
+    IndexedMeshGeometry geometry_;
 
     /// category used in logging
     static const std::string loggerCat_;
 };
 
+/**
+ * Marching cubes isosurface extraction for scalar volumes.
+ *
+ * The volume is processed in slabs of cell layers in parallel. Within a slab, the vertices
+ * on cell edges are shared between adjacent cells by an edge cache. Vertices on the planes
+ * between slabs are welded afterwards, so that the resulting triangle mesh is indexed
+ * without duplicate vertices. Bricks of the volume's min/max octree that do not contain
+ * the isovalue are skipped.
+ */
 template <typename T>
 class MarchingCubes {
 public:
-    enum VoxelOrder { XYZ, XZY };   // TODO: add support for every possible order
-
-    typedef T VoxelType;
-
-    struct Triangle {
-        Triangle() : marker_(false) {}
-        Triangle(const tgt::vec3& v0, const tgt::vec3& v1, const tgt::vec3& v2) : marker_(false) {
-            vertices_[0] = v0;
-            vertices_[1] = v1;
-            vertices_[2] = v2;
-        }
-        tgt::vec3 vertices_[3];
-        bool marker_;
-    };
-
-public:
-    static std::vector<Triangle> march(const T* const texture, const tgt::ivec3& texDim,
-        const T isovalue, const VoxelOrder& voxelOrder = XYZ);
+    /**
+     * Extracts the isosurface of the passed volume.
+     *
+     * @param volume the input volume
+     * @param isoValue the isovalue as normalized intensity
+     * @param spacing voxel spacing, used for transforming the vertices into physical coordinates
+     *        and for computing the gradient normals
+     * @param offset volume offset, used for transforming the vertices into physical coordinates
+     * @param octree optional min/max octree of the volume, used for skipping empty bricks
+     * @param vertices receives the vertex positions in physical coordinates
+     * @param normals receives the normalized negative gradients at the vertices
+     * @param indices receives three vertex indices per triangle
+     *
+     * @return false, if the number of vertices exceeds the 32 bit index range
+     */
+    static bool extract(const VolumeAtomic<T>* volume, float isoValue, const tgt::vec3& spacing,
+        const tgt::vec3& offset, const VolumeMinMaxOctree* octree,
+        std::vector<tgt::vec3>& vertices, std::vector<tgt::vec3>& normals, std::vector<uint32_t>& indices);
 
 private:
-    class GridCell {
-    public:
-        GridCell(const unsigned int number, const T* const texture,
-            const tgt::ivec3& texDim, const VoxelOrder& voxelOrder);
-
-        tgt::vec3 vertices_[8];
-        T values_[8];
+    /// Result of a single slab with slab-local vertex indices.
+    struct Slab {
+        std::vector<tgt::vec3> vertices_;
+        std::vector<tgt::vec3> normals_;
+        std::vector<uint32_t> indices_;
+
+        /// Vertices on the lower and upper plane of the slab as pairs of edge key and vertex index.
+        std::vector<std::pair<size_t, uint32_t> > lowerPlane_;
+        std::vector<std::pair<size_t, uint32_t> > upperPlane_;
+    };
 
-    private:
-        const VoxelOrder voxelOrder_;
+    /// Edge caches of the current cell layer: x- and y-edges of the lower and upper plane and z-edges.
+    struct EdgeCache {
+        std::vector<uint32_t> xEdges_[2];
+        std::vector<uint32_t> yEdges_[2];
+        std::vector<uint32_t> zEdges_;
     };
 
-private:
-    static std::vector<Triangle> polygonise(const GridCell& grid, const T isovalue);
+    static void extractSlab(const VolumeAtomic<T>* volume, float isoValue, const tgt::vec3& spacing,
+        const tgt::vec3& offset, const VolumeMinMaxOctree* octree, size_t zBegin, size_t zEnd,
+        EdgeCache& cache, Slab& slab);
 
-    /**
-     * Performs linear interpolation of the two given vertices using the given
-     * values at those vertices of the cube / grid cell.
-     */
-    static tgt::vec3 linIntVertex(const int isolevel, const tgt::vec3& p1, const tgt::vec3& p2,
-        const int value1, const int value2);
+    /// Returns the vertex index of the passed cell edge, creating the vertex if necessary.
+    static uint32_t getEdgeVertex(const VolumeAtomic<T>* volume, float isoValue, const tgt::vec3& spacing,
+        const tgt::vec3& offset, const tgt::svec3& cell, int edge, size_t layer, EdgeCache& cache, Slab& slab);
 
-    /**
-     * Converts the given position (cartesian coordinates >= 0 in the volume texture) to
-     * the corresponding voxel number. The texture is supposed to contain the data in
-     * XZY-order.
-     */
-    static unsigned int posToVoxelNumberXYZ(const tgt::ivec3& pos, const tgt::ivec3& dimensions)
-    {
-        return ((pos.z * dimensions.x * dimensions.y) + (pos.y * dimensions.x) + pos.x);
-    }
+    /// Returns the voxel value as normalized intensity.
+    static float getValue(const VolumeAtomic<T>* volume, const tgt::svec3& pos);
 
-    static unsigned int posToVoxelNumberXZY(const tgt::ivec3& pos, const tgt::ivec3& dimensions)
-    {
-        return ((pos.y * dimensions.x * dimensions.z) + (pos.z * dimensions.x) + pos.x);
-    }
+    /// Returns the gradient at the passed voxel in physical units.
+    static tgt::vec3 getGradient(const VolumeAtomic<T>* volume, const tgt::svec3& pos, const tgt::vec3& spacing);
 
-    /**
-     * Converts the given voxel (its number in the texture) to cartesian coordinates. The
-     * texture is supposed to contain the data in XZY-order.
-     */
-    static tgt::ivec3 voxelNumberToPosXYZ(const unsigned int n, const tgt::ivec3& dimensions)
-    {
-        return tgt::ivec3((n % dimensions.x), ((n / dimensions.x) % dimensions.y),
-            (n / (dimensions.x * dimensions.y)));
-    }
-
-    static tgt::ivec3 voxelNumberToPosXZY(const unsigned int n, const tgt::ivec3& dimensions)
-    {
-        return tgt::ivec3((n % dimensions.x), (n / (dimensions.x * dimensions.z)),
-            ((n / dimensions.x) % dimensions.z));
-    }
+    static const uint32_t NO_VERTEX;
+
+    /// Number of cell layers per slab.
+    static const size_t SLAB_SIZE;
 
-private:
     static const int edgeTable[256];
     static const int triTable[256][16];
-};
 
-// ----------------------------------------------------------------------------
-
-template <typename T>
-MarchingCubes<T>::GridCell::GridCell(const unsigned int number, const T* const texture,
-                                  const tgt::ivec3& texDim, const VoxelOrder& voxelOrder)
-    : voxelOrder_(voxelOrder)
-{
-    // use the correct voxelToPos method according to the voxel order.
-    //
-    tgt::ivec3 (*voxelNumberToPos)(unsigned int, const tgt::ivec3&);
-    unsigned int (*posToVoxelNumber)(const tgt::ivec3&, const tgt::ivec3&);
-
-    switch (voxelOrder_) {
-        case XYZ:
-            voxelNumberToPos = &MarchingCubes::voxelNumberToPosXYZ;
-            posToVoxelNumber = &MarchingCubes::posToVoxelNumberXYZ;
-            break;
-        case XZY:
-            voxelNumberToPos = &MarchingCubes::voxelNumberToPosXZY;
-            posToVoxelNumber = &MarchingCubes::posToVoxelNumberXZY;
-            break;
-        default:
-            voxelNumberToPos = 0;
-            posToVoxelNumber = 0;
-            break;
-    }   // switch
-
-    if ((voxelNumberToPos == 0) || (posToVoxelNumber == 0))
-        throw std::bad_alloc();
-
-    // left lower back (0, 0, 0)
-    tgt::ivec3 pos = (*voxelNumberToPos)(number, texDim);
-    vertices_[0] = static_cast<tgt::vec3>(pos);
-
-    // right lower back (1, 0, 0)
-    vertices_[1] = vertices_[0];
-    vertices_[1].x += 1.0f;
-
-    // right lower front (1, 0, 1);
-    vertices_[2] = vertices_[1];
-    vertices_[2].z += 1.0f;
-
-    // left lower front (0, 0, 1)
-    vertices_[3] = vertices_[0];
-    vertices_[3].z += 1.0f;
-
-    // left upper back (0, 1, 0)
-    vertices_[4] = vertices_[0];
-    vertices_[4].y += 1.0f;
-
-    // right upper back (1, 1, 0)
-    vertices_[5] = vertices_[4];
-    vertices_[5].x += 1.0f;
-
-    // right upper front (1, 1, 1)
-    vertices_[6] = vertices_[5];
-    vertices_[6].z += 1.0f;
-
-    // left upper fron (0, 1, 1)
-    vertices_[7] = vertices_[4];
-    vertices_[7].z += 1.0f;
-
-    tgt::ivec3 p(0, 0, 0);
-    for (int i = 0; i < 8; ++i) {
-        const tgt::vec3& pos = vertices_[i];
-        p = static_cast<tgt::ivec3>(pos);
-        unsigned int n = (*posToVoxelNumber)(p, texDim);
-        values_[i] = texture[n];
-    }
-}
+    /// Lower corner (x, y, z) and direction (3) of the cell edges.
+    static const int edgeInfo[12][4];
+};
 
 } //namespace
 
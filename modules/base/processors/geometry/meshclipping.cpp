@@ -28,6 +28,8 @@
 
 #include "meshclipping.h"
 
+#include "voreen/core/datastructures/geometry/indexedmeshgeometry.h"
+
 namespace voreen {
 
 const std::string MeshClipping::loggerCat_("voreen.MeshClipping");
@@ -58,9 +60,19 @@ Processor* MeshClipping::create() const {
 void MeshClipping::process() {
     tgtAssert(inport_.getData(), "no geometry");
 
+    // indexed meshes are clipped without closing them
+    const IndexedMeshGeometry* indexedGeometry = dynamic_cast<const IndexedMeshGeometry*>(inport_.getData());
+    if (indexedGeometry) {
+        IndexedMeshGeometry* geometry = new IndexedMeshGeometry(*indexedGeometry);
+        if (enabled_.get())
+            geometry->clip(tgt::vec4(tgt::normalize(normal_.get()), position_.get()));
+        outport_.setData(geometry);
+        return;
+    }
+
     const MeshListGeometry* inportGeometry = dynamic_cast<const MeshListGeometry*>(inport_.getData());
     if (!inportGeometry) {
-        LWARNING("Input geometry type not supported, expecting MeshListGeometry.");
+        LWARNING("Input geometry type not supported, expecting MeshListGeometry or IndexedMeshGeometry.");
         outport_.setData(0);
         return;
     }
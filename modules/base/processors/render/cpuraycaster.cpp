@@ -28,13 +28,152 @@
 
 #include "cpuraycaster.h"
 #include "voreen/core/datastructures/transfunc/transfuncintensitygradient.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+
+#include "tgt/stopwatch.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace voreen {
 
 using tgt::vec3;
 using tgt::vec4;
+using tgt::ivec2;
 using tgt::svec3;
 
+const std::string CPURaycaster::loggerCat_("voreen.base.CPURaycaster");
+
+namespace {
+
+/// Returns the wall clock time in seconds.
+double getWallClockTime() {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return static_cast<double>(tgt::Stopwatch::getTicks()) / 1000.0;
+#endif
+}
+
+/// Returns the index of the calling thread within the current parallel region.
+int getThreadIndex() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Samples a single channel of a VolumeAtomic without border directly
+ * from its voxel array, using precomputed strides. The raw values are
+ * interpolated first and normalized afterwards, which yields the same
+ * result as Volume::getVoxelFloat() for unsigned integer and float types.
+ */
+template<class T>
+class AtomicSampler {
+public:
+    typedef typename VolumeElement<T>::BaseType BaseType;
+
+    AtomicSampler(const VolumeAtomic<T>* volume, size_t channel = 0)
+        : data_(volume->voxel())
+        , channel_(channel)
+        , maxIndex_(volume->getDimensions() - svec3(1))
+        , strideY_(volume->getDimensions().x)
+        , strideZ_(volume->getDimensions().x * volume->getDimensions().y)
+        , scale_(VolumeElement<BaseType>::isInteger() ? 1.f / static_cast<float>(VolumeElement<BaseType>::rangeMaxElement()) : 1.f)
+    {
+        tgtAssert(!volume->hasBorder(), "volumes with border are not supported");
+        tgtAssert(!VolumeElement<BaseType>::isSigned() || !VolumeElement<BaseType>::isInteger(),
+            "signed integer types are not supported");
+    }
+
+    inline float nearest(const vec3& pos) const {
+        svec3 p = tgt::min(svec3(tgt::iround(tgt::abs(pos))), maxIndex_);
+        return fetch(p.z*strideZ_ + p.y*strideY_ + p.x) * scale_;
+    }
+
+    inline float linear(const vec3& pos) const {
+        vec3 posAbs = tgt::abs(pos);
+        svec3 llb = svec3(posAbs);
+        vec3 p = posAbs - vec3(llb); // decimal part
+        llb = tgt::min(llb, maxIndex_);
+
+        // offsets to the upper neighbors, clamped at the volume's upper boundary
+        const size_t dx = (llb.x < maxIndex_.x ? 1 : 0);
+        const size_t dy = (llb.y < maxIndex_.y ? strideY_ : 0);
+        const size_t dz = (llb.z < maxIndex_.z ? strideZ_ : 0);
+        const size_t base = llb.z*strideZ_ + llb.y*strideY_ + llb.x;
+
+        // gather all eight corners first, so that the loads are independent of each other
+        float v[8];
+        v[0] = fetch(base);
+        v[1] = fetch(base + dx);
+        v[2] = fetch(base + dy);
+        v[3] = fetch(base + dy + dx);
+        v[4] = fetch(base + dz);
+        v[5] = fetch(base + dz + dx);
+        v[6] = fetch(base + dz + dy);
+        v[7] = fetch(base + dz + dy + dx);
+
+        float x00 = v[0] + p.x * (v[1] - v[0]);
+        float x10 = v[2] + p.x * (v[3] - v[2]);
+        float x01 = v[4] + p.x * (v[5] - v[4]);
+        float x11 = v[6] + p.x * (v[7] - v[6]);
+        float y0 = x00 + p.y * (x10 - x00);
+        float y1 = x01 + p.y * (x11 - x01);
+        return (y0 + p.z * (y1 - y0)) * scale_;
+    }
+
+private:
+    inline float fetch(size_t index) const {
+        return static_cast<float>(VolumeElement<T>::getChannel(data_[index], channel_));
+    }
+
+    const T* data_;
+    size_t channel_;
+    svec3 maxIndex_;
+    size_t strideY_;
+    size_t strideZ_;
+    float scale_;
+};
+
+/**
+ * Fallback sampler for all volume types without a specialized sampler,
+ * which accesses the volume through the virtual Volume interface.
+ */
+class GenericSampler {
+public:
+    GenericSampler(const Volume* volume, size_t channel = 0)
+        : volume_(volume)
+        , channel_(channel)
+    {}
+
+    inline float nearest(const vec3& pos) const {
+        return volume_->getVoxelFloat(tgt::iround(pos), channel_);
+    }
+
+    inline float linear(const vec3& pos) const {
+        return volume_->getVoxelFloatLinear(pos, channel_);
+    }
+
+private:
+    const Volume* volume_;
+    size_t channel_;
+};
+
+template<bool LINEAR, class Sampler>
+inline float sampleVolume(const Sampler& sampler, const vec3& pos) {
+    return (LINEAR ? sampler.linear(pos) : sampler.nearest(pos));
+}
+
+} // namespace
+
 CPURaycaster::CPURaycaster()
   : VolumeRaycaster()
   , volumePort_(Port::INPORT, "volumehandle.volumehandle")
@@ -44,6 +183,13 @@ CPURaycaster::CPURaycaster()
   , outport_(Port::OUTPORT, "image.output", true, INVALID_RESULT, GL_RGBA16F_ARB)
   , transferFunc_("transferFunction", "Transfer function")
   , texFilterMode_("textureFilterMode_", "Texture Filtering")
+  , numThreads_("numThreads", "Number of Threads (0: all cores)", 0, 0, 256)
+  , tileSize_("tileSize", "Tile Size", 32, 4, 512)
+  , logTileTimings_("logTileTimings", "Log Tile Timings", false, Processor::VALID)
+  , skipEmptySpace_("skipEmptySpace", "Empty Space Skipping", true)
+  , terminationThreshold_("terminationThreshold", "Early Ray Termination Opacity", 0.95f, 0.5f, 1.f)
+  , intensityGradientTF_(false)
+  , tfLUTDims_(0)
 {
     addPort(volumePort_);
     addPort(gradientVolumePort_);
@@ -58,6 +204,18 @@ CPURaycaster::CPURaycaster()
     texFilterMode_.addOption("linear",  "Linear",   GL_LINEAR);
     texFilterMode_.selectByKey("linear");
     addProperty(texFilterMode_);
+
+    // acceleration
+    addProperty(skipEmptySpace_);
+    addProperty(terminationThreshold_);
+
+    // parallelization
+#ifndef _OPENMP
+    numThreads_.setWidgetsEnabled(false);
+#endif
+    addProperty(numThreads_);
+    addProperty(tileSize_);
+    addProperty(logTileTimings_);
 }
 
 Processor* CPURaycaster::create() const {
@@ -90,6 +248,15 @@ void CPURaycaster::process() {
             }
         } 
     }
+    else {
+        LWARNING("CPURaycaster::process: no tf");
+        return;
+    }
+
+    if (texFilterMode_.getValue() != GL_NEAREST && texFilterMode_.getValue() != GL_LINEAR) {
+        LERROR("Unknown texture filter mode");
+        return;
+    }
 
     // if 2D TF: check whether gradient volume is supplied
     if (intensityGradientTF_ ) {
@@ -103,13 +270,39 @@ void CPURaycaster::process() {
         }
     }
 
+    // setup per-frame ray casting parameters (shared by all threads)
+    RaycastingContext context;
+    context.volume_ = volumePort_.getData()->getRepresentation<Volume>();
+    context.gradientVolume_ = intensityGradientTF_ ? gradientVolumePort_.getData()->getRepresentation<Volume>() : 0;
+    context.volDimF_ = tgt::vec3((context.volume_->getDimensions() - svec3(1)));
+    // use dimension with the highest resolution for calculating the sampling step size
+    context.samplingStepSize_ = 1.f / (tgt::max(context.volume_->getDimensions()) * samplingRate_.get());
+    context.filterMode_ = texFilterMode_.getValue();
+    context.terminationThreshold_ = terminationThreshold_.get();
+    context.octree_ = 0;
+
+    // download tf texture once per frame
+    updateTransFuncLUT();
+    LGL_ERROR;
+
+    // the octree is computed once and then cached by the volume handle
+    if (skipEmptySpace_.get()) {
+        context.octree_ = volumePort_.getData()->getDerivedData<VolumeMinMaxOctree>();
+        if (context.octree_)
+            classifyOctreeNodes(context.octree_);
+        else
+            LWARNING("Failed to create min/max octree: empty space skipping disabled");
+    }
+
     // activate outport
     outport_.activateTarget();
     outport_.clearTarget();
     LGL_ERROR;
 
+    const ivec2 imageSize = entryPort_.getSize();
+
     // create output buffer
-    tgt::vec4* output = new tgt::vec4[entryPort_.getSize().x * entryPort_.getSize().y];
+    tgt::vec4* output = new tgt::vec4[imageSize.x * imageSize.y];
 
     // download entry/exit point textures
     tgt::vec4* entryBuffer = reinterpret_cast<tgt::vec4*>(
@@ -118,26 +311,40 @@ void CPURaycaster::process() {
         exitPort_.getColorTexture()->downloadTextureToBuffer(GL_RGBA, GL_FLOAT));
     LGL_ERROR;
 
-    // iterate over viewport and perform ray casting for each fragment
-    for (int y=0; y < entryPort_.getSize().y; ++y) {
-        for (int x=0; x < entryPort_.getSize().x; ++x) {
-            vec4 gl_FragColor = vec4(0.f);
-            int p = (y * entryPort_.getSize().x + x);
-
-            vec4 frontPos = entryBuffer[p];
-            vec4 backPos = exitBuffer[p];
-
-            if ((frontPos == vec4(0.0)) && (backPos == vec4(0.0))) {
-                //background needs no raycasting
-            }
-            else {
-                //fragCoords are lying inside the boundingbox
-                gl_FragColor = directRendering(frontPos.xyz(), backPos.xyz());
-            }
+    // subdivide viewport into tiles
+    const int tileSize = tileSize_.get();
+    const int numTilesX = (imageSize.x + tileSize - 1) / tileSize;
+    const int numTilesY = (imageSize.y + tileSize - 1) / tileSize;
+    const int numTiles = numTilesX * numTilesY;
+
+#ifdef _OPENMP
+    const int numThreads = (numThreads_.get() > 0 ? numThreads_.get() : omp_get_max_threads());
+#else
+    const int numThreads = 1;
+#endif
+
+    std::vector<double> tileTimes(numTiles, 0.0);
+    std::vector<double> threadTimes(numThreads, 0.0);
+    const double frameStart = getWallClockTime();
+
+    // instantiate the ray casting loop for the most common volume types,
+    // all other types are accessed through the (slower) virtual interface
+    const Volume* volume = context.volume_;
+    if (volume->hasBorder())
+        renderImage(GenericSampler(volume), imageSize, entryBuffer, exitBuffer, output, context, tileSize, numThreads, tileTimes, threadTimes);
+    else if (const VolumeUInt8* v = dynamic_cast<const VolumeUInt8*>(volume))
+        renderImage(AtomicSampler<uint8_t>(v), imageSize, entryBuffer, exitBuffer, output, context, tileSize, numThreads, tileTimes, threadTimes);
+    else if (const VolumeUInt16* v = dynamic_cast<const VolumeUInt16*>(volume))
+        renderImage(AtomicSampler<uint16_t>(v), imageSize, entryBuffer, exitBuffer, output, context, tileSize, numThreads, tileTimes, threadTimes);
+    else if (const VolumeFloat* v = dynamic_cast<const VolumeFloat*>(volume))
+        renderImage(AtomicSampler<float>(v), imageSize, entryBuffer, exitBuffer, output, context, tileSize, numThreads, tileTimes, threadTimes);
+    else if (const Volume4xUInt8* v = dynamic_cast<const Volume4xUInt8*>(volume))
+        renderImage(AtomicSampler<tgt::col4>(v), imageSize, entryBuffer, exitBuffer, output, context, tileSize, numThreads, tileTimes, threadTimes);
+    else
+        renderImage(GenericSampler(volume), imageSize, entryBuffer, exitBuffer, output, context, tileSize, numThreads, tileTimes, threadTimes);
+
+    const double frameTime = getWallClockTime() - frameStart;
 
-            output[p] = gl_FragColor;
-        }
-    }
     delete[] entryBuffer;
     delete[] exitBuffer;
 
@@ -149,34 +356,111 @@ void CPURaycaster::process() {
     delete[] output;
     outport_.deactivateTarget();
     LGL_ERROR;
+
+    // timing readout
+    if (logTileTimings_.get() && numTiles > 0) {
+        double tileSum = 0.0;
+        for (size_t i=0; i<tileTimes.size(); i++)
+            tileSum += tileTimes[i];
+        double maxThreadTime = *std::max_element(threadTimes.begin(), threadTimes.end());
+
+        std::ostringstream stream;
+        stream.precision(3);
+        stream << std::fixed;
+        stream << "Frame: " << 1000.0*frameTime << " ms, " << numTiles << " tiles (" << tileSize << "x" << tileSize << ") on "
+               << numThreads << " thread(s). Tile time min/avg/max: "
+               << 1000.0 * *std::min_element(tileTimes.begin(), tileTimes.end()) << "/"
+               << 1000.0 * tileSum / numTiles << "/"
+               << 1000.0 * *std::max_element(tileTimes.begin(), tileTimes.end()) << " ms. "
+               << "Parallel efficiency: " << (frameTime > 0.0 ? 100.0 * tileSum / (frameTime * numThreads) : 100.0) << "% "
+               << "(load balance: " << (maxThreadTime > 0.0 ? 100.0 * tileSum / (maxThreadTime * numThreads) : 100.0) << "%)";
+        LINFO(stream.str());
+    }
+}
+
+template<class Sampler>
+void CPURaycaster::renderImage(const Sampler& sampler, const ivec2& imageSize,
+                               const vec4* entryBuffer, const vec4* exitBuffer, vec4* output,
+                               const RaycastingContext& context, int tileSize, int numThreads,
+                               std::vector<double>& tileTimes, std::vector<double>& threadTimes) const
+{
+    const int numTilesX = (imageSize.x + tileSize - 1) / tileSize;
+    const int numTiles = static_cast<int>(tileTimes.size());
+    const bool linear = (context.filterMode_ == GL_LINEAR);
+
+    // perform ray casting for each tile: tiles are handed out one at a time,
+    // so that threads finishing cheap (e.g., background) tiles pick up the remaining work
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads)
+    for (int tile = 0; tile < numTiles; ++tile) {
+        const double tileStart = getWallClockTime();
+
+        ivec2 llf = ivec2(tile % numTilesX, tile / numTilesX) * tileSize;
+        ivec2 urb = tgt::min(llf + ivec2(tileSize), imageSize);
+        if (linear)
+            renderTile<Sampler, true>(llf, urb, imageSize, entryBuffer, exitBuffer, output, sampler, context);
+        else
+            renderTile<Sampler, false>(llf, urb, imageSize, entryBuffer, exitBuffer, output, sampler, context);
+
+        tileTimes[tile] = getWallClockTime() - tileStart;
+        threadTimes[getThreadIndex()] += tileTimes[tile];
+    }
 }
 
-vec4 CPURaycaster::directRendering(const vec3& first, const vec3& last) {
+template<class Sampler, bool LINEAR>
+void CPURaycaster::renderTile(const ivec2& llf, const ivec2& urb, const ivec2& imageSize,
+                              const vec4* entryBuffer, const vec4* exitBuffer, vec4* output,
+                              const Sampler& sampler, const RaycastingContext& context) const
+{
+    for (int y=llf.y; y < urb.y; ++y) {
+        for (int x=llf.x; x < urb.x; ++x) {
+            vec4 gl_FragColor = vec4(0.f);
+            int p = (y * imageSize.x + x);
+
+            const vec4& frontPos = entryBuffer[p];
+            const vec4& backPos = exitBuffer[p];
 
-    tgtAssert(transferFunc_.get(), "no transfunc");
+            if ((frontPos == vec4(0.0)) && (backPos == vec4(0.0))) {
+                //background needs no raycasting
+            }
+            else {
+                //fragCoords are lying inside the boundingbox
+                gl_FragColor = directRendering<Sampler, LINEAR>(frontPos.xyz(), backPos.xyz(), sampler, context);
+            }
 
-    // retrieve intensity volume
-    const Volume* volume = volumePort_.getData()->getRepresentation<Volume>();
-    tgtAssert(volume, "no input volume");
-    tgt::svec3 volDim = volume->getDimensions();
-    tgt::vec3 volDimF = tgt::vec3((volume->getDimensions() - svec3(1)));
-
-    // retrieve gradient volume, if 2D TF is to be applied
-    const Volume* volumeGradient = 0;
-    if (intensityGradientTF_) {
-        volumeGradient = gradientVolumePort_.getData()->getRepresentation<Volume>();
-        tgtAssert(volumeGradient, "no gradient volume");
-        tgtAssert(volumeGradient->getNumChannels() >= 3, "gradient volume has less than three channels");
-        tgtAssert(volumeGradient->getDimensions() == volDim, "dimensions mismatch");
+            output[p] = gl_FragColor;
+        }
     }
+}
 
-    // use dimension with the highest resolution for calculating the sampling step size
-    float samplingStepSize = 1.f / (tgt::max(volDim) * samplingRate_.get());
+void CPURaycaster::updateTransFuncLUT() {
+    tgtAssert(transferFunc_.get(), "no transfunc");
 
-    // retrieve tf texture
     tgt::Texture* tfTexture = transferFunc_.get()->getTexture();
+    tgtAssert(tfTexture, "no tf texture");
     tfTexture->downloadTexture();
 
+    tfLUTDims_ = ivec2(tfTexture->getWidth(), intensityGradientTF_ ? tfTexture->getHeight() : 1);
+    tfLUT_.resize(tfLUTDims_.x * tfLUTDims_.y);
+
+    if (!intensityGradientTF_) {
+        for (int x=0; x < tfLUTDims_.x; ++x)
+            tfLUT_[x] = vec4(tfTexture->texel<tgt::col4>(static_cast<size_t>(x))) / 255.f;
+    }
+    else {
+        for (int y=0; y < tfLUTDims_.y; ++y)
+            for (int x=0; x < tfLUTDims_.x; ++x)
+                tfLUT_[y*tfLUTDims_.x + x] = tfTexture->texel<tgt::vec4>(static_cast<size_t>(x), static_cast<size_t>(y));
+    }
+}
+
+template<class Sampler, bool LINEAR>
+vec4 CPURaycaster::directRendering(const vec3& first, const vec3& last, const Sampler& sampler,
+                                   const RaycastingContext& context) const
+{
+    const Volume* volumeGradient = context.gradientVolume_;
+    const vec3& volDimF = context.volDimF_;
+    const float samplingStepSize = context.samplingStepSize_;
+
     // calculate ray parameters
     float tend;
     float t = 0.0f;
@@ -193,42 +477,44 @@ vec4 CPURaycaster::directRendering(const vec3& first, const vec3& last) {
         direction = normalize(direction);
     }
     
+    // ray in voxel coordinates, used for empty space skipping
+    const vec3 firstVoxel = first * volDimF;
+    const vec3 directionVoxel = direction * volDimF;
+
     // ray-casting loop
     vec4 result = vec4(0.0f);
     float depthT = -1.0f;
     bool finished = false;
     for (int loop=0; !finished && loop<255*255; ++loop) {
+        if (context.octree_) {
+            t = skipEmptySpace(firstVoxel, directionVoxel, t, context);
+            if (t > tend)
+                break;
+        }
+
         vec3 sample = first + t * direction;
-        float intensity = 0.f;
-        if (texFilterMode_.getValue() == GL_NEAREST) 
-            intensity = volume->getVoxelFloat(tgt::iround(sample*volDimF));
-        else if (texFilterMode_.getValue() == GL_LINEAR) 
-            intensity = volume->getVoxelFloatLinear(sample*volDimF);
-        else 
-            LERROR("Unknown texture filter mode");
+        float intensity = sampleVolume<LINEAR>(sampler, sample*volDimF);
 
         // no shading is applied
         vec4 color;
-        if (!intensityGradientTF_)
-            color = apply1DTF(tfTexture, intensity);
+        if (!volumeGradient)
+            color = apply1DTF(intensity);
         else {
             tgt::vec3 grad;
-            if (texFilterMode_.getValue() == GL_NEAREST) {
+            if (!LINEAR) {
                 tgt::ivec3 iSample = tgt::iround(sample*volDimF);
                 grad.x = volumeGradient->getVoxelFloat(iSample, 0);
                 grad.y = volumeGradient->getVoxelFloat(iSample, 1);
                 grad.z = volumeGradient->getVoxelFloat(iSample, 2);
             }
-            else if (texFilterMode_.getValue() == GL_LINEAR) {
+            else {
                 grad.x = volumeGradient->getVoxelFloatLinear(sample*volDimF, 0);
                 grad.y = volumeGradient->getVoxelFloatLinear(sample*volDimF, 1);
                 grad.z = volumeGradient->getVoxelFloatLinear(sample*volDimF, 2);
             }
-            else 
-                LERROR("Unknown texture filter mode");
 
             float gradMag = tgt::clamp(tgt::length(grad), 0.f, 1.f);
-            color = apply2DTF(tfTexture, intensity, gradMag);
+            color = apply2DTF(intensity, gradMag);
         }
 
         // perform compositing
@@ -249,7 +535,7 @@ vec4 CPURaycaster::directRendering(const vec3& first, const vec3& last) {
             depthT = t;
 
         // early ray termination
-        if (result.a >= 0.95f) {
+        if (result.a >= context.terminationThreshold_) {
              result.a = 1.0f;
              finished = true;
         }
@@ -267,15 +553,85 @@ vec4 CPURaycaster::directRendering(const vec3& first, const vec3& last) {
     return result;
 }
 
-vec4 CPURaycaster::apply1DTF(tgt::Texture* tfTexture, float intensity) {
-    vec4 value = vec4(tfTexture->texel<tgt::col4>(size_t(intensity * (tfTexture->getWidth()-1)))) / 255.f;
-    return value;
+void CPURaycaster::classifyOctreeNodes(const VolumeMinMaxOctree* octree) {
+    tgtAssert(octree, "no octree");
+    tgtAssert(!tfLUT_.empty(), "tf lut not initialized");
+
+    // prefix sum over the TF columns with non-zero opacity (for any gradient magnitude),
+    // so that each node can be classified in constant time
+    std::vector<int> opaquePrefix(tfLUTDims_.x + 1, 0);
+    for (int x=0; x < tfLUTDims_.x; ++x) {
+        bool opaque = false;
+        for (int y=0; y < tfLUTDims_.y && !opaque; ++y)
+            opaque = (tfLUT_[y*tfLUTDims_.x + x].a > 0.f);
+        opaquePrefix[x+1] = opaquePrefix[x] + (opaque ? 1 : 0);
+    }
+
+    emptyNodes_.resize(octree->getNumLevels());
+    for (size_t level=0; level < octree->getNumLevels(); ++level) {
+        const std::vector<tgt::vec2>& nodes = octree->getLevel(level);
+        emptyNodes_[level].resize(nodes.size());
+        for (size_t i=0; i < nodes.size(); ++i) {
+            // same bucket mapping as in apply1DTF/apply2DTF, which is monotonic in the intensity
+            int first = tgt::clamp(static_cast<int>(nodes[i].x * (tfLUTDims_.x-1)), 0, tfLUTDims_.x-1);
+            int last = tgt::clamp(static_cast<int>(nodes[i].y * (tfLUTDims_.x-1)), 0, tfLUTDims_.x-1);
+            emptyNodes_[level][i] = (opaquePrefix[last+1] - opaquePrefix[first] == 0) ? 1 : 0;
+        }
+    }
+}
+
+float CPURaycaster::skipEmptySpace(const vec3& firstVoxel, const vec3& directionVoxel, float t,
+                                   const RaycastingContext& context) const
+{
+    const VolumeMinMaxOctree* octree = context.octree_;
+    const vec3 pos = firstVoxel + t*directionVoxel;
+
+    // find leaf brick containing the sample
+    tgt::svec3 node = tgt::svec3(tgt::max(pos, vec3(0.f))) / octree->getBrickSize();
+    tgt::svec3 levelDims = octree->getLevelDimensions(0);
+    node = tgt::min(node, levelDims - tgt::svec3(1));
+    if (!emptyNodes_[0][(node.z*levelDims.y + node.y)*levelDims.x + node.x])
+        return t;
+
+    // ascend as long as the parent node is empty as well
+    size_t level = 0;
+    while (level+1 < octree->getNumLevels()) {
+        tgt::svec3 parent = node / size_t(2);
+        tgt::svec3 parentDims = octree->getLevelDimensions(level+1);
+        if (!emptyNodes_[level+1][(parent.z*parentDims.y + parent.y)*parentDims.x + parent.x])
+            break;
+        node = parent;
+        ++level;
+    }
+
+    // determine ray parameter at which the ray leaves the node
+    const float nodeSize = static_cast<float>(octree->getBrickSize() << level);
+    const vec3 llf = vec3(node) * nodeSize;
+    const vec3 urb = llf + vec3(nodeSize);
+    float tExit = std::numeric_limits<float>::max();
+    for (size_t i=0; i < 3; ++i) {
+        if (directionVoxel[i] > 0.f)
+            tExit = std::min(tExit, (urb[i] - firstVoxel[i]) / directionVoxel[i]);
+        else if (directionVoxel[i] < 0.f)
+            tExit = std::min(tExit, (llf[i] - firstVoxel[i]) / directionVoxel[i]);
+    }
+
+    // advance to the first regular sample position behind the node
+    const float step = context.samplingStepSize_;
+    if (tExit <= t)
+        return t;
+    return t + std::max(1.f, ceilf((tExit - t) / step)) * step;
+}
+
+vec4 CPURaycaster::apply1DTF(float intensity) const {
+    int x = tgt::clamp(static_cast<int>(intensity * (tfLUTDims_.x-1)), 0, tfLUTDims_.x-1);
+    return tfLUT_[x];
 }
 
-vec4 CPURaycaster::apply2DTF(tgt::Texture* tfTexture, float intensity, float gradientMagnitude) {
-    vec4 value = vec4(tfTexture->texel<tgt::vec4>(size_t(intensity * (tfTexture->getWidth()-1)),
-        size_t(gradientMagnitude * (tfTexture->getHeight()-1))));
-    return value;
+vec4 CPURaycaster::apply2DTF(float intensity, float gradientMagnitude) const {
+    int x = tgt::clamp(static_cast<int>(intensity * (tfLUTDims_.x-1)), 0, tfLUTDims_.x-1);
+    int y = tgt::clamp(static_cast<int>(gradientMagnitude * (tfLUTDims_.y-1)), 0, tfLUTDims_.y-1);
+    return tfLUT_[y*tfLUTDims_.x + x];
 }
 
 } // namespace voreen
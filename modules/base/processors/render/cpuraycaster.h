@@ -32,6 +32,10 @@
 #include "voreen/core/processors/volumeraycaster.h"
 #include "voreen/core/properties/transfuncproperty.h"
 #include "voreen/core/properties/optionproperty.h"
+#include "voreen/core/properties/intproperty.h"
+#include "voreen/core/properties/boolproperty.h"
+#include "voreen/core/properties/floatproperty.h"
+#include "voreen/core/datastructures/volume/volumeminmaxoctree.h"
 
 #include "voreen/core/ports/volumeport.h"
 
@@ -39,6 +43,14 @@ namespace voreen {
 
 /**
  * Performs a simple raycasting on the CPU.
+ *
+ * The image plane is subdivided into square tiles that are dynamically
+ * distributed among the available threads (requires OpenMP). The transfer
+ * function is downloaded only once per frame into a flat lookup table.
+ *
+ * Empty space skipping is based on the VolumeMinMaxOctree of the input
+ * volume: nodes whose intensity range is mapped to zero opacity by the
+ * transfer function are skipped by the rays.
  */
 class CPURaycaster : public VolumeRaycaster {
 public:
@@ -56,12 +68,85 @@ protected:
     virtual void process();
 
     /**
-     * Performs the actual ray casting for a single ray, 
+     * Per-frame ray casting parameters, which are shared read-only
+     * by all threads.
+     */
+    struct RaycastingContext {
+        const Volume* volume_;          ///< intensity volume
+        const Volume* gradientVolume_;  ///< gradient volume, only set for 2D TFs
+        tgt::vec3 volDimF_;             ///< volume dimensions minus one, for mapping texture coords to voxel coords
+        float samplingStepSize_;        ///< ray step size in texture coordinates
+        GLint filterMode_;              ///< GL_NEAREST or GL_LINEAR
+        const VolumeMinMaxOctree* octree_; ///< used for empty space skipping, may be null
+        float terminationThreshold_;    ///< opacity at which rays are terminated
+    };
+
+    /**
+     * Casts the rays of all tiles of the image plane in parallel.
+     * The passed sampler determines the volume type the ray casting loop
+     * is instantiated for.
+     *
+     * @param tileTimes receives the rendering time of each tile in seconds
+     * @param threadTimes receives the accumulated tile times of each thread in seconds
+     */
+    template<class Sampler>
+    void renderImage(const Sampler& sampler, const tgt::ivec2& imageSize,
+        const tgt::vec4* entryBuffer, const tgt::vec4* exitBuffer, tgt::vec4* output,
+        const RaycastingContext& context, int tileSize, int numThreads,
+        std::vector<double>& tileTimes, std::vector<double>& threadTimes) const;
+
+    /**
+     * Casts the rays of all pixels within the passed tile of the image plane.
+     *
+     * @param llf lower left corner of the tile in pixel coordinates
+     * @param urb upper right corner of the tile in pixel coordinates (exclusive)
+     */
+    template<class Sampler, bool LINEAR>
+    void renderTile(const tgt::ivec2& llf, const tgt::ivec2& urb, const tgt::ivec2& imageSize,
+        const tgt::vec4* entryBuffer, const tgt::vec4* exitBuffer, tgt::vec4* output,
+        const Sampler& sampler, const RaycastingContext& context) const;
+
+    /**
+     * Performs the actual ray casting for a single ray,
      * which determined by the passed entry and exit points.
+     *
+     * The intensity volume is accessed through the passed sampler and the
+     * filter mode is a template parameter, so that the inner loop
+     * does neither contain virtual calls nor branches on the filter mode.
+     *
+     * @note This function is called concurrently from multiple threads
+     *  and must therefore not modify the processor's state.
+     */
+    template<class Sampler, bool LINEAR>
+    tgt::vec4 directRendering(const tgt::vec3& first, const tgt::vec3& last,
+        const Sampler& sampler, const RaycastingContext& context) const;
+
+    /**
+     * Downloads the transfer function texture and copies it
+     * into the CPU lookup table tfLUT_.
+     */
+    void updateTransFuncLUT();
+
+    /**
+     * Determines for all nodes of the passed octree whether the transfer function
+     * maps their intensity range to zero opacity, and stores the result in emptyNodes_.
+     * Must be called after updateTransFuncLUT().
      */
-    virtual tgt::vec4 directRendering(const tgt::vec3& first, const tgt::vec3& last);
-    tgt::vec4 apply1DTF(tgt::Texture* tfTexture, float intensity);
-    tgt::vec4 apply2DTF(tgt::Texture* tfTexture, float intensity, float gradientMagnitude);
+    void classifyOctreeNodes(const VolumeMinMaxOctree* octree);
+
+    /**
+     * If the passed sample position lies within an empty octree node, the ray parameter
+     * of the first sample behind the largest empty node containing it is returned.
+     * Otherwise, the passed ray parameter is returned unchanged.
+     *
+     * @param firstVoxel ray entry point in voxel coordinates
+     * @param directionVoxel ray direction in voxel coordinates (per unit ray parameter)
+     */
+    float skipEmptySpace(const tgt::vec3& firstVoxel, const tgt::vec3& directionVoxel, float t,
+        const RaycastingContext& context) const;
+
+    tgt::vec4 apply1DTF(float intensity) const;
+    tgt::vec4 apply2DTF(float intensity, float gradientMagnitude) const;
 
     VolumePort volumePort_;
     VolumePort gradientVolumePort_;
@@ -71,8 +156,21 @@ protected:
 
     TransFuncProperty transferFunc_;   ///< the property that controls the transfer-function
     IntOptionProperty texFilterMode_;  ///< texture filtering mode to use for volume access
+    IntProperty numThreads_;           ///< number of threads to use, 0 selects all available cores
+    IntProperty tileSize_;             ///< edge length of the image tiles that are distributed among the threads
+    BoolProperty logTileTimings_;      ///< if true, per-tile timing statistics are logged after each frame
+    BoolProperty skipEmptySpace_;      ///< enables empty space skipping based on the volume's min/max octree
+    FloatProperty terminationThreshold_; ///< opacity threshold for early ray termination
 
     bool intensityGradientTF_;
+
+    std::vector<tgt::vec4> tfLUT_;     ///< CPU copy of the transfer function texture, normalized to [0,1]
+    tgt::ivec2 tfLUTDims_;             ///< dimensions of the lookup table (height is 1 for 1D TFs)
+
+    /// per octree level: for each node, whether it is mapped to zero opacity by the current TF
+    std::vector<std::vector<uint8_t> > emptyNodes_;
+
+    static const std::string loggerCat_;
 };
 
 } // namespace voreen
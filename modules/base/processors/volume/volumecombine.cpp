@@ -29,6 +29,7 @@
 #include "volumecombine.h"
 
 #include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/voxelexpression.h"
 #include "voreen/core/datastructures/volume/operators/volumeoperatorresize.h"
 #include "voreen/core/datastructures/geometry/meshlistgeometry.h"
 
@@ -128,10 +129,7 @@ void VolumeCombine::process() {
 
 
     // optimized combination for volumes that share a common grid in world-space
-    if (firstVolume->getDimensions() == secondVolume->getDimensions() &&
-        firstVolume->getSpacing() == secondVolume->getSpacing()     &&
-        firstVolume->getOffset() == secondVolume->getOffset()     &&
-        firstVolume->getPhysicalToWorldMatrix() == secondVolume->getPhysicalToWorldMatrix()) {
+    if (VoxelExpression::onCommonGrid(firstVolume, secondVolume)) {
 
         try {
             if (referenceVolume_.isSelected("first"))
@@ -167,11 +165,6 @@ void VolumeCombine::process() {
     outport_.setData(combinedVolume);
 }
 
-inline bool withinRange(const tgt::vec3& pos, const tgt::vec3& llf, const tgt::vec3& urb) {
-    return tgt::hand(tgt::greaterThanEqual(pos, llf)) &&
-           tgt::hand(tgt::lessThanEqual(   pos, urb));
-}
-
 void VolumeCombine::combineVolumes(VolumeHandle* combinedVolume, const VolumeHandleBase* firstVolume,
                                    const VolumeHandleBase* secondVolume, CombineOperation operation) const {
 
@@ -179,126 +172,34 @@ void VolumeCombine::combineVolumes(VolumeHandle* combinedVolume, const VolumeHan
 
     // compute transformation from voxel coordinates of combined volume
     // to voxel coords of input volumes
-    tgt::mat4 combinedToFirst = computeConversionMatrix(combinedVolume, firstVolume);
-    tgt::mat4 combinedToSecond = computeConversionMatrix(combinedVolume, secondVolume);
-
-    LDEBUG("Voxel-to-world (First): " << combinedToFirst);
-    LDEBUG("Voxel-to-world (Second) " << combinedToSecond);
-
-    // determine which volume is the other (non reference) one
-    const VolumeHandleBase* otherVolume = referenceVolume_.isSelected("first") ? secondVolume : firstVolume;
-
-    //
-    // voxel-wise combination
-    //
-    tgt::vec3 dimFirst(firstVolume->getDimensions() - svec3(1));
-    tgt::vec3 dimSecond(secondVolume->getDimensions() - svec3(1));
-    const float c = factorC_.get();
-    const float d = factorD_.get();
-    const bool nearestFiltering = filteringMode_.isSelected("nearest");
-    const bool linearFiltering = filteringMode_.isSelected("linear");
-    const bool cubicFiltering = filteringMode_.isSelected("cubic");
-
-    const Volume* v1 = firstVolume->getRepresentation<Volume>();
-    const Volume* v2 = secondVolume->getRepresentation<Volume>();
-    Volume* vc = combinedVolume->getWritableRepresentation<Volume>();
-
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS(pos, tgt::ivec3(0), combinedVolume->getDimensions(), progressBar_) {
-        for (size_t referenceChannel = 0; referenceChannel < combinedVolume->getNumChannels(); ++referenceChannel) {
-            size_t otherChannel = (combinedVolume->getNumChannels() == otherVolume->getNumChannels()) ? referenceChannel : 0;
-
-            // transform sampling pos to coordinate systems of input volumes
-            tgt::vec3 posFirst = combinedToFirst*tgt::vec3(pos);
-            tgt::vec3 posSecond = combinedToSecond*tgt::vec3(pos);
-
-            // sample input volumes, if transformed voxel position lies inside respective volume
-            float valFirst = 0.f;
-            float valSecond = 0.f;
-            if (nearestFiltering) {
-                if (withinRange(posFirst, tgt::vec3::zero, dimFirst))
-                    valFirst = v1->getVoxelFloat(tgt::iround(posFirst), referenceChannel);
-                if (withinRange(posSecond, tgt::vec3::zero, dimSecond))
-                    valSecond = v2->getVoxelFloat(tgt::iround(posSecond), otherChannel);
-            }
-            else if (linearFiltering) {
-                if (withinRange(posFirst, tgt::vec3::zero, dimFirst))
-                    valFirst = v1->getVoxelFloatLinear(posFirst, referenceChannel);
-                if (withinRange(posSecond, tgt::vec3::zero, dimSecond))
-                    valSecond = v2->getVoxelFloatLinear(posSecond, otherChannel);
-
-            }
-            else if (cubicFiltering) {
-                if (withinRange(posFirst, tgt::vec3::zero, dimFirst))
-                    valFirst = v1->getVoxelFloatCubic(posFirst, referenceChannel);
-                if (withinRange(posSecond, tgt::vec3::zero, dimSecond))
-                    valSecond = v2->getVoxelFloatCubic(posSecond, otherChannel);
-            }
-            else {
-                LERROR("Unknown filter mode: " << filteringMode_.get());
-                return;
-            }
-
-            // apply operation to sampled values (note: a switch-block within a volume traversal loop
-            // should normally be avoided, however in this case the main operations are way more expensive)
-            float result = 0.f;
-            switch (operation) {
-                case OP_MAX:
-                    result = std::max(valFirst, valSecond);
-                    break;
-                case OP_MIN:
-                    result = std::min(valFirst, valSecond);
-                    break;
-                case OP_ADD:
-                    result = valFirst + valSecond;
-                    break;
-                case OP_A_MINUS_B:
-                    result = valFirst - valSecond;
-                    break;
-                case OP_B_MINUS_A:
-                    result = valSecond - valFirst;
-                    break;
-                case OP_MULT:
-                    result = valFirst * valSecond;
-                    break;
-                case OP_AVG:
-                    result = (valFirst + valSecond) / 2.f;
-                    break;
-                case OP_WEIGHTED_SUM:
-                    result = c*valFirst + (1.f-c)*valSecond;
-                    break;
-                case OP_WEIGHTED_SUM_2P:
-                    result = c*valFirst + d*valSecond;
-                    break;
-                case OP_BLEND:
-                    result = valFirst + valSecond*(1.f - valFirst);
-                    break;
-                case OP_MASK_A_BY_B:
-                    result = (valSecond > 0.f) ? valFirst : 0.f;
-                    break;
-                case OP_MASK_B_BY_A:
-                    result = (valFirst > 0.f) ? valSecond : 0.f;
-                    break;
-                case OP_PRIORITY_FIRST:
-                    result = (valFirst > 0.f) ? valFirst : valSecond;
-                    break;
-                case OP_PRIORITY_SECOND:
-                    result = (valSecond > 0.f) ? valSecond : valFirst;
-                    break;
-                case OP_TAKE_FIRST:
-                    result = valFirst;
-                    break;
-                case OP_TAKE_SECOND:
-                    result = valSecond;
-                    break;
-                default:
-                    LERROR("Unknown operation: " << combineFunction_.get());
-                    return;
-            }
-
-            // assign clamped result to combined volume
-            vc->setVoxelFloat(tgt::clamp(result, 0.f, 1.f), pos, referenceChannel);
-        }
-    } // VRN_FOR_EACH_VOXEL_WITH_PROGRESS
+    std::vector<tgt::mat4> combinedToInput;
+    combinedToInput.push_back(computeConversionMatrix(combinedVolume, firstVolume));
+    combinedToInput.push_back(computeConversionMatrix(combinedVolume, secondVolume));
+
+    LDEBUG("Voxel-to-world (First): " << combinedToInput[0]);
+    LDEBUG("Voxel-to-world (Second) " << combinedToInput[1]);
+
+    VoxelExpression::Filtering filtering;
+    if (filteringMode_.isSelected("nearest"))
+        filtering = VoxelExpression::FILTER_NEAREST;
+    else if (filteringMode_.isSelected("linear"))
+        filtering = VoxelExpression::FILTER_LINEAR;
+    else if (filteringMode_.isSelected("cubic"))
+        filtering = VoxelExpression::FILTER_CUBIC;
+    else {
+        LERROR("Unknown filter mode: " << filteringMode_.get());
+        return;
+    }
+
+    // the combined values are clamped to [0,1]
+    VoxelExpression expression("clamp(" + getCombineExpression(operation) + ", 0, 1)");
+    expression.setParameter("c", factorC_.get());
+    expression.setParameter("d", factorD_.get());
+
+    std::vector<const Volume*> inputs;
+    inputs.push_back(firstVolume->getRepresentation<Volume>());
+    inputs.push_back(secondVolume->getRepresentation<Volume>());
+    expression.apply(inputs, combinedToInput, combinedVolume->getWritableRepresentation<Volume>(), filtering, progressBar_);
 }
 
 void VolumeCombine::combineVolumesOnCommonGrid(VolumeHandle* combinedVolume, const VolumeHandleBase* firstVolume,
@@ -307,82 +208,55 @@ void VolumeCombine::combineVolumesOnCommonGrid(VolumeHandle* combinedVolume, con
     tgtAssert(combinedVolume->getDimensions() == firstVolume->getDimensions() &&
               combinedVolume->getDimensions() == secondVolume->getDimensions(), "Volume dimensions mismatch");
 
-    // determine which volume is the other (non reference) one
-    const VolumeHandleBase* otherVolume = referenceVolume_.isSelected("first") ? secondVolume : firstVolume;
-
-    const float c = factorC_.get();
-    const float d = factorD_.get();
-    const Volume* v1 = firstVolume->getRepresentation<Volume>();
-    const Volume* v2 = secondVolume->getRepresentation<Volume>();
-    Volume* vc = combinedVolume->getWritableRepresentation<Volume>();
-
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS(pos, tgt::ivec3(0), combinedVolume->getDimensions(), progressBar_) {
-        for (size_t referenceChannel = 0; referenceChannel < combinedVolume->getNumChannels(); ++referenceChannel) {
-            size_t otherChannel = (combinedVolume->getNumChannels() == otherVolume->getNumChannels()) ? referenceChannel : 0;
-            float valFirst = v1->getVoxelFloat(pos, referenceChannel);
-            float valSecond = v2->getVoxelFloat(pos, otherChannel);
-
-            // apply operation to input voxel values
-            float result = 0.f;
-            switch (operation) {
-                case OP_MAX:
-                    result = std::max(valFirst, valSecond);
-                    break;
-                case OP_MIN:
-                    result = std::min(valFirst, valSecond);
-                    break;
-                case OP_ADD:
-                    result = valFirst + valSecond;
-                    break;
-                case OP_A_MINUS_B:
-                    result = valFirst - valSecond;
-                    break;
-                case OP_B_MINUS_A:
-                    result = valSecond - valFirst;
-                    break;
-                case OP_MULT:
-                    result = valFirst * valSecond;
-                    break;
-                case OP_AVG:
-                    result = (valFirst + valSecond) / 2.f;
-                    break;
-                case OP_WEIGHTED_SUM:
-                    result = c*valFirst + (1.f-c)*valSecond;
-                    break;
-                case OP_WEIGHTED_SUM_2P:
-                    result = c*valFirst + d*valSecond;
-                    break;
-                case OP_BLEND:
-                    result = valFirst + valSecond*(1.f - valFirst);
-                    break;
-                case OP_MASK_A_BY_B:
-                    result = (valSecond > 0.f) ? valFirst : 0.f;
-                    break;
-                case OP_MASK_B_BY_A:
-                    result = (valFirst > 0.f) ? valSecond : 0.f;
-                    break;
-                case OP_PRIORITY_FIRST:
-                    result = (valFirst > 0.f) ? valFirst : valSecond;
-                    break;
-                case OP_PRIORITY_SECOND:
-                    result = (valSecond > 0.f) ? valSecond : valFirst;
-                    break;
-                case OP_TAKE_FIRST:
-                    result = valFirst;
-                    break;
-                case OP_TAKE_SECOND:
-                    result = valSecond;
-                    break;
-                default:
-                    LERROR("Unknown operation: " << combineFunction_.get());
-                    return;
-            }
-
-            // assign clamped result to combined volume
-            //vc->setVoxelFloat(tgt::clamp(result, 0.f, 1.f), pos, referenceChannel); //FIXME: clamp prevents working with float volumes
-            vc->setVoxelFloat(result, pos, referenceChannel); //FIXME: clamp prevents working with float volumes
-        } // for referenceChannel
-    } // VRN_FOR_EACH_VOXEL_WITH_PROGRESS
+    // in contrast to the resampling combination, the result is not clamped in order to support float volumes
+    VoxelExpression expression(getCombineExpression(operation));
+    expression.setParameter("c", factorC_.get());
+    expression.setParameter("d", factorD_.get());
+
+    std::vector<const Volume*> inputs;
+    inputs.push_back(firstVolume->getRepresentation<Volume>());
+    inputs.push_back(secondVolume->getRepresentation<Volume>());
+    expression.apply(inputs, combinedVolume->getWritableRepresentation<Volume>(), progressBar_);
+}
+
+std::string VolumeCombine::getCombineExpression(CombineOperation operation) {
+    switch (operation) {
+        case OP_MAX:
+            return "max(A, B)";
+        case OP_MIN:
+            return "min(A, B)";
+        case OP_ADD:
+            return "A + B";
+        case OP_A_MINUS_B:
+            return "A - B";
+        case OP_B_MINUS_A:
+            return "B - A";
+        case OP_MULT:
+            return "A * B";
+        case OP_AVG:
+            return "(A + B) / 2";
+        case OP_WEIGHTED_SUM:
+            return "c*A + (1-c)*B";
+        case OP_WEIGHTED_SUM_2P:
+            return "c*A + d*B";
+        case OP_BLEND:
+            return "A + B*(1 - A)";
+        case OP_MASK_A_BY_B:
+            return "B > 0 ? A : 0";
+        case OP_MASK_B_BY_A:
+            return "A > 0 ? B : 0";
+        case OP_PRIORITY_FIRST:
+            return "A > 0 ? A : B";
+        case OP_PRIORITY_SECOND:
+            return "B > 0 ? B : A";
+        case OP_TAKE_FIRST:
+            return "A";
+        case OP_TAKE_SECOND:
+            return "B";
+        default:
+            tgtAssert(false, "unknown combine operation");
+            return "A";
+    }
 }
 
 VolumeHandle* VolumeCombine::createCombinedVolume(const VolumeHandleBase* refVolume, const VolumeHandleBase* secondVolume) const {
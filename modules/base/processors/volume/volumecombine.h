@@ -85,6 +85,9 @@ private:
     void combineVolumesOnCommonGrid(VolumeHandle* combinedVolume, const VolumeHandleBase* firstVolume,
         const VolumeHandleBase* secondVolume, CombineOperation operation) const;
 
+    /// Returns the voxel expression computing the passed operation of the inputs A and B.
+    static std::string getCombineExpression(CombineOperation operation);
+
     /// Creates a combined (empty) volume from the two input volumes in world space,
     /// or 0 in case the combined volume could not be created due to bad allocation.
     VolumeHandle* createCombinedVolume(const VolumeHandleBase* refVolume, const VolumeHandleBase* secondVolume) const;
@@ -29,21 +29,37 @@
 #include "volumedistancetransform.h"
 #include "voreen/core/datastructures/volume/volume.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
-#include "voreen/core/datastructures/volume/volumeoperator.h"
+#include "voreen/core/datastructures/volume/distancetransform.h"
 
 namespace voreen {
 
+const std::string VolumeDistanceTransform::loggerCat_("voreen.VolumeDistanceTransform");
+
 VolumeDistanceTransform::VolumeDistanceTransform()
     : CachingVolumeProcessor()
     , inport_(Port::INPORT, "volumehandle.input")
     , outport_(Port::OUTPORT, "volumehandle.output", 0)
-
+    , outputType_("outputType", "Output")
+    , signedDistance_("signedDistance", "Signed Distance", false)
+    , threshold_("threshold", "Foreground Threshold", 0.f, 0.f, 1.f)
+    , result_(0)
 {
     addPort(inport_);
     addPort(outport_);
+
+    outputType_.addOption("distance", "Euclidean distance (float)");
+    outputType_.addOption("squared", "Squared voxel distance (uint32)");
+    outputType_.onChange(CallMemberAction<VolumeDistanceTransform>(this, &VolumeDistanceTransform::adjustPropertyVisibilities));
+    addProperty(outputType_);
+    addProperty(signedDistance_);
+    addProperty(threshold_);
+
+    adjustPropertyVisibilities();
 }
 
-VolumeDistanceTransform::~VolumeDistanceTransform() {}
+VolumeDistanceTransform::~VolumeDistanceTransform() {
+    delete result_;
+}
 
 std::string VolumeDistanceTransform::getCategory() const {
     return "Volume Processing";
@@ -54,119 +70,59 @@ std::string VolumeDistanceTransform::getClassName() const {
 }
 
 Processor::CodeState VolumeDistanceTransform::getCodeState() const {
-    return CODE_STATE_EXPERIMENTAL;
+    return CODE_STATE_TESTING;
 }
 
 Processor* VolumeDistanceTransform::create() const {
     return new VolumeDistanceTransform();
 }
 
-void VolumeDistanceTransform::process() {
-    distanceTransform();
+bool VolumeDistanceTransform::isThreadSafe() const {
+    return true;
 }
 
-// private methods
-//
+void VolumeDistanceTransform::process() {
+    computeResults();
+    publishResults();
+}
 
-void VolumeDistanceTransform::distanceTransform() {
+void VolumeDistanceTransform::computeResults() {
+    // may run on a worker thread: the result and all messages are kept until publishResults()
     tgtAssert(inport_.hasData(), "Inport has not data");
+    delete result_;
+    result_ = 0;
+    errorMessage_.clear();
 
-    VolumeUInt16* v = 0;
     const VolumeHandleBase* handle = inport_.getData();
-    const Volume* vol = inport_.getData()->getRepresentation<Volume>();
-
-    if (!dynamic_cast<const VolumeUInt16*>(vol)) {
-        v = new VolumeUInt16(vol->getDimensions());
-        for (size_t z=0; z<v->getDimensions().z ; z++) {
-            for (size_t x=0; x<v->getDimensions().x ; x++)
-                for (size_t y=0 ;y<v->getDimensions().y ; y++)
-                    if (vol->getVoxelFloat(x,y,z) > 0.5) {
-                        v->voxel(x,y,z) = 65535;
-                    }
-                    else
-                        v->voxel(x,y,z) = 0;
-        }
-        //LWARNING("Currently only 16 bit volumes supported.");
-        //return;
+    const Volume* vol = handle->getRepresentation<Volume>();
+    if (!vol) {
+        errorMessage_ = "No volume representation available";
+        return;
     }
-    else {
-        v = dynamic_cast<VolumeUInt16*>(inport_.getData()->getRepresentation<Volume>()->clone());
-    }
-
-    uint16_t val = 65535;
-    uint16_t dist = 0;
-
-    for (size_t z=1; z<v->getDimensions().z-1 ; z++){
-        for (size_t x=1; x<v->getDimensions().x-1 ; x++)
-            for (size_t y=1 ;y<v->getDimensions().y-1 ; y++)
-                if (v->voxel(x,y,z) > 0) {
-
-                    dist = 0;
-                    val =  255;
-
-                    if (v->voxel(x-1,y,z) + 1 < val + dist)         {   val = v->voxel(x-1,y,z);  dist = 3; }
-                    if (v->voxel(x,y-1,z) + 3 < val + dist)         {   val = v->voxel(x,y-1,z);  dist = 3; }
-                    if (v->voxel(x-1,y-1,z) + 4 < val + dist )      {   val = v->voxel(x-1,y-1,z); dist = 4; }
-                    if (v->voxel(x+1,y-1,z) + 4 < val + dist )      {   val = v->voxel(x+1,y-1,z); dist = 4; }
-                    if (v->voxel(x,y,z-1) + 3 < val + dist)         {   val = v->voxel(x,y,z-1);  dist = 3; }
-
-                    if (v->voxel(x-1,y,z-1) + 4  < val + dist){ val = v->voxel(x-1,y,z-1); dist = 4; }
-                    if (v->voxel(x,y-1,z-1) + 4  < val + dist){ val = v->voxel(x,y-1,z-1); dist = 4; }
 
-                    if (v->voxel(x-1,y,z+1) + 4  < val + dist){ val = v->voxel(x-1,y,z+1); dist = 4; }
-                    if (v->voxel(x,y-1,z+1) + 4  < val + dist){ val = v->voxel(x,y-1,z+1); dist = 4; }
+    // voxels above the threshold are foreground, the distance is computed to the nearest background voxel
+    Volume* result = 0;
+    if (outputType_.isSelected("squared"))
+        result = DistanceTransform::computeSquaredDistances(vol, threshold_.get(), progressBar_);
+    else
+        result = DistanceTransform::computeDistances(vol, threshold_.get(), handle->getSpacing(), signedDistance_.get(), progressBar_);
 
+    result_ = new VolumeHandle(result, handle);
+}
 
-                    if (v->voxel(x-1,y-1,z+1) + 5 < val + dist){ val = v->voxel(x-1,y-1,z+1); dist = 5; }
-                    if (v->voxel(x-1,y-1,z-1) + 5 < val + dist){ val = v->voxel(x-1,y-1,z-1); dist = 5; }
-
-                    if (v->voxel(x+1,y-1,z-1) + 5 < val + dist){ val = v->voxel(x+1,y-1,z-1); dist = 5; }
-                    if (v->voxel(x+1,y-1,z+1) + 5 < val + dist){ val = v->voxel(x+1,y-1,z+1); dist = 5; }
-
-                    v->voxel(x,y,z) = val + dist;
-                }
-    }
-
-    for (size_t z=v->getDimensions().z-2; z>2; z--){
-        for (size_t x=v->getDimensions().x-2; x>2; x--)
-            for (size_t y=v->getDimensions().y-2; y>2; y--)
-                if (v->voxel(x,y,z) > 0) {
-                    dist = 0;
-                    val = v->voxel(x,y,z);
-
-                    if (v->voxel(x+1,y,z) + 3 < val + dist)          { val = v->voxel(x+1,y,z); dist = 3; }
-                    if (v->voxel(x,y+1,z) + 3 < val + dist)          { val = v->voxel(x,y+1,z); dist = 3; }
-                    if (v->voxel(x+1,y+1,z) + 4 < val + dist)        { val = v->voxel(x+1,y+1,z); dist = 4; }
-                    if (v->voxel(x,y,z+1) + 3  < val + dist)         { val = v->voxel(x,y,z+1); dist = 3; }
-
-                    if (v->voxel(x-1,y+1,z) + 4 < val + dist){ val = v->voxel(x-1,y+1,z); dist = 4; }
-                    if (v->voxel(x-1,y+1,z+1) + 5 < val + dist){ val = v->voxel(x-1,y+1,z+1); dist = 5; }
-                    if (v->voxel(x-1,y+1,z-1) + 5 < val + dist){ val = v->voxel(x-1,y+1,z-1); dist = 5; }
-
-                    if (v->voxel(x+1,y,z+1) + 4 < val + dist){ val = v->voxel(x+1,y,z+1); dist = 4; }
-                    if (v->voxel(x,y+1,z+1) + 4 < val + dist){ val = v->voxel(x,y+1,z+1); dist = 4; }
-                    if (v->voxel(x+1,y+1,z+1) + 5 < val + dist){ val = v->voxel(x+1,y+1,z+1); dist = 5; }
-
-                    if (v->voxel(x+1,y,z-1) + 4 < val + dist){ val = v->voxel(x+1,y,z-1); dist = 4; }
-                    if (v->voxel(x,y+1,z-1) + 4 < val + dist){ val = v->voxel(x,y,z-1); dist = 4; }
-                    if (v->voxel(x+1,y+1,z-1)+ 5 < val + dist){ val = v->voxel(x+1,y+1,z-1); dist = 5; }
-
-                    if ((val + dist) <  v->voxel(x,y,z)) v->voxel(x,y,z) =  val + dist;
-
-                }
+void VolumeDistanceTransform::publishResults() {
+    if (!errorMessage_.empty())
+        LERROR(errorMessage_);
 
-    }
+    outport_.setData(result_);
+    result_ = 0;
+}
 
-    //border cleaning, it was not transformed by distance mapping, property of the algorithm
-    for (size_t x =0; x< v->getDimensions().x;x++)
-        for (size_t y =0; y< v->getDimensions().y;y++)
-            for (size_t z =0; z< v->getDimensions().z;z++){
-                if ( (x < 3) || (x > v->getDimensions().x-3) || (y < 3) || (y > v->getDimensions().y-3)
-                        || (z < 3) || (z > v->getDimensions().z-3))
-                   v->voxel(x,y,z) = 65535;
+// private methods
+//
 
-            }
-    outport_.setData(new VolumeHandle(v, handle));
+void VolumeDistanceTransform::adjustPropertyVisibilities() {
+    signedDistance_.setVisible(outputType_.isSelected("distance"));
 }
 
 }   // namespace
@@ -32,6 +32,8 @@
 #include <string>
 #include "voreen/core/processors/volumeprocessor.h"
 #include "voreen/core/properties/boolproperty.h"
+#include "voreen/core/properties/floatproperty.h"
+#include "voreen/core/properties/optionproperty.h"
 
 
 namespace voreen {
@@ -47,16 +49,28 @@ public:
     virtual std::string getClassName() const;
     virtual Processor::CodeState getCodeState() const;
     virtual Processor* create() const;
+    virtual bool isThreadSafe() const;
 
 protected:
     virtual void process();
+    virtual void computeResults();
+    virtual void publishResults();
 
 private:
-    void distanceTransform();
+    void adjustPropertyVisibilities();
 
 private:
     VolumePort inport_;
     VolumePort outport_;
+
+    StringOptionProperty outputType_;
+    BoolProperty signedDistance_;
+    FloatProperty threshold_;
+
+    VolumeHandle* result_;          ///< computed by computeResults(), assigned to the outport by publishResults()
+    std::string errorMessage_;      ///< logged by publishResults()
+
+    static const std::string loggerCat_;
 };
 
 }   //namespace
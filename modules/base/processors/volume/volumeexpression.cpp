@@ -0,0 +1,211 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "volumeexpression.h"
+
+#include "voreen/core/datastructures/volume/volumefactory.h"
+
+#include <sstream>
+
+namespace voreen {
+
+const std::string VolumeExpression::loggerCat_("voreen.base.VolumeExpression");
+
+VolumeExpression::VolumeExpression()
+    : CachingVolumeProcessor()
+    , inportA_(Port::INPORT, "volume.a")
+    , inportB_(Port::INPORT, "volume.b")
+    , inportC_(Port::INPORT, "volume.c")
+    , inportD_(Port::INPORT, "volume.d")
+    , outport_(Port::OUTPORT, "outport", true)
+    , enableProcessing_("enabled", "Enable", true)
+    , expressionProp_("expression", "Expression", "A")
+    , parameterC_("parameterC", "Parameter c", 0.5f, -10.f, 10.f)
+    , parameterD_("parameterD", "Parameter d", 0.5f, -10.f, 10.f)
+    , outputFormat_("outputFormat", "Output Format")
+    , filteringMode_("filteringMode", "Filtering")
+    , expressionValid_(true)
+{
+    addPort(inportA_);
+    addPort(inportB_);
+    addPort(inportC_);
+    addPort(inportD_);
+    addPort(outport_);
+
+    outputFormat_.addOption("input", "Same as A");
+    outputFormat_.addOption("uint8", "uint8");
+    outputFormat_.addOption("uint16", "uint16");
+    outputFormat_.addOption("float", "float");
+
+    filteringMode_.addOption("nearest", "Nearest");
+    filteringMode_.addOption("linear",  "Linear");
+    filteringMode_.addOption("cubic",   "Cubic");
+    filteringMode_.set("linear");
+
+    expressionProp_.onChange(CallMemberAction<VolumeExpression>(this, &VolumeExpression::compileExpression));
+    parameterC_.setTracking(false);
+    parameterD_.setTracking(false);
+
+    addProperty(enableProcessing_);
+    addProperty(expressionProp_);
+    addProperty(parameterC_);
+    addProperty(parameterD_);
+    addProperty(outputFormat_);
+    addProperty(filteringMode_);
+
+    compileExpression();
+    setExpensiveComputationStatus(COMPUTATION_STATUS_PROGRESSBAR);
+}
+
+VolumeExpression::~VolumeExpression() {}
+
+Processor* VolumeExpression::create() const {
+    return new VolumeExpression();
+}
+
+bool VolumeExpression::isReady() const {
+    if (!isInitialized() || !outport_.isReady() || !inportA_.isReady())
+        return false;
+
+    const VolumePort* inports[] = { &inportA_, &inportB_, &inportC_, &inportD_ };
+    for (size_t i = 1; i < VoxelExpression::MAX_INPUTS; i++) {
+        if (expression_.usesInput(i) && !inports[i]->isReady())
+            return false;
+    }
+    return true;
+}
+
+void VolumeExpression::compileExpression() {
+    try {
+        expression_.compile(expressionProp_.get());
+        expressionValid_ = true;
+    }
+    catch (const VoreenException& e) {
+        LERROR(e.what());
+        expressionValid_ = false;
+    }
+}
+
+void VolumeExpression::process() {
+    tgtAssert(inportA_.getData() && inportA_.getData()->getRepresentation<Volume>(), "No input volume");
+
+    if (!enableProcessing_.get()) {
+        outport_.setData(const_cast<VolumeHandleBase*>(inportA_.getData()), false);
+        return;
+    }
+    if (!expressionValid_) {
+        outport_.setData(0);
+        return;
+    }
+
+    const VolumePort* inports[] = { &inportA_, &inportB_, &inportC_, &inportD_ };
+    const VolumeHandleBase* reference = inportA_.getData();
+    std::vector<const VolumeHandleBase*> inputs(expression_.getNumInputs(), static_cast<const VolumeHandleBase*>(0));
+    std::vector<const Volume*> inputVolumes(inputs.size(), static_cast<const Volume*>(0));
+    bool commonGrid = true;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!expression_.usesInput(i))
+            continue;
+        inputs[i] = inports[i]->getData();
+        inputVolumes[i] = inputs[i]->getRepresentation<Volume>();
+        if (!inputVolumes[i]) {
+            LERROR("No volume data for input " << static_cast<char>('A' + i));
+            outport_.setData(0);
+            return;
+        }
+        commonGrid &= VoxelExpression::onCommonGrid(reference, inputs[i]);
+    }
+
+    VolumeHandle* outputVolume = createOutputVolume(reference);
+    if (!outputVolume) {
+        outport_.setData(0);
+        return;
+    }
+
+    expression_.setParameter("c", parameterC_.get());
+    expression_.setParameter("d", parameterD_.get());
+    Volume* output = outputVolume->getWritableRepresentation<Volume>();
+
+    if (commonGrid) {
+        LINFO("Evaluating '" << expression_.getExpression() << "' on common grid with dimensions "
+            << reference->getDimensions() << "...");
+        expression_.apply(inputVolumes, output, progressBar_);
+    }
+    else {
+        VoxelExpression::Filtering filtering = VoxelExpression::FILTER_LINEAR;
+        if (filteringMode_.isSelected("nearest"))
+            filtering = VoxelExpression::FILTER_NEAREST;
+        else if (filteringMode_.isSelected("cubic"))
+            filtering = VoxelExpression::FILTER_CUBIC;
+
+        std::vector<tgt::mat4> outputToInput(inputs.size(), tgt::mat4::identity);
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (inputs[i])
+                outputToInput[i] = computeConversionMatrix(outputVolume, inputs[i]);
+        }
+        LINFO("Evaluating '" << expression_.getExpression() << "' with " << filteringMode_.get()
+            << " resampling to dimensions " << reference->getDimensions() << "...");
+        expression_.apply(inputVolumes, outputToInput, output, filtering, progressBar_);
+    }
+
+    outport_.setData(outputVolume);
+}
+
+VolumeHandle* VolumeExpression::createOutputVolume(const VolumeHandleBase* reference) const {
+    const Volume* referenceVolume = reference->getRepresentation<Volume>();
+    const size_t numChannels = referenceVolume->getNumChannels();
+
+    Volume* output = 0;
+    try {
+        if (outputFormat_.isSelected("input")) {
+            output = referenceVolume->createNew(referenceVolume->getDimensions(), VolumeRepresentation::VolumeBorders(), true);
+        }
+        else {
+            std::string format = outputFormat_.get();
+            if (numChannels > 1) {
+                std::ostringstream stream;
+                stream << "Vector" << numChannels << "(" << format << ")";
+                format = stream.str();
+            }
+            output = VolumeFactory().create(format, referenceVolume->getDimensions());
+        }
+    }
+    catch (const std::bad_alloc&) {
+        LERROR("Failed to create output volume with dimensions " << referenceVolume->getDimensions()
+            << " : bad allocation");
+        return 0;
+    }
+    if (!output) {
+        LERROR("Failed to create output volume of format '" << outputFormat_.get() << "'");
+        return 0;
+    }
+
+    return new VolumeHandle(output, reference);
+}
+
+} // namespace
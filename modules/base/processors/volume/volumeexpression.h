@@ -0,0 +1,96 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMEEXPRESSION_H
+#define VRN_VOLUMEEXPRESSION_H
+
+#include "voreen/core/processors/volumeprocessor.h"
+#include "voreen/core/datastructures/volume/voxelexpression.h"
+#include "voreen/core/properties/boolproperty.h"
+#include "voreen/core/properties/floatproperty.h"
+#include "voreen/core/properties/optionproperty.h"
+#include "voreen/core/properties/stringproperty.h"
+
+namespace voreen {
+
+/**
+ * Computes a volume by evaluating a voxel-wise arithmetic expression
+ * over up to four input volumes, which are referenced as A, B, C and D.
+ * The result has the grid of the first input. The other inputs are resampled
+ * unless they share the grid of the first input.
+ *
+ * Since the whole expression is evaluated in a single pass, it can replace chains
+ * of voxel-wise processors, e.g. "B > 0 ? 1 - A : 0" for combination and inversion.
+ *
+ * @see VoxelExpression
+ */
+class VolumeExpression : public CachingVolumeProcessor {
+public:
+    VolumeExpression();
+    ~VolumeExpression();
+    virtual Processor* create() const;
+
+    virtual std::string getClassName() const      { return "VolumeExpression";  }
+    virtual std::string getCategory() const       { return "Volume Processing"; }
+    virtual CodeState getCodeState() const        { return CODE_STATE_TESTING;  }
+
+    /// Only the inputs referenced by the expression have to be connected.
+    virtual bool isReady() const;
+
+protected:
+    virtual void process();
+
+private:
+    /// Compiles the expression property, logging syntax errors.
+    void compileExpression();
+
+    /// Creates the (empty) output volume on the grid of the first input.
+    VolumeHandle* createOutputVolume(const VolumeHandleBase* reference) const;
+
+    VolumePort inportA_;
+    VolumePort inportB_;
+    VolumePort inportC_;
+    VolumePort inportD_;
+    VolumePort outport_;
+
+    BoolProperty enableProcessing_;
+    StringProperty expressionProp_;
+    FloatProperty parameterC_;
+    FloatProperty parameterD_;
+    StringOptionProperty outputFormat_;
+    StringOptionProperty filteringMode_;
+
+    VoxelExpression expression_;
+    bool expressionValid_;
+
+    static const std::string loggerCat_; ///< category used in logging
+};
+
+} // namespace
+
+#endif // VRN_VOLUMEEXPRESSION_H
@@ -46,6 +46,8 @@ VolumeFiltering::VolumeFiltering()
     , filteringOperator_("filteringOperator", "Operator")
     , kernelSize_("kernelSize", "Kernel Size")
     , forceUpdate_(true)
+    , result_(0)
+    , resultComputed_(false)
 {
     addPort(inport_);
     addPort(outport_);
@@ -70,6 +72,7 @@ VolumeFiltering::VolumeFiltering()
 }
 
 VolumeFiltering::~VolumeFiltering() {
+    delete result_;
 }
 
 Processor* VolumeFiltering::create() const {
@@ -77,48 +80,60 @@ Processor* VolumeFiltering::create() const {
 }
 
 void VolumeFiltering::process() {
-    if (!enableProcessing_.get()) {
-        outport_.setData(const_cast<VolumeHandleBase*>(inport_.getData()), false);
-    }
-    else if (forceUpdate_ || inport_.hasChanged()) {
-        applyOperator();
-    }
+    computeResults();
+    publishResults();
 }
 
-// private methods
-//
+void VolumeFiltering::computeResults() {
+    // may run on a worker thread: the result and all messages are kept until publishResults()
+    delete result_;
+    result_ = 0;
+    resultComputed_ = false;
+    errorMessage_.clear();
 
-void VolumeFiltering::forceUpdate() {
-    forceUpdate_ = true;
-}
+    if (!enableProcessing_.get() || !(forceUpdate_ || inport_.hasChanged()))
+        return;
 
-void VolumeFiltering::applyOperator() {
     tgtAssert(inport_.hasData(), "Inport has no data");
-
     forceUpdate_ = false;
+    resultComputed_ = true;
+
+    const VolumeHandleBase* input = inport_.getData();
+    if (!input->getRepresentation<Volume>())
+        return;
 
-    if (inport_.getData()->getRepresentation<Volume>()) {
-        const VolumeHandleBase* input = inport_.getData();
-        VolumeHandle* transformed = 0; // = input->clone();
-
-        if (filteringOperator_.isSelected("median")) {
-            //volOpMedian.setProgressBar(progressBar_);
-            transformed = VolumeOperatorMedian::APPLY_OP(input, kernelSize_.getValue());
-        }
-        //else if (filteringOperator_.isSelected("erosion")) {
-            //VolumeOperatorErosion volOpErosion(kernelSize_.getValue());
-            //volOpErosion(transformed);
-        //}
-        else {
-            LERROR("Unknown operator: " << filteringOperator_.get());
-        }
-
-        outport_.setData(transformed);
+    if (filteringOperator_.isSelected("median")) {
+        //volOpMedian.setProgressBar(progressBar_);
+        result_ = VolumeOperatorMedian::APPLY_OP(input, kernelSize_.getValue());
     }
+    //else if (filteringOperator_.isSelected("erosion")) {
+        //VolumeOperatorErosion volOpErosion(kernelSize_.getValue());
+        //volOpErosion(transformed);
+    //}
     else {
-        outport_.setData(0);
+        errorMessage_ = "Unknown operator: " + filteringOperator_.get();
+    }
+}
+
+void VolumeFiltering::publishResults() {
+    if (!errorMessage_.empty())
+        LERROR(errorMessage_);
+
+    if (!enableProcessing_.get()) {
+        outport_.setData(const_cast<VolumeHandleBase*>(inport_.getData()), false);
+    }
+    else if (resultComputed_) {
+        outport_.setData(result_);
+        result_ = 0;
+        resultComputed_ = false;
     }
 }
 
+// private methods
+//
+
+void VolumeFiltering::forceUpdate() {
+    forceUpdate_ = true;
+}
 
 }   // namespace
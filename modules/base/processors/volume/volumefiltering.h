@@ -44,12 +44,14 @@ public:
     virtual std::string getClassName() const      { return "VolumeFiltering"; }
     virtual std::string getCategory() const       { return "Volume Processing"; }
     virtual CodeState getCodeState() const        { return CODE_STATE_TESTING; }
+    virtual bool isThreadSafe() const             { return true; }
 
 protected:
     virtual void process();
+    virtual void computeResults();
+    virtual void publishResults();
 private:
     void forceUpdate();
-    void applyOperator();
 
     VolumePort inport_;
     VolumePort outport_;
@@ -60,6 +62,10 @@ private:
 
     bool forceUpdate_;
 
+    VolumeHandle* result_;          ///< computed by computeResults(), assigned to the outport by publishResults()
+    bool resultComputed_;           ///< true, if result_ replaces the current output
+    std::string errorMessage_;      ///< logged by publishResults()
+
     static const std::string loggerCat_;
 };
 
@@ -31,6 +31,8 @@
 #include "voreen/core/datastructures/volume/volumehandle.h"
 #include "voreen/core/datastructures/volume/gradient.h"
 
+#include <sstream>
+
 namespace voreen {
 
 const std::string VolumeGradient::loggerCat_("voreen.VolumeGradient");
@@ -39,8 +41,8 @@ VolumeGradient::VolumeGradient()
     : VolumeProcessor(),
     technique_("technique", "Technique"),
     inport_(Port::INPORT, "volumehandle.input"),
-    outport_(Port::OUTPORT, "volumehandle.output", 0)
-
+    outport_(Port::OUTPORT, "volumehandle.output", 0),
+    result_(0)
 {
     technique_.addOption("central-differences", "Central differences");
     technique_.addOption("sobel", "Sobel");
@@ -51,59 +53,86 @@ VolumeGradient::VolumeGradient()
     addPort(outport_);
 }
 
-VolumeGradient::~VolumeGradient() {}
+VolumeGradient::~VolumeGradient() {
+    delete result_;
+}
 
 Processor* VolumeGradient::create() const {
     return new VolumeGradient();
 }
 
 void VolumeGradient::process() {
+    computeResults();
+    publishResults();
+}
+
+void VolumeGradient::computeResults() {
+    // may run on a worker thread: the result and all messages are kept until publishResults()
+    delete result_;
+    result_ = 0;
+    errorMessage_.clear();
+    warningMessage_.clear();
 
     const VolumeHandleBase* inputHandle = inport_.getData();
     const Volume* inputVolume = inputHandle->getRepresentation<Volume>();
-    VolumeHandle* outputVolume = 0;
 
     // expecting a single-channel volume
-    if (inputVolume->getNumChannels() == 1) {
-
-        bool bit16 = inputVolume->getBitsAllocated() > 8;
-
-        if (technique_.get() == "central-differences") {
-            if (bit16)
-                outputVolume = calcGradientsCentralDifferences<uint16_t>(inputHandle);
-            else if (!bit16)
-                outputVolume = calcGradientsCentralDifferences<uint8_t>(inputHandle);
-            else {
-                tgtAssert(false, "Should not get here");
-            }
-        }
-        else if (technique_.get() == "sobel") {
-            if (bit16)
-                outputVolume = calcGradientsSobel<uint16_t>(inputHandle);
-            else if (!bit16)
-                outputVolume = calcGradientsSobel<uint8_t>(inputHandle);
-            else {
-                tgtAssert(false, "Should not get here");
-            }
-        }
-        else if (technique_.get() == "linear-regression") {
-            if (bit16)
-                outputVolume = calcGradientsLinearRegression<uint16_t>(inputHandle);
-            else if (!bit16)
-                outputVolume = calcGradientsLinearRegression<uint8_t>(inputHandle);
-            else {
-                tgtAssert(false, "Should not get here");
-            }
-        }
-        else {
-            LERROR("Unknown technique");
-        }
+    if (inputVolume->getNumChannels() != 1) {
+        std::ostringstream message;
+        message << "Intensity volume expected, but passed volume consists of " << inputVolume->getNumChannels() << " channels.";
+        warningMessage_ = message.str();
+        return;
     }
+
+    // the gradient functions log unsupported input themselves, so it is rejected beforehand
+    int bitsStored = inputVolume->getBitsStored();
+    bool supported = false;
+    if (technique_.get() == "central-differences")
+        supported = dynamic_cast<const VolumeUInt8*>(inputVolume) || dynamic_cast<const VolumeUInt16*>(inputVolume)
+            || dynamic_cast<const VolumeFloat*>(inputVolume);
+    else if (technique_.get() == "sobel")
+        supported = (bitsStored == 8 || bitsStored == 16);
+    else if (technique_.get() == "linear-regression")
+        supported = (bitsStored == 8 || bitsStored == 12 || bitsStored == 16);
     else {
-        LWARNING("Intensity volume expected, but passed volume consists of " << inputVolume->getNumChannels() << " channels.");
+        errorMessage_ = "Unknown technique";
+        return;
     }
+    if (!supported) {
+        errorMessage_ = "Input volume not supported by technique " + technique_.get();
+        return;
+    }
+
+    bool bit16 = inputVolume->getBitsAllocated() > 8;
+
+    if (technique_.get() == "central-differences") {
+        if (bit16)
+            result_ = calcGradientsCentralDifferences<uint16_t>(inputHandle);
+        else
+            result_ = calcGradientsCentralDifferences<uint8_t>(inputHandle);
+    }
+    else if (technique_.get() == "sobel") {
+        if (bit16)
+            result_ = calcGradientsSobel<uint16_t>(inputHandle);
+        else
+            result_ = calcGradientsSobel<uint8_t>(inputHandle);
+    }
+    else {
+        if (bit16)
+            result_ = calcGradientsLinearRegression<uint16_t>(inputHandle);
+        else
+            result_ = calcGradientsLinearRegression<uint8_t>(inputHandle);
+    }
+}
+
+void VolumeGradient::publishResults() {
+    if (!errorMessage_.empty())
+        LERROR(errorMessage_);
+    if (!warningMessage_.empty())
+        LWARNING(warningMessage_);
 
-    outport_.setData(outputVolume);
+    outport_.setData(result_);
+    result_ = 0;
 }
 
 }   // namespace
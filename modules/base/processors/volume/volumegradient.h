@@ -47,9 +47,12 @@ public:
     virtual std::string getClassName() const { return "VolumeGradient"; }
     virtual std::string getCategory() const  { return "Volume Processing"; }
     virtual CodeState getCodeState() const   { return CODE_STATE_STABLE; }
+    virtual bool isThreadSafe() const        { return true; }
 
 protected:
     virtual void process();
+    virtual void computeResults();
+    virtual void publishResults();
 
 private:
     StringOptionProperty technique_;
@@ -57,6 +60,10 @@ private:
     VolumePort inport_;
     VolumePort outport_;
 
+    VolumeHandle* result_;          ///< computed by computeResults(), assigned to the outport by publishResults()
+    std::string errorMessage_;      ///< logged by publishResults()
+    std::string warningMessage_;    ///< logged by publishResults()
+
     static const std::string loggerCat_; ///< category used in logging
 };
 
@@ -29,8 +29,11 @@
 #include "volumehalfsample.h"
 #include "voreen/core/datastructures/volume/volume.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/volumepyramid.h"
 #include "voreen/core/datastructures/volume/operators/volumeoperatorhalfsample.h"
 
+#include <algorithm>
+
 namespace voreen {
 
 const std::string VolumeHalfsample::loggerCat_("voreen.VolumeHalfsample");
@@ -38,10 +41,13 @@ const std::string VolumeHalfsample::loggerCat_("voreen.VolumeHalfsample");
 VolumeHalfsample::VolumeHalfsample()
     : VolumeProcessor(),
     inport_(Port::INPORT, "input"),
-    outport_(Port::OUTPORT, "output", 0)
+    outport_(Port::OUTPORT, "output", 0),
+    numSteps_("numSteps", "Halfsampling Steps", 1, 1, 8)
 {
     addPort(inport_);
     addPort(outport_);
+
+    addProperty(numSteps_);
 }
 
 VolumeHalfsample::~VolumeHalfsample() {}
@@ -52,7 +58,34 @@ Processor* VolumeHalfsample::create() const {
 
 void VolumeHalfsample::process() {
     const VolumeHandleBase* inputVolume = inport_.getData();
-    VolumeHandle* outputVolume = VolumeOperatorHalfsample::APPLY_OP(inputVolume);
+    size_t numSteps = static_cast<size_t>(numSteps_.get());
+
+    // use a volume pyramid that is already cached with the input volume (e.g. deserialized
+    // or computed for another processor), but do not build one just for this processor
+    if (inputVolume->hasDerivedData<VolumePyramid>()) {
+        VolumePyramid* pyramid = inputVolume->getDerivedData<VolumePyramid>();
+        if (pyramid && pyramid->getNumLevels() > 0) {
+            const VolumeHandle* levelVolume = pyramid->getLevel(std::min(numSteps, pyramid->getNumLevels()) - 1);
+            const Volume* levelData = levelVolume->getRepresentation<Volume>();
+            if (levelData) {
+                // the level is owned by the pyramid
+                outport_.setData(new VolumeHandle(levelData->clone(), levelVolume));
+                return;
+            }
+        }
+    }
+
+    // halfsample directly, keeping only the previous step
+    VolumeHandle* outputVolume = 0;
+    const VolumeHandleBase* current = inputVolume;
+    for (size_t i = 0; i < numSteps && tgt::min(current->getDimensions()) >= 2; i++) {
+        VolumeHandle* next = VolumeOperatorHalfsample::APPLY_OP(current);
+        if (!next)
+            break;
+        delete outputVolume;
+        outputVolume = next;
+        current = next;
+    }
 
     outport_.setData(outputVolume);
 }
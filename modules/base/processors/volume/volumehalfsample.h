@@ -31,6 +31,7 @@
 
 #include <string>
 #include "voreen/core/processors/volumeprocessor.h"
+#include "voreen/core/properties/intproperty.h"
 
 namespace voreen {
 
@@ -53,6 +54,8 @@ private:
     VolumePort inport_;
     VolumePort outport_;
 
+    IntProperty numSteps_;  ///< number of successive halfsampling steps
+
     static const std::string loggerCat_; ///< category used in logging
 };
 
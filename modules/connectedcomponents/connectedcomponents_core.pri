@@ -1,11 +1,15 @@
 
 SOURCES += \
+    $${VRN_MODULE_DIR}/connectedcomponents/datastructures/componentstatistics.cpp \
     $${VRN_MODULE_DIR}/connectedcomponents/processors/connectedcomponents2d.cpp \
-    $${VRN_MODULE_DIR}/connectedcomponents/processors/connectedcomponents3d.cpp
+    $${VRN_MODULE_DIR}/connectedcomponents/processors/connectedcomponents3d.cpp \
+    $${VRN_MODULE_DIR}/connectedcomponents/utils/componentlabeling.cpp
 
 HEADERS += \
+    $${VRN_MODULE_DIR}/connectedcomponents/datastructures/componentstatistics.h \
     $${VRN_MODULE_DIR}/connectedcomponents/processors/connectedcomponents2d.h \
-    $${VRN_MODULE_DIR}/connectedcomponents/processors/connectedcomponents3d.h
+    $${VRN_MODULE_DIR}/connectedcomponents/processors/connectedcomponents3d.h \
+    $${VRN_MODULE_DIR}/connectedcomponents/utils/componentlabeling.h
 
 ### Local Variables:
 ### mode:conf-unix
@@ -28,6 +28,7 @@
 
 #include "connectedcomponentsmodule.h"
 
+#include "datastructures/componentstatistics.h"
 #include "processors/connectedcomponents2d.h"
 #include "processors/connectedcomponents3d.h"
 
@@ -41,6 +42,8 @@ ConnectedComponentsModule::ConnectedComponentsModule()
 
     addProcessor(new ConnectedComponents2D());
     addProcessor(new ConnectedComponents3D());
+
+    addSerializerFactory(new ComponentStatisticsFactory());
 }
 
 } // namespace
@@ -0,0 +1,134 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "componentstatistics.h"
+
+#include "modules/connectedcomponents/utils/componentlabeling.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+
+namespace voreen {
+
+ComponentStatistics::Component::Component()
+    : label_(0)
+    , numVoxels_(0)
+    , llf_(static_cast<size_t>(0))
+    , urb_(static_cast<size_t>(0))
+    , centroid_(0.0)
+{}
+
+ComponentStatistics::ComponentStatistics()
+    : VolumeDerivedData()
+{}
+
+ComponentStatistics::ComponentStatistics(const std::vector<Component>& components)
+    : VolumeDerivedData()
+    , components_(components)
+{}
+
+VolumeDerivedData* ComponentStatistics::createFrom(const VolumeHandleBase* handle) const {
+    tgtAssert(handle, "no volume handle");
+    const VolumeUInt32* labels = dynamic_cast<const VolumeUInt32*>(handle->getRepresentation<Volume>());
+    if (!labels)
+        return 0;
+    return new ComponentStatistics(ComponentLabeling::computeStatistics(labels));
+}
+
+size_t ComponentStatistics::getNumComponents() const {
+    return components_.size();
+}
+
+const ComponentStatistics::Component& ComponentStatistics::getComponent(size_t index) const {
+    tgtAssert(index < components_.size(), "invalid component index");
+    return components_[index];
+}
+
+const std::vector<ComponentStatistics::Component>& ComponentStatistics::getComponents() const {
+    return components_;
+}
+
+void ComponentStatistics::serialize(XmlSerializer& s) const {
+    std::vector<size_t> labels, numVoxels;
+    std::vector<tgt::ivec3> llf, urb;
+    std::vector<tgt::dvec3> centroids;
+    for (size_t i = 0; i < components_.size(); i++) {
+        labels.push_back(components_[i].label_);
+        numVoxels.push_back(components_[i].numVoxels_);
+        llf.push_back(tgt::ivec3(components_[i].llf_));
+        urb.push_back(tgt::ivec3(components_[i].urb_));
+        centroids.push_back(components_[i].centroid_);
+    }
+    s.serialize("labels", labels);
+    s.serialize("numVoxels", numVoxels);
+    s.serialize("llf", llf);
+    s.serialize("urb", urb);
+    s.serialize("centroids", centroids);
+}
+
+void ComponentStatistics::deserialize(XmlDeserializer& s) {
+    std::vector<size_t> labels, numVoxels;
+    std::vector<tgt::ivec3> llf, urb;
+    std::vector<tgt::dvec3> centroids;
+    s.deserialize("labels", labels);
+    s.deserialize("numVoxels", numVoxels);
+    s.deserialize("llf", llf);
+    s.deserialize("urb", urb);
+    s.deserialize("centroids", centroids);
+
+    if (numVoxels.size() != labels.size() || llf.size() != labels.size() ||
+        urb.size() != labels.size() || centroids.size() != labels.size())
+    {
+        s.raise(XmlSerializationFormatException("Component statistics: number of entries mismatch"));
+    }
+
+    components_.resize(labels.size());
+    for (size_t i = 0; i < labels.size(); i++) {
+        components_[i].label_ = static_cast<uint32_t>(labels[i]);
+        components_[i].numVoxels_ = numVoxels[i];
+        components_[i].llf_ = tgt::svec3(llf[i]);
+        components_[i].urb_ = tgt::svec3(urb[i]);
+        components_[i].centroid_ = centroids[i];
+    }
+}
+
+//---------------------------------------------------------------------------
+
+const std::string ComponentStatisticsFactory::getTypeString(const std::type_info& type) const {
+    if (type == typeid(ComponentStatistics))
+        return "ComponentStatistics";
+    else
+        return "";
+}
+
+Serializable* ComponentStatisticsFactory::createType(const std::string& typeString) {
+    if (typeString == "ComponentStatistics")
+        return new ComponentStatistics();
+    else
+        return 0;
+}
+
+} // namespace voreen
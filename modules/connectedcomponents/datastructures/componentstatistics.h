@@ -0,0 +1,105 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_COMPONENTSTATISTICS_H
+#define VRN_COMPONENTSTATISTICS_H
+
+#include "voreen/core/datastructures/volume/volumederiveddata.h"
+#include "voreen/core/io/serialization/serialization.h"
+#include "tgt/vector.h"
+
+#include <vector>
+
+namespace voreen {
+
+/**
+ * Per-component statistics of a connected component label volume:
+ * the number of voxels, the bounding box and the centroid of each component,
+ * all in voxel coordinates.
+ *
+ * The statistics are computed together with the labels by ComponentLabeling
+ * and attached to the label volume. If they are requested for another
+ * uint32 label volume, they are derived from its labels.
+ */
+class ComponentStatistics : public VolumeDerivedData {
+public:
+    /// Statistics of a single component.
+    struct Component {
+        Component();
+
+        uint32_t label_;        ///< label of the component's voxels
+        size_t numVoxels_;      ///< number of voxels
+        tgt::svec3 llf_;        ///< lower-left-front corner of the bounding box (inclusive)
+        tgt::svec3 urb_;        ///< upper-right-back corner of the bounding box (inclusive)
+        tgt::dvec3 centroid_;   ///< mean position of the component's voxels
+    };
+
+    /// Empty default constructor required by VolumeDerivedData interface.
+    ComponentStatistics();
+
+    ComponentStatistics(const std::vector<Component>& components);
+
+    /**
+     * Derives the statistics from the labels of a uint32 label volume, where zero is background.
+     * Returns null for other volume types.
+     *
+     * @see VolumeDerivedData
+     */
+    virtual VolumeDerivedData* createFrom(const VolumeHandleBase* handle) const;
+
+    /// Returns the number of components.
+    size_t getNumComponents() const;
+
+    /// Returns the statistics of the component with the passed index.
+    const Component& getComponent(size_t index) const;
+
+    /// Returns the statistics of all components, ordered by label unless the labels have been stretched.
+    const std::vector<Component>& getComponents() const;
+
+    /// @see VolumeDerivedData
+    virtual void serialize(XmlSerializer& s) const;
+
+    /// @see VolumeDerivedData
+    virtual void deserialize(XmlDeserializer& s);
+
+private:
+    std::vector<Component> components_;
+};
+
+/**
+ * Creates the derived data of the connected components module during serialization.
+ */
+class ComponentStatisticsFactory : public SerializableFactory {
+public:
+    virtual const std::string getTypeString(const std::type_info& type) const;
+    virtual Serializable* createType(const std::string& typeString);
+};
+
+} // namespace voreen
+
+#endif // VRN_COMPONENTSTATISTICS_H
@@ -28,9 +28,15 @@
 
 #include "connectedcomponents3d.h"
 
+#include "modules/connectedcomponents/utils/componentlabeling.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 
-#include "connexe.h"
+#ifdef VRN_MODULE_PLOTTING
+#include "modules/plotting/utils/plotdata.h"
+#endif
+
+#include <algorithm>
+#include <limits>
 
 namespace voreen {
 
@@ -40,16 +46,22 @@ ConnectedComponents3D::ConnectedComponents3D()
     : VolumeProcessor(),
       inport_(Port::INPORT, "inport"),
       outport_(Port::OUTPORT, "outport"),
+#ifdef VRN_MODULE_PLOTTING
+      statisticsOutport_(Port::OUTPORT, "statisticsOutport"),
+#endif
       enableProcessing_("enabled", "Enable", true),
       connectivity_("connectivity", "Connectivity"),
       minComponentSize_("minComponentSize", "Min Component Size", 1, 1, 10000000),
-      maxComponents_("maxComponents", "Max Components", (1<<16)-1, 1, (1<<16)-1),
+      maxComponents_("maxComponents", "Max Components", std::numeric_limits<int>::max(), 1, std::numeric_limits<int>::max()),
       componentSorting_("sorting", "Component Sorting"),
       binarizeOutput_("binarizeOutput", "Binarize Output", false),
       stretchLabels_("stretchLabels", "Stretch Labels", true)
 {
     addPort(inport_);
     addPort(outport_);
+#ifdef VRN_MODULE_PLOTTING
+    addPort(statisticsOutport_);
+#endif
 
     connectivity_.addOption("6-neighborhood", "6 Neighborhood", 6);
     connectivity_.addOption("10-neighborhood", "10 Neighborhood", 10);
@@ -77,6 +89,38 @@ Processor* ConnectedComponents3D::create() const {
     return new ConnectedComponents3D();
 }
 
+void ConnectedComponents3D::deinitialize() throw (tgt::Exception) {
+#ifdef VRN_MODULE_PLOTTING
+    statisticsOutport_.setData(0, true);
+#endif
+    VolumeProcessor::deinitialize();
+}
+
+namespace {
+
+/// Orders components by decreasing size, and by label if the sizes are equal.
+struct LargerComponent {
+    bool operator()(const ComponentStatistics::Component& a, const ComponentStatistics::Component& b) const {
+        return a.numVoxels_ > b.numVoxels_ || (a.numVoxels_ == b.numVoxels_ && a.label_ < b.label_);
+    }
+};
+
+/// Orders components by increasing size, and by label if the sizes are equal.
+struct SmallerComponent {
+    bool operator()(const ComponentStatistics::Component& a, const ComponentStatistics::Component& b) const {
+        return a.numVoxels_ < b.numVoxels_ || (a.numVoxels_ == b.numVoxels_ && a.label_ < b.label_);
+    }
+};
+
+/// Orders components by label.
+struct LowerLabel {
+    bool operator()(const ComponentStatistics::Component& a, const ComponentStatistics::Component& b) const {
+        return a.label_ < b.label_;
+    }
+};
+
+} // namespace
+
 void ConnectedComponents3D::process() {
 
     tgtAssert(inport_.getData() && inport_.getData()->getRepresentation<Volume>(), "No volume");
@@ -87,50 +131,97 @@ void ConnectedComponents3D::process() {
     }
 
     const Volume* volume = inport_.getData()->getRepresentation<Volume>();
-    tgt::ivec3 volDim = volume->getDimensions();
 
-    const VolumeUInt8* volUint8 = dynamic_cast<const VolumeUInt8*>(volume);
-    const VolumeUInt16* volUint16 = dynamic_cast<const VolumeUInt16*>(volume);
-    const VolumeFloat* volFloat = dynamic_cast<const VolumeFloat*>(volume);
-    if (!volUint8 && !volUint16 && !volFloat) {
-        LERROR("Unsupported volume type: VolumeUInt8, VolumeUInt16 or VolumeFloat expected.");
+    // compute connected component labels and statistics
+    VolumeUInt32* labelVolume = 0;
+    std::vector<ComponentStatistics::Component> components;
+    try {
+        labelVolume = ComponentLabeling::labelComponents(volume, 1.0, connectivity_.getValue(), components, progressBar_);
+    }
+    catch (const VoreenException& e) {
+        LERROR(e.what());
         outport_.setData(0);
         return;
     }
-
-    // compute connected component labels
-    uint16_t* labels = 0;
-    try {
-        labels = new uint16_t[volume->getNumVoxels()];
-    }
-    catch (std::bad_alloc) {
+    catch (const std::bad_alloc&) {
         LERROR("Failed to create label volume: bad allocation");
         outport_.setData(0);
         return;
     }
-    int numLabels = CountConnectedComponentsWithAllParams(
-        const_cast<void*>(reinterpret_cast<const void*>(volume->getData())), (volUint8 ? UCHAR_TYPE : (volUint16 ? USHORT_TYPE : FLOAT_TYPE)),
-        reinterpret_cast<void*>(labels), USHORT_TYPE, tgt::ivec3(volume->getDimensions()).elem, 1.0,
-        connectivity_.getValue(),minComponentSize_.get(), maxComponents_.get(), binarizeOutput_.get() ? 1 : 0);
+    const size_t numLabels = components.size();
+
+    // discard small components and keep the largest ones
+    std::vector<ComponentStatistics::Component> kept;
+    for (size_t i = 0; i < components.size(); i++) {
+        if (components[i].numVoxels_ >= static_cast<size_t>(minComponentSize_.get()))
+            kept.push_back(components[i]);
+    }
+    if (kept.size() > static_cast<size_t>(maxComponents_.get())) {
+        std::partial_sort(kept.begin(), kept.begin() + maxComponents_.get(), kept.end(), LargerComponent());
+        kept.resize(maxComponents_.get());
+        std::sort(kept.begin(), kept.end(), LowerLabel());
+    }
 
     // sort components
-    if ((numLabels > 0) && !componentSorting_.isSelected("none") && !binarizeOutput_.get()) {
-        int decreasing = componentSorting_.isSelected("decreasing") ? 1 : 0;
-        RelabelConnectedComponentsBySize(labels, USHORT_TYPE, volDim.elem, decreasing);
+    if (!binarizeOutput_.get()) {
+        if (componentSorting_.isSelected("decreasing"))
+            std::sort(kept.begin(), kept.end(), LargerComponent());
+        else if (componentSorting_.isSelected("increasing"))
+            std::sort(kept.begin(), kept.end(), SmallerComponent());
     }
 
-    // stretch labels to use full range
-    if ((numLabels > 0) && stretchLabels_.get() && !binarizeOutput_.get()) {
-        float scale = static_cast<float>((1<<16) - 2) / numLabels;
-        for (size_t i=0; i<volume->getNumVoxels(); i++)
-            labels[i] = tgt::ifloor(labels[i]*scale);
+    // map the labels to the final ones, optionally stretched over the whole
+    // intensity range in order to maximize contrast
+    const uint32_t maxLabel = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> mapping(numLabels + 1, 0);
+    bool identity = (kept.size() == numLabels);
+    for (size_t i = 0; i < kept.size(); i++) {
+        uint32_t label = static_cast<uint32_t>(i + 1);
+        if (binarizeOutput_.get())
+            label = maxLabel;
+        else if (stretchLabels_.get())
+            label = static_cast<uint32_t>((static_cast<uint64_t>(i + 1) * (maxLabel - 1)) / kept.size());
+        mapping[kept[i].label_] = label;
+        identity &= (label == kept[i].label_);
+        kept[i].label_ = label;
+    }
+    if (!identity)
+        ComponentLabeling::relabel(labelVolume, mapping);
+
+    LINFO("Detected " << numLabels << " connected components, " << kept.size() << " kept");
+
+#ifdef VRN_MODULE_PLOTTING
+    // statistics for plotting are only assembled if requested, since they may have millions of rows
+    if (statisticsOutport_.isConnected()) {
+        PlotData* plotData = new PlotData(1, 10);
+        const char* columnLabels[] = { "Label", "Voxels", "LLF x", "LLF y", "LLF z", "URB x", "URB y", "URB z",
+                                       "Centroid x", "Centroid y", "Centroid z" };
+        for (int i = 0; i < 11; i++)
+            plotData->setColumnLabel(i, columnLabels[i]);
+
+        std::vector<plot_t> row(11);
+        for (size_t i = 0; i < kept.size(); i++) {
+            const ComponentStatistics::Component& component = kept[i];
+            row[0] = component.label_;
+            row[1] = static_cast<plot_t>(component.numVoxels_);
+            for (int j = 0; j < 3; j++) {
+                row[2+j] = static_cast<plot_t>(component.llf_[j]);
+                row[5+j] = static_cast<plot_t>(component.urb_[j]);
+                row[8+j] = component.centroid_[j];
+            }
+            plotData->insert(row);
+        }
+        statisticsOutport_.setData(plotData, true);
     }
+    else {
+        statisticsOutport_.setData(0, true);
+    }
+#endif
 
     // assign label volume to outport
-    VolumeUInt16* labelVolume = new VolumeUInt16(labels, volume->getDimensions());
-    outport_.setData(new VolumeHandle(labelVolume, inport_.getData()));
-
-    LGL_ERROR;
+    VolumeHandle* labelHandle = new VolumeHandle(labelVolume, inport_.getData());
+    labelHandle->addDerivedData(new ComponentStatistics(kept));
+    outport_.setData(labelHandle);
 }
 
 } // namespace
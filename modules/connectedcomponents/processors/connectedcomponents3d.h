@@ -35,12 +35,21 @@
 #include "voreen/core/properties/optionproperty.h"
 #include "voreen/core/properties/intproperty.h"
 
+#ifdef VRN_MODULE_PLOTTING
+#include "modules/plotting/ports/plotport.h"
+#endif
+
 namespace voreen {
 
 /**
  * Detects connected components in a volume data set and intensity-codes the assigned labels
- * in a 16 bit output volume of the same dimensions.
+ * in a 32 bit output volume of the same dimensions.
+ *
+ * The per-component statistics (voxel count, bounding box, centroid) are attached to the
+ * label volume as ComponentStatistics and, if the plotting module is available,
+ * put out as plot data.
  *
+ * @see ComponentLabeling
  * @see ConnectedComponents2D
  */
 class ConnectedComponents3D : public VolumeProcessor {
@@ -55,10 +64,14 @@ public:
 
 protected:
     virtual void process();
+    virtual void deinitialize() throw (tgt::Exception);
 
 private:
     VolumePort inport_;     ///< Volume to analyze.
     VolumePort outport_;    ///< Output volume storing the components' labels.
+#ifdef VRN_MODULE_PLOTTING
+    PlotPort statisticsOutport_;    ///< Per-component statistics, only computed if connected.
+#endif
 
     BoolProperty enableProcessing_;         ///< If set to false, the input volume is passed through.
     IntOptionProperty connectivity_;        ///< Voxel neighborhood to consider for the analysis.
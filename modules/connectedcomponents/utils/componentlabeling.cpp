@@ -0,0 +1,397 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "componentlabeling.h"
+
+#include "voreen/core/io/progressbar.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace voreen {
+
+const std::string ComponentLabeling::loggerCat_("voreen.connectedcomponents.ComponentLabeling");
+
+namespace {
+
+/// Marks compacted labels during the final pass, in contrast to parent pointers.
+const uint32_t FINAL_LABEL = 0x80000000u;
+
+/// Offset to a neighbor that precedes a voxel in storage order.
+struct NeighborOffset {
+    int dx_, dy_, dz_;
+    ptrdiff_t index_;
+};
+
+/**
+ * Returns the offsets to the neighbors preceding a voxel in storage order,
+ * which are sufficient for connecting all neighbors in a single sweep.
+ */
+std::vector<NeighborOffset> getBackwardNeighbors(int connectivity, const tgt::svec3& dims) {
+    std::vector<NeighborOffset> offsets;
+    for (int dz = -1; dz <= 0; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                // only neighbors preceding the voxel
+                if (dz == 0 && (dy > 0 || (dy == 0 && dx >= 0)))
+                    continue;
+
+                int distance = std::abs(dx) + std::abs(dy) + std::abs(dz);
+                bool neighbor;
+                if (connectivity == 6)
+                    neighbor = (distance == 1);
+                else if (connectivity == 10)
+                    neighbor = (dz == 0 || distance == 1);
+                else if (connectivity == 18)
+                    neighbor = (distance <= 2);
+                else
+                    neighbor = true;
+
+                if (neighbor) {
+                    NeighborOffset offset;
+                    offset.dx_ = dx;
+                    offset.dy_ = dy;
+                    offset.dz_ = dz;
+                    offset.index_ = (static_cast<ptrdiff_t>(dz)*static_cast<ptrdiff_t>(dims.y) + dy)*static_cast<ptrdiff_t>(dims.x) + dx;
+                    offsets.push_back(offset);
+                }
+            }
+        }
+    }
+    return offsets;
+}
+
+/// Returns the root of the voxel's tree, halving the path on the way.
+inline uint32_t findRoot(uint32_t* labels, uint32_t voxel) {
+    while (labels[voxel] != voxel + 1) {
+        uint32_t parent = labels[voxel] - 1;
+        labels[voxel] = labels[parent];
+        voxel = parent;
+    }
+    return voxel;
+}
+
+/// Merges the trees of two voxels. The smaller voxel index becomes the root.
+inline void unite(uint32_t* labels, uint32_t first, uint32_t second) {
+    uint32_t firstRoot = findRoot(labels, first);
+    uint32_t secondRoot = findRoot(labels, second);
+    if (firstRoot < secondRoot)
+        labels[secondRoot] = firstRoot + 1;
+    else if (secondRoot < firstRoot)
+        labels[firstRoot] = secondRoot + 1;
+}
+
+/// Accumulated statistics of a component.
+struct ComponentSums {
+    ComponentSums()
+        : numVoxels_(0)
+        , llf_(std::numeric_limits<size_t>::max())
+        , urb_(static_cast<size_t>(0))
+    {
+        sum_[0] = sum_[1] = sum_[2] = 0;
+    }
+
+    void add(size_t x, size_t y, size_t z) {
+        numVoxels_++;
+        llf_ = tgt::min(llf_, tgt::svec3(x, y, z));
+        urb_ = tgt::max(urb_, tgt::svec3(x, y, z));
+        sum_[0] += x;
+        sum_[1] += y;
+        sum_[2] += z;
+    }
+
+    void add(const ComponentSums& other) {
+        numVoxels_ += other.numVoxels_;
+        llf_ = tgt::min(llf_, other.llf_);
+        urb_ = tgt::max(urb_, other.urb_);
+        for (int i = 0; i < 3; i++)
+            sum_[i] += other.sum_[i];
+    }
+
+    ComponentStatistics::Component getComponent(uint32_t label) const {
+        ComponentStatistics::Component component;
+        component.label_ = label;
+        component.numVoxels_ = static_cast<size_t>(numVoxels_);
+        component.llf_ = llf_;
+        component.urb_ = urb_;
+        if (numVoxels_ > 0) {
+            double n = static_cast<double>(numVoxels_);
+            component.centroid_ = tgt::dvec3(sum_[0] / n, sum_[1] / n, sum_[2] / n);
+        }
+        return component;
+    }
+
+    uint64_t numVoxels_;
+    tgt::svec3 llf_;
+    tgt::svec3 urb_;
+    uint64_t sum_[3];
+};
+
+} // namespace
+
+VolumeUInt32* ComponentLabeling::labelComponents(const Volume* volume, double threshold, int connectivity,
+        std::vector<ComponentStatistics::Component>& components, ProgressBar* progressBar)
+        throw (VoreenException, std::bad_alloc)
+{
+    tgtAssert(volume, "no volume");
+
+    if (volume->getNumVoxels() >= static_cast<size_t>(FINAL_LABEL))
+        throw VoreenException("Connected component labelling requires less than 2^31 voxels");
+
+    if (const VolumeUInt8* v = dynamic_cast<const VolumeUInt8*>(volume))
+        return computeLabels(v, threshold, connectivity, components, progressBar);
+    else if (const VolumeUInt16* v = dynamic_cast<const VolumeUInt16*>(volume))
+        return computeLabels(v, threshold, connectivity, components, progressBar);
+    else if (const VolumeUInt32* v = dynamic_cast<const VolumeUInt32*>(volume))
+        return computeLabels(v, threshold, connectivity, components, progressBar);
+    else if (const VolumeFloat* v = dynamic_cast<const VolumeFloat*>(volume))
+        return computeLabels(v, threshold, connectivity, components, progressBar);
+    else
+        throw VoreenException("Unsupported volume type: VolumeUInt8, VolumeUInt16, VolumeUInt32 or VolumeFloat expected");
+}
+
+template<typename T>
+VolumeUInt32* ComponentLabeling::computeLabels(const VolumeAtomic<T>* volume, double threshold, int connectivity,
+        std::vector<ComponentStatistics::Component>& components, ProgressBar* progressBar)
+{
+    const tgt::svec3 dims = volume->getDimensions();
+    const size_t sliceSize = dims.x * dims.y;
+    const int dimZ = static_cast<int>(dims.z);
+    const std::vector<NeighborOffset> neighbors = getBackwardNeighbors(connectivity, dims);
+    const int numNeighbors = static_cast<int>(neighbors.size());
+
+    VolumeUInt32* labelVolume = new VolumeUInt32(dims);
+    uint32_t* labels = labelVolume->voxel();
+    const T* voxels = volume->voxel();
+
+    // split the volume into slabs of slices, several per thread for load balancing
+#ifdef _OPENMP
+    int numSlabs = std::min(dimZ, 4 * omp_get_max_threads());
+#else
+    int numSlabs = 1;
+#endif
+    numSlabs = std::max(numSlabs, 1);
+    std::vector<int> slabStart(numSlabs + 1);
+    for (int s = 0; s <= numSlabs; s++)
+        slabStart[s] = static_cast<int>((static_cast<int64_t>(dimZ) * s) / numSlabs);
+
+    // 1. label each slab independently, the trees of a slab only contain voxels of the slab
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int s = 0; s < numSlabs; s++) {
+        for (int z = slabStart[s]; z < slabStart[s+1]; z++) {
+            for (size_t y = 0; y < dims.y; y++) {
+                uint32_t index = static_cast<uint32_t>(z*sliceSize + y*dims.x);
+                for (size_t x = 0; x < dims.x; x++, index++) {
+                    if (static_cast<double>(voxels[index]) < threshold) {
+                        labels[index] = 0;
+                        continue;
+                    }
+                    labels[index] = index + 1;
+                    for (int n = 0; n < numNeighbors; n++) {
+                        const NeighborOffset& offset = neighbors[n];
+                        if (   (offset.dx_ < 0 && x == 0) || (offset.dx_ > 0 && x + 1 == dims.x)
+                            || (offset.dy_ < 0 && y == 0) || (offset.dy_ > 0 && y + 1 == dims.y)
+                            || (offset.dz_ < 0 && z == slabStart[s]))
+                            continue;
+                        uint32_t neighbor = static_cast<uint32_t>(index + offset.index_);
+                        if (labels[neighbor])
+                            unite(labels, index, neighbor);
+                    }
+                }
+            }
+        }
+    }
+    if (progressBar)
+        progressBar->setProgress(0.4f);
+
+    // 2. merge the trees along the slab boundaries
+    for (int s = 1; s < numSlabs; s++) {
+        const size_t z = slabStart[s];
+        for (size_t y = 0; y < dims.y; y++) {
+            uint32_t index = static_cast<uint32_t>(z*sliceSize + y*dims.x);
+            for (size_t x = 0; x < dims.x; x++, index++) {
+                if (!labels[index])
+                    continue;
+                for (int n = 0; n < numNeighbors; n++) {
+                    const NeighborOffset& offset = neighbors[n];
+                    if (   offset.dz_ == 0
+                        || (offset.dx_ < 0 && x == 0) || (offset.dx_ > 0 && x + 1 == dims.x)
+                        || (offset.dy_ < 0 && y == 0) || (offset.dy_ > 0 && y + 1 == dims.y))
+                        continue;
+                    uint32_t neighbor = static_cast<uint32_t>(index + offset.index_);
+                    if (labels[neighbor])
+                        unite(labels, index, neighbor);
+                }
+            }
+        }
+    }
+    if (progressBar)
+        progressBar->setProgress(0.5f);
+
+    // 3. let each voxel point directly to its root and count the roots, i.e., components, per slab.
+    //    Concurrent reads of other slabs only observe ancestors of the respective voxel.
+    std::vector<uint32_t> numRoots(numSlabs, 0);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int s = 0; s < numSlabs; s++) {
+        uint32_t count = 0;
+        uint32_t end = static_cast<uint32_t>(slabStart[s+1]*sliceSize);
+        for (uint32_t index = static_cast<uint32_t>(slabStart[s]*sliceSize); index < end; index++) {
+            if (!labels[index])
+                continue;
+            uint32_t root = index;
+            while (labels[root] != root + 1)
+                root = labels[root] - 1;
+            labels[index] = root + 1;
+            if (root == index)
+                count++;
+        }
+        numRoots[s] = count;
+    }
+    std::vector<uint32_t> firstLabel(numSlabs + 1, 1);
+    for (int s = 0; s < numSlabs; s++)
+        firstLabel[s+1] = firstLabel[s] + numRoots[s];
+    const uint32_t numComponents = firstLabel[numSlabs] - 1;
+    if (progressBar)
+        progressBar->setProgress(0.7f);
+
+    // 4. assign the compacted labels to the roots and to the voxels whose root lies in the same slab.
+    //    Since the root is the first voxel of a component, it is always visited before the other voxels.
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int s = 0; s < numSlabs; s++) {
+        uint32_t label = firstLabel[s];
+        uint32_t begin = static_cast<uint32_t>(slabStart[s]*sliceSize);
+        uint32_t end = static_cast<uint32_t>(slabStart[s+1]*sliceSize);
+        for (uint32_t index = begin; index < end; index++) {
+            uint32_t root = labels[index] - 1;
+            if (!labels[index] || root < begin)
+                continue;
+            if (root == index)
+                labels[index] = (label++) | FINAL_LABEL;
+            else
+                labels[index] = labels[root];
+        }
+    }
+
+    // 5. resolve the labels of components spanning several slabs and gather the statistics.
+    //    Each slab owns the statistics of the components whose root it contains,
+    //    the others are accumulated separately and merged afterwards.
+    std::vector<ComponentSums> sums(numComponents);
+    std::vector<std::map<uint32_t, ComponentSums> > foreignSums(numSlabs);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int s = 0; s < numSlabs; s++) {
+        std::map<uint32_t, ComponentSums>& foreign = foreignSums[s];
+        for (int z = slabStart[s]; z < slabStart[s+1]; z++) {
+            for (size_t y = 0; y < dims.y; y++) {
+                uint32_t index = static_cast<uint32_t>(z*sliceSize + y*dims.x);
+                for (size_t x = 0; x < dims.x; x++, index++) {
+                    uint32_t label = labels[index];
+                    if (!label)
+                        continue;
+                    // the root's label may already have been unmarked by its own slab
+                    if (!(label & FINAL_LABEL))
+                        label = labels[label - 1];
+                    label &= ~FINAL_LABEL;
+                    labels[index] = label;
+
+                    if (label >= firstLabel[s] && label < firstLabel[s+1])
+                        sums[label - 1].add(x, y, z);
+                    else
+                        foreign[label].add(x, y, z);
+                }
+            }
+        }
+    }
+    for (int s = 0; s < numSlabs; s++) {
+        for (std::map<uint32_t, ComponentSums>::const_iterator it = foreignSums[s].begin(); it != foreignSums[s].end(); ++it)
+            sums[it->first - 1].add(it->second);
+    }
+
+    components.resize(numComponents);
+    for (uint32_t i = 0; i < numComponents; i++)
+        components[i] = sums[i].getComponent(i + 1);
+
+    if (progressBar)
+        progressBar->setProgress(1.f);
+    LDEBUG("Labelled " << numComponents << " components in " << numSlabs << " slabs");
+
+    return labelVolume;
+}
+
+void ComponentLabeling::relabel(VolumeUInt32* labelVolume, const std::vector<uint32_t>& mapping) {
+    tgtAssert(labelVolume, "no label volume");
+    uint32_t* labels = labelVolume->voxel();
+    const size_t sliceSize = labelVolume->getDimensions().x * labelVolume->getDimensions().y;
+    const int dimZ = static_cast<int>(labelVolume->getDimensions().z);
+
+    #pragma omp parallel for
+    for (int z = 0; z < dimZ; z++) {
+        for (size_t i = z*sliceSize; i < (z+1)*sliceSize; i++) {
+            tgtAssert(labels[i] < mapping.size(), "label not mapped");
+            labels[i] = mapping[labels[i]];
+        }
+    }
+    labelVolume->invalidate();
+}
+
+std::vector<ComponentStatistics::Component> ComponentLabeling::computeStatistics(const VolumeUInt32* labelVolume) {
+    tgtAssert(labelVolume, "no label volume");
+    const tgt::svec3 dims = labelVolume->getDimensions();
+    const uint32_t* labels = labelVolume->voxel();
+
+    std::vector<ComponentSums> sums;
+    size_t index = 0;
+    for (size_t z = 0; z < dims.z; z++) {
+        for (size_t y = 0; y < dims.y; y++) {
+            for (size_t x = 0; x < dims.x; x++, index++) {
+                uint32_t label = labels[index];
+                if (!label)
+                    continue;
+                if (label > sums.size())
+                    sums.resize(label);
+                sums[label - 1].add(x, y, z);
+            }
+        }
+    }
+
+    std::vector<ComponentStatistics::Component> components;
+    for (size_t i = 0; i < sums.size(); i++) {
+        if (sums[i].numVoxels_ > 0)
+            components.push_back(sums[i].getComponent(static_cast<uint32_t>(i + 1)));
+    }
+    return components;
+}
+
+} // namespace voreen
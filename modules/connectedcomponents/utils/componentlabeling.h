@@ -0,0 +1,95 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_COMPONENTLABELING_H
+#define VRN_COMPONENTLABELING_H
+
+#include "modules/connectedcomponents/datastructures/componentstatistics.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/utils/exception.h"
+
+#include <vector>
+
+namespace voreen {
+
+class ProgressBar;
+
+/**
+ * Parallel connected component labelling of volumes with 32 bit labels.
+ *
+ * The volume is split into slabs of slices, which are labelled in parallel
+ * using union-find on the label array, where each provisional label points
+ * to the parent voxel. The trees of neighboring slabs are then merged along
+ * the slab boundaries. Finally, the labels are compacted to 1..n in storage order
+ * of the components' first voxels, and the component statistics are gathered
+ * in the same pass.
+ */
+class ComponentLabeling {
+public:
+    /**
+     * Labels the connected components of the foreground voxels, i.e., voxels whose
+     * raw value is at least the threshold. Background voxels are labelled zero.
+     *
+     * @param volume scalar input volume
+     * @param threshold foreground threshold, applied to the raw voxel values
+     * @param connectivity voxel neighborhood to consider: 6, 10 (8 in-plane + 2),
+     *        18 or 26
+     * @param components receives the statistics of the components, the component
+     *        with label i is stored at index i-1
+     * @param progressBar optional progress bar, updated after each phase
+     *
+     * @throw VoreenException if the volume type is not supported or the volume
+     *        has 2^31 voxels or more
+     */
+    static VolumeUInt32* labelComponents(const Volume* volume, double threshold, int connectivity,
+        std::vector<ComponentStatistics::Component>& components, ProgressBar* progressBar = 0)
+        throw (VoreenException, std::bad_alloc);
+
+    /**
+     * Replaces each label l by mapping[l], in parallel. The mapping has to contain
+     * an entry for each label that occurs in the volume, including zero.
+     */
+    static void relabel(VolumeUInt32* labels, const std::vector<uint32_t>& mapping);
+
+    /**
+     * Computes the statistics of the components of a label volume, where zero is background.
+     * Labels that do not occur are omitted.
+     */
+    static std::vector<ComponentStatistics::Component> computeStatistics(const VolumeUInt32* labels);
+
+private:
+    template<typename T>
+    static VolumeUInt32* computeLabels(const VolumeAtomic<T>* volume, double threshold, int connectivity,
+        std::vector<ComponentStatistics::Component>& components, ProgressBar* progressBar);
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_COMPONENTLABELING_H
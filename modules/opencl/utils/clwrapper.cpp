@@ -1478,83 +1478,81 @@ ImageObject3D::ImageObject3D(const Context* context, cl_mem_flags flags, const V
 
     cl_image_format volume_format;
 
-    const std::type_info& volumeType(typeid(*vol));
-
     // MOST OF THESE HAVE NOT YET BEEN TESTED, USE CAREFULLY!
     // VolumeUIntX
-    if (volumeType == typeid(VolumeUInt8)) {
+    if (dynamic_cast<const VolumeUInt8*>(vol)) {
         volume_format.image_channel_order = CL_INTENSITY;
         volume_format.image_channel_data_type = CL_UNORM_INT8;
     }
-    else if (volumeType == typeid(VolumeUInt16)) {
+    else if (dynamic_cast<const VolumeUInt16*>(vol)) {
         volume_format.image_channel_order = CL_INTENSITY;
         volume_format.image_channel_data_type = CL_UNORM_INT16;
     }
-    else if (volumeType == typeid(VolumeUInt32)) {
+    else if (dynamic_cast<const VolumeUInt32*>(vol)) {
         volume_format.image_channel_order = CL_INTENSITY;
         volume_format.image_channel_data_type = CL_UNSIGNED_INT32;
     }
     // VolumeIntX
-    else if (volumeType == typeid(VolumeInt8)) {
+    else if (dynamic_cast<const VolumeInt8*>(vol)) {
         volume_format.image_channel_order = CL_INTENSITY;
         volume_format.image_channel_data_type = CL_SNORM_INT8;
     }
-    else if (volumeType == typeid(VolumeInt16)) {
+    else if (dynamic_cast<const VolumeInt16*>(vol)) {
         volume_format.image_channel_order = CL_INTENSITY;
         volume_format.image_channel_data_type = CL_SNORM_INT16;
     }
-    else if (volumeType == typeid(VolumeInt32)) {
+    else if (dynamic_cast<const VolumeInt32*>(vol)) {
         volume_format.image_channel_order = CL_INTENSITY;
         volume_format.image_channel_data_type = CL_SIGNED_INT32;
     }
     // VolumeFloat
-    else if (volumeType == typeid(VolumeFloat)) {
+    else if (dynamic_cast<const VolumeFloat*>(vol)) {
         volume_format.image_channel_order = CL_INTENSITY;
         volume_format.image_channel_data_type = CL_FLOAT;
     }
     // Volume3x with int8 types
-    else if (volumeType == typeid(Volume3xUInt8)) {
+    else if (dynamic_cast<const Volume3xUInt8*>(vol)) {
         volume_format.image_channel_order = CL_RGB;
         volume_format.image_channel_data_type = CL_UNORM_INT8;
     }
-    else if (volumeType == typeid(Volume3xInt8)) {
+    else if (dynamic_cast<const Volume3xInt8*>(vol)) {
         volume_format.image_channel_order = CL_RGB;
         volume_format.image_channel_data_type = CL_UNORM_INT16;
     }
     // Volume4x with int8 types
-    else if (volumeType == typeid(Volume4xUInt8)) {
+    else if (dynamic_cast<const Volume4xUInt8*>(vol)) {
         volume_format.image_channel_order = CL_RGBA;
         volume_format.image_channel_data_type = CL_UNORM_INT8;
     }
-    else if (volumeType == typeid(Volume4xInt8)) {
+    else if (dynamic_cast<const Volume4xInt8*>(vol)) {
         volume_format.image_channel_order = CL_RGBA;
         volume_format.image_channel_data_type = CL_SNORM_INT8;
     }
     // Volume3x with int16 types
-    else if (volumeType == typeid(Volume3xUInt16)) {
+    else if (dynamic_cast<const Volume3xUInt16*>(vol)) {
         volume_format.image_channel_order = CL_RGB;
         volume_format.image_channel_data_type = CL_UNORM_INT16;
     }
-    else if (volumeType == typeid(Volume3xInt16)) {
+    else if (dynamic_cast<const Volume3xInt16*>(vol)) {
         volume_format.image_channel_order = CL_RGB;
         volume_format.image_channel_data_type = CL_SNORM_INT16;
     }
     // Volume4x with int16 types
-    else if (volumeType == typeid(Volume4xUInt16)) {
+    else if (dynamic_cast<const Volume4xUInt16*>(vol)) {
         volume_format.image_channel_order = CL_RGBA;
         volume_format.image_channel_data_type = CL_UNORM_INT16;
     }
-    else if (volumeType == typeid(Volume4xInt16)) {
+    else if (dynamic_cast<const Volume4xInt16*>(vol)) {
         volume_format.image_channel_order = CL_RGBA;
         volume_format.image_channel_data_type = CL_SNORM_INT16;
     }
     // Volume3x with real types
-    else if (volumeType == typeid(Volume3xFloat)) {
+    else if (dynamic_cast<const Volume3xFloat*>(vol)) {
         volume_format.image_channel_order = CL_RGB;
         volume_format.image_channel_data_type = CL_FLOAT;
     }
     // Volume4x with real types
-    else if (volumeType == typeid(Volume4xFloat)) {
+    else if (dynamic_cast<const Volume4xFloat*>(vol)) {
         volume_format.image_channel_order = CL_RGBA;
         volume_format.image_channel_data_type = CL_FLOAT;
     }
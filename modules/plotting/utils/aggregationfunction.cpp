@@ -28,13 +28,92 @@
 
 #include "aggregationfunction.h"
 
+#include "tgt/assert.h"
+
 #include <algorithm>
 #include <limits>
 #include <math.h>
 
 namespace voreen {
 
+// AggregationState methods -------------------------------------------------------
+
+AggregationState::AggregationState()
+    : count_(0)
+    , validCount_(0)
+    , sum_(0)
+    , min_(std::numeric_limits<plot_t>::quiet_NaN())
+    , max_(std::numeric_limits<plot_t>::quiet_NaN())
+    , mean_(0)
+    , m2_(0)
+{}
+
+void AggregationState::add(plot_t value) {
+    ++count_;
+    if (value != value)
+        return;
+
+    ++validCount_;
+    sum_ += value;
+    if (value < min_ || min_ != min_)
+        min_ = value;
+    if (value > max_ || max_ != max_)
+        max_ = value;
+
+    // Welford's update of mean and squared deviations
+    plot_t delta = value - mean_;
+    mean_ += delta / validCount_;
+    m2_ += delta * (value - mean_);
+}
+
+void AggregationState::merge(const AggregationState& other) {
+    if (other.validCount_ > 0) {
+        if (validCount_ == 0) {
+            min_ = other.min_;
+            max_ = other.max_;
+            mean_ = other.mean_;
+            m2_ = other.m2_;
+        }
+        else {
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+
+            // pairwise combination of the squared deviations (Chan et al.)
+            plot_t n = static_cast<plot_t>(validCount_ + other.validCount_);
+            plot_t delta = other.mean_ - mean_;
+            mean_ += delta * other.validCount_ / n;
+            m2_ += other.m2_ + delta * delta * validCount_ * other.validCount_ / n;
+        }
+        sum_ += other.sum_;
+        validCount_ += other.validCount_;
+    }
+    count_ += other.count_;
+}
+
+namespace {
 
+/// Variance as computed by AggregationFunctionVariance::evaluate(), whose deviations of the valid
+/// values are taken from the average over all values including NaN values.
+plot_t stateVariance(const AggregationState& state) {
+    if (state.count_ == 0)
+        return 0;
+    plot_t average = state.sum_ / state.count_;
+    plot_t shift = state.mean_ - average;
+    return (state.m2_ + state.validCount_ * shift * shift) / state.count_;
+}
+
+} // namespace
+
+// AggregationFunction methods -------------------------------------------------------
+
+bool AggregationFunction::isIncremental() const {
+    return false;
+}
+
+plot_t AggregationFunction::evaluateState(const AggregationState& /*state*/) const {
+    tgtAssert(false, "AggregationFunction::evaluateState: function is not incremental");
+    return std::numeric_limits<plot_t>::quiet_NaN();
+}
 
 // AggregationFunctionCountHistogramm methods -------------------------------------------------------
 
@@ -66,6 +145,14 @@ plot_t AggregationFunctionCount::evaluate(std::vector<plot_t>& values) const {
     return static_cast<plot_t>(values.size());
 }
 
+bool AggregationFunctionCount::isIncremental() const {
+    return true;
+}
+
+plot_t AggregationFunctionCount::evaluateState(const AggregationState& state) const {
+    return static_cast<plot_t>(state.count_);
+}
+
 AggregationFunction* AggregationFunctionCount::clone() const {
     return new AggregationFunctionCount();
 }
@@ -123,6 +210,16 @@ plot_t AggregationFunctionMin::evaluate(std::vector<plot_t>& values) const {
     return min;
 }
 
+bool AggregationFunctionMin::isIncremental() const {
+    return true;
+}
+
+plot_t AggregationFunctionMin::evaluateState(const AggregationState& state) const {
+    if (state.count_ == 0)
+        return 0;
+    return state.min_;
+}
+
 AggregationFunction* AggregationFunctionMin::clone() const {
     return new AggregationFunctionMin();
 }
@@ -180,6 +277,16 @@ plot_t AggregationFunctionMax::evaluate(std::vector<plot_t>& values) const {
     return max;
 }
 
+bool AggregationFunctionMax::isIncremental() const {
+    return true;
+}
+
+plot_t AggregationFunctionMax::evaluateState(const AggregationState& state) const {
+    if (state.count_ == 0)
+        return 0;
+    return state.max_;
+}
+
 AggregationFunction* AggregationFunctionMax::clone() const {
     return new AggregationFunctionMax();
 }
@@ -207,6 +314,14 @@ plot_t AggregationFunctionSum::evaluate(std::vector<plot_t>& values) const {
     return sum;
 }
 
+bool AggregationFunctionSum::isIncremental() const {
+    return true;
+}
+
+plot_t AggregationFunctionSum::evaluateState(const AggregationState& state) const {
+    return state.sum_;
+}
+
 AggregationFunction* AggregationFunctionSum::clone() const {
     return new AggregationFunctionSum();
 }
@@ -261,6 +376,16 @@ plot_t AggregationFunctionAverage::evaluate(std::vector<plot_t>& values) const {
     return sum/values.size();
 }
 
+bool AggregationFunctionAverage::isIncremental() const {
+    return true;
+}
+
+plot_t AggregationFunctionAverage::evaluateState(const AggregationState& state) const {
+    if (state.count_ == 0)
+        return 0;
+    return state.sum_ / state.count_;
+}
+
 AggregationFunction* AggregationFunctionAverage::clone() const {
     return new AggregationFunctionAverage();
 }
@@ -411,6 +536,14 @@ plot_t AggregationFunctionStandardDeviation::evaluate(std::vector<plot_t>& value
     return std::sqrt(sqrtsum/values.size());
 }
 
+bool AggregationFunctionStandardDeviation::isIncremental() const {
+    return true;
+}
+
+plot_t AggregationFunctionStandardDeviation::evaluateState(const AggregationState& state) const {
+    return std::sqrt(stateVariance(state));
+}
+
 AggregationFunction* AggregationFunctionStandardDeviation::clone() const {
     return new AggregationFunctionStandardDeviation();
 }
@@ -446,6 +579,14 @@ plot_t AggregationFunctionVariance::evaluate(std::vector<plot_t>& values) const
     return sqrtsum/values.size();
 }
 
+bool AggregationFunctionVariance::isIncremental() const {
+    return true;
+}
+
+plot_t AggregationFunctionVariance::evaluateState(const AggregationState& state) const {
+    return stateVariance(state);
+}
+
 AggregationFunction* AggregationFunctionVariance::clone() const {
     return new AggregationFunctionVariance();
 }
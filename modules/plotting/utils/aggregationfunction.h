@@ -34,6 +34,31 @@
 
 namespace voreen {
 
+/**
+ * \brief Running state of an aggregation, which can be updated value by value and merged with
+ * the state of another part of the same data.
+ *
+ * Used by PlotData::groupBy() to aggregate incremental AggregationFunctions without collecting
+ * the values of each group first. NaN values are counted in count_ but ignored otherwise.
+ */
+struct VRN_CORE_API AggregationState {
+    AggregationState();
+
+    /// Adds the value \a value to the state.
+    void add(plot_t value);
+
+    /// Merges the state \a other, gathered from a disjoint set of values, into this state.
+    void merge(const AggregationState& other);
+
+    size_t count_;          ///< number of values, including NaN values
+    size_t validCount_;     ///< number of values which are not NaN
+    plot_t sum_;            ///< sum of all valid values
+    plot_t min_;            ///< minimum of all valid values, NaN if there are none
+    plot_t max_;            ///< maximum of all valid values, NaN if there are none
+    plot_t mean_;           ///< mean of all valid values
+    plot_t m2_;             ///< sum of squared deviations of all valid values from mean_
+};
+
 /**
  * \brief Abstract super class for aggregation functions which can be applied to the data.
  *
@@ -70,6 +95,18 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const = 0;
 
+    /**
+     * Returns true if this function can be computed from an AggregationState by evaluateState().
+     * The default implementation returns false.
+     */
+    virtual bool isIncremental() const;
+
+    /**
+     * Computes the aggregation from the running state \a state, yielding the same result as
+     * evaluate() on the values the state was built from. Only valid if isIncremental() is true.
+     */
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const = 0;
 
@@ -116,6 +153,12 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const;
 
+    /// @see AggregationFunction::isIncremental
+    virtual bool isIncremental() const;
+
+    /// @see AggregationFunction::evaluateState
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const;
 
@@ -168,6 +211,12 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const;
 
+    /// @see AggregationFunction::isIncremental
+    virtual bool isIncremental() const;
+
+    /// @see AggregationFunction::evaluateState
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const;
 
@@ -220,6 +269,12 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const;
 
+    /// @see AggregationFunction::isIncremental
+    virtual bool isIncremental() const;
+
+    /// @see AggregationFunction::evaluateState
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const;
 
@@ -272,6 +327,12 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const;
 
+    /// @see AggregationFunction::isIncremental
+    virtual bool isIncremental() const;
+
+    /// @see AggregationFunction::evaluateState
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const;
 
@@ -298,6 +359,12 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const;
 
+    /// @see AggregationFunction::isIncremental
+    virtual bool isIncremental() const;
+
+    /// @see AggregationFunction::evaluateState
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const;
 
@@ -426,6 +493,12 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const;
 
+    /// @see AggregationFunction::isIncremental
+    virtual bool isIncremental() const;
+
+    /// @see AggregationFunction::evaluateState
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const;
 
@@ -452,6 +525,12 @@ public:
     /// Applies the aggregation function to values \a values.
     virtual plot_t evaluate(std::vector<plot_t>& values) const;
 
+    /// @see AggregationFunction::isIncremental
+    virtual bool isIncremental() const;
+
+    /// @see AggregationFunction::evaluateState
+    virtual plot_t evaluateState(const AggregationState& state) const;
+
     /// Create a copy of the actuell AggregationFunction.
     virtual AggregationFunction* clone() const;
 
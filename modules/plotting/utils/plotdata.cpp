@@ -31,14 +31,22 @@
 #include "plotrow.h"
 #include "plotcell.h"
 
+#include "aggregationfunction.h"
+
 #include "tgt/assert.h"
 #include "tgt/logmanager.h"
+#include "tgt/types.h"
 
 #include <map>
 #include <vector>
 #include <algorithm>
 #include <limits>
 #include <sstream>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace voreen {
 
@@ -631,164 +639,272 @@ bool PlotData::rearrangeColumns(std::vector<int>& newKeyColumns, std::vector<int
     return true;
 }
 
-bool PlotData::groupBy(int groupColumn, const std::vector<std::pair<int, AggregationFunction*> >& functions, PlotData& target) const {
-    // check if all indexes are within bounds
-    if (groupColumn < 0 || groupColumn >= getColumnCount())
-        return false;
-    for (std::vector<std::pair<int, AggregationFunction*> >::const_iterator it = functions.begin(); it < functions.end(); ++it)
-        if (it->first < 0 || it->first >= getColumnCount())
-            return false;
+namespace {
 
-    target.reset(1, static_cast<int>(functions.size()));
+/// Key of a group built by PlotData::groupBy(): a value, a tag or the null cell.
+struct GroupKey {
+    enum Kind {
+        VALUE = 0,
+        TAG = 1,
+        NULLCELL = 2
+    };
 
-    // we will sort and group the data into hashmaps before applying the AggregationFunctions to them
-    std::map<plot_t, std::vector<plot_t>*> groupedByValues;
-    std::map<std::string, std::vector<plot_t>*> groupedByTags;
-    std::map<bool, std::vector<plot_t>*> groupedByNulls;
+    GroupKey(const PlotCellValue& cell)
+        : kind_(cell.isValue() ? VALUE : (cell.isNull() ? NULLCELL : TAG))
+        , value_(cell.isValue() ? cell.getValue() : 0)
+        , tag_(kind_ == TAG ? cell.getTag() : std::string())
+    {}
 
-    std::map<plot_t, std::vector<plot_t>*>::iterator gbvIt;
-    std::map<std::string, std::vector<plot_t>*>::iterator gbtIt;
-    std::map<bool, std::vector<plot_t>*>::iterator gbnIt;
-    // alright, we will start with grouping the data in our hashmaps
-    int funcCount = static_cast<int>(functions.size());
-    std::vector<PlotRowValue>::const_iterator rowIt;
-    for (rowIt = rows_.begin(); rowIt != rows_.end(); ++rowIt) {
-        const PlotCellValue& groupedCell = rowIt->getCellAt(groupColumn);
-
-        // check whether to group by value or by tag - here we group by value
-        if (groupedCell.isValue()) {
-            // check if the data in this cell is already in the hashmap -> a group for it already exists
-            gbvIt = groupedByValues.find(groupedCell.getValue());
-
-            // it is not in the hashmap -> create new group
-            if (gbvIt == groupedByValues.end()) {
-                // first we create an array of vector of plot_t where we will store the data which shall be aggregated:
-                std::vector<plot_t>* temp = new std::vector<plot_t>[funcCount]();
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-                groupedByValues.insert(std::pair<plot_t, std::vector<plot_t>*>(groupedCell.getValue(), temp));
-            }
-            // there is already an entry in the hashmap, so just push the values into the vector which shall be aggregated
-            else {
-                std::vector<plot_t>* temp = gbvIt->second;
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-            }
+    bool operator==(const GroupKey& rhs) const {
+        if (kind_ != rhs.kind_)
+            return false;
+        if (kind_ == VALUE)
+            return value_ == rhs.value_ || (value_ != value_ && rhs.value_ != rhs.value_);
+        return tag_ == rhs.tag_;
+    }
+
+    /// Same order as the former std::map based grouping: values, then tags, then null.
+    bool operator<(const GroupKey& rhs) const {
+        if (kind_ != rhs.kind_)
+            return kind_ < rhs.kind_;
+        if (kind_ == VALUE) {
+            // NaN keys go last to keep the order strict
+            if (rhs.value_ != rhs.value_)
+                return value_ == value_;
+            return value_ < rhs.value_;
         }
-        else if(groupedCell.isNull()) {
-            gbnIt = groupedByNulls.find(groupedCell.isNull());
-            if (gbnIt == groupedByNulls.end()) {
-                // first we create an array of vector of plot_t where we will store the data which shall be aggregated:
-                std::vector<plot_t>* temp = new std::vector<plot_t>[funcCount];
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-                groupedByNulls.insert(std::pair<bool, std::vector<plot_t>*>(groupedCell.isNull(), temp));
-            }
-            // there is already an entry in the hashmap, so just push the values into the vector which shall be aggregated
-            else {
-                std::vector<plot_t>* temp = gbnIt->second;
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-            }
+        return tag_ < rhs.tag_;
+    }
+
+    size_t hash() const {
+        uint64_t h;
+        if (kind_ == VALUE) {
+            // -0 and 0 as well as all NaNs fall into the same group
+            plot_t v = value_;
+            if (v == 0)
+                v = 0;
+            else if (v != v)
+                v = std::numeric_limits<plot_t>::quiet_NaN();
+            memcpy(&h, &v, sizeof(h));
         }
-        // ok, we group by tag
         else {
-            // check if the data in this cell is already in the hashmap -> a group for it already exists
-            gbtIt = groupedByTags.find(groupedCell.getTag());
-
-            // it is not in the hashmap -> create new group
-            if (gbtIt == groupedByTags.end()) {
-                // first we create an array of vector of plot_t where we will store the data which shall be aggregated:
-                std::vector<plot_t>* temp = new std::vector<plot_t>[funcCount];
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-                groupedByTags.insert(std::pair<std::string, std::vector<plot_t>*>(groupedCell.getTag(), temp));
-            }
-            // there is already an entry in the hashmap, so just push the values into the vector which shall be aggregated
-            else {
-                std::vector<plot_t>* temp = gbtIt->second;
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
+            // FNV-1a
+            h = 14695981039346656037ULL + kind_;
+            for (size_t i = 0; i < tag_.size(); ++i) {
+                h ^= static_cast<unsigned char>(tag_[i]);
+                h *= 1099511628211ULL;
             }
         }
+        // MurmurHash3 finalizer
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
     }
 
-    // grouping is done, now, we will insert the grouped data into the target PlotData
-    // first insert all groupedByValues rows
-    for (gbvIt = groupedByValues.begin(); gbvIt != groupedByValues.end(); ++gbvIt) {
-        std::vector<PlotCellValue> cells;
-        cells.push_back(PlotCellValue(gbvIt->first));
+    Kind kind_;
+    plot_t value_;
+    std::string tag_;
+};
+
+/**
+ * Open addressing hash table holding the groups of PlotData::groupBy(). Each group has one
+ * AggregationState per incremental function and one value list per other function.
+ */
+class GroupTable {
+public:
+    GroupTable(const std::vector<bool>& incremental)
+        : incremental_(incremental)
+        , funcCount_(incremental.size())
+        , slots_(64, 0)
+    {}
+
+    size_t size() const {
+        return keys_.size();
+    }
 
-        for (int i=0; i<funcCount; ++i) {
-            plot_t val = functions[i].second->evaluate(gbvIt->second[i]);
-            if (val != val){
-                cells.push_back(PlotCellValue());
-            }
-            else {
-                cells.push_back(PlotCellValue(functions[i].second->evaluate(gbvIt->second[i])));
-            }
+    const GroupKey& getKey(size_t group) const {
+        return keys_[group];
+    }
+
+    /// Returns the index of the group \a key, creates the group if it does not exist yet.
+    size_t findOrInsert(const GroupKey& key) {
+        size_t hash = key.hash();
+        size_t mask = slots_.size() - 1;
+        size_t slot = hash & mask;
+        while (slots_[slot] != 0) {
+            size_t group = slots_[slot] - 1;
+            if (hashes_[group] == hash && keys_[group] == key)
+                return group;
+            slot = (slot + 1) & mask;
         }
 
-        target.insert(cells);
+        keys_.push_back(key);
+        hashes_.push_back(hash);
+        states_.resize(states_.size() + funcCount_);
+        values_.resize(values_.size() + funcCount_);
+        slots_[slot] = keys_.size();
+
+        // keep the load factor at most 1/2
+        if (2 * keys_.size() > slots_.size())
+            rehash();
+        return keys_.size() - 1;
     }
 
-    // now insert all groupedByTags rows
-    for (gbtIt = groupedByTags.begin(); gbtIt != groupedByTags.end(); ++gbtIt) {
-        std::vector<PlotCellValue> cells;
-        cells.push_back(PlotCellValue(gbtIt->first));
+    /// Adds the aggregated column values of \a row to group \a group.
+    void add(size_t group, const PlotRowValue& row, const std::vector<std::pair<int, AggregationFunction*> >& functions) {
+        size_t base = group * funcCount_;
+        for (size_t i = 0; i < funcCount_; ++i) {
+            if (incremental_[i])
+                states_[base + i].add(row.getValueAt(functions[i].first));
+            else
+                values_[base + i].push_back(row.getValueAt(functions[i].first));
+        }
+    }
 
-        for (int i=0; i<funcCount; ++i) {
-            plot_t val = functions[i].second->evaluate(gbtIt->second[i]);
-            if (val != val){
-                cells.push_back(PlotCellValue());
-            }
-            else {
-                cells.push_back(PlotCellValue(functions[i].second->evaluate(gbtIt->second[i])));
+    /// Merges all groups of \a other into this table, values of \a other are appended.
+    void merge(const GroupTable& other) {
+        for (size_t g = 0; g < other.size(); ++g) {
+            size_t base = findOrInsert(other.keys_[g]) * funcCount_;
+            size_t otherBase = g * funcCount_;
+            for (size_t i = 0; i < funcCount_; ++i) {
+                if (incremental_[i]) {
+                    states_[base + i].merge(other.states_[otherBase + i]);
+                }
+                else {
+                    const std::vector<plot_t>& src = other.values_[otherBase + i];
+                    values_[base + i].insert(values_[base + i].end(), src.begin(), src.end());
+                }
             }
         }
+    }
 
-        target.insert(cells);
+    /// Applies \a function, the i-th of the grouping functions, to group \a group.
+    plot_t evaluate(size_t group, size_t i, const AggregationFunction* function) {
+        size_t index = group * funcCount_ + i;
+        if (incremental_[i])
+            return function->evaluateState(states_[index]);
+        return function->evaluate(values_[index]);
     }
-        // now insert all groupedByNulls rows
-    for (gbnIt = groupedByNulls.begin(); gbnIt != groupedByNulls.end(); ++gbnIt) {
-        std::vector<PlotCellValue> cells;
-        cells.push_back(PlotCellValue());
 
-        for (int i=0; i<funcCount; ++i) {
-            plot_t val = functions[i].second->evaluate(gbnIt->second[i]);
-            if (val != val){
-                cells.push_back(PlotCellValue());
-            }
-            else {
-                cells.push_back(PlotCellValue(functions[i].second->evaluate(gbnIt->second[i])));
-            }
+private:
+    void rehash() {
+        std::vector<size_t> slots(2 * slots_.size(), 0);
+        size_t mask = slots.size() - 1;
+        for (size_t group = 0; group < keys_.size(); ++group) {
+            size_t slot = hashes_[group] & mask;
+            while (slots[slot] != 0)
+                slot = (slot + 1) & mask;
+            slots[slot] = group + 1;
         }
+        slots_.swap(slots);
+    }
 
-        target.insert(cells);
+    const std::vector<bool>& incremental_;
+    size_t funcCount_;
+
+    std::vector<GroupKey> keys_;
+    std::vector<size_t> hashes_;
+    std::vector<AggregationState> states_;          ///< funcCount_ states per group
+    std::vector<std::vector<plot_t> > values_;      ///< funcCount_ value lists per group
+    std::vector<size_t> slots_;                     ///< group index + 1, 0 marks an empty slot
+};
+
+/// Orders group indices by their keys.
+class GroupKeyLess {
+public:
+    GroupKeyLess(const GroupTable& table)
+        : table_(table)
+    {}
+
+    bool operator()(size_t lhs, size_t rhs) const {
+        return table_.getKey(lhs) < table_.getKey(rhs);
     }
 
-    // finally free all data which is not necessary anymore:
-    while (groupedByValues.size() > 0) {
-        gbvIt = groupedByValues.begin();
-        delete [] gbvIt->second;
-        groupedByValues.erase(gbvIt);
+private:
+    const GroupTable& table_;
+};
+
+} // namespace
+
+bool PlotData::groupBy(int groupColumn, const std::vector<std::pair<int, AggregationFunction*> >& functions, PlotData& target) const {
+    // check if all indexes are within bounds
+    if (groupColumn < 0 || groupColumn >= getColumnCount())
+        return false;
+    for (std::vector<std::pair<int, AggregationFunction*> >::const_iterator it = functions.begin(); it < functions.end(); ++it)
+        if (it->first < 0 || it->first >= getColumnCount())
+            return false;
+
+    target.reset(1, static_cast<int>(functions.size()));
+
+    // incremental functions are aggregated on the fly, all others need the values of the whole group
+    int funcCount = static_cast<int>(functions.size());
+    std::vector<bool> incremental(funcCount);
+    for (int i = 0; i < funcCount; ++i)
+        incremental[i] = functions[i].second->isIncremental();
+
+    // each thread groups a contiguous range of rows into its own hash table, the tables are
+    // merged in thread order afterwards so that value lists keep the row order
+    int rowCount = static_cast<int>(rows_.size());
+    int threadCount = 1;
+#ifdef _OPENMP
+    if (rowCount >= 16384)
+        threadCount = omp_get_max_threads();
+#endif
+    std::vector<GroupTable*> tables(threadCount, static_cast<GroupTable*>(0));
+
+    #pragma omp parallel num_threads(threadCount)
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        GroupTable* table = new GroupTable(incremental);
+        tables[thread] = table;
+
+        #pragma omp for schedule(static)
+        for (int r = 0; r < rowCount; ++r) {
+            const PlotRowValue& row = rows_[r];
+            table->add(table->findOrInsert(GroupKey(row.getCellAt(groupColumn))), row, functions);
+        }
     }
-    while (groupedByTags.size() > 0) {
-        gbtIt = groupedByTags.begin();
-        delete [] gbtIt->second;
-        groupedByTags.erase(gbtIt);
+    for (int t = 1; t < threadCount; ++t) {
+        if (tables[t]) {
+            tables[0]->merge(*tables[t]);
+            delete tables[t];
+        }
     }
-    while (groupedByNulls.size() > 0) {
-        gbnIt = groupedByNulls.begin();
-        delete [] gbnIt->second;
-        groupedByNulls.erase(gbnIt);
+    GroupTable& groups = *tables[0];
+
+    // insert the grouped rows into the target PlotData: values ascending, then tags, then null
+    std::vector<size_t> order(groups.size());
+    for (size_t g = 0; g < order.size(); ++g)
+        order[g] = g;
+    std::sort(order.begin(), order.end(), GroupKeyLess(groups));
+
+    for (size_t g = 0; g < order.size(); ++g) {
+        const GroupKey& key = groups.getKey(order[g]);
+        std::vector<PlotCellValue> cells;
+        if (key.kind_ == GroupKey::VALUE)
+            cells.push_back(PlotCellValue(key.value_));
+        else if (key.kind_ == GroupKey::TAG)
+            cells.push_back(PlotCellValue(key.tag_));
+        else
+            cells.push_back(PlotCellValue());
+
+        for (int i=0; i<funcCount; ++i) {
+            plot_t val = groups.evaluate(order[g], i, functions[i].second);
+            if (val != val)
+                cells.push_back(PlotCellValue());
+            else
+                cells.push_back(PlotCellValue(val));
+        }
+
+        target.insert(cells);
     }
+    delete tables[0];
 
     for (int i = 0; i < static_cast<int>(functions.size()); ++i) {
         target.setColumnLabel(i+1,getColumnLabel(functions.at(i).first));
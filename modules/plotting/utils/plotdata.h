@@ -270,6 +270,8 @@ public:
      *          in the columns with indices referred as second part in \a functions will be aggregated with the according
      *          AggregationFunction and inserted into the corresponding grouped PlotRow.
      *          \a target will be reset before inserting the rows: column count will be (1+functions.size()).
+     *          Rows are grouped in a hash table, incremental AggregationFunctions are aggregated on the fly
+     *          (@see AggregationFunction::isIncremental()) and large data is grouped in parallel.
      *
      * \param   groupColumn     column index to apply grouping to
      * \param   functions       set of pairs of an AggregationFunction and a column index which specifies where to apply
@@ -0,0 +1,412 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "brickedvolume.h"
+
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/io/serialization/serialization.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <zlib.h>
+
+using tgt::ivec3;
+using tgt::svec3;
+
+namespace {
+
+/// Seeks to a 64 bit file position.
+bool seekFile(FILE* file, int64_t pos) {
+#ifdef _MSC_VER
+    return (_fseeki64(file, pos, SEEK_SET) == 0);
+#else
+    return (fseeko(file, static_cast<off_t>(pos), SEEK_SET) == 0);
+#endif
+}
+
+} // namespace
+
+namespace voreen {
+
+BrickedVolumeIndex::BrickedVolumeIndex()
+    : dimensions_(0)
+    , brickSize_(64)
+{}
+
+BrickedVolumeIndex::BrickedVolumeIndex(const std::string& filename, const std::string& format,
+                                       tgt::ivec3 dimensions, tgt::ivec3 brickSize)
+    : filename_(filename)
+    , format_(format)
+    , dimensions_(dimensions)
+    , brickSize_(brickSize)
+{}
+
+tgt::ivec3 BrickedVolumeIndex::getNumBricks() const {
+    return (dimensions_ + brickSize_ - 1) / brickSize_;
+}
+
+size_t BrickedVolumeIndex::getBrickIndex(const tgt::ivec3& brick) const {
+    ivec3 numBricks = getNumBricks();
+    return (static_cast<size_t>(brick.z) * numBricks.y + brick.y) * numBricks.x + brick.x;
+}
+
+tgt::ivec3 BrickedVolumeIndex::getBrickDimensions(const tgt::ivec3& brick) const {
+    ivec3 llf = brick * brickSize_;
+    return tgt::min(llf + brickSize_, dimensions_) - llf;
+}
+
+int64_t BrickedVolumeIndex::getBrickOffset(size_t index) const {
+    tgtAssert(index < offsets_.size(), "invalid brick index");
+    return offsets_[index];
+}
+
+size_t BrickedVolumeIndex::getCompressedBrickSize(size_t index) const {
+    tgtAssert(index < compressedSizes_.size(), "invalid brick index");
+    return static_cast<size_t>(compressedSizes_[index]);
+}
+
+void BrickedVolumeIndex::setCompressedBrickSizes(const std::vector<int>& sizes) {
+    compressedSizes_ = sizes;
+    updateOffsets();
+}
+
+void BrickedVolumeIndex::updateOffsets() {
+    offsets_.resize(compressedSizes_.size());
+    int64_t offset = 0;
+    for (size_t i = 0; i < compressedSizes_.size(); i++) {
+        offsets_[i] = offset;
+        offset += compressedSizes_[i];
+    }
+}
+
+void BrickedVolumeIndex::serialize(XmlSerializer& s) const {
+    s.serialize("filename", filename_);
+    s.serialize("format", format_);
+    s.serialize("dimensions", dimensions_);
+    s.serialize("brickSize", brickSize_);
+    s.serialize("compression", std::string("zlib"));
+    s.serialize("BrickSizes", compressedSizes_, "b");
+}
+
+void BrickedVolumeIndex::deserialize(XmlDeserializer& s) {
+    s.deserialize("filename", filename_);
+    s.deserialize("format", format_);
+    s.deserialize("dimensions", dimensions_);
+    s.deserialize("brickSize", brickSize_);
+    std::string compression;
+    s.deserialize("compression", compression);
+    if (compression != "zlib")
+        throw XmlSerializationFormatException("Unsupported brick compression: " + compression);
+    s.deserialize("BrickSizes", compressedSizes_, "b");
+    if (compressedSizes_.size() != static_cast<size_t>(tgt::hmul(getNumBricks())))
+        throw XmlSerializationFormatException("Number of bricks does not match the volume dimensions");
+    updateOffsets();
+}
+
+//-----------------------------------------------------------------------------
+
+BrickedVolumeFile::BrickedVolumeFile(const std::string& path, const BrickedVolumeIndex& index)
+    : path_(path)
+    , index_(index)
+    , bytesPerVoxel_(1)
+    , refCount_(0)
+    , file_(0)
+{
+    // create one voxel volume to get bytes per voxel for current type
+    VolumeFactory vf;
+    Volume* volume = vf.create(index_.getFormat(), tgt::svec3(1,1,1));
+    if (volume) {
+        bytesPerVoxel_ = volume->getBytesPerVoxel();
+        delete volume;
+    }
+}
+
+BrickedVolumeFile::~BrickedVolumeFile() {
+    BrickCache::getInstance()->removeBricks(this);
+    if (file_)
+        fclose(file_);
+}
+
+size_t BrickedVolumeFile::getBrickSizeInBytes(size_t index) const {
+    ivec3 numBricks = index_.getNumBricks();
+    ivec3 brick(static_cast<int>(index % numBricks.x),
+                static_cast<int>((index / numBricks.x) % numBricks.y),
+                static_cast<int>(index / (static_cast<size_t>(numBricks.x) * numBricks.y)));
+    return tgt::hmul(svec3(index_.getBrickDimensions(brick))) * static_cast<size_t>(bytesPerVoxel_);
+}
+
+void BrickedVolumeFile::readBrick(size_t index, char* dest) const throw (tgt::IOException) {
+    size_t compressedSize = index_.getCompressedBrickSize(index);
+    std::vector<char> compressed(compressedSize);
+
+    // the file handle is shared, so only the decompression is done concurrently
+    bool opened = true;
+    bool success = false;
+    #pragma omp critical (BrickedVolumeFileRead)
+    {
+        if (!file_)
+            file_ = fopen(path_.c_str(), "rb");
+        opened = (file_ != 0);
+        success = opened && seekFile(file_, index_.getBrickOffset(index))
+            && (compressedSize == 0 || fread(&compressed[0], compressedSize, 1, file_) == 1);
+    }
+    if (!opened)
+        throw tgt::IOException("Unable to open brick file for reading", path_);
+    if (!success)
+        throw tgt::IOException("Failed to read brick", path_);
+
+    uLongf destSize = static_cast<uLongf>(getBrickSizeInBytes(index));
+    uLongf expectedSize = destSize;
+    if (uncompress(reinterpret_cast<Bytef*>(dest), &destSize,
+                   reinterpret_cast<const Bytef*>(compressedSize ? &compressed[0] : 0),
+                   static_cast<uLong>(compressedSize)) != Z_OK || destSize != expectedSize)
+    {
+        throw tgt::IOException("Failed to decompress brick", path_);
+    }
+}
+
+void BrickedVolumeFile::addReference() {
+    refCount_++;
+}
+
+void BrickedVolumeFile::removeReference() {
+    refCount_--;
+    if (refCount_ <= 0)
+        delete this;
+}
+
+//-----------------------------------------------------------------------------
+
+const std::string BrickCache::loggerCat_("voreen.zip.BrickCache");
+
+BrickCache::BrickCache()
+    : memoryBudget_(512 << 20)
+    , memoryUsage_(0)
+{}
+
+BrickCache* BrickCache::getInstance() {
+    static BrickCache instance;
+    return &instance;
+}
+
+void BrickCache::setMemoryBudget(size_t bytes) {
+    memoryBudget_ = bytes;
+    evict();
+}
+
+size_t BrickCache::getMemoryBudget() const {
+    return memoryBudget_;
+}
+
+size_t BrickCache::getMemoryUsage() const {
+    return memoryUsage_;
+}
+
+const char* BrickCache::getBrick(const BrickedVolumeFile* file, size_t brickIndex) throw (tgt::IOException) {
+    tgtAssert(file, "no file");
+    BrickKey key(file, brickIndex);
+    std::map<BrickKey, EntryList::iterator>::iterator it = lookup_.find(key);
+    if (it != lookup_.end()) {
+        // move to front
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &entries_.front().data_[0];
+    }
+
+    std::vector<char> data(file->getBrickSizeInBytes(brickIndex));
+    file->readBrick(brickIndex, &data[0]);
+    insert(key, data);
+    return &entries_.front().data_[0];
+}
+
+void BrickCache::prefetch(const BrickedVolumeFile* file, const std::vector<size_t>& brickIndices) throw (tgt::IOException) {
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < brickIndices.size(); i++) {
+        if (lookup_.find(BrickKey(file, brickIndices[i])) == lookup_.end())
+            missing.push_back(brickIndices[i]);
+    }
+    if (missing.empty())
+        return;
+
+    std::vector<std::vector<char> > data(missing.size());
+    bool failed = false;
+    std::string error;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < static_cast<int>(missing.size()); i++) {
+        try {
+            data[i].resize(file->getBrickSizeInBytes(missing[i]));
+            file->readBrick(missing[i], &data[i][0]);
+        }
+        catch (tgt::IOException& e) {
+            #pragma omp critical
+            {
+                failed = true;
+                error = e.what();
+            }
+        }
+    }
+    if (failed)
+        throw tgt::IOException(error, file->getPath());
+
+    for (size_t i = 0; i < missing.size(); i++)
+        insert(BrickKey(file, missing[i]), data[i]);
+}
+
+void BrickCache::insert(const BrickKey& key, std::vector<char>& data) {
+    entries_.push_front(CacheEntry());
+    entries_.front().key_ = key;
+    entries_.front().data_.swap(data);
+    lookup_[key] = entries_.begin();
+    memoryUsage_ += entries_.front().data_.size();
+    evict();
+}
+
+void BrickCache::evict() {
+    while (memoryUsage_ > memoryBudget_ && entries_.size() > 1) {
+        memoryUsage_ -= entries_.back().data_.size();
+        lookup_.erase(entries_.back().key_);
+        entries_.pop_back();
+    }
+}
+
+void BrickCache::removeBricks(const BrickedVolumeFile* file) {
+    EntryList::iterator it = entries_.begin();
+    while (it != entries_.end()) {
+        if (it->key_.first == file) {
+            memoryUsage_ -= it->data_.size();
+            lookup_.erase(it->key_);
+            it = entries_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void BrickCache::clear() {
+    entries_.clear();
+    lookup_.clear();
+    memoryUsage_ = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+const std::string BrickedDiskRepresentation::loggerCat_("voreen.zip.BrickedDiskRepresentation");
+
+BrickedDiskRepresentation::BrickedDiskRepresentation(BrickedVolumeFile* file, const VolumeRepresentation::VolumeBorders& border)
+    : DiskRepresentation(file->getPath(), file->getIndex().getFormat(), file->getIndex().getDimensions(), 0, border)
+    , file_(file)
+{
+    file_->addReference();
+}
+
+BrickedDiskRepresentation::BrickedDiskRepresentation(BrickedVolumeFile* file, tgt::ivec3 dimensions,
+        tgt::svec3 subVolumeOffset, const VolumeRepresentation::VolumeBorders& border)
+    : DiskRepresentation(file->getPath(), file->getIndex().getFormat(), dimensions, 0, border)
+    , file_(file)
+{
+    fileDimensions_ = svec3(file_->getIndex().getDimensions());
+    subVolumeOffset_ = subVolumeOffset;
+    file_->addReference();
+}
+
+BrickedDiskRepresentation::~BrickedDiskRepresentation() {
+    file_->removeReference();
+}
+
+DiskRepresentation* BrickedDiskRepresentation::getSubVolume(tgt::svec3 dimensions, tgt::svec3 offset,
+    const VolumeRepresentation::VolumeBorders& border) const throw (std::bad_alloc)
+{
+    BrickedDiskRepresentation* newDiskRep = new BrickedDiskRepresentation(file_, ivec3(dimensions), subVolumeOffset_ + offset, border);
+    newDiskRep->originalDimensions_ = dimensions_;
+    return newDiskRep;
+}
+
+void BrickedDiskRepresentation::readVoxels(void* buffer) const throw (tgt::IOException) {
+    const BrickedVolumeIndex& index = file_->getIndex();
+    size_t bytesPerVoxel = static_cast<size_t>(file_->getBytesPerVoxel());
+    char* dest = reinterpret_cast<char*>(buffer);
+
+    // region to read in volume coordinates, may exceed the volume due to the border
+    ivec3 volumeDims = index.getDimensions();
+    ivec3 regionLlf = ivec3(subVolumeOffset_) - ivec3(borders_.llf);
+    ivec3 regionDims = ivec3(getDimensionsWithBorder());
+    ivec3 validLlf = tgt::max(regionLlf, ivec3(0));
+    ivec3 validUrb = tgt::min(regionLlf + regionDims, volumeDims);
+
+    if (validLlf != regionLlf || validUrb != regionLlf + regionDims)
+        memset(dest, 0, getNumVoxelsWithBorder() * bytesPerVoxel);
+    if (tgt::hor(tgt::greaterThanEqual(validLlf, validUrb)))
+        return;
+
+    ivec3 brickSize = index.getBrickSize();
+    ivec3 firstBrick = validLlf / brickSize;
+    ivec3 lastBrick = (validUrb - 1) / brickSize;
+    BrickCache* cache = BrickCache::getInstance();
+
+    // process one slab of bricks at a time: decompress its missing bricks in parallel,
+    // as long as they fit into the cache, and then copy the intersecting rows
+    for (int bz = firstBrick.z; bz <= lastBrick.z; bz++) {
+        std::vector<size_t> slabBricks;
+        size_t slabBytes = 0;
+        for (int by = firstBrick.y; by <= lastBrick.y; by++) {
+            for (int bx = firstBrick.x; bx <= lastBrick.x; bx++) {
+                size_t brickIndex = index.getBrickIndex(ivec3(bx, by, bz));
+                slabBricks.push_back(brickIndex);
+                slabBytes += file_->getBrickSizeInBytes(brickIndex);
+            }
+        }
+        if (slabBytes <= cache->getMemoryBudget())
+            cache->prefetch(file_, slabBricks);
+
+        for (int by = firstBrick.y; by <= lastBrick.y; by++) {
+            for (int bx = firstBrick.x; bx <= lastBrick.x; bx++) {
+                ivec3 brick(bx, by, bz);
+                ivec3 brickLlf = brick * brickSize;
+                ivec3 brickDims = index.getBrickDimensions(brick);
+                const char* brickData = cache->getBrick(file_, index.getBrickIndex(brick));
+
+                ivec3 llf = tgt::max(validLlf, brickLlf);
+                ivec3 urb = tgt::min(validUrb, brickLlf + brickDims);
+                size_t rowBytes = static_cast<size_t>(urb.x - llf.x) * bytesPerVoxel;
+                for (int z = llf.z; z < urb.z; z++) {
+                    for (int y = llf.y; y < urb.y; y++) {
+                        size_t srcIndex = (static_cast<size_t>(z - brickLlf.z) * brickDims.y + static_cast<size_t>(y - brickLlf.y)) * brickDims.x
+                            + static_cast<size_t>(llf.x - brickLlf.x);
+                        size_t destIndex = (static_cast<size_t>(z - regionLlf.z) * regionDims.y + static_cast<size_t>(y - regionLlf.y)) * regionDims.x
+                            + static_cast<size_t>(llf.x - regionLlf.x);
+                        memcpy(dest + destIndex * bytesPerVoxel, brickData + srcIndex * bytesPerVoxel, rowBytes);
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace voreen
@@ -0,0 +1,235 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_BRICKEDVOLUME_H
+#define VRN_BRICKEDVOLUME_H
+
+#include "modules/zip/zipmoduledefine.h"
+
+#include "voreen/core/io/serialization/serializable.h"
+#include "voreen/core/datastructures/volume/diskrepresentation.h"
+
+#include "tgt/exception.h"
+#include "tgt/vector.h"
+
+#include <cstdio>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+/**
+ * Layout and brick index of a bricked volume file.
+ *
+ * The volume is divided into bricks of fixed size (bricks at the upper
+ * volume boundaries are cropped), which are stored one after another in
+ * x, y, z order, each compressed independently with zlib.
+ */
+class VRN_MODULE_ZIP_API BrickedVolumeIndex : public Serializable {
+public:
+    BrickedVolumeIndex();
+    BrickedVolumeIndex(const std::string& filename, const std::string& format,
+                       tgt::ivec3 dimensions, tgt::ivec3 brickSize);
+
+    /// File containing the compressed bricks, relative to the header file.
+    std::string getFilename() const { return filename_; }
+    /// @see VolumeFactory
+    std::string getFormat() const { return format_; }
+    tgt::ivec3 getDimensions() const { return dimensions_; }
+    tgt::ivec3 getBrickSize() const { return brickSize_; }
+
+    /// Returns the number of bricks per dimension.
+    tgt::ivec3 getNumBricks() const;
+    /// Returns the linear index of the brick at the passed brick position.
+    size_t getBrickIndex(const tgt::ivec3& brick) const;
+    /// Returns the dimensions of the brick at the passed brick position, which are cropped at the volume boundary.
+    tgt::ivec3 getBrickDimensions(const tgt::ivec3& brick) const;
+
+    /// Returns the byte offset of the compressed brick in the file.
+    int64_t getBrickOffset(size_t index) const;
+    /// Returns the size of the compressed brick in bytes.
+    size_t getCompressedBrickSize(size_t index) const;
+    /// Sets the compressed sizes of all bricks in linear brick order.
+    void setCompressedBrickSizes(const std::vector<int>& sizes);
+
+    virtual void serialize(XmlSerializer& s) const;
+    virtual void deserialize(XmlDeserializer& s);
+
+private:
+    void updateOffsets();
+
+    std::string filename_;
+    std::string format_;
+    tgt::ivec3 dimensions_;
+    tgt::ivec3 brickSize_;
+    std::vector<int> compressedSizes_;
+    std::vector<int64_t> offsets_;
+};
+
+/**
+ * A bricked volume file opened for reading. The object is reference counted,
+ * since it is shared by all disk representations referring to the file.
+ * The file is kept open as long as the object exists.
+ */
+class VRN_MODULE_ZIP_API BrickedVolumeFile {
+public:
+    /**
+     * @param path absolute path of the file containing the compressed bricks
+     */
+    BrickedVolumeFile(const std::string& path, const BrickedVolumeIndex& index);
+
+    std::string getPath() const { return path_; }
+    const BrickedVolumeIndex& getIndex() const { return index_; }
+    int getBytesPerVoxel() const { return bytesPerVoxel_; }
+
+    /// Returns the size of the uncompressed brick in bytes.
+    size_t getBrickSizeInBytes(size_t index) const;
+
+    /**
+     * Reads and decompresses a brick. Thread-safe: reading is serialized,
+     * decompression is done concurrently.
+     *
+     * @param dest buffer of at least getBrickSizeInBytes(index) bytes
+     * @throw tgt::IOException if the brick could not be read or decompressed
+     */
+    void readBrick(size_t index, char* dest) const throw (tgt::IOException);
+
+    void addReference();
+    /// Deletes the object, if no references are left.
+    void removeReference();
+
+private:
+    ~BrickedVolumeFile();
+
+    std::string path_;
+    BrickedVolumeIndex index_;
+    int bytesPerVoxel_;
+    int refCount_;
+    mutable FILE* file_; ///< opened on first read
+};
+
+/**
+ * Least recently used cache of decompressed bricks, which is shared by all
+ * bricked volumes. The cache evicts bricks as soon as its memory usage exceeds
+ * the memory budget, though the most recently used brick is always kept.
+ *
+ * @note The cache must not be accessed by multiple threads concurrently.
+ *  Bricks are decompressed in parallel by prefetch(), though.
+ */
+class VRN_MODULE_ZIP_API BrickCache {
+public:
+    static BrickCache* getInstance();
+
+    /**
+     * Sets the memory budget in bytes and evicts bricks, if necessary. Default: 512 MB
+     *
+     * @see BrickedVvdVolumeReader for setting the budget on reading a volume
+     */
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+    /// Returns the memory currently occupied by cached bricks.
+    size_t getMemoryUsage() const;
+
+    /**
+     * Returns the decompressed brick, reading it from disk if it is not cached.
+     * The returned pointer is valid until the next call of getBrick, prefetch or clear.
+     *
+     * @throw tgt::IOException if the brick could not be read
+     */
+    const char* getBrick(const BrickedVolumeFile* file, size_t brickIndex) throw (tgt::IOException);
+
+    /**
+     * Reads the passed bricks that are not cached yet, decompressing them in parallel.
+     *
+     * @throw tgt::IOException if a brick could not be read
+     */
+    void prefetch(const BrickedVolumeFile* file, const std::vector<size_t>& brickIndices) throw (tgt::IOException);
+
+    /// Removes all bricks of the passed file from the cache.
+    void removeBricks(const BrickedVolumeFile* file);
+    void clear();
+
+private:
+    typedef std::pair<const BrickedVolumeFile*, size_t> BrickKey;
+    struct CacheEntry {
+        BrickKey key_;
+        std::vector<char> data_;
+    };
+    typedef std::list<CacheEntry> EntryList;
+
+    BrickCache();
+
+    /// Inserts an entry as most recently used one and swaps the data into it.
+    void insert(const BrickKey& key, std::vector<char>& data);
+    /// Evicts least recently used bricks until the usage is within the budget.
+    void evict();
+
+    EntryList entries_; ///< most recently used first
+    std::map<BrickKey, EntryList::iterator> lookup_;
+    size_t memoryBudget_;
+    size_t memoryUsage_;
+
+    static const std::string loggerCat_;
+};
+
+/**
+ * Disk representation of a bricked volume file (or a sub volume of it).
+ * Voxels are assembled from the bricks intersecting the requested region,
+ * which are paged through the BrickCache.
+ */
+class VRN_MODULE_ZIP_API BrickedDiskRepresentation : public DiskRepresentation {
+public:
+    BrickedDiskRepresentation(BrickedVolumeFile* file,
+        const VolumeRepresentation::VolumeBorders& border = VolumeRepresentation::VolumeBorders());
+    virtual ~BrickedDiskRepresentation();
+
+    const BrickedVolumeFile* getBrickedFile() const { return file_; }
+
+    virtual DiskRepresentation* getSubVolume(tgt::svec3 dimensions, tgt::svec3 offset = tgt::svec3(0,0,0),
+        const VolumeRepresentation::VolumeBorders& border = VolumeRepresentation::VolumeBorders()) const throw (std::bad_alloc);
+
+    /// Compressed bricks never form a contiguous raw byte range.
+    virtual bool isContiguous() const { return false; }
+
+    virtual void readVoxels(void* buffer) const throw (tgt::IOException);
+
+protected:
+    /// Creates a sub volume representation of the file.
+    BrickedDiskRepresentation(BrickedVolumeFile* file, tgt::ivec3 dimensions,
+        tgt::svec3 subVolumeOffset, const VolumeRepresentation::VolumeBorders& border);
+
+    BrickedVolumeFile* file_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_BRICKEDVOLUME_H
@@ -0,0 +1,56 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "brickedvvdformat.h"
+
+namespace voreen {
+
+BrickedVvdObject::BrickedVvdObject(const VolumeHandleBase* vh, const BrickedVolumeIndex& index)
+    : index_(index)
+{
+    copyMetaData(vh);
+}
+
+VolumeHandle* BrickedVvdObject::createVolume(std::string directory) {
+    BrickedVolumeFile* file = new BrickedVolumeFile(directory + "/" + index_.getFilename(), index_);
+    VolumeRepresentation* volume = new BrickedDiskRepresentation(file);
+    return new VolumeHandle(volume, &metaData_);
+}
+
+void BrickedVvdObject::serialize(XmlSerializer& s) const {
+    s.serialize("BrickedData", index_);
+    metaData_.serialize(s);
+}
+
+void BrickedVvdObject::deserialize(XmlDeserializer& s) {
+    s.deserialize("BrickedData", index_);
+    metaData_.deserialize(s);
+    renameLegacyMetaData();
+}
+
+} // namespace voreen
@@ -0,0 +1,61 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_BRICKEDVVDFORMAT_H
+#define VRN_BRICKEDVVDFORMAT_H
+
+#include "voreen/core/io/vvdformat.h"
+#include "brickedvolume.h"
+
+namespace voreen {
+
+/**
+ * Helper class to save and load bricked .bvvd files. In contrast to VvdObject,
+ * the header references a file of independently compressed bricks and
+ * stores their index.
+ */
+class VRN_MODULE_ZIP_API BrickedVvdObject : public VvdObject {
+public:
+    BrickedVvdObject() {}
+    BrickedVvdObject(const VolumeHandleBase* vh, const BrickedVolumeIndex& index);
+
+    const BrickedVolumeIndex& getIndex() const { return index_; }
+
+    /// Creates a volume handle with a BrickedDiskRepresentation. The brick file name is relative to \p directory.
+    virtual VolumeHandle* createVolume(std::string directory);
+
+    virtual void serialize(XmlSerializer& s) const;
+    virtual void deserialize(XmlDeserializer& s);
+
+private:
+    BrickedVolumeIndex index_;
+};
+
+} // namespace voreen
+
+#endif // VRN_BRICKEDVVDFORMAT_H
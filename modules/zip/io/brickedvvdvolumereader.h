@@ -0,0 +1,64 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_BRICKEDVVDVOLUMEREADER_H
+#define VRN_BRICKEDVVDVOLUMEREADER_H
+
+#include "modules/zip/zipmoduledefine.h"
+#include "voreen/core/io/volumereader.h"
+
+namespace voreen {
+
+/**
+ * Reads bricked, zlib compressed volumes (.bvvd header plus brick file).
+ * The voxel data is not loaded on reading: bricks are decompressed on demand
+ * and paged through the BrickCache.
+ *
+ * The memory budget of the BrickCache, which is shared by all bricked volumes,
+ * can be set in MB by the search parameter "brickCacheSize", e.g. "volume.bvvd?brickCacheSize=2048".
+ *
+ * @see BrickedVvdVolumeWriter
+ */
+class VRN_MODULE_ZIP_API BrickedVvdVolumeReader : public VolumeReader {
+public:
+    BrickedVvdVolumeReader(ProgressBar* progress = 0);
+    virtual VolumeReader* create(ProgressBar* progress = 0) const;
+
+    virtual std::string getClassName() const   { return "BrickedVvdVolumeReader"; }
+    virtual std::string getFormatDescription() const { return "Bricked and compressed Voreen volume format"; }
+
+    virtual VolumeCollection* read(const std::string& url)
+        throw (tgt::FileException, std::bad_alloc);
+
+private:
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_BRICKEDVVDVOLUMEREADER_H
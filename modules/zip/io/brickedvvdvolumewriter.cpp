@@ -0,0 +1,218 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "brickedvvdvolumewriter.h"
+#include "brickedvvdformat.h"
+
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/io/progressbar.h"
+
+#include "tgt/filesystem.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <zlib.h>
+
+using tgt::ivec3;
+using tgt::svec3;
+
+namespace voreen {
+
+const std::string BrickedVvdVolumeWriter::loggerCat_("voreen.zip.BrickedVvdVolumeWriter");
+
+BrickedVvdVolumeWriter::BrickedVvdVolumeWriter(ProgressBar* progress)
+    : VolumeWriter(progress)
+    , brickSize_(64)
+    , compressionLevel_(1)
+{
+    extensions_.push_back("bvvd");
+}
+
+VolumeWriter* BrickedVvdVolumeWriter::create(ProgressBar* progress) const {
+    return new BrickedVvdVolumeWriter(progress);
+}
+
+void BrickedVvdVolumeWriter::setBrickSize(int brickSize) {
+    tgtAssert(brickSize > 0, "invalid brick size");
+    brickSize_ = brickSize;
+}
+
+int BrickedVvdVolumeWriter::getBrickSize() const {
+    return brickSize_;
+}
+
+void BrickedVvdVolumeWriter::setCompressionLevel(int level) {
+    compressionLevel_ = level;
+}
+
+int BrickedVvdVolumeWriter::getCompressionLevel() const {
+    return compressionLevel_;
+}
+
+void BrickedVvdVolumeWriter::write(const std::string& filename, const VolumeHandleBase* volumeHandle)
+    throw (tgt::IOException)
+{
+    tgtAssert(volumeHandle, "No volume handle");
+
+    // read voxels from the disk representation, if the volume has not been loaded yet
+    const Volume* volume = 0;
+    const DiskRepresentation* disk = 0;
+    if (!volumeHandle->hasRepresentation<Volume>() && volumeHandle->hasRepresentation<DiskRepresentation>())
+        disk = volumeHandle->getRepresentation<DiskRepresentation>();
+    else
+        volume = volumeHandle->getRepresentation<Volume>();
+    if (!volume && !disk) {
+        LWARNING("No volume");
+        return;
+    }
+
+    VolumeFactory vf;
+    std::string format = (volume ? vf.getType(volume) : disk->getFormat());
+    int bytesPerVoxel = (volume ? volume->getBytesPerVoxel() : disk->getBytesPerVoxel());
+    ivec3 dims = ivec3(volumeHandle->getDimensions());
+    if (format.empty())
+        throw tgt::IOException("Format currently not supported", filename);
+
+    std::string headerName = filename;
+    std::string brickName = getFileNameWithoutExtension(filename) + ".bricks";
+    LINFO("saving " << headerName << " and " << brickName);
+
+    // BRICKS: ------------------------
+
+    std::fstream brickOut(brickName.c_str(), std::ios::out | std::ios::binary);
+    if (!brickOut.is_open() || brickOut.bad())
+        throw tgt::IOException("Unable to open brick file for writing", brickName);
+
+    BrickedVolumeIndex index(tgt::FileSystem::fileName(brickName), format, dims, ivec3(brickSize_));
+    ivec3 numBricks = index.getNumBricks();
+    std::vector<int> compressedSizes;
+    compressedSizes.reserve(tgt::hmul(svec3(numBricks)));
+
+    size_t sliceBytes = static_cast<size_t>(dims.x) * dims.y * bytesPerVoxel;
+    std::vector<char> slab;
+    for (int bz = 0; bz < numBricks.z; bz++) {
+        if (getProgressBar())
+            getProgressBar()->setProgress(static_cast<float>(bz) / static_cast<float>(numBricks.z));
+
+        // one slab of full slices covering the brick row
+        int z0 = bz * brickSize_;
+        int slabDepth = std::min(brickSize_, dims.z - z0);
+        const char* slabData = 0;
+        if (volume) {
+            slabData = static_cast<const char*>(volume->getData()) + static_cast<size_t>(z0) * sliceBytes;
+        }
+        else {
+            slab.resize(static_cast<size_t>(slabDepth) * sliceBytes);
+            DiskRepresentation* slabDisk = disk->getSubVolume(svec3(dims.x, dims.y, slabDepth), svec3(0, 0, z0));
+            try {
+                slabDisk->readVoxels(&slab[0]);
+            }
+            catch (tgt::IOException&) {
+                delete slabDisk;
+                throw;
+            }
+            delete slabDisk;
+            slabData = &slab[0];
+        }
+
+        // compress the bricks of the slab in parallel
+        int numSlabBricks = numBricks.x * numBricks.y;
+        std::vector<std::vector<char> > compressed(numSlabBricks);
+        bool failed = false;
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < numSlabBricks; i++) {
+            ivec3 brick(i % numBricks.x, i / numBricks.x, bz);
+            ivec3 brickLlf = brick * brickSize_;
+            ivec3 brickDims = index.getBrickDimensions(brick);
+            size_t rowBytes = static_cast<size_t>(brickDims.x) * bytesPerVoxel;
+
+            std::vector<char> brickData(rowBytes * brickDims.y * brickDims.z);
+            for (int z = 0; z < brickDims.z; z++) {
+                for (int y = 0; y < brickDims.y; y++) {
+                    size_t srcIndex = (static_cast<size_t>(z) * dims.y + brickLlf.y + y) * dims.x + brickLlf.x;
+                    memcpy(&brickData[(static_cast<size_t>(z) * brickDims.y + y) * rowBytes],
+                           slabData + srcIndex * bytesPerVoxel, rowBytes);
+                }
+            }
+
+            uLongf compressedSize = compressBound(static_cast<uLong>(brickData.size()));
+            compressed[i].resize(compressedSize);
+            if (compress2(reinterpret_cast<Bytef*>(&compressed[i][0]), &compressedSize,
+                          reinterpret_cast<const Bytef*>(&brickData[0]), static_cast<uLong>(brickData.size()),
+                          compressionLevel_) != Z_OK)
+            {
+                failed = true;
+            }
+            compressed[i].resize(compressedSize);
+        }
+        if (failed)
+            throw tgt::IOException("Failed to compress brick", brickName);
+
+        for (int i = 0; i < numSlabBricks; i++) {
+            brickOut.write(&compressed[i][0], compressed[i].size());
+            compressedSizes.push_back(static_cast<int>(compressed[i].size()));
+        }
+        if (brickOut.bad())
+            throw tgt::IOException("Failed to write brick file", brickName);
+    }
+    brickOut.close();
+    index.setCompressedBrickSizes(compressedSizes);
+
+    if (getProgressBar())
+        getProgressBar()->setProgress(1.f);
+
+    // HEADER: ------------------------
+
+    XmlSerializer s(headerName);
+    s.setUseAttributes(true);
+
+    std::vector<BrickedVvdObject> vec;
+    vec.push_back(BrickedVvdObject(volumeHandle, index));
+    s.serialize("Volumes", vec, "Volume");
+
+    std::ostringstream textStream;
+    try {
+        s.write(textStream);
+    }
+    catch (std::exception& e) {
+        throw tgt::IOException("Failed to write serialization data to string stream: " + std::string(e.what()), headerName);
+    }
+    if (textStream.fail())
+        throw tgt::IOException("Failed to write serialization data to string stream.", headerName);
+
+    std::fstream fileStream(headerName.c_str(), std::ios_base::out);
+    if (fileStream.fail())
+        throw tgt::IOException("Failed to open file for writing", headerName);
+    fileStream << textStream.str();
+    if (fileStream.bad())
+        throw tgt::IOException("Failed to write header file", headerName);
+    fileStream.close();
+}
+
+} // namespace voreen
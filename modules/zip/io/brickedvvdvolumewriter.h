@@ -0,0 +1,77 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_BRICKEDVVDVOLUMEWRITER_H
+#define VRN_BRICKEDVVDVOLUMEWRITER_H
+
+#include "modules/zip/zipmoduledefine.h"
+#include "voreen/core/io/volumewriter.h"
+
+#include "tgt/vector.h"
+
+namespace voreen {
+
+/**
+ * Writes the volume into a .bvvd header and a .bricks file containing
+ * fixed-size bricks, each compressed independently with zlib.
+ *
+ * Volumes that have not been loaded into RAM are read from their
+ * DiskRepresentation slab by slab, so volumes larger than the main memory
+ * can be converted.
+ *
+ * @see BrickedVvdVolumeReader
+ */
+class VRN_MODULE_ZIP_API BrickedVvdVolumeWriter : public VolumeWriter {
+public:
+    BrickedVvdVolumeWriter(ProgressBar* progress = 0);
+    virtual VolumeWriter* create(ProgressBar* progress = 0) const;
+
+    virtual std::string getClassName() const   { return "BrickedVvdVolumeWriter"; }
+    virtual std::string getFormatDescription() const { return "Bricked and compressed Voreen volume format"; }
+
+    /// Sets the edge length of the bricks in voxels. Default: 64
+    void setBrickSize(int brickSize);
+    int getBrickSize() const;
+
+    /// Sets the zlib compression level (0-9, -1 for the zlib default). Default: 1
+    void setCompressionLevel(int level);
+    int getCompressionLevel() const;
+
+    virtual void write(const std::string& filename, const VolumeHandleBase* volumeHandle)
+        throw (tgt::IOException);
+
+private:
+    int brickSize_;
+    int compressionLevel_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_BRICKEDVVDVOLUMEWRITER_H
@@ -4,10 +4,18 @@ contains(DEFINES, VRN_DYNAMIC_LIBS) {
 }
 
 SOURCES += \
+    $${VRN_MODULE_DIR}/zip/io/brickedvolume.cpp \
+    $${VRN_MODULE_DIR}/zip/io/brickedvvdformat.cpp \
+    $${VRN_MODULE_DIR}/zip/io/brickedvvdvolumereader.cpp \
+    $${VRN_MODULE_DIR}/zip/io/brickedvvdvolumewriter.cpp \
     $${VRN_MODULE_DIR}/zip/io/ziparchive.cpp \
     $${VRN_MODULE_DIR}/zip/io/zipvolumereader.cpp
     
 HEADERS += \
+    $${VRN_MODULE_DIR}/zip/io/brickedvolume.h \
+    $${VRN_MODULE_DIR}/zip/io/brickedvvdformat.h \
+    $${VRN_MODULE_DIR}/zip/io/brickedvvdvolumereader.h \
+    $${VRN_MODULE_DIR}/zip/io/brickedvvdvolumewriter.h \
     $${VRN_MODULE_DIR}/zip/io/ziparchive.h \
     $${VRN_MODULE_DIR}/zip/io/zipvolumereader.h
     
\ No newline at end of file
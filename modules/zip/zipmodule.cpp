@@ -29,6 +29,8 @@
 #include "zipmodule.h"
 
 #include "io/zipvolumereader.h"
+#include "io/brickedvvdvolumereader.h"
+#include "io/brickedvvdvolumewriter.h"
 
 namespace voreen {
 
@@ -39,6 +41,8 @@ ZIPModule::ZIPModule()
     setXMLFileName("zip/zipmodule.xml");
 
     addVolumeReader(new ZipVolumeReader());
+    addVolumeReader(new BrickedVvdVolumeReader());
+    addVolumeWriter(new BrickedVvdVolumeWriter());
 }
 
 } // namespace
@@ -72,6 +72,14 @@ void FaceGeometry::setFaceNormal(const tgt::vec3& normal) {
     setHasChanged(true);
 }
 
+bool FaceGeometry::isFaceNormalSet() const {
+    return normalIsSet_;
+}
+
+tgt::vec3 FaceGeometry::getFaceNormal() const {
+    return normal_;
+}
+
 void FaceGeometry::clear() {
     vertices_.clear();
     normalIsSet_ = false;
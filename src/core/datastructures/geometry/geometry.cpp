@@ -29,8 +29,12 @@
 #include "voreen/core/datastructures/geometry/geometry.h"
 
 #include "voreen/core/io/serialization/xmlserializer.h"
+#include "voreen/core/io/serialization/xmldeserializer.h"
+#include "voreen/core/io/binarygeometryfile.h"
 #include "voreen/core/utils/hashing.h"
 
+#include "tgt/filesystem.h"
+
 #include <sstream>
 
 namespace voreen {
@@ -63,4 +67,90 @@ std::string Geometry::getHash() const {
     return VoreenHash::getHash(stream.str());
 }
 
+bool Geometry::serializeBinary(BinaryGeometryFile& /*file*/) const {
+    return false;
+}
+
+bool Geometry::deserializeBinary(const BinaryGeometryFile& /*file*/) {
+    return false;
+}
+
+bool Geometry::serializeBinaryReference(XmlSerializer& s) const {
+    std::string documentPath = s.getDocumentPath();
+    if (documentPath.empty())
+        return false;
+
+    BinaryGeometryFile file;
+    if (!serializeBinary(file))
+        return false;
+
+    std::string directory = tgt::FileSystem::dirName(documentPath);
+    std::string filename = tgt::FileSystem::baseName(documentPath) + "." + file.getHash() + "." + BinaryGeometryFile::FILE_EXTENSION;
+    std::string path = directory.empty() ? filename : directory + "/" + filename;
+    if (!tgt::FileSystem::fileExists(path)) {
+        try {
+            file.write(path);
+        }
+        catch (tgt::FileException& e) {
+            throw SerializationException("Failed to write binary geometry file: " + std::string(e.what()));
+        }
+    }
+
+    s.serialize("BinaryFile", filename);
+    s.addReferencedFile(filename);
+    return true;
+}
+
+void Geometry::removeUnreferencedBinaryFiles(const XmlSerializer& s) {
+    std::string documentPath = s.getDocumentPath();
+    if (documentPath.empty())
+        return;
+
+    // only files named <document>.<hash>.vgb, as written by serializeBinaryReference(), are considered
+    std::string directory = tgt::FileSystem::dirName(documentPath);
+    std::string prefix = tgt::FileSystem::baseName(documentPath) + ".";
+    std::string suffix = "." + BinaryGeometryFile::FILE_EXTENSION;
+    const size_t hashLength = 32;
+
+    std::vector<std::string> files = tgt::FileSystem::listFiles(directory.empty() ? "." : directory);
+    for (size_t i = 0; i < files.size(); i++) {
+        const std::string& filename = files[i];
+        if (filename.size() != prefix.size() + hashLength + suffix.size()
+                || filename.compare(0, prefix.size(), prefix) != 0
+                || filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) != 0
+                || filename.substr(prefix.size(), hashLength).find_first_not_of("0123456789abcdef") != std::string::npos)
+            continue;
+        if (s.getReferencedFiles().count(filename))
+            continue;
+
+        std::string path = directory.empty() ? filename : directory + "/" + filename;
+        if (!tgt::FileSystem::deleteFile(path))
+            LWARNINGC("voreen.Geometry", "Failed to delete unreferenced binary geometry file " << path);
+    }
+}
+
+bool Geometry::deserializeBinaryReference(XmlDeserializer& s) {
+    std::string filename;
+    try {
+        s.deserialize("BinaryFile", filename);
+    }
+    catch (XmlSerializationNoSuchDataException&) {
+        s.removeLastError();
+        return false;
+    }
+
+    std::string directory = tgt::FileSystem::dirName(s.getDocumentPath());
+    std::string path = directory.empty() ? filename : directory + "/" + filename;
+    BinaryGeometryFile file;
+    try {
+        file.read(path);
+    }
+    catch (tgt::FileException& e) {
+        throw SerializationException("Failed to read binary geometry file: " + std::string(e.what()));
+    }
+    if (!deserializeBinary(file))
+        throw SerializationException("Geometry type does not support binary serialization");
+    return true;
+}
+
 } // namespace
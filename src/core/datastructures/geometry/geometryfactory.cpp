@@ -32,6 +32,7 @@
 #include "voreen/core/datastructures/geometry/facegeometry.h"
 #include "voreen/core/datastructures/geometry/meshgeometry.h"
 #include "voreen/core/datastructures/geometry/meshlistgeometry.h"
+#include "voreen/core/datastructures/geometry/indexedmeshgeometry.h"
 #include "voreen/core/datastructures/geometry/pointlistgeometry.h"
 #include "voreen/core/datastructures/geometry/pointsegmentlistgeometry.h"
 
@@ -46,6 +47,8 @@ const std::string GeometryFactory::getTypeString(const std::type_info& type) con
         return "MeshGeometry";
     else if (type == typeid(MeshListGeometry))
         return "MeshListGeometry";
+    else if (type == typeid(IndexedMeshGeometry))
+        return "IndexedMeshGeometry";
     else if (type == typeid(PointListGeometryVec3))
         return "PointListGeometryVec3";
     else if (type == typeid(PointSegmentListGeometryVec3))
@@ -63,6 +66,8 @@ Serializable* GeometryFactory::createType(const std::string& typeString) {
         return new MeshGeometry();
     else if (typeString == "MeshListGeometry")
         return new MeshListGeometry();
+    else if (typeString == "IndexedMeshGeometry")
+        return new IndexedMeshGeometry();
     else if (typeString == "PointListGeometryVec3")
         return new PointListGeometryVec3();
     else if (typeString == "PointSegmentListGeometryVec3")
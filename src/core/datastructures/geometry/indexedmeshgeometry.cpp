@@ -0,0 +1,486 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/geometry/indexedmeshgeometry.h"
+
+#include "tgt/glmath.h"
+
+#include "voreen/core/io/serialization/xmlserializer.h"
+#include "voreen/core/io/serialization/xmldeserializer.h"
+#include "voreen/core/io/binarygeometryfile.h"
+
+#include <map>
+#include <cmath>
+#include <cfloat>
+#include <limits>
+
+namespace voreen {
+
+namespace {
+
+// key for merging vertices with equal attributes during conversion
+struct VertexKey {
+    float attributes_[10];
+
+    bool operator<(const VertexKey& rhs) const {
+        for (int i = 0; i < 10; ++i) {
+            if (attributes_[i] != rhs.attributes_[i])
+                return attributes_[i] < rhs.attributes_[i];
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+IndexedMeshGeometry::IndexedMeshGeometry()
+    : Geometry()
+{
+}
+
+IndexedMeshGeometry IndexedMeshGeometry::createFromMesh(const MeshGeometry& mesh) {
+    // normals are only converted if they are defined for all vertices
+    bool hasNormals = true;
+    for (MeshGeometry::const_iterator face = mesh.begin(); face != mesh.end() && hasNormals; ++face) {
+        if (face->isFaceNormalSet())
+            continue;
+        for (FaceGeometry::const_iterator vertex = face->begin(); vertex != face->end(); ++vertex) {
+            if (!vertex->isNormalDefined()) {
+                hasNormals = false;
+                break;
+            }
+        }
+    }
+
+    IndexedMeshGeometry result;
+    std::map<VertexKey, uint32_t> vertexMap;
+    std::vector<uint32_t> faceIndices;
+    for (MeshGeometry::const_iterator face = mesh.begin(); face != mesh.end(); ++face) {
+        faceIndices.clear();
+        for (FaceGeometry::const_iterator vertex = face->begin(); vertex != face->end(); ++vertex) {
+            tgt::vec3 position = vertex->getCoords();
+            tgt::vec3 normal = hasNormals ? (face->isFaceNormalSet() ? face->getFaceNormal() : vertex->getNormal()) : tgt::vec3(0.f);
+            tgt::vec4 color = vertex->getColor();
+
+            VertexKey key;
+            for (int i = 0; i < 3; ++i) {
+                key.attributes_[i] = position[i];
+                key.attributes_[3 + i] = normal[i];
+            }
+            for (int i = 0; i < 4; ++i)
+                key.attributes_[6 + i] = color[i];
+
+            std::map<VertexKey, uint32_t>::iterator it = vertexMap.find(key);
+            if (it == vertexMap.end()) {
+                uint32_t index = (hasNormals ? result.addVertex(position, normal, color)
+                                             : result.addVertex(position, tgt::vec3(0.f), color));
+                it = vertexMap.insert(std::make_pair(key, index)).first;
+            }
+            faceIndices.push_back(it->second);
+        }
+
+        // faces are convex, so a triangle fan suffices
+        for (size_t i = 2; i < faceIndices.size(); ++i)
+            result.addTriangle(faceIndices[0], faceIndices[i - 1], faceIndices[i]);
+    }
+
+    if (!hasNormals)
+        result.normals_.clear();
+    return result;
+}
+
+MeshGeometry IndexedMeshGeometry::toMeshGeometry() const {
+    MeshGeometry mesh;
+    for (size_t i = 0; i < indices_.size(); i += 3) {
+        FaceGeometry face;
+        for (size_t j = 0; j < 3; ++j) {
+            uint32_t index = indices_[i + j];
+            VertexGeometry vertex(positions_[index]);
+            if (!normals_.empty())
+                vertex.setNormal(normals_[index]);
+            if (!colors_.empty())
+                vertex.setColor(colors_[index]);
+            face.addVertex(vertex);
+        }
+        mesh.addFace(face);
+    }
+    return mesh;
+}
+
+size_t IndexedMeshGeometry::getVertexCount() const {
+    return positions_.size();
+}
+
+size_t IndexedMeshGeometry::getTriangleCount() const {
+    return indices_.size() / 3;
+}
+
+bool IndexedMeshGeometry::empty() const {
+    return indices_.empty();
+}
+
+void IndexedMeshGeometry::clear() {
+    positions_.clear();
+    normals_.clear();
+    colors_.clear();
+    indices_.clear();
+
+    setHasChanged(true);
+}
+
+uint32_t IndexedMeshGeometry::addVertex(const tgt::vec3& position) {
+    tgtAssert(positions_.size() < std::numeric_limits<uint32_t>::max(), "Too many vertices");
+    positions_.push_back(position);
+    if (!normals_.empty())
+        normals_.resize(positions_.size(), tgt::vec3(0.f));
+    if (!colors_.empty())
+        colors_.resize(positions_.size(), tgt::vec4(1.f));
+
+    setHasChanged(true);
+    return static_cast<uint32_t>(positions_.size() - 1);
+}
+
+uint32_t IndexedMeshGeometry::addVertex(const tgt::vec3& position, const tgt::vec3& normal) {
+    normals_.resize(positions_.size(), tgt::vec3(0.f));
+    normals_.push_back(normal);
+    return addVertex(position);
+}
+
+uint32_t IndexedMeshGeometry::addVertex(const tgt::vec3& position, const tgt::vec3& normal, const tgt::vec4& color) {
+    colors_.resize(positions_.size(), tgt::vec4(1.f));
+    colors_.push_back(color);
+    return addVertex(position, normal);
+}
+
+void IndexedMeshGeometry::addTriangle(uint32_t a, uint32_t b, uint32_t c) {
+    tgtAssert(a < positions_.size() && b < positions_.size() && c < positions_.size(), "Invalid vertex index");
+    indices_.push_back(a);
+    indices_.push_back(b);
+    indices_.push_back(c);
+
+    setHasChanged(true);
+}
+
+void IndexedMeshGeometry::setData(const std::vector<tgt::vec3>& positions, const std::vector<tgt::vec3>& normals,
+                                  const std::vector<tgt::vec4>& colors, const std::vector<uint32_t>& indices)
+{
+    tgtAssert(normals.empty() || normals.size() == positions.size(), "Normal count does not match vertex count");
+    tgtAssert(colors.empty() || colors.size() == positions.size(), "Color count does not match vertex count");
+    tgtAssert(indices.size() % 3 == 0, "Index count is not a multiple of three");
+
+    positions_ = positions;
+    normals_ = normals;
+    colors_ = colors;
+    indices_ = indices;
+
+    setHasChanged(true);
+}
+
+void IndexedMeshGeometry::setColor(const tgt::vec4& color) {
+    colors_.assign(positions_.size(), color);
+
+    setHasChanged(true);
+}
+
+const std::vector<tgt::vec3>& IndexedMeshGeometry::getPositions() const {
+    return positions_;
+}
+
+std::vector<tgt::vec3>& IndexedMeshGeometry::getPositions() {
+    return positions_;
+}
+
+const std::vector<tgt::vec3>& IndexedMeshGeometry::getNormals() const {
+    return normals_;
+}
+
+std::vector<tgt::vec3>& IndexedMeshGeometry::getNormals() {
+    return normals_;
+}
+
+const std::vector<tgt::vec4>& IndexedMeshGeometry::getColors() const {
+    return colors_;
+}
+
+std::vector<tgt::vec4>& IndexedMeshGeometry::getColors() {
+    return colors_;
+}
+
+const std::vector<uint32_t>& IndexedMeshGeometry::getIndices() const {
+    return indices_;
+}
+
+std::vector<uint32_t>& IndexedMeshGeometry::getIndices() {
+    return indices_;
+}
+
+void IndexedMeshGeometry::render() const {
+    if (indices_.empty())
+        return;
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, positions_[0].elem);
+    if (!normals_.empty()) {
+        glEnableClientState(GL_NORMAL_ARRAY);
+        glNormalPointer(GL_FLOAT, 0, normals_[0].elem);
+    }
+    if (!colors_.empty()) {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_FLOAT, 0, colors_[0].elem);
+    }
+
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, &indices_[0]);
+
+    glPopClientAttrib();
+}
+
+void IndexedMeshGeometry::transform(const tgt::mat4& transformation) {
+    tgt::mat4 normalMatrix = transformation.getRotationalPart();
+    tgt::mat4 inverse;
+    if (normalMatrix.invert(inverse))
+        normalMatrix = tgt::transpose(inverse);
+
+    int numVertices = static_cast<int>(positions_.size());
+    bool hasNormals = !normals_.empty();
+    #pragma omp parallel for
+    for (int i = 0; i < numVertices; ++i) {
+        positions_[i] = transformation * positions_[i];
+        if (hasNormals) {
+            tgt::vec3 normal = normalMatrix * normals_[i];
+            float length = tgt::length(normal);
+            normals_[i] = (length > 0.f ? normal / length : normal);
+        }
+    }
+
+    setHasChanged(true);
+}
+
+void IndexedMeshGeometry::getBoundingBox(tgt::vec3& llf, tgt::vec3& urb) const {
+    llf = tgt::vec3(FLT_MAX);
+    urb = tgt::vec3(-FLT_MAX);
+    for (size_t i = 0; i < positions_.size(); ++i) {
+        llf = tgt::min(llf, positions_[i]);
+        urb = tgt::max(urb, positions_[i]);
+    }
+}
+
+void IndexedMeshGeometry::clip(const tgt::vec4& clipplane, double epsilon) {
+    if (indices_.empty())
+        return;
+
+    // signed distances of all vertices, vertices within epsilon lie on the plane
+    std::vector<double> distances(positions_.size());
+    int numVertices = static_cast<int>(positions_.size());
+    #pragma omp parallel for
+    for (int i = 0; i < numVertices; ++i) {
+        double distance = tgt::dot(clipplane.xyz(), positions_[i]) - clipplane.w;
+        distances[i] = (std::abs(distance) <= epsilon ? 0.0 : distance);
+    }
+
+    // intersection vertices are shared between the triangles of a cut edge
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> edgeVertices;
+    std::vector<uint32_t> clippedIndices;
+    clippedIndices.reserve(indices_.size());
+    for (size_t i = 0; i < indices_.size(); i += 3) {
+        const uint32_t* triangle = &indices_[i];
+        int numInside = 0;
+        for (int j = 0; j < 3; ++j) {
+            if (distances[triangle[j]] <= 0.0)
+                numInside++;
+        }
+
+        if (numInside == 3) {
+            clippedIndices.insert(clippedIndices.end(), triangle, triangle + 3);
+            continue;
+        }
+        else if (numInside == 0)
+            continue;
+
+        // clip the triangle edges, which yields a polygon with three or four vertices
+        uint32_t polygon[4];
+        size_t polygonSize = 0;
+        for (int j = 0; j < 3; ++j) {
+            uint32_t first = triangle[j];
+            uint32_t second = triangle[(j + 1) % 3];
+            if (distances[first] <= 0.0)
+                polygon[polygonSize++] = first;
+
+            if ((distances[first] < 0.0 && distances[second] > 0.0) || (distances[first] > 0.0 && distances[second] < 0.0)) {
+                std::pair<uint32_t, uint32_t> edge(std::min(first, second), std::max(first, second));
+                std::map<std::pair<uint32_t, uint32_t>, uint32_t>::iterator it = edgeVertices.find(edge);
+                if (it == edgeVertices.end()) {
+                    // always interpolate in the same direction for a consistent result
+                    float t = static_cast<float>(distances[edge.first] / (distances[edge.first] - distances[edge.second]));
+                    uint32_t index = static_cast<uint32_t>(positions_.size());
+                    positions_.push_back(positions_[edge.first] + (positions_[edge.second] - positions_[edge.first]) * t);
+                    if (!normals_.empty()) {
+                        tgt::vec3 normal = normals_[edge.first] + (normals_[edge.second] - normals_[edge.first]) * t;
+                        float length = tgt::length(normal);
+                        normals_.push_back(length > 0.f ? normal / length : normal);
+                    }
+                    if (!colors_.empty())
+                        colors_.push_back(colors_[edge.first] + (colors_[edge.second] - colors_[edge.first]) * t);
+                    it = edgeVertices.insert(std::make_pair(edge, index)).first;
+                }
+                polygon[polygonSize++] = it->second;
+            }
+        }
+
+        for (size_t j = 2; j < polygonSize; ++j) {
+            clippedIndices.push_back(polygon[0]);
+            clippedIndices.push_back(polygon[j - 1]);
+            clippedIndices.push_back(polygon[j]);
+        }
+    }
+
+    indices_.swap(clippedIndices);
+    removeUnusedVertices();
+
+    setHasChanged(true);
+}
+
+void IndexedMeshGeometry::removeUnusedVertices() {
+    const uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> newIndices(positions_.size(), unused);
+    for (size_t i = 0; i < indices_.size(); ++i)
+        newIndices[indices_[i]] = 0;
+
+    // compact the attribute arrays in place, preserving the vertex order
+    uint32_t numVertices = 0;
+    for (size_t i = 0; i < positions_.size(); ++i) {
+        if (newIndices[i] == unused)
+            continue;
+        newIndices[i] = numVertices;
+        positions_[numVertices] = positions_[i];
+        if (!normals_.empty())
+            normals_[numVertices] = normals_[i];
+        if (!colors_.empty())
+            colors_[numVertices] = colors_[i];
+        numVertices++;
+    }
+    positions_.resize(numVertices);
+    if (!normals_.empty())
+        normals_.resize(numVertices);
+    if (!colors_.empty())
+        colors_.resize(numVertices);
+
+    for (size_t i = 0; i < indices_.size(); ++i)
+        indices_[i] = newIndices[indices_[i]];
+}
+
+void IndexedMeshGeometry::serialize(XmlSerializer& s) const {
+    if (serializeBinaryReference(s))
+        return;
+
+    std::vector<tgt::ivec3> triangles(getTriangleCount());
+    for (size_t i = 0; i < triangles.size(); ++i)
+        triangles[i] = tgt::ivec3(indices_[3*i], indices_[3*i + 1], indices_[3*i + 2]);
+
+    s.serialize("positions", positions_);
+    if (!normals_.empty())
+        s.serialize("normals", normals_);
+    if (!colors_.empty())
+        s.serialize("colors", colors_);
+    s.serialize("triangles", triangles);
+}
+
+void IndexedMeshGeometry::deserialize(XmlDeserializer& s) {
+    clear();
+    if (deserializeBinaryReference(s)) {
+        setHasChanged(true);
+        return;
+    }
+
+    std::vector<tgt::ivec3> triangles;
+    s.deserialize("positions", positions_);
+    try {
+        s.deserialize("normals", normals_);
+    }
+    catch (...) {
+        s.removeLastError();
+        normals_.clear();
+    }
+    try {
+        s.deserialize("colors", colors_);
+    }
+    catch (...) {
+        s.removeLastError();
+        colors_.clear();
+    }
+    s.deserialize("triangles", triangles);
+
+    indices_.resize(triangles.size() * 3);
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        for (size_t j = 0; j < 3; ++j)
+            indices_[3*i + j] = static_cast<uint32_t>(triangles[i][j]);
+    }
+    setHasChanged(true);
+}
+
+std::string IndexedMeshGeometry::getHash() const {
+    BinaryGeometryFile file;
+    serializeBinary(file);
+    return file.getHash();
+}
+
+bool IndexedMeshGeometry::serializeBinary(BinaryGeometryFile& file) const {
+    file.setArray("positions", positions_);
+    if (!normals_.empty())
+        file.setArray("normals", normals_);
+    if (!colors_.empty())
+        file.setArray("colors", colors_);
+    file.setArray("indices", indices_);
+    return true;
+}
+
+bool IndexedMeshGeometry::deserializeBinary(const BinaryGeometryFile& file) {
+    clear();
+    file.getArray("positions", positions_);
+    if (file.hasArray("normals"))
+        file.getArray("normals", normals_);
+    if (file.hasArray("colors"))
+        file.getArray("colors", colors_);
+    file.getArray("indices", indices_);
+
+    bool valid = (normals_.empty() || normals_.size() == positions_.size()) &&
+                 (colors_.empty() || colors_.size() == positions_.size()) &&
+                 indices_.size() % 3 == 0;
+    for (size_t i = 0; i < indices_.size() && valid; ++i)
+        valid = (indices_[i] < positions_.size());
+    if (!valid) {
+        clear();
+        throw SerializationException("Inconsistent indexed mesh arrays");
+    }
+
+    setHasChanged(true);
+    return true;
+}
+
+} // namespace
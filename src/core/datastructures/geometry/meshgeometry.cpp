@@ -30,6 +30,7 @@
 
 #include "voreen/core/io/serialization/xmlserializer.h"
 #include "voreen/core/io/serialization/xmldeserializer.h"
+#include "voreen/core/io/binarygeometryfile.h"
 
 using tgt::vec3;
 using tgt::vec4;
@@ -283,6 +284,113 @@ void MeshGeometry::deserialize(XmlDeserializer& s) {
     setHasChanged(true);
 }
 
+bool MeshGeometry::serializeBinary(BinaryGeometryFile& file) const {
+    serializeMeshes(std::vector<MeshGeometry>(1, *this), file);
+    return true;
+}
+
+bool MeshGeometry::deserializeBinary(const BinaryGeometryFile& file) {
+    std::vector<MeshGeometry> meshes;
+    deserializeMeshes(file, meshes);
+    if (meshes.size() != 1)
+        throw SerializationException("Expected exactly one mesh");
+    faces_.swap(meshes.front().faces_);
+    setHasChanged(true);
+    return true;
+}
+
+void MeshGeometry::serializeMeshes(const std::vector<MeshGeometry>& meshes, BinaryGeometryFile& file) {
+    std::vector<uint32_t> meshFaceCounts;
+    std::vector<uint32_t> faceVertexCounts;
+    std::vector<uint8_t> faceNormalSet;
+    std::vector<vec3> faceNormals;
+    std::vector<vec3> positions;
+    std::vector<vec3> texCoords;
+    std::vector<vec4> colors;
+    std::vector<vec3> normals;
+    std::vector<uint8_t> normalDefined;
+
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        meshFaceCounts.push_back(static_cast<uint32_t>(meshes[i].getFaceCount()));
+        for (const_iterator face = meshes[i].begin(); face != meshes[i].end(); ++face) {
+            faceVertexCounts.push_back(static_cast<uint32_t>(face->getVertexCount()));
+            faceNormalSet.push_back(face->isFaceNormalSet() ? 1 : 0);
+            faceNormals.push_back(face->getFaceNormal());
+            for (FaceGeometry::const_iterator vertex = face->begin(); vertex != face->end(); ++vertex) {
+                positions.push_back(vertex->getCoords());
+                texCoords.push_back(vertex->getTexCoords());
+                colors.push_back(vertex->getColor());
+                normals.push_back(vertex->getNormal());
+                normalDefined.push_back(vertex->isNormalDefined() ? 1 : 0);
+            }
+        }
+    }
+
+    file.setArray("meshFaceCounts", meshFaceCounts);
+    file.setArray("faceVertexCounts", faceVertexCounts);
+    file.setArray("faceNormalSet", faceNormalSet);
+    file.setArray("faceNormals", faceNormals);
+    file.setArray("positions", positions);
+    file.setArray("texCoords", texCoords);
+    file.setArray("colors", colors);
+    file.setArray("normals", normals);
+    file.setArray("normalDefined", normalDefined);
+}
+
+void MeshGeometry::deserializeMeshes(const BinaryGeometryFile& file, std::vector<MeshGeometry>& meshes) {
+    std::vector<uint32_t> meshFaceCounts;
+    std::vector<uint32_t> faceVertexCounts;
+    std::vector<uint8_t> faceNormalSet;
+    std::vector<vec3> faceNormals;
+    std::vector<vec3> positions;
+    std::vector<vec3> texCoords;
+    std::vector<vec4> colors;
+    std::vector<vec3> normals;
+    std::vector<uint8_t> normalDefined;
+
+    file.getArray("meshFaceCounts", meshFaceCounts);
+    file.getArray("faceVertexCounts", faceVertexCounts);
+    file.getArray("faceNormalSet", faceNormalSet);
+    file.getArray("faceNormals", faceNormals);
+    file.getArray("positions", positions);
+    file.getArray("texCoords", texCoords);
+    file.getArray("colors", colors);
+    file.getArray("normals", normals);
+    file.getArray("normalDefined", normalDefined);
+
+    size_t numFaces = 0;
+    for (size_t i = 0; i < meshFaceCounts.size(); ++i)
+        numFaces += meshFaceCounts[i];
+    size_t numVertices = 0;
+    for (size_t i = 0; i < faceVertexCounts.size(); ++i)
+        numVertices += faceVertexCounts[i];
+    if (faceVertexCounts.size() != numFaces || faceNormalSet.size() != numFaces || faceNormals.size() != numFaces ||
+        positions.size() != numVertices || texCoords.size() != numVertices || colors.size() != numVertices ||
+        normals.size() != numVertices || normalDefined.size() != numVertices)
+    {
+        throw SerializationException("Inconsistent mesh arrays");
+    }
+
+    meshes.clear();
+    meshes.resize(meshFaceCounts.size());
+    size_t face = 0;
+    size_t vertex = 0;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        meshes[i].faces_.resize(meshFaceCounts[i]);
+        for (size_t j = 0; j < meshFaceCounts[i]; ++j, ++face) {
+            FaceGeometry& faceGeometry = meshes[i].faces_[j];
+            for (size_t k = 0; k < faceVertexCounts[face]; ++k, ++vertex) {
+                VertexGeometry vertexGeometry(positions[vertex], texCoords[vertex], colors[vertex]);
+                if (normalDefined[vertex])
+                    vertexGeometry.setNormal(normals[vertex]);
+                faceGeometry.addVertex(vertexGeometry);
+            }
+            if (faceNormalSet[face])
+                faceGeometry.setFaceNormal(faceNormals[face]);
+        }
+    }
+}
+
 void MeshGeometry::createCubeFaces(FaceGeometry& topFace, FaceGeometry& frontFace, FaceGeometry& leftFace,
                                    FaceGeometry& backFace, FaceGeometry& rightFace, FaceGeometry& bottomFace,
                                    tgt::vec3 coordLlf, tgt::vec3 coordUrb, tgt::vec3 texLlf,
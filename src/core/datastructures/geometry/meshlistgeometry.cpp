@@ -29,6 +29,7 @@
 #include "voreen/core/datastructures/geometry/meshlistgeometry.h"
 #include "voreen/core/io/serialization/xmlserializer.h"
 #include "voreen/core/io/serialization/xmldeserializer.h"
+#include "voreen/core/io/binarygeometryfile.h"
 
 namespace voreen {
 
@@ -154,4 +155,15 @@ void MeshListGeometry::deserialize(XmlDeserializer& s) {
     setHasChanged(true);
 }
 
+bool MeshListGeometry::serializeBinary(BinaryGeometryFile& file) const {
+    MeshGeometry::serializeMeshes(meshes_, file);
+    return true;
+}
+
+bool MeshListGeometry::deserializeBinary(const BinaryGeometryFile& file) {
+    MeshGeometry::deserializeMeshes(file, meshes_);
+    setHasChanged(true);
+    return true;
+}
+
 } // namespace
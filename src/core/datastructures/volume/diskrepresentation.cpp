@@ -30,11 +30,22 @@
 
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/datastructures/volume/mappedvolume.h"
 
 #include "voreen/core/io/volumereader.h"
 
 #include <algorithm>
 #include <typeinfo>
+#include <string.h>
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
 
 using tgt::vec3;
 using tgt::bvec3;
@@ -43,6 +54,144 @@ using tgt::svec3;
 using tgt::col4;
 using tgt::mat4;
 
+namespace {
+
+/// A single row of voxels to be read from the file.
+struct RowRead {
+    int64_t filePos_;
+    char* dest_;
+    size_t numBytes_;
+};
+
+#ifdef WIN32
+
+int64_t getFileSize(const std::string& filename) {
+    struct _stati64 fileStat;
+    if (_stati64(filename.c_str(), &fileStat) != 0)
+        return -1;
+    return static_cast<int64_t>(fileStat.st_size);
+}
+
+void readRows(const std::string& filename, const std::vector<RowRead>& rows) throw (tgt::IOException) {
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (fin == 0)
+        throw tgt::IOException("Unable to open raw file for reading", filename);
+
+    int64_t filePos = -1;
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (rows[i].filePos_ != filePos)
+            _fseeki64(fin, rows[i].filePos_, SEEK_SET);
+        if (fread(rows[i].dest_, rows[i].numBytes_, 1, fin) != 1) {
+            fclose(fin);
+            throw tgt::IOException("fread() failed", filename);
+        }
+        filePos = rows[i].filePos_ + rows[i].numBytes_;
+    }
+    fclose(fin);
+}
+
+#else
+
+int64_t getFileSize(const std::string& filename) {
+    struct stat fileStat;
+    if (stat(filename.c_str(), &fileStat) != 0)
+        return -1;
+    return static_cast<int64_t>(fileStat.st_size);
+}
+
+/// Reads numBytes at filePos, retrying on short reads.
+bool preadFully(int fd, char* dest, size_t numBytes, int64_t filePos) {
+    while (numBytes > 0) {
+        ssize_t n = pread(fd, dest, numBytes, static_cast<off_t>(filePos));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        dest += n;
+        numBytes -= static_cast<size_t>(n);
+        filePos += n;
+    }
+    return true;
+}
+
+/**
+ * Reads the rows, which have to be sorted by file position.
+ * Rows separated by small gaps are gathered by a single vectored read,
+ * with the gaps being read into a scratch buffer.
+ */
+void readRows(const std::string& filename, const std::vector<RowRead>& rows) throw (tgt::IOException) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw tgt::IOException("Unable to open raw file for reading", filename);
+
+#if defined(__linux__) || defined(__FreeBSD__)
+    // gaps up to this size are read and discarded instead of issuing separate reads
+    const size_t MAX_GAP = 64 << 10;
+    const size_t MAX_IOV = 512;
+    std::vector<char> gapBuffer(MAX_GAP);
+    std::vector<struct iovec> iov;
+    iov.reserve(MAX_IOV);
+
+    size_t i = 0;
+    while (i < rows.size()) {
+        // collect a group of rows starting at rows[i]
+        iov.clear();
+        int64_t groupPos = rows[i].filePos_;
+        int64_t filePos = groupPos;
+        size_t groupBytes = 0;
+        size_t j = i;
+        while (j < rows.size() && iov.size() + 2 <= MAX_IOV) {
+            int64_t gap = rows[j].filePos_ - filePos;
+            if (gap < 0 || gap > static_cast<int64_t>(MAX_GAP))
+                break;
+            if (gap > 0) {
+                struct iovec g;
+                g.iov_base = &gapBuffer[0];
+                g.iov_len = static_cast<size_t>(gap);
+                iov.push_back(g);
+                groupBytes += static_cast<size_t>(gap);
+            }
+            struct iovec r;
+            r.iov_base = rows[j].dest_;
+            r.iov_len = rows[j].numBytes_;
+            iov.push_back(r);
+            groupBytes += rows[j].numBytes_;
+            filePos = rows[j].filePos_ + rows[j].numBytes_;
+            j++;
+        }
+
+        ssize_t n = -1;
+        do {
+            n = preadv(fd, &iov[0], static_cast<int>(iov.size()), static_cast<off_t>(groupPos));
+        } while (n < 0 && errno == EINTR);
+
+        if (n != static_cast<ssize_t>(groupBytes)) {
+            // short or failed vectored read: fall back to reading the rows separately
+            for (size_t k = i; k < j; k++) {
+                if (!preadFully(fd, rows[k].dest_, rows[k].numBytes_, rows[k].filePos_)) {
+                    close(fd);
+                    throw tgt::IOException("pread() failed", filename);
+                }
+            }
+        }
+        i = j;
+    }
+#else
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!preadFully(fd, rows[i].dest_, rows[i].numBytes_, rows[i].filePos_)) {
+            close(fd);
+            throw tgt::IOException("pread() failed", filename);
+        }
+    }
+#endif
+
+    close(fd);
+}
+
+#endif
+
+} // namespace
+
 namespace voreen {
 
 const std::string DiskRepresentation::loggerCat_("voreen.DiskRepresentation");
@@ -52,7 +201,17 @@ DiskRepresentation::DiskRepresentation(const std::string& filename, const std::s
     , filename_(filename)
     , format_(format)
     , offset_(offset)
+    , fileDimensions_(dimensions)
+    , subVolumeOffset_(0, 0, 0)
+    , bytesPerVoxel_(1)
 {
+    // create one voxel volume to get bytes per voxel for current type
+    VolumeFactory vf;
+    Volume* volume = vf.create(getFormat(), tgt::svec3(1,1,1));
+    if (volume) {
+        bytesPerVoxel_ = volume->getBytesPerVoxel();
+        delete volume;
+    }
 }
 
 DiskRepresentation::DiskRepresentation(const DiskRepresentation* diskrep)
@@ -60,7 +219,11 @@ DiskRepresentation::DiskRepresentation(const DiskRepresentation* diskrep)
       , filename_(diskrep->getFileName())
       , format_(diskrep->getFormat())
       , offset_(diskrep->getOffset())
+      , fileDimensions_(diskrep->getFileDimensions())
+      , subVolumeOffset_(diskrep->getSubVolumeOffset())
+      , bytesPerVoxel_(diskrep->getBytesPerVoxel())
 {
+    originalDimensions_ = diskrep->getOriginalDimensions();
 }
 
 DiskRepresentation::~DiskRepresentation() {
@@ -72,30 +235,134 @@ int DiskRepresentation::getNumChannels() const {
 }
 
 DiskRepresentation* DiskRepresentation::getSubVolume(tgt::svec3 dimensions, tgt::svec3 offset, const VolumeRepresentation::VolumeBorders& border) const throw (std::bad_alloc){
-    // create one voxel volume to get bits for current type
-    VolumeFactory vf;
-    Volume* volume = vf.create(getFormat(), tgt::svec3(1,1,1));
+    // create new disk representation referring to the same stored volume
+    DiskRepresentation* newDiskRep = new DiskRepresentation(filename_, format_, static_cast<tgt::ivec3>(dimensions), offset_, border);
+    newDiskRep->originalDimensions_ = dimensions_;
+    newDiskRep->fileDimensions_ = fileDimensions_;
+    newDiskRep->subVolumeOffset_ = subVolumeOffset_ + offset;
 
-    int voxelSize = 1;
-    if(volume){
-        voxelSize = volume->getBitsAllocated() / 8;
-        delete volume;
+    return newDiskRep;
+}
+
+int64_t DiskRepresentation::getDataOffset() const throw (tgt::IOException) {
+    int64_t bytesPerVoxel = static_cast<int64_t>(bytesPerVoxel_);
+    int64_t baseOffset = offset_;
+    if (baseOffset < 0) {
+        //Assume data is aligned to end of file.
+        int64_t fileSize = getFileSize(filename_);
+        if (fileSize < 0)
+            throw tgt::IOException("Unable to determine file size", filename_);
+        baseOffset = fileSize - static_cast<int64_t>(hmul(fileDimensions_)) * bytesPerVoxel;
     }
 
-    // calculate offset
-    tgt::ivec3 dataDimsI = static_cast<tgt::ivec3>(getDimensions());
-    tgt::ivec3 offsetI = static_cast<tgt::ivec3>(offset);
-    int64_t initialStartPos = offset_ + (offsetI.z * (dataDimsI.x*dataDimsI.y)*voxelSize)+(offsetI.y * dataDimsI.x*voxelSize) + (offsetI.x*voxelSize);
+    svec3 pos = subVolumeOffset_;
+    int64_t voxelIndex = (static_cast<int64_t>(pos.z) * fileDimensions_.y + pos.y) * fileDimensions_.x + pos.x;
+    return baseOffset + voxelIndex * bytesPerVoxel;
+}
 
-    // create new disk representation
-    DiskRepresentation* newDiskRep = new DiskRepresentation(filename_, format_, static_cast<tgt::ivec3>(dimensions), initialStartPos, border);
-    newDiskRep->originalDimensions_ = dimensions_;
+bool DiskRepresentation::isContiguous() const {
+    if (borders_.llf != svec3(0,0,0) || borders_.urb != svec3(0,0,0))
+        return false;
+    if (tgt::hor(tgt::greaterThan(subVolumeOffset_ + dimensions_, fileDimensions_)))
+        return false;
+    // full rows, and full slices unless only a single slice is covered
+    if (dimensions_.x != fileDimensions_.x)
+        return (dimensions_.y == 1 && dimensions_.z == 1);
+    if (dimensions_.y != fileDimensions_.y)
+        return (dimensions_.z == 1);
+    return true;
+}
 
-    return newDiskRep;
+void DiskRepresentation::readVoxels(void* buffer) const throw (tgt::IOException) {
+    size_t bytesPerVoxel = static_cast<size_t>(bytesPerVoxel_);
+    char* dest = reinterpret_cast<char*>(buffer);
+
+    if (isContiguous()) {
+        std::vector<RowRead> rows(1);
+        rows[0].filePos_ = getDataOffset();
+        rows[0].dest_ = dest;
+        rows[0].numBytes_ = hmul(dimensions_) * bytesPerVoxel;
+        readRows(filename_, rows);
+        return;
+    }
+
+    // region to read in coordinates of the stored volume, may exceed it due to the border
+    ivec3 fileDims(fileDimensions_);
+    ivec3 regionLlf = ivec3(subVolumeOffset_) - ivec3(borders_.llf);
+    ivec3 regionDims = ivec3(getDimensionsWithBorder());
+    ivec3 validLlf = tgt::max(regionLlf, ivec3(0));
+    ivec3 validUrb = tgt::min(regionLlf + regionDims, fileDims);
+
+    if (validLlf != regionLlf || validUrb != regionLlf + regionDims)
+        memset(dest, 0, getNumVoxelsWithBorder() * bytesPerVoxel);
+    if (tgt::hor(tgt::greaterThanEqual(validLlf, validUrb)))
+        return;
+
+    // byte position of the stored volume's first voxel
+    int64_t baseOffset = getDataOffset() - ((static_cast<int64_t>(subVolumeOffset_.z) * fileDims.y + subVolumeOffset_.y) * fileDims.x + subVolumeOffset_.x) * static_cast<int64_t>(bytesPerVoxel);
+
+    std::vector<RowRead> rows;
+    rows.reserve(static_cast<size_t>(validUrb.z - validLlf.z) * static_cast<size_t>(validUrb.y - validLlf.y));
+    size_t rowBytes = static_cast<size_t>(validUrb.x - validLlf.x) * bytesPerVoxel;
+    for (int z = validLlf.z; z < validUrb.z; z++) {
+        for (int y = validLlf.y; y < validUrb.y; y++) {
+            RowRead row;
+            row.filePos_ = baseOffset + ((static_cast<int64_t>(z) * fileDims.y + y) * fileDims.x + validLlf.x) * static_cast<int64_t>(bytesPerVoxel);
+            size_t destIndex = (static_cast<size_t>(z - regionLlf.z) * regionDims.y + static_cast<size_t>(y - regionLlf.y)) * regionDims.x
+                + static_cast<size_t>(validLlf.x - regionLlf.x);
+            row.dest_ = dest + destIndex * bytesPerVoxel;
+            row.numBytes_ = rowBytes;
+            rows.push_back(row);
+        }
+    }
+
+    readRows(filename_, rows);
 }
 
 //--------------------------------------------------------
 
+bool RepresentationConverterLoadFromDisk::useMemoryMapping_ = false;
+
+void RepresentationConverterLoadFromDisk::setUseMemoryMapping(bool enabled) {
+    useMemoryMapping_ = enabled;
+}
+
+bool RepresentationConverterLoadFromDisk::getUseMemoryMapping() {
+    return useMemoryMapping_;
+}
+
+Volume* RepresentationConverterLoadFromDisk::createMappedVolume(const DiskRepresentation* dr) const {
+    // only volumes without border covering a contiguous byte range can be mapped directly
+    if (!dr->isContiguous())
+        return 0;
+
+    int bytesPerVoxel = dr->getBytesPerVoxel();
+    MappedFile* file = 0;
+    try {
+        int64_t dataOffset = dr->getDataOffset();
+
+        // the voxels have to be aligned to their base type in the mapped memory
+        int64_t alignment = 1;
+        while (alignment < 8 && (bytesPerVoxel % (alignment * 2)) == 0)
+            alignment *= 2;
+        if ((dataOffset % alignment) != 0)
+            return 0;
+
+        size_t numBytes = hmul(dr->getDimensions()) * static_cast<size_t>(bytesPerVoxel);
+        file = new MappedFile(dr->getFileName(), dataOffset, numBytes);
+    }
+    catch (tgt::IOException& e) {
+        LDEBUGC("voreen.RepresentationConverterLoadFromDisk", "Memory mapping failed, reading file instead: " << e.what());
+        return 0;
+    }
+
+    VolumeFactory vf;
+    Volume* volume = vf.createMapped(dr->getFormat(), file, dr->getDimensions());
+    if (!volume)
+        delete file;
+    return volume;
+}
+
 bool RepresentationConverterLoadFromDisk::canConvert(const VolumeRepresentation* source) const {
     if(dynamic_cast<const DiskRepresentation*>(source))
         return true;
@@ -107,50 +374,33 @@ VolumeRepresentation* RepresentationConverterLoadFromDisk::convert(const VolumeR
     const DiskRepresentation* dr = dynamic_cast<const DiskRepresentation*>(source);
 
     if(dr) {
-        Volume* volume = 0;
         LDEBUGC("voreen.RepresentationConverterLoadFromDisk", "creating volume from diskrepr. " << dr->getFileName() << " format: " << dr->getFormat());
-        VolumeFactory vf;
-        volume = vf.create(dr->getFormat(), dr->getDimensions());
 
-        if(!volume)
-            return 0;
-
-        FILE* fin;
-        fin = fopen(dr->getFileName().c_str(),"rb");
-
-        if (fin == 0)
-            throw tgt::IOException("Unable to open raw file for reading", dr->getFileName());
-
-        size_t bytesPerVoxel = static_cast<size_t>(volume->getBitsAllocated() / 8);
-        size_t numVoxels = hmul(dr->getDimensions());
-        size_t numBytes = numVoxels * bytesPerVoxel;
+        if (useMemoryMapping_ && MappedFile::isSupported()) {
+            Volume* volume = createMappedVolume(dr);
+            if (volume)
+                return volume;
+        }
 
-        int64_t offset = dr->getOffset();
-        if(offset < 0) {
-            //Assume data is aligned to end of file.
-            
-            // get file size:
-            fseek(fin, 0, SEEK_END);
-            int64_t fileSize = ftell(fin);
-            rewind(fin);
+        // create one voxel volume of the format and derive the actual volume including border from it
+        VolumeFactory vf;
+        Volume* voxel = vf.create(dr->getFormat(), tgt::svec3(1,1,1));
+        if (!voxel)
+            return 0;
+        Volume* volume = voxel->createNew(dr->getDimensions(), dr->getBorder(), true);
+        delete voxel;
+        if (!volume)
+            return 0;
 
-            //calculate real offset:
-            offset = fileSize - numBytes;
+        try {
+            dr->readVoxels(volume->getData());
         }
-#ifdef _MSC_VER
-        _fseeki64(fin, offset, SEEK_SET);
-#else
-        fseek(fin, offset, SEEK_SET);
-#endif
-
-        if(fread(reinterpret_cast<char*>(volume->getData()), numBytes, 1, fin) != 1) {
-            LERRORC("voreen.RepresentationConverterLoadFromDisk", "fread() failed");
-            fclose(fin);
+        catch (tgt::IOException& e) {
+            LERRORC("voreen.RepresentationConverterLoadFromDisk", e.what());
             delete volume;
             return 0;
         }
 
-        fclose(fin);
         return volume;
     }
     else {
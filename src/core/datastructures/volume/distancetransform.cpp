@@ -0,0 +1,232 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/volume/distancetransform.h"
+#include "voreen/core/io/progressbar.h"
+
+#include <limits>
+#include <cmath>
+
+namespace voreen {
+
+const std::string DistanceTransform::loggerCat_("voreen.DistanceTransform");
+
+namespace {
+
+/**
+ * Computes d(p) = min_q (weight*(p-q)^2 + f(q)) for one line of n samples by determining the
+ * lower envelope of the parabolas rooted at the samples. Infinite samples are skipped.
+ * The buffers v and z have to provide space for n and n+1 elements.
+ */
+void transformLine(const double* f, double* d, size_t n, double weight, size_t* v, double* z) {
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // compute lower envelope
+    int k = -1;
+    for (size_t q = 0; q < n; q++) {
+        if (f[q] == inf)
+            continue;
+        if (k < 0) {
+            k = 0;
+            v[0] = q;
+            z[0] = -inf;
+            z[1] = inf;
+            continue;
+        }
+
+        double s;
+        for (;;) {
+            double p = static_cast<double>(v[k]);
+            double qd = static_cast<double>(q);
+            s = ((f[q] + weight*qd*qd) - (f[v[k]] + weight*p*p)) / (2.0*weight*(qd - p));
+            if (s > z[k])
+                break;
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k+1] = inf;
+    }
+
+    // no finite sample on this line
+    if (k < 0) {
+        for (size_t q = 0; q < n; q++)
+            d[q] = inf;
+        return;
+    }
+
+    // fill in values of the envelope
+    k = 0;
+    for (size_t q = 0; q < n; q++) {
+        while (z[k+1] < static_cast<double>(q))
+            k++;
+        double dq = static_cast<double>(q) - static_cast<double>(v[k]);
+        d[q] = weight*dq*dq + f[v[k]];
+    }
+}
+
+/// Per-thread buffers for transforming lines of at most n samples.
+struct LineBuffers {
+    LineBuffers(size_t n)
+        : f(n), d(n), v(n), z(n+1)
+    {}
+    std::vector<double> f;
+    std::vector<double> d;
+    std::vector<size_t> v;
+    std::vector<double> z;
+};
+
+template<typename T>
+double toDistance(T value) {
+    return (value == std::numeric_limits<T>::max() ? std::numeric_limits<double>::infinity() : static_cast<double>(value));
+}
+
+template<typename T>
+T fromDistance(double value) {
+    return (value >= static_cast<double>(std::numeric_limits<T>::max()) ? std::numeric_limits<T>::max() : static_cast<T>(value));
+}
+
+} // namespace
+
+template<typename T>
+void DistanceTransform::computeSquaredDistances(const Volume* volume, float threshold, bool foreground,
+        const tgt::vec3& spacing, VolumeAtomic<T>* result, ProgressBar* progressBar, float progressOffset, float progressScale)
+{
+    tgtAssert(volume && result, "null pointer passed");
+    tgtAssert(volume->getDimensions() == result->getDimensions(), "dimension mismatch");
+
+    const tgt::svec3 dims = volume->getDimensions();
+    const int dimX = static_cast<int>(dims.x);
+    const int dimY = static_cast<int>(dims.y);
+    const int dimZ = static_cast<int>(dims.z);
+    const size_t maxDim = tgt::max(dims);
+    const T maxValue = std::numeric_limits<T>::max();
+
+    // initialize: voxels of the other class have distance zero
+    #pragma omp parallel for
+    for (int z = 0; z < dimZ; z++) {
+        for (size_t y = 0; y < dims.y; y++) {
+            for (size_t x = 0; x < dims.x; x++) {
+                bool isForeground = volume->getVoxelFloat(x, y, z) > threshold;
+                result->voxel(x, y, z) = (isForeground == foreground ? maxValue : T(0));
+            }
+        }
+    }
+
+    // one pass per axis: x-lines are contiguous, for y and z the lines are gathered
+    for (int axis = 0; axis < 3; axis++) {
+        const double weight = static_cast<double>(spacing[axis]) * static_cast<double>(spacing[axis]);
+        const size_t n = dims[axis];
+        const int numLines = static_cast<int>(axis == 2 ? dims.y : dims.z);
+
+        #pragma omp parallel
+        {
+            LineBuffers buffers(maxDim);
+
+            #pragma omp for schedule(dynamic, 1)
+            for (int line = 0; line < numLines; line++) {
+                // each iteration transforms all lines of one slice orthogonal to the line direction
+                int numInner = (axis == 0 ? dimY : dimX);
+                for (int inner = 0; inner < numInner; inner++) {
+                    tgt::svec3 pos;
+                    if (axis == 0)
+                        pos = tgt::svec3(0, inner, line);
+                    else if (axis == 1)
+                        pos = tgt::svec3(inner, 0, line);
+                    else
+                        pos = tgt::svec3(inner, line, 0);
+
+                    tgt::svec3 p = pos;
+                    for (size_t i = 0; i < n; i++) {
+                        p[axis] = i;
+                        buffers.f[i] = toDistance(result->voxel(p));
+                    }
+                    transformLine(&buffers.f[0], &buffers.d[0], n, weight, &buffers.v[0], &buffers.z[0]);
+                    for (size_t i = 0; i < n; i++) {
+                        p[axis] = i;
+                        result->voxel(p) = fromDistance<T>(buffers.d[i]);
+                    }
+                }
+            }
+        }
+
+        if (progressBar)
+            progressBar->setProgress(progressOffset + progressScale * static_cast<float>(axis + 1) / 3.f);
+    }
+}
+
+VolumeFloat* DistanceTransform::computeDistances(const Volume* volume, float threshold, const tgt::vec3& spacing,
+        bool signedDistance, ProgressBar* progressBar)
+{
+    tgtAssert(volume, "no volume");
+
+    VolumeFloat* result = new VolumeFloat(volume->getDimensions());
+    // processed slice-wise, since the number of voxels may exceed the int range
+    const int dimZ = static_cast<int>(result->getDimensions().z);
+    const size_t sliceSize = result->getDimensions().x * result->getDimensions().y;
+    const float maxValue = std::numeric_limits<float>::max();
+    const float progressScale = (signedDistance ? 0.5f : 1.f);
+
+    computeSquaredDistances<float>(volume, threshold, true, spacing, result, progressBar, 0.f, progressScale);
+    #pragma omp parallel for
+    for (int z = 0; z < dimZ; z++) {
+        for (size_t i = z*sliceSize; i < (z+1)*sliceSize; i++) {
+            float& value = result->voxel(i);
+            if (value != maxValue)
+                value = std::sqrt(value);
+        }
+    }
+
+    if (signedDistance) {
+        // background voxels are zero in the first transform and vice versa
+        VolumeFloat* background = new VolumeFloat(volume->getDimensions());
+        computeSquaredDistances<float>(volume, threshold, false, spacing, background, progressBar, 0.5f, 0.5f);
+        #pragma omp parallel for
+        for (int z = 0; z < dimZ; z++) {
+            for (size_t i = z*sliceSize; i < (z+1)*sliceSize; i++) {
+                float value = background->voxel(i);
+                if (value != 0.f)
+                    result->voxel(i) = -(value == maxValue ? maxValue : std::sqrt(value));
+            }
+        }
+        delete background;
+    }
+
+    return result;
+}
+
+VolumeUInt32* DistanceTransform::computeSquaredDistances(const Volume* volume, float threshold, ProgressBar* progressBar) {
+    tgtAssert(volume, "no volume");
+
+    VolumeUInt32* result = new VolumeUInt32(volume->getDimensions());
+    computeSquaredDistances<uint32_t>(volume, threshold, true, tgt::vec3(1.f), result, progressBar, 0.f, 1.f);
+    return result;
+}
+
+} // namespace voreen
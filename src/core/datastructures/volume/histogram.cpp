@@ -32,8 +32,135 @@
 #include "voreen/core/io/serialization/xmlserializer.h"
 #include "voreen/core/io/serialization/xmldeserializer.h"
 
+#include <limits>
+
 namespace voreen {
 
+namespace {
+
+/**
+ * Running count, mean and sum of squared deviations (M2),
+ * which can be merged pairwise (Chan et al.).
+ */
+struct RunningMoments {
+    RunningMoments() : n_(0), mean_(0.0), m2_(0.0) {}
+
+    void merge(double n, double mean, double m2) {
+        if (n == 0.0)
+            return;
+        double total = n_ + n;
+        double delta = mean - mean_;
+        mean_ += delta * n / total;
+        m2_ += m2 + delta * delta * n_ * n / total;
+        n_ = total;
+    }
+
+    double n_;
+    double mean_;
+    double m2_;
+};
+
+/// Converts an element value to float in the same way as getTypeAsFloat().
+template<class T>
+float normalizeElement(T value) {
+    if (!VolumeElement<T>::isInteger())
+        return static_cast<float>(value);
+    else if (value >= 0)
+        return static_cast<float>(static_cast<double>(value) / VolumeElement<T>::rangeMaxElement());
+    else
+        return static_cast<float>(static_cast<double>(value) / -static_cast<double>(VolumeElement<T>::rangeMinElement()));
+}
+
+/**
+ * Number of entries of a lookup table covering all values of T. Only instantiated
+ * with SMALL_TYPE = true for types of at most 16 bits, other types have no table.
+ */
+template<class T, bool SMALL_TYPE>
+struct LookupTableSize {
+    static size_t get() { return 0; }
+};
+
+template<class T>
+struct LookupTableSize<T, true> {
+    static size_t get() {
+        return static_cast<size_t>(static_cast<int>(std::numeric_limits<T>::max())
+            - static_cast<int>(std::numeric_limits<T>::min()) + 1);
+    }
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+VolumeStatistics::VolumeStatistics() :
+    VolumeDerivedData(),
+    minValue_(0.f),
+    maxValue_(0.f),
+    mean_(0.f),
+    variance_(0.f),
+    numSamples_(0)
+{}
+
+VolumeStatistics::VolumeStatistics(float minValue, float maxValue, float mean, float variance, size_t numSamples) :
+    VolumeDerivedData(),
+    minValue_(minValue),
+    maxValue_(maxValue),
+    mean_(mean),
+    variance_(variance),
+    numSamples_(numSamples)
+{}
+
+VolumeDerivedData* VolumeStatistics::createFrom(const VolumeHandleBase* handle) const {
+    tgtAssert(handle, "no volume handle");
+    VolumeStatistics* statistics = new VolumeStatistics();
+    HistogramIntensity* histogram = new HistogramIntensity(handle->getRepresentation<Volume>(), 256, statistics);
+    if (!handle->hasDerivedData<HistogramIntensity>())
+        const_cast<VolumeHandleBase*>(handle)->addDerivedData<HistogramIntensity>(histogram);
+    else
+        delete histogram;
+    return statistics;
+}
+
+float VolumeStatistics::getMinValue() const {
+    return minValue_;
+}
+
+float VolumeStatistics::getMaxValue() const {
+    return maxValue_;
+}
+
+float VolumeStatistics::getMean() const {
+    return mean_;
+}
+
+float VolumeStatistics::getVariance() const {
+    return variance_;
+}
+
+float VolumeStatistics::getStandardDeviation() const {
+    return sqrtf(variance_);
+}
+
+size_t VolumeStatistics::getNumSamples() const {
+    return numSamples_;
+}
+
+void VolumeStatistics::serialize(XmlSerializer& s) const  {
+    s.serialize("minValue", minValue_);
+    s.serialize("maxValue", maxValue_);
+    s.serialize("mean", mean_);
+    s.serialize("variance", variance_);
+    s.serialize("numSamples", numSamples_);
+}
+
+void VolumeStatistics::deserialize(XmlDeserializer& s) {
+    s.deserialize("minValue", minValue_);
+    s.deserialize("maxValue", maxValue_);
+    s.deserialize("mean", mean_);
+    s.deserialize("variance", variance_);
+    s.deserialize("numSamples", numSamples_);
+}
+
 //Histogram1D createHistogram1DFromVolume(const VolumeHandleBase* handle, int bucketCount) {
 //    const Volume* vol = handle->getRepresentation<Volume>();
 //    RealWorldMapping rwm = handle->getRealWorldMapping();
@@ -62,7 +189,7 @@ HistogramIntensity::HistogramIntensity() :
     maxValue_(-1)
 {}
 
-HistogramIntensity::HistogramIntensity(const Volume* volume, int bucketCount) :
+HistogramIntensity::HistogramIntensity(const Volume* volume, int bucketCount, VolumeStatistics* statistics) :
     VolumeDerivedData()
 {
     tgtAssert(volume, "HistogramIntensity: No volume");
@@ -77,71 +204,138 @@ HistogramIntensity::HistogramIntensity(const Volume* volume, int bucketCount) :
 
     maxValue_ = 0;
 
-    const Volume* currentVolume = volume;
-
-    const VolumeUInt8* sourceDataset8Bit = dynamic_cast<const VolumeUInt8*>(currentVolume);
-    if (sourceDataset8Bit) {
-        int bucket;
-        float m = (bucketCount - 1.f) / 255.f;
-
-        for (size_t i=0; i < sourceDataset8Bit->getNumVoxels(); ++i) {
-            bucket = static_cast<int>(floor(sourceDataset8Bit->voxel(i) * m));
-            int value = histValues_[bucket] + 1;
-            histValues_[bucket] = value;
+    if (const VolumeUInt8* v = dynamic_cast<const VolumeUInt8*>(volume))
+        computeHistogram(v, 0, 0.0, 255.0, statistics);
+    else if (const VolumeInt8* v = dynamic_cast<const VolumeInt8*>(volume))
+        computeHistogram(v, 0, -128.0, 127.0, statistics);
+    else if (const VolumeUInt16* v = dynamic_cast<const VolumeUInt16*>(volume))
+        computeHistogram(v, 0, 0.0, (v->getBitsStored() == 12) ? 4095.0 : 65535.0, statistics);
+    else if (const VolumeInt16* v = dynamic_cast<const VolumeInt16*>(volume))
+        computeHistogram(v, 0, -32768.0, 32767.0, statistics);
+    else if (const VolumeUInt32* v = dynamic_cast<const VolumeUInt32*>(volume))
+        computeHistogram(v, 0, 0.0, 4294967295.0, statistics);
+    else if (const VolumeInt32* v = dynamic_cast<const VolumeInt32*>(volume))
+        computeHistogram(v, 0, -2147483648.0, 2147483647.0, statistics);
+    else if (const VolumeFloat* v = dynamic_cast<const VolumeFloat*>(volume))
+        computeHistogram(v, 0, 0.0, 1.0, statistics);
+    else if (const VolumeDouble* v = dynamic_cast<const VolumeDouble*>(volume))
+        computeHistogram(v, 0, 0.0, 1.0, statistics);
+    else if (const Volume4xUInt8* v = dynamic_cast<const Volume4xUInt8*>(volume))
+        computeHistogram(v, 3, 0.0, 255.0, statistics);
+    else
+        LWARNINGC("voreen.HistogramIntensity", "Unsupported volume type: histogram is empty");
+}
 
-            if (value > maxValue_)
-                maxValue_ = value;
+template<class T>
+void HistogramIntensity::computeHistogram(const VolumeAtomic<T>* volume, size_t channel, double rangeMin, double rangeMax,
+                                          VolumeStatistics* statistics)
+{
+    typedef typename VolumeElement<T>::BaseType BaseType;
+
+    const int bucketCount = static_cast<int>(histValues_.size());
+    const double m = (bucketCount - 1.0) / (rangeMax - rangeMin);
+    const T* data = volume->voxel();
+    const size_t numVoxels = volume->getNumVoxels();
+
+    // Types with at most 16 bits are mapped to buckets by a lookup table.
+    // Each thread then updates four interleaved sets of buckets, so that
+    // consecutive equal values do not stall on the same counter.
+    const bool useLUT = VolumeElement<BaseType>::isInteger() && sizeof(BaseType) <= 2;
+    const int lutOffset = useLUT ? -static_cast<int>(std::numeric_limits<BaseType>::min()) : 0;
+    std::vector<int> lut;
+    if (useLUT) {
+        lut.resize(LookupTableSize<BaseType, (sizeof(BaseType) <= 2)>::get());
+        float mf = static_cast<float>(m);
+        for (size_t i=0; i < lut.size(); ++i) {
+            float x = (static_cast<float>(static_cast<int>(i) - lutOffset) - static_cast<float>(rangeMin)) * mf;
+            int bucket = static_cast<int>(floor(x));
+            lut[i] = (bucket >= 0 && bucket < bucketCount) ? bucket : -1;
         }
     }
 
-    const Volume4xUInt8* sourceDataset32Bit = dynamic_cast<const Volume4xUInt8*>(currentVolume);
-    if (sourceDataset32Bit) {
-        int bucket;
-        float m = (bucketCount - 1.f) / 255.f;
-
-        for (size_t i=0; i < sourceDataset32Bit->getNumVoxels(); ++i) {
-            bucket = static_cast<int>(floor(sourceDataset32Bit->voxel(i)[3] * m));
-            int value = histValues_[bucket] + 1;
-            histValues_[bucket] = value;
+    // process the volume in chunks of 1M voxels (int loop variable for OpenMP 2.0 compatibility)
+    const size_t chunkSize = size_t(1) << 20;
+    const int numChunks = static_cast<int>((numVoxels + chunkSize - 1) / chunkSize);
+
+    std::vector<uint64_t> buckets(bucketCount, 0);
+    BaseType minValue = std::numeric_limits<BaseType>::max();
+    BaseType maxValue = VolumeElement<BaseType>::isInteger() ? std::numeric_limits<BaseType>::min() : -std::numeric_limits<BaseType>::max();
+    RunningMoments moments;
+
+    #pragma omp parallel
+    {
+        std::vector<uint64_t> localBuckets((useLUT ? 4 : 1) * bucketCount, 0);
+        BaseType localMin = minValue;
+        BaseType localMax = maxValue;
+        RunningMoments localMoments;
+
+        #pragma omp for schedule(dynamic, 4)
+        for (int chunk = 0; chunk < numChunks; ++chunk) {
+            const size_t start = chunk * chunkSize;
+            const size_t end = std::min(start + chunkSize, numVoxels);
+
+            double sum = 0.0;
+            double sumSq = 0.0;
+            BaseType chunkMin = localMin;
+            BaseType chunkMax = localMax;
+            if (useLUT) {
+                for (size_t i = start; i < end; ++i) {
+                    BaseType value = VolumeElement<T>::getChannel(data[i], channel);
+                    int bucket = lut[static_cast<int>(value) + lutOffset];
+                    if (bucket >= 0)
+                        localBuckets[(i & 3) * bucketCount + bucket]++;
+                    chunkMin = std::min(chunkMin, value);
+                    chunkMax = std::max(chunkMax, value);
+                    double d = static_cast<double>(value);
+                    sum += d;
+                    sumSq += d*d;
+                }
+            }
+            else {
+                for (size_t i = start; i < end; ++i) {
+                    BaseType value = VolumeElement<T>::getChannel(data[i], channel);
+                    double d = static_cast<double>(value);
+                    double x = (d - rangeMin) * m;
+                    if (x >= 0.0 && x < bucketCount)
+                        localBuckets[static_cast<int>(x)]++;
+                    chunkMin = std::min(chunkMin, value);
+                    chunkMax = std::max(chunkMax, value);
+                    sum += d;
+                    sumSq += d*d;
+                }
+            }
+            localMin = chunkMin;
+            localMax = chunkMax;
 
-            if (value > maxValue_)
-                maxValue_ = value;
+            // convert chunk sums to mean/M2 before merging for numerical stability
+            double n = static_cast<double>(end - start);
+            double mean = sum / n;
+            localMoments.merge(n, mean, std::max(0.0, sumSq - n*mean*mean));
         }
-    }
 
-    const VolumeUInt16* sourceDataset16Bit = dynamic_cast<const VolumeUInt16*>(currentVolume);
-    if (sourceDataset16Bit) {
-        int bucket;
-        float maxValue = (sourceDataset16Bit->getBitsStored() == 12) ? 4095.f : 65535.f;
-        float m = (bucketCount - 1.f) / maxValue;
-
-        for (size_t i=0; i < sourceDataset16Bit->getNumVoxels(); ++i) {
-            bucket = static_cast<int>(floor(sourceDataset16Bit->voxel(i) * m));
-            if (bucket < static_cast<int>(histValues_.size())) {
-                int value = histValues_[bucket] + 1;
-                histValues_[bucket] = value;
-
-                if (value > maxValue_)
-                    maxValue_ = value;
-            }
+        #pragma omp critical
+        {
+            for (size_t i = 0; i < localBuckets.size(); ++i)
+                buckets[i % bucketCount] += localBuckets[i];
+            minValue = std::min(minValue, localMin);
+            maxValue = std::max(maxValue, localMax);
+            moments.merge(localMoments.n_, localMoments.mean_, localMoments.m2_);
         }
     }
 
-    const VolumeFloat* sourceDatasetFloat = dynamic_cast<const VolumeFloat*>(currentVolume);
-    if (sourceDatasetFloat) {
-        float m = (bucketCount - 1.f);
-        int count = static_cast<int>(histValues_.size());
-
-        for (size_t i=0; i < sourceDatasetFloat->getNumVoxels(); ++i) {
-            int bucket = static_cast<int>(floor(sourceDatasetFloat->voxel(i) * m));
-            if (bucket < count && bucket >= 0) {
-                int value = histValues_[bucket] + 1;
-                histValues_[bucket] = value;
+    // copy to histogram (saturating), determine max bucket once
+    for (int i = 0; i < bucketCount; ++i) {
+        histValues_[i] = static_cast<int>(std::min<uint64_t>(buckets[i], std::numeric_limits<int>::max()));
+        maxValue_ = std::max(maxValue_, histValues_[i]);
+    }
 
-                if (value > maxValue_)
-                    maxValue_ = value;
-            }
-        }
+    if (statistics && numVoxels > 0) {
+        double scale = 1.0;
+        if (VolumeElement<BaseType>::isInteger())
+            scale = 1.0 / static_cast<double>(VolumeElement<BaseType>::rangeMaxElement());
+        double variance = (moments.n_ > 0.0 ? moments.m2_ / moments.n_ : 0.0);
+        *statistics = VolumeStatistics(normalizeElement(minValue), normalizeElement(maxValue),
+            static_cast<float>(moments.mean_ * scale), static_cast<float>(variance * scale * scale), numVoxels);
     }
 }
 
@@ -152,7 +346,12 @@ HistogramIntensity::HistogramIntensity(const HistogramIntensity& h) {
 
 VolumeDerivedData* HistogramIntensity::createFrom(const VolumeHandleBase* handle) const {
     tgtAssert(handle, "no volume handle");
-    HistogramIntensity* histogram = new HistogramIntensity(handle->getRepresentation<Volume>(), 256);
+    VolumeStatistics* statistics = new VolumeStatistics();
+    HistogramIntensity* histogram = new HistogramIntensity(handle->getRepresentation<Volume>(), 256, statistics);
+    if (!handle->hasDerivedData<VolumeStatistics>())
+        const_cast<VolumeHandleBase*>(handle)->addDerivedData<VolumeStatistics>(statistics);
+    else
+        delete statistics;
     return histogram;
 }
 
@@ -190,6 +389,10 @@ float HistogramIntensity::getLogNormalized(int i) const {
      return (logf(static_cast<float>(1+histValues_[i]) ) / log( static_cast<float>(1+maxValue_)));
 }
 
+int HistogramIntensity::getMaxValue() const {
+    return maxValue_;
+}
+
 float HistogramIntensity::getLogNormalized(float i) const {
     size_t bucketCount = histValues_.size();
     float m = (bucketCount - 1.f);
@@ -0,0 +1,171 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/volume/mappedvolume.h"
+
+#include "tgt/filesystem.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace voreen {
+
+const std::string MappedFile::loggerCat_("voreen.MappedFile");
+
+MappedFile::MappedFile(const std::string& filename, int64_t offset, size_t numBytes) throw (tgt::IOException)
+    : filename_(filename)
+    , mapping_(0)
+    , mappingSize_(0)
+    , data_(0)
+    , numBytes_(numBytes)
+#ifdef WIN32
+    , fileHandle_(INVALID_HANDLE_VALUE)
+    , mappingHandle_(0)
+#endif
+{
+    if (numBytes_ == 0)
+        throw tgt::IOException("Unable to map empty byte range", filename_);
+
+#ifdef WIN32
+    HANDLE file = CreateFileA(filename_.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (file == INVALID_HANDLE_VALUE)
+        throw tgt::IOException("Unable to open raw file for mapping", filename_);
+    fileHandle_ = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw tgt::IOException("Unable to determine file size", filename_);
+    }
+    if (offset < 0)
+        offset = fileSize.QuadPart - static_cast<int64_t>(numBytes_);
+    if (offset < 0 || offset + static_cast<int64_t>(numBytes_) > fileSize.QuadPart) {
+        CloseHandle(file);
+        throw tgt::IOException("Mapped byte range exceeds file size", filename_);
+    }
+
+    // copy-on-write mapping, the file itself is never modified
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+    if (!mapping) {
+        CloseHandle(file);
+        throw tgt::IOException("Unable to create file mapping", filename_);
+    }
+    mappingHandle_ = mapping;
+
+    // view offset has to be a multiple of the allocation granularity
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    int64_t granularity = static_cast<int64_t>(sysInfo.dwAllocationGranularity);
+    int64_t alignedOffset = (offset / granularity) * granularity;
+    size_t delta = static_cast<size_t>(offset - alignedOffset);
+    mappingSize_ = numBytes_ + delta;
+
+    mapping_ = MapViewOfFile(mapping, FILE_MAP_COPY,
+                             static_cast<DWORD>(alignedOffset >> 32),
+                             static_cast<DWORD>(alignedOffset & 0xFFFFFFFF),
+                             mappingSize_);
+    if (!mapping_) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw tgt::IOException("Unable to map view of file", filename_);
+    }
+#else
+    int fd = open(filename_.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw tgt::IOException("Unable to open raw file for mapping", filename_);
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        throw tgt::IOException("Unable to determine file size", filename_);
+    }
+    int64_t fileSize = static_cast<int64_t>(fileStat.st_size);
+    if (offset < 0)
+        offset = fileSize - static_cast<int64_t>(numBytes_);
+    if (offset < 0 || offset + static_cast<int64_t>(numBytes_) > fileSize) {
+        close(fd);
+        throw tgt::IOException("Mapped byte range exceeds file size", filename_);
+    }
+
+    // mapping offset has to be a multiple of the page size
+    int64_t pageSize = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+    int64_t alignedOffset = (offset / pageSize) * pageSize;
+    size_t delta = static_cast<size_t>(offset - alignedOffset);
+    mappingSize_ = numBytes_ + delta;
+
+    // private mapping: pages are shared with other readers until written to (copy-on-write)
+    mapping_ = mmap(0, mappingSize_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, static_cast<off_t>(alignedOffset));
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = 0;
+        throw tgt::IOException("Unable to map raw file", filename_);
+    }
+#endif
+
+    data_ = reinterpret_cast<char*>(mapping_) + delta;
+}
+
+MappedFile::~MappedFile() {
+#ifdef WIN32
+    if (mapping_)
+        UnmapViewOfFile(mapping_);
+    if (mappingHandle_)
+        CloseHandle(reinterpret_cast<HANDLE>(mappingHandle_));
+    if (fileHandle_ != INVALID_HANDLE_VALUE)
+        CloseHandle(reinterpret_cast<HANDLE>(fileHandle_));
+#else
+    if (mapping_ && munmap(mapping_, mappingSize_) != 0)
+        LWARNING("munmap() failed for " << filename_);
+#endif
+}
+
+bool MappedFile::isSupported() {
+    // address space of 32 bit processes is too small for mapping large volumes
+    return (sizeof(void*) >= 8);
+}
+
+//------------------------------------------------------------------------------
+
+Volume* MappedVolumeBase::copyIfMappedFrom(const Volume* volume, const std::string& filename) {
+    const MappedVolumeBase* mapped = dynamic_cast<const MappedVolumeBase*>(volume);
+    if (!mapped || !tgt::FileSystem::comparePaths(mapped->getMappedFile()->getFileName(), filename))
+        return 0;
+
+    // VolumeAtomic<T>::clone() copies the voxels into newly allocated memory
+    return volume->clone();
+}
+
+} // namespace voreen
@@ -29,6 +29,9 @@
 #include "voreen/core/datastructures/volume/volumederiveddatafactory.h"
 
 #include "voreen/core/datastructures/volume/volumehash.h"
+#include "voreen/core/datastructures/volume/histogram.h"
+#include "voreen/core/datastructures/volume/volumeminmaxoctree.h"
+#include "voreen/core/datastructures/volume/volumepyramid.h"
 
 
 namespace voreen {
@@ -36,6 +39,12 @@ namespace voreen {
 const std::string VolumeDerivedDataFactory::getTypeString(const std::type_info& type) const {
     if (type == typeid(VolumeHash))
         return "VolumeHash";
+    else if (type == typeid(VolumeMinMaxOctree))
+        return "VolumeMinMaxOctree";
+    else if (type == typeid(VolumeStatistics))
+        return "VolumeStatistics";
+    else if (type == typeid(VolumePyramid))
+        return "VolumePyramid";
     else 
         return "";
 }
@@ -43,6 +52,12 @@ const std::string VolumeDerivedDataFactory::getTypeString(const std::type_info&
 Serializable* VolumeDerivedDataFactory::createType(const std::string& typeString) {
     if (typeString == "VolumeHash")
         return new VolumeHash();
+    else if (typeString == "VolumeMinMaxOctree")
+        return new VolumeMinMaxOctree();
+    else if (typeString == "VolumeStatistics")
+        return new VolumeStatistics();
+    else if (typeString == "VolumePyramid")
+        return new VolumePyramid();
     else
         return 0;
 }
@@ -339,7 +339,13 @@ VolumeHandle* VolumeHandleBase::clone() const throw (std::bad_alloc) {
 }
 
 std::string VolumeHandleBase::getHash() const {
-    return getDerivedData<VolumeHash>()->getHash();
+    VolumeHash* hash = getDerivedData<VolumeHash>();
+    if (hash && hash->getVersion() != VolumeHash::CURRENT_VERSION) {
+        // hash has been computed by an outdated algorithm => recompute
+        removeDerivedDataInternal<VolumeHash>();
+        hash = getDerivedData<VolumeHash>();
+    }
+    return (hash ? hash->getHash() : "");
 }
 
 tgt::vec3 VolumeHandleBase::getCubeSize() const {
@@ -739,8 +745,8 @@ void VolumeHandle::deserialize(XmlDeserializer& s) {
     delete progressDialog;
 }
 
-void VolumeHandle::setHash(const std::string& hash) const {
-    addDerivedDataInternal<VolumeHash>(new VolumeHash(hash));
+void VolumeHandle::setHash(const std::string& hash, int version) const {
+    addDerivedDataInternal<VolumeHash>(new VolumeHash(hash, version));
 }
 
 void VolumeHandle::setModality(Modality modality) {
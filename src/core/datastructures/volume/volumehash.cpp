@@ -37,11 +37,13 @@ namespace voreen {
 
 VolumeHash::VolumeHash() :
     VolumeDerivedData(),
-    hash_("")
+    hash_(""),
+    version_(CURRENT_VERSION)
 {}
 
-VolumeHash::VolumeHash(const std::string& hash) :
-    VolumeDerivedData()
+VolumeHash::VolumeHash(const std::string& hash, int version) :
+    VolumeDerivedData(),
+    version_(version)
 {
     setHash(hash);
 }
@@ -54,16 +56,25 @@ VolumeDerivedData* VolumeHash::createFrom(const VolumeHandleBase* handle) const
 
     size_t s = v->getNumVoxels() * v->getBytesPerVoxel();
 
-    std::string h = VoreenHash::getHash(v->getData(), s);
-    return new VolumeHash(h);
+    std::string h = VoreenHash::getHash(v->getData(), s, VoreenHash::CHUNKED_MURMUR3);
+    return new VolumeHash(h, CURRENT_VERSION);
 }
 
 void VolumeHash::serialize(XmlSerializer& s) const  {
     s.serialize("hash", hash_);
+    s.serialize("version", version_);
 }
 
 void VolumeHash::deserialize(XmlDeserializer& s) {
     s.deserialize("hash", hash_);
+    try {
+        s.deserialize("version", version_);
+    }
+    catch (XmlSerializationNoSuchDataException&) {
+        // hashes serialized without version have been computed by MD5
+        s.removeLastError();
+        version_ = VERSION_MD5;
+    }
 }
 
 } // namespace voreen
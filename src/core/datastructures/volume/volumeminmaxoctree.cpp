@@ -0,0 +1,161 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/volume/volumeminmaxoctree.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+
+#include "voreen/core/io/serialization/xmlserializer.h"
+#include "voreen/core/io/serialization/xmldeserializer.h"
+
+#include <limits>
+
+namespace voreen {
+
+VolumeMinMaxOctree::VolumeMinMaxOctree() :
+    VolumeDerivedData(),
+    brickSize_(0)
+{}
+
+VolumeMinMaxOctree::VolumeMinMaxOctree(const Volume* volume, size_t brickSize) :
+    VolumeDerivedData(),
+    brickSize_(brickSize)
+{
+    tgtAssert(volume, "no volume");
+    tgtAssert(brickSize > 0, "invalid brick size");
+
+    const tgt::svec3 volDims = volume->getDimensions();
+    tgt::ivec3 dims = tgt::ivec3((volDims + tgt::svec3(brickSize_ - 1)) / brickSize_);
+    levelDims_.push_back(dims);
+    levels_.push_back(std::vector<tgt::vec2>(tgt::hmul(dims)));
+
+    // leaf level: min/max of each brick including the first voxel layer of the upper neighbors
+    std::vector<tgt::vec2>& leaves = levels_.front();
+    const int numSlabs = dims.z;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int bz = 0; bz < numSlabs; ++bz) {
+        for (int by = 0; by < dims.y; ++by) {
+            for (int bx = 0; bx < dims.x; ++bx) {
+                tgt::svec3 llf = tgt::svec3(bx, by, bz) * brickSize_;
+                tgt::svec3 urb = tgt::min(llf + tgt::svec3(brickSize_ + 1), volDims);
+
+                float minValue = std::numeric_limits<float>::max();
+                float maxValue = -std::numeric_limits<float>::max();
+                for (size_t z = llf.z; z < urb.z; ++z) {
+                    for (size_t y = llf.y; y < urb.y; ++y) {
+                        for (size_t x = llf.x; x < urb.x; ++x) {
+                            float value = volume->getVoxelFloat(x, y, z);
+                            minValue = std::min(minValue, value);
+                            maxValue = std::max(maxValue, value);
+                        }
+                    }
+                }
+                leaves[(bz*dims.y + by)*dims.x + bx] = tgt::vec2(minValue, maxValue);
+            }
+        }
+    }
+
+    // inner levels: merge 2x2x2 child nodes until a single root node remains
+    while (tgt::hmul(dims) > 1) {
+        const tgt::ivec3 childDims = dims;
+        dims = (childDims + tgt::ivec3(1)) / 2;
+        const std::vector<tgt::vec2>& children = levels_.back();
+        std::vector<tgt::vec2> nodes(tgt::hmul(dims));
+
+        for (int z = 0; z < dims.z; ++z) {
+            for (int y = 0; y < dims.y; ++y) {
+                for (int x = 0; x < dims.x; ++x) {
+                    tgt::vec2 range(std::numeric_limits<float>::max(), -std::numeric_limits<float>::max());
+                    tgt::ivec3 llf = tgt::ivec3(x, y, z) * 2;
+                    tgt::ivec3 urb = tgt::min(llf + tgt::ivec3(2), childDims);
+                    for (int cz = llf.z; cz < urb.z; ++cz) {
+                        for (int cy = llf.y; cy < urb.y; ++cy) {
+                            for (int cx = llf.x; cx < urb.x; ++cx) {
+                                const tgt::vec2& child = children[(cz*childDims.y + cy)*childDims.x + cx];
+                                range.x = std::min(range.x, child.x);
+                                range.y = std::max(range.y, child.y);
+                            }
+                        }
+                    }
+                    nodes[(z*dims.y + y)*dims.x + x] = range;
+                }
+            }
+        }
+
+        levelDims_.push_back(dims);
+        levels_.push_back(nodes);
+    }
+}
+
+VolumeDerivedData* VolumeMinMaxOctree::createFrom(const VolumeHandleBase* handle) const {
+    tgtAssert(handle, "no volume handle");
+
+    const Volume* v = handle->getRepresentation<Volume>();
+    if (!v)
+        return 0;
+
+    return new VolumeMinMaxOctree(v);
+}
+
+size_t VolumeMinMaxOctree::getBrickSize() const {
+    return brickSize_;
+}
+
+size_t VolumeMinMaxOctree::getNumLevels() const {
+    return levels_.size();
+}
+
+tgt::svec3 VolumeMinMaxOctree::getLevelDimensions(size_t level) const {
+    tgtAssert(level < levelDims_.size(), "invalid level");
+    return tgt::svec3(levelDims_[level]);
+}
+
+const std::vector<tgt::vec2>& VolumeMinMaxOctree::getLevel(size_t level) const {
+    tgtAssert(level < levels_.size(), "invalid level");
+    return levels_[level];
+}
+
+tgt::vec2 VolumeMinMaxOctree::getMinMax(size_t level, const tgt::svec3& node) const {
+    tgtAssert(level < levels_.size(), "invalid level");
+    const tgt::ivec3& dims = levelDims_[level];
+    tgtAssert(tgt::hand(tgt::lessThan(tgt::ivec3(node), dims)), "invalid node");
+    return levels_[level][(node.z*dims.y + node.y)*dims.x + node.x];
+}
+
+void VolumeMinMaxOctree::serialize(XmlSerializer& s) const  {
+    s.serialize("brickSize", brickSize_);
+    s.serialize("levelDimensions", levelDims_);
+    s.serialize("levels", levels_);
+}
+
+void VolumeMinMaxOctree::deserialize(XmlDeserializer& s) {
+    s.deserialize("brickSize", brickSize_);
+    s.deserialize("levelDimensions", levelDims_);
+    s.deserialize("levels", levels_);
+}
+
+} // namespace voreen
@@ -0,0 +1,165 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/volume/volumepyramid.h"
+
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/diskrepresentation.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorhalfsample.h"
+#include "voreen/core/io/vvdformat.h"
+#include "voreen/core/io/serialization/serialization.h"
+
+#include "tgt/filesystem.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace voreen {
+
+const std::string VolumePyramid::loggerCat_("voreen.VolumePyramid");
+
+VolumePyramid::VolumePyramid()
+    : VolumeDerivedData()
+{}
+
+VolumePyramid::VolumePyramid(const VolumeHandleBase* handle, size_t maxLevels)
+    : VolumeDerivedData()
+{
+    tgtAssert(handle, "no volume handle");
+
+    const VolumeHandleBase* current = handle;
+    while (tgt::min(current->getDimensions()) >= 2 && (maxLevels == 0 || levels_.size() < maxLevels)) {
+        VolumeHandle* level = VolumeOperatorHalfsample::APPLY_OP(current);
+        if (!level)
+            break;
+        levels_.push_back(level);
+        current = level;
+    }
+}
+
+VolumePyramid::~VolumePyramid() {
+    clear();
+}
+
+void VolumePyramid::clear() {
+    for (size_t i = 0; i < levels_.size(); i++)
+        delete levels_[i];
+    levels_.clear();
+}
+
+VolumeDerivedData* VolumePyramid::createFrom(const VolumeHandleBase* handle) const {
+    tgtAssert(handle, "no volume handle");
+    try {
+        return new VolumePyramid(handle);
+    }
+    catch (VolumeOperatorUnsupportedTypeException&) {
+        LWARNING("Volume type not supported by halfsampling");
+        return 0;
+    }
+}
+
+size_t VolumePyramid::getNumLevels() const {
+    return levels_.size();
+}
+
+const VolumeHandle* VolumePyramid::getLevel(size_t level) const {
+    tgtAssert(level < levels_.size(), "invalid level");
+    return levels_[level];
+}
+
+const VolumeHandle* VolumePyramid::getCoarsestLevel() const {
+    return (levels_.empty() ? 0 : levels_.back());
+}
+
+void VolumePyramid::serialize(XmlSerializer& s) const {
+    std::vector<VvdRawDataObject> rawData;
+    std::vector<tgt::vec3> spacings;
+    std::vector<tgt::vec3> offsets;
+
+    // level data can only be stored next to a document
+    std::string documentPath = s.getDocumentPath();
+    if (!documentPath.empty()) {
+        std::string directory = tgt::FileSystem::dirName(documentPath);
+        std::string baseName = tgt::FileSystem::baseName(documentPath);
+        for (size_t i = 0; i < levels_.size(); i++) {
+            const Volume* volume = levels_[i]->getRepresentation<Volume>();
+            if (!volume) {
+                LERROR("Level " << i << " not available");
+                rawData.clear();
+                break;
+            }
+
+            std::ostringstream rawName;
+            rawName << baseName << ".level" << (i+1) << ".raw";
+            std::string rawPath = directory.empty() ? rawName.str() : directory + "/" + rawName.str();
+            std::fstream rawout(rawPath.c_str(), std::ios::out | std::ios::binary);
+            rawout.write(static_cast<const char*>(volume->getData()), volume->getNumBytes());
+            if (!rawout.is_open() || rawout.bad()) {
+                LERROR("Failed to write pyramid level to " << rawPath);
+                rawData.clear();
+                break;
+            }
+            rawout.close();
+
+            rawData.push_back(VvdRawDataObject(volume, rawName.str()));
+            spacings.push_back(levels_[i]->getSpacing());
+            offsets.push_back(levels_[i]->getOffset());
+        }
+    }
+    if (rawData.size() != levels_.size()) {
+        spacings.clear();
+        offsets.clear();
+    }
+
+    s.serialize("Levels", rawData, "Level");
+    s.serialize("Spacings", spacings, "spacing");
+    s.serialize("Offsets", offsets, "offset");
+}
+
+void VolumePyramid::deserialize(XmlDeserializer& s) {
+    clear();
+
+    std::vector<VvdRawDataObject> rawData;
+    std::vector<tgt::vec3> spacings;
+    std::vector<tgt::vec3> offsets;
+    s.deserialize("Levels", rawData, "Level");
+    s.deserialize("Spacings", spacings, "spacing");
+    s.deserialize("Offsets", offsets, "offset");
+    if (spacings.size() != rawData.size() || offsets.size() != rawData.size())
+        throw XmlSerializationFormatException("Inconsistent number of pyramid levels");
+
+    // levels are loaded from their raw files on first access
+    std::string directory = tgt::FileSystem::dirName(s.getDocumentPath());
+    for (size_t i = 0; i < rawData.size(); i++) {
+        std::string rawPath = directory.empty() ? rawData[i].getFilename() : directory + "/" + rawData[i].getFilename();
+        DiskRepresentation* disk = new DiskRepresentation(rawPath, rawData[i].getFormat(), rawData[i].getDimensions());
+        levels_.push_back(new VolumeHandle(disk, spacings[i], offsets[i]));
+    }
+}
+
+} // namespace voreen
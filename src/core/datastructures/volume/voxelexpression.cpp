@@ -0,0 +1,804 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/volume/voxelexpression.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/io/progressbar.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace voreen {
+
+const std::string VoxelExpression::loggerCat_("voreen.VoxelExpression");
+
+namespace {
+
+/// Number of voxels that are evaluated at once.
+const size_t BLOCK_SIZE = 1024;
+
+/**
+ * Reads and writes consecutive voxels of one channel of a volume as normalized float values.
+ */
+class VoxelRow {
+public:
+    virtual ~VoxelRow() {}
+    virtual void read(size_t index, size_t numVoxels, size_t channel, float* values) const = 0;
+    virtual void write(const float* values, size_t index, size_t numVoxels, size_t channel) = 0;
+    virtual void invalidate() = 0;
+};
+
+/// Type-specialized access, which works directly on the voxel array.
+template<typename T>
+class VoxelRowGeneric : public VoxelRow {
+public:
+    VoxelRowGeneric(VolumeAtomic<T>* volume)
+        : volume_(volume)
+    {}
+
+    virtual void read(size_t index, size_t numVoxels, size_t channel, float* values) const {
+        const T* voxels = volume_->voxel() + index;
+        for (size_t i = 0; i < numVoxels; i++)
+            values[i] = getTypeAsFloat(VolumeElement<T>::getChannel(voxels[i], channel));
+    }
+
+    virtual void write(const float* values, size_t index, size_t numVoxels, size_t channel) {
+        typedef typename VolumeElement<T>::BaseType Base;
+        T* voxels = volume_->voxel() + index;
+        for (size_t i = 0; i < numVoxels; i++)
+            VolumeElement<T>::setChannel(getFloatAsType<Base>(values[i]), voxels[i], channel);
+    }
+
+    virtual void invalidate() {
+        volume_->invalidate();
+    }
+
+private:
+    VolumeAtomic<T>* volume_;
+};
+
+/// Fallback for volume types without a specialization, using the virtual voxel access.
+class VoxelRowVirtual : public VoxelRow {
+public:
+    VoxelRowVirtual(Volume* volume)
+        : volume_(volume)
+    {}
+
+    virtual void read(size_t index, size_t numVoxels, size_t channel, float* values) const {
+        for (size_t i = 0; i < numVoxels; i++)
+            values[i] = volume_->getVoxelFloat(index + i, channel);
+    }
+
+    virtual void write(const float* values, size_t index, size_t numVoxels, size_t channel) {
+        for (size_t i = 0; i < numVoxels; i++)
+            volume_->setVoxelFloat(values[i], index + i, channel);
+    }
+
+    virtual void invalidate() {}
+
+private:
+    Volume* volume_;
+};
+
+#define VRN_CREATE_VOXEL_ROW(T) \
+    if (VolumeAtomic<T>* va = dynamic_cast<VolumeAtomic<T>*>(volume)) \
+        return new VoxelRowGeneric<T>(va);
+
+#define VRN_CREATE_VOXEL_ROW_CHANNELS(T) \
+    VRN_CREATE_VOXEL_ROW(T) \
+    VRN_CREATE_VOXEL_ROW(tgt::Vector2<T>) \
+    VRN_CREATE_VOXEL_ROW(tgt::Vector3<T>) \
+    VRN_CREATE_VOXEL_ROW(tgt::Vector4<T>)
+
+/**
+ * Creates the row access for the passed volume. Input volumes are only read,
+ * so the const_cast is safe.
+ */
+VoxelRow* createVoxelRow(const Volume* constVolume) {
+    Volume* volume = const_cast<Volume*>(constVolume);
+    VRN_CREATE_VOXEL_ROW_CHANNELS(uint8_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(int8_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(uint16_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(int16_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(uint32_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(int32_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(uint64_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(int64_t)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(float)
+    VRN_CREATE_VOXEL_ROW_CHANNELS(double)
+    return new VoxelRowVirtual(volume);
+}
+
+#undef VRN_CREATE_VOXEL_ROW_CHANNELS
+#undef VRN_CREATE_VOXEL_ROW
+
+inline bool withinRange(const tgt::vec3& pos, const tgt::vec3& llf, const tgt::vec3& urb) {
+    return tgt::hand(tgt::greaterThanEqual(pos, llf)) &&
+           tgt::hand(tgt::lessThanEqual(   pos, urb));
+}
+
+/// Per-thread buffers for evaluating blocks of voxels.
+struct EvaluationBuffers {
+    EvaluationBuffers(size_t numInputs, size_t blockSize, size_t scratchSize)
+        : inputValues(numInputs * blockSize)
+        , inputs(numInputs)
+        , result(blockSize)
+        , scratch(std::max<size_t>(scratchSize, 1))
+    {
+        for (size_t i = 0; i < numInputs; i++)
+            inputs[i] = &inputValues[i * blockSize];
+    }
+    /// Returns the value arrays of the inputs, or null if there are no inputs.
+    const float* const* getInputs() const {
+        return (inputs.empty() ? 0 : &inputs[0]);
+    }
+    std::vector<float> inputValues;
+    std::vector<float*> inputs;
+    std::vector<float> result;
+    std::vector<float> scratch;
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Recursive descent parser, which emits the instructions of the parsed expression
+ * in postfix order.
+ */
+class VoxelExpression::Parser {
+public:
+    Parser(const std::string& source, VoxelExpression& target)
+        : source_(source)
+        , pos_(0)
+        , target_(target)
+    {}
+
+    void parse() throw (VoreenException) {
+        parseConditional();
+        skipWhitespace();
+        if (pos_ < source_.size())
+            error("unexpected '" + source_.substr(pos_, 1) + "'");
+    }
+
+private:
+    void error(const std::string& message) const throw (VoreenException) {
+        std::ostringstream stream;
+        stream << "Invalid voxel expression '" << source_ << "': " << message << " at position " << pos_;
+        throw VoreenException(stream.str());
+    }
+
+    void skipWhitespace() {
+        while (pos_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[pos_])))
+            pos_++;
+    }
+
+    /// Consumes the passed token, if it is next in the input.
+    bool accept(const char* token) {
+        skipWhitespace();
+        size_t length = std::strlen(token);
+        if (source_.compare(pos_, length, token) != 0)
+            return false;
+        pos_ += length;
+        return true;
+    }
+
+    void expect(const char* token) {
+        if (!accept(token))
+            error("expected '" + std::string(token) + "'");
+    }
+
+    size_t parseConditional() {
+        size_t condition = parseOr();
+        if (!accept("?"))
+            return condition;
+        size_t first = parseConditional();
+        expect(":");
+        size_t second = parseConditional();
+        return target_.emit(OP_SELECT, condition, first, second);
+    }
+
+    size_t parseOr() {
+        size_t result = parseAnd();
+        while (accept("||"))
+            result = target_.emit(OP_OR, result, parseAnd());
+        return result;
+    }
+
+    size_t parseAnd() {
+        size_t result = parseComparison();
+        while (accept("&&"))
+            result = target_.emit(OP_AND, result, parseComparison());
+        return result;
+    }
+
+    size_t parseComparison() {
+        size_t result = parseSum();
+        for (;;) {
+            // two-character operators have to be checked first
+            OpCode op;
+            if (accept("<="))
+                op = OP_LESS_EQUAL;
+            else if (accept(">="))
+                op = OP_GREATER_EQUAL;
+            else if (accept("=="))
+                op = OP_EQUAL;
+            else if (accept("!="))
+                op = OP_NOT_EQUAL;
+            else if (accept("<"))
+                op = OP_LESS;
+            else if (accept(">"))
+                op = OP_GREATER;
+            else
+                return result;
+            result = target_.emit(op, result, parseSum());
+        }
+    }
+
+    size_t parseSum() {
+        size_t result = parseProduct();
+        for (;;) {
+            if (accept("+"))
+                result = target_.emit(OP_ADD, result, parseProduct());
+            else if (accept("-"))
+                result = target_.emit(OP_SUB, result, parseProduct());
+            else
+                return result;
+        }
+    }
+
+    size_t parseProduct() {
+        size_t result = parseUnary();
+        for (;;) {
+            if (accept("*"))
+                result = target_.emit(OP_MUL, result, parseUnary());
+            else if (accept("/"))
+                result = target_.emit(OP_DIV, result, parseUnary());
+            else
+                return result;
+        }
+    }
+
+    size_t parseUnary() {
+        if (accept("-"))
+            return target_.emit(OP_NEG, parseUnary());
+        if (accept("+"))
+            return parseUnary();
+        // do not mistake != for a negation
+        skipWhitespace();
+        if (source_.compare(pos_, 1, "!") == 0 && source_.compare(pos_, 2, "!=") != 0) {
+            pos_++;
+            return target_.emit(OP_NOT, parseUnary());
+        }
+        return parsePower();
+    }
+
+    size_t parsePower() {
+        size_t base = parsePrimary();
+        if (accept("^"))
+            return target_.emit(OP_POW, base, parseUnary());
+        return base;
+    }
+
+    size_t parsePrimary() {
+        skipWhitespace();
+        if (pos_ >= source_.size())
+            error("unexpected end of expression");
+
+        if (accept("(")) {
+            size_t result = parseConditional();
+            expect(")");
+            return result;
+        }
+
+        char c = source_[pos_];
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* begin = source_.c_str() + pos_;
+            char* end = 0;
+            double value = std::strtod(begin, &end);
+            if (end == begin)
+                error("invalid number");
+            pos_ += end - begin;
+            return target_.emit(OP_CONSTANT, 0, 0, 0, static_cast<float>(value));
+        }
+
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = pos_;
+            while (pos_ < source_.size() && (std::isalnum(static_cast<unsigned char>(source_[pos_])) || source_[pos_] == '_'))
+                pos_++;
+            std::string name = source_.substr(start, pos_ - start);
+
+            if (accept("("))
+                return parseFunction(name);
+
+            if (name.size() == 1 && name[0] >= 'A' && name[0] < static_cast<char>('A' + MAX_INPUTS))
+                return target_.emit(OP_INPUT, static_cast<size_t>(name[0] - 'A'));
+
+            std::vector<std::string>& names = target_.parameterNames_;
+            size_t index = std::find(names.begin(), names.end(), name) - names.begin();
+            if (index == names.size()) {
+                names.push_back(name);
+                target_.parameterValues_.push_back(0.f);
+            }
+            return target_.emit(OP_PARAMETER, index);
+        }
+
+        error("expected operand");
+        return 0;
+    }
+
+    /// Parses the arguments of a function call, after the opening parenthesis.
+    size_t parseFunction(const std::string& name) {
+        OpCode op;
+        if (name == "min")
+            op = OP_MIN;
+        else if (name == "max")
+            op = OP_MAX;
+        else if (name == "pow")
+            op = OP_POW;
+        else if (name == "clamp")
+            op = OP_CLAMP;
+        else if (name == "mix")
+            op = OP_MIX;
+        else if (name == "abs")
+            op = OP_ABS;
+        else if (name == "sqrt")
+            op = OP_SQRT;
+        else if (name == "exp")
+            op = OP_EXP;
+        else if (name == "log")
+            op = OP_LOG;
+        else if (name == "floor")
+            op = OP_FLOOR;
+        else if (name == "ceil")
+            op = OP_CEIL;
+        else {
+            error("unknown function '" + name + "'");
+            return 0;
+        }
+
+        size_t args[3] = { 0, 0, 0 };
+        size_t numArgs = getNumOperands(op);
+        for (size_t i = 0; i < numArgs; i++) {
+            if (i > 0)
+                expect(",");
+            args[i] = parseConditional();
+        }
+        expect(")");
+        return target_.emit(op, args[0], args[1], args[2]);
+    }
+
+    const std::string& source_;
+    size_t pos_;
+    VoxelExpression& target_;
+};
+
+//-----------------------------------------------------------------------------
+
+VoxelExpression::VoxelExpression() {
+    compile("0");
+}
+
+VoxelExpression::VoxelExpression(const std::string& expression) throw (VoreenException) {
+    compile(expression);
+}
+
+void VoxelExpression::compile(const std::string& expression) throw (VoreenException) {
+    VoxelExpression compiled(*this);
+    compiled.program_.clear();
+    compiled.parameterNames_.clear();
+    compiled.parameterValues_.clear();
+    Parser(expression, compiled).parse();
+
+    // retain values of parameters that are still referenced
+    for (size_t i = 0; i < compiled.parameterNames_.size(); i++) {
+        std::vector<std::string>::const_iterator it =
+            std::find(parameterNames_.begin(), parameterNames_.end(), compiled.parameterNames_[i]);
+        if (it != parameterNames_.end())
+            compiled.parameterValues_[i] = parameterValues_[it - parameterNames_.begin()];
+    }
+
+    expression_ = expression;
+    program_.swap(compiled.program_);
+    parameterNames_.swap(compiled.parameterNames_);
+    parameterValues_.swap(compiled.parameterValues_);
+}
+
+const std::string& VoxelExpression::getExpression() const {
+    return expression_;
+}
+
+bool VoxelExpression::usesInput(size_t index) const {
+    for (size_t i = 0; i < program_.size(); i++) {
+        if (program_[i].op_ == OP_INPUT && program_[i].operands_[0] == index)
+            return true;
+    }
+    return false;
+}
+
+size_t VoxelExpression::getNumInputs() const {
+    size_t numInputs = 0;
+    for (size_t i = 0; i < program_.size(); i++) {
+        if (program_[i].op_ == OP_INPUT)
+            numInputs = std::max(numInputs, program_[i].operands_[0] + 1);
+    }
+    return numInputs;
+}
+
+std::vector<std::string> VoxelExpression::getParameterNames() const {
+    return parameterNames_;
+}
+
+void VoxelExpression::setParameter(const std::string& name, float value) {
+    std::vector<std::string>::const_iterator it = std::find(parameterNames_.begin(), parameterNames_.end(), name);
+    if (it != parameterNames_.end())
+        parameterValues_[it - parameterNames_.begin()] = value;
+}
+
+size_t VoxelExpression::getNumOperands(OpCode op) {
+    switch (op) {
+        case OP_INPUT:
+        case OP_PARAMETER:
+        case OP_CONSTANT:
+            return 0;
+        case OP_NEG:
+        case OP_NOT:
+        case OP_ABS:
+        case OP_SQRT:
+        case OP_EXP:
+        case OP_LOG:
+        case OP_FLOOR:
+        case OP_CEIL:
+            return 1;
+        case OP_SELECT:
+        case OP_CLAMP:
+        case OP_MIX:
+            return 3;
+        default:
+            return 2;
+    }
+}
+
+size_t VoxelExpression::emit(OpCode op, size_t a, size_t b, size_t c, float value) {
+    Instruction instr;
+    instr.op_ = op;
+    instr.operands_[0] = a;
+    instr.operands_[1] = b;
+    instr.operands_[2] = c;
+    instr.value_ = value;
+
+    size_t numOperands = getNumOperands(op);
+    bool constant = (numOperands > 0);
+    for (size_t i = 0; i < numOperands; i++)
+        constant &= (program_[instr.operands_[i]].op_ == OP_CONSTANT);
+
+    if (constant) {
+        // instructions are emitted in postfix order, so the constant operands
+        // are the last instructions of the program
+        float args[3] = { 0.f, 0.f, 0.f };
+        for (size_t i = 0; i < numOperands; i++)
+            args[i] = program_[instr.operands_[i]].value_;
+        float result;
+        execute(instr, &args[0], &args[1], &args[2], 0, &result, 1);
+        program_.resize(program_.size() - numOperands);
+
+        instr.op_ = OP_CONSTANT;
+        instr.value_ = result;
+    }
+
+    program_.push_back(instr);
+    return program_.size() - 1;
+}
+
+void VoxelExpression::execute(const Instruction& instr, const float* a, const float* b, const float* c,
+                              const float* parameters, float* out, size_t n)
+{
+    // one loop per operation, so that the compiler can vectorize each of them
+    switch (instr.op_) {
+        case OP_PARAMETER:
+            std::fill(out, out + n, parameters[instr.operands_[0]]);
+            break;
+        case OP_CONSTANT:
+            std::fill(out, out + n, instr.value_);
+            break;
+        case OP_NEG:
+            for (size_t i = 0; i < n; i++)
+                out[i] = -a[i];
+            break;
+        case OP_NOT:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] == 0.f ? 1.f : 0.f);
+            break;
+        case OP_ABS:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::fabs(a[i]);
+            break;
+        case OP_SQRT:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::sqrt(a[i]);
+            break;
+        case OP_EXP:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::exp(a[i]);
+            break;
+        case OP_LOG:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::log(a[i]);
+            break;
+        case OP_FLOOR:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::floor(a[i]);
+            break;
+        case OP_CEIL:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::ceil(a[i]);
+            break;
+        case OP_ADD:
+            for (size_t i = 0; i < n; i++)
+                out[i] = a[i] + b[i];
+            break;
+        case OP_SUB:
+            for (size_t i = 0; i < n; i++)
+                out[i] = a[i] - b[i];
+            break;
+        case OP_MUL:
+            for (size_t i = 0; i < n; i++)
+                out[i] = a[i] * b[i];
+            break;
+        case OP_DIV:
+            for (size_t i = 0; i < n; i++)
+                out[i] = a[i] / b[i];
+            break;
+        case OP_POW:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::pow(a[i], b[i]);
+            break;
+        case OP_MIN:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::min(a[i], b[i]);
+            break;
+        case OP_MAX:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::max(a[i], b[i]);
+            break;
+        case OP_LESS:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] < b[i] ? 1.f : 0.f);
+            break;
+        case OP_LESS_EQUAL:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] <= b[i] ? 1.f : 0.f);
+            break;
+        case OP_GREATER:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] > b[i] ? 1.f : 0.f);
+            break;
+        case OP_GREATER_EQUAL:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] >= b[i] ? 1.f : 0.f);
+            break;
+        case OP_EQUAL:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] == b[i] ? 1.f : 0.f);
+            break;
+        case OP_NOT_EQUAL:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] != b[i] ? 1.f : 0.f);
+            break;
+        case OP_AND:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] != 0.f && b[i] != 0.f ? 1.f : 0.f);
+            break;
+        case OP_OR:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] != 0.f || b[i] != 0.f ? 1.f : 0.f);
+            break;
+        case OP_SELECT:
+            for (size_t i = 0; i < n; i++)
+                out[i] = (a[i] != 0.f ? b[i] : c[i]);
+            break;
+        case OP_CLAMP:
+            for (size_t i = 0; i < n; i++)
+                out[i] = std::min(std::max(a[i], b[i]), c[i]);
+            break;
+        case OP_MIX:
+            for (size_t i = 0; i < n; i++)
+                out[i] = a[i] + (b[i] - a[i])*c[i];
+            break;
+        default:
+            tgtAssert(false, "unexpected operation");
+    }
+}
+
+size_t VoxelExpression::getScratchSize(size_t numVoxels) const {
+    return program_.size() * numVoxels;
+}
+
+void VoxelExpression::evaluate(const float* const* inputs, float* result, size_t n, float* scratch) const {
+    tgtAssert(!program_.empty(), "no program");
+    const float* parameters = (parameterValues_.empty() ? 0 : &parameterValues_[0]);
+    const size_t last = program_.size() - 1;
+
+    // register i is stored at scratch + i*n, inputs are referenced without copying
+    for (size_t i = 0; i < program_.size(); i++) {
+        const Instruction& instr = program_[i];
+        if (instr.op_ == OP_INPUT) {
+            if (i == last)
+                std::copy(inputs[instr.operands_[0]], inputs[instr.operands_[0]] + n, result);
+            continue;
+        }
+
+        const float* operands[3] = { 0, 0, 0 };
+        for (size_t j = 0; j < getNumOperands(instr.op_); j++) {
+            const Instruction& operand = program_[instr.operands_[j]];
+            if (operand.op_ == OP_INPUT)
+                operands[j] = inputs[operand.operands_[0]];
+            else
+                operands[j] = scratch + instr.operands_[j]*n;
+        }
+        float* out = (i == last ? result : scratch + i*n);
+        execute(instr, operands[0], operands[1], operands[2], parameters, out, n);
+    }
+}
+
+void VoxelExpression::apply(const std::vector<const Volume*>& inputs, Volume* output, ProgressBar* progressBar) const {
+    tgtAssert(output, "no output volume");
+    tgtAssert(inputs.size() >= getNumInputs(), "missing input volumes");
+
+    const size_t numInputs = getNumInputs();
+    const size_t numChannels = output->getNumChannels();
+    std::vector<VoxelRow*> inputRows(numInputs, static_cast<VoxelRow*>(0));
+    for (size_t i = 0; i < numInputs; i++) {
+        if (usesInput(i)) {
+            tgtAssert(inputs[i], "missing input volume");
+            tgtAssert(inputs[i]->getDimensions() == output->getDimensions(), "dimensions mismatch");
+            inputRows[i] = createVoxelRow(inputs[i]);
+        }
+    }
+    VoxelRow* outputRow = createVoxelRow(output);
+
+    const tgt::svec3 dims = output->getDimensions();
+    const size_t sliceSize = dims.x * dims.y;
+    const int dimZ = static_cast<int>(dims.z);
+    const size_t scratchSize = getScratchSize(BLOCK_SIZE);
+
+    // process blocks of slices in parallel, updating the progress after each block
+    const int blockSize = 16;
+    for (int blockStart = 0; blockStart < dimZ; blockStart += blockSize) {
+        int blockEnd = std::min(blockStart + blockSize, dimZ);
+        #pragma omp parallel
+        {
+            EvaluationBuffers buffers(numInputs, BLOCK_SIZE, scratchSize);
+
+            #pragma omp for
+            for (int z = blockStart; z < blockEnd; z++) {
+                for (size_t channel = 0; channel < numChannels; channel++) {
+                    for (size_t start = 0; start < sliceSize; start += BLOCK_SIZE) {
+                        size_t index = z*sliceSize + start;
+                        size_t n = std::min(BLOCK_SIZE, sliceSize - start);
+                        for (size_t i = 0; i < numInputs; i++) {
+                            if (!inputRows[i])
+                                continue;
+                            size_t inputChannel = (static_cast<size_t>(inputs[i]->getNumChannels()) == numChannels ? channel : 0);
+                            inputRows[i]->read(index, n, inputChannel, buffers.inputs[i]);
+                        }
+                        evaluate(buffers.getInputs(), &buffers.result[0], n, &buffers.scratch[0]);
+                        outputRow->write(&buffers.result[0], index, n, channel);
+                    }
+                }
+            }
+        }
+        if (progressBar)
+            progressBar->setProgress(static_cast<float>(blockEnd) / static_cast<float>(dimZ));
+    }
+    outputRow->invalidate();
+
+    for (size_t i = 0; i < numInputs; i++)
+        delete inputRows[i];
+    delete outputRow;
+}
+
+void VoxelExpression::apply(const std::vector<const Volume*>& inputs, const std::vector<tgt::mat4>& outputToInput,
+                            Volume* output, Filtering filtering, ProgressBar* progressBar) const
+{
+    tgtAssert(output, "no output volume");
+    tgtAssert(inputs.size() >= getNumInputs() && outputToInput.size() >= getNumInputs(), "missing input volumes");
+
+    const size_t numInputs = getNumInputs();
+    const size_t numChannels = output->getNumChannels();
+    std::vector<tgt::vec3> inputURB(numInputs);
+    for (size_t i = 0; i < numInputs; i++) {
+        if (usesInput(i)) {
+            tgtAssert(inputs[i], "missing input volume");
+            inputURB[i] = tgt::vec3(inputs[i]->getDimensions() - tgt::svec3(1));
+        }
+    }
+    VoxelRow* outputRow = createVoxelRow(output);
+
+    const tgt::svec3 dims = output->getDimensions();
+    const int dimZ = static_cast<int>(dims.z);
+    const size_t scratchSize = getScratchSize(dims.x);
+
+    const int blockSize = 16;
+    for (int blockStart = 0; blockStart < dimZ; blockStart += blockSize) {
+        int blockEnd = std::min(blockStart + blockSize, dimZ);
+        #pragma omp parallel
+        {
+            EvaluationBuffers buffers(numInputs, dims.x, scratchSize);
+
+            #pragma omp for
+            for (int z = blockStart; z < blockEnd; z++) {
+                for (size_t y = 0; y < dims.y; y++) {
+                    size_t index = (z*dims.y + y)*dims.x;
+                    for (size_t channel = 0; channel < numChannels; channel++) {
+                        // sample the inputs along the output row
+                        for (size_t i = 0; i < numInputs; i++) {
+                            if (!usesInput(i))
+                                continue;
+                            const Volume* input = inputs[i];
+                            size_t inputChannel = (static_cast<size_t>(input->getNumChannels()) == numChannels ? channel : 0);
+                            float* values = buffers.inputs[i];
+                            for (size_t x = 0; x < dims.x; x++) {
+                                tgt::vec3 pos = outputToInput[i]*tgt::vec3(tgt::svec3(x, y, z));
+                                if (!withinRange(pos, tgt::vec3::zero, inputURB[i]))
+                                    values[x] = 0.f;
+                                else if (filtering == FILTER_NEAREST)
+                                    values[x] = input->getVoxelFloat(tgt::iround(pos), inputChannel);
+                                else if (filtering == FILTER_LINEAR)
+                                    values[x] = input->getVoxelFloatLinear(pos, inputChannel);
+                                else
+                                    values[x] = input->getVoxelFloatCubic(pos, inputChannel);
+                            }
+                        }
+                        evaluate(buffers.getInputs(), &buffers.result[0], dims.x, &buffers.scratch[0]);
+                        outputRow->write(&buffers.result[0], index, dims.x, channel);
+                    }
+                }
+            }
+        }
+        if (progressBar)
+            progressBar->setProgress(static_cast<float>(blockEnd) / static_cast<float>(dimZ));
+    }
+    outputRow->invalidate();
+    delete outputRow;
+}
+
+bool VoxelExpression::onCommonGrid(const VolumeHandleBase* first, const VolumeHandleBase* second) {
+    tgtAssert(first && second, "null pointer passed");
+    return first->getDimensions() == second->getDimensions() &&
+           first->getSpacing() == second->getSpacing() &&
+           first->getOffset() == second->getOffset() &&
+           first->getPhysicalToWorldMatrix() == second->getPhysicalToWorldMatrix();
+}
+
+} // namespace voreen
@@ -0,0 +1,413 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/io/binarygeometryfile.h"
+
+#include "voreen/core/datastructures/geometry/geometry.h"
+#include "voreen/core/datastructures/geometry/geometryfactory.h"
+#include "voreen/core/datastructures/volume/mappedvolume.h"
+#include "voreen/core/utils/hashing.h"
+
+#include "tgt/logmanager.h"
+
+#ifdef VRN_MODULE_ZIP
+#include <zlib.h>
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <typeinfo>
+
+namespace voreen {
+
+namespace {
+
+const char SIGNATURE[8] = { 'V', 'R', 'N', 'G', 'E', 'O', 'B', '\0' };
+const uint32_t FORMAT_VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const size_t ALIGNMENT = 16;
+
+size_t alignOffset(size_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+template<typename T>
+void writeValue(std::ostream& stream, T value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::ostream& stream, const std::string& str) {
+    writeValue(stream, static_cast<uint32_t>(str.size()));
+    stream.write(str.c_str(), str.size());
+}
+
+template<typename T>
+T readValue(std::istream& stream) {
+    T value = T();
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+std::string readString(std::istream& stream) {
+    uint32_t length = readValue<uint32_t>(stream);
+    if (!stream.good() || length > (1 << 16))
+        return "";
+    std::string str(length, '\0');
+    if (length > 0)
+        stream.read(&str[0], length);
+    return str;
+}
+
+} // namespace
+
+const std::string BinaryGeometryFile::FILE_EXTENSION("vgb");
+const std::string BinaryGeometryFile::loggerCat_("voreen.BinaryGeometryFile");
+
+BinaryGeometryFile::BinaryGeometryFile()
+    : mapping_(0)
+{}
+
+BinaryGeometryFile::~BinaryGeometryFile() {
+    delete mapping_;
+}
+
+void BinaryGeometryFile::setGeometryType(const std::string& type) {
+    geometryType_ = type;
+}
+
+std::string BinaryGeometryFile::getGeometryType() const {
+    return geometryType_;
+}
+
+bool BinaryGeometryFile::hasArray(const std::string& name) const {
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        if (arrays_[i].name_ == name)
+            return true;
+    }
+    return false;
+}
+
+void BinaryGeometryFile::setArray(const std::string& name, ElementType type, size_t components, size_t elementSize,
+                                  const void* data, size_t count)
+{
+    tgtAssert(elementSize == components * (type == UINT8 ? 1 : 4), "unexpected element size");
+
+    Array array;
+    array.name_ = name;
+    array.type_ = type;
+    array.components_ = components;
+    array.count_ = count;
+    array.elementSize_ = elementSize;
+    array.offset_ = 0;
+    array.storedBytes_ = 0;
+    array.compressed_ = false;
+    if (count > 0)
+        array.data_.assign(reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + count * elementSize);
+
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        if (arrays_[i].name_ == name) {
+            arrays_[i] = array;
+            return;
+        }
+    }
+    arrays_.push_back(array);
+}
+
+const BinaryGeometryFile::Array& BinaryGeometryFile::getArray(const std::string& name, ElementType type,
+                                                              size_t components) const
+    throw (SerializationException)
+{
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        if (arrays_[i].name_ != name)
+            continue;
+        if (arrays_[i].type_ != type || arrays_[i].components_ != components)
+            throw SerializationException("Element type of geometry array '" + name + "' does not match");
+        return arrays_[i];
+    }
+    throw SerializationException("Geometry array '" + name + "' not found");
+}
+
+void BinaryGeometryFile::copyArray(const Array& array, void* dest) const throw (SerializationException) {
+    size_t numBytes = array.getNumBytes();
+    if (!array.data_.empty() || numBytes == 0) {
+        if (numBytes > 0)
+            memcpy(dest, &array.data_[0], numBytes);
+        return;
+    }
+
+    const char* fileData = mapping_ ? reinterpret_cast<const char*>(mapping_->getData())
+                                    : (fileData_.empty() ? 0 : &fileData_[0]);
+    tgtAssert(fileData, "no file data");
+
+    if (!array.compressed_) {
+        memcpy(dest, fileData + array.offset_, numBytes);
+        return;
+    }
+
+#ifdef VRN_MODULE_ZIP
+    uLongf destSize = static_cast<uLongf>(numBytes);
+    if (uncompress(reinterpret_cast<Bytef*>(dest), &destSize,
+                   reinterpret_cast<const Bytef*>(fileData + array.offset_),
+                   static_cast<uLong>(array.storedBytes_)) != Z_OK || destSize != numBytes)
+    {
+        throw SerializationException("Failed to decompress geometry array '" + array.name_ + "' of " + filename_);
+    }
+#else
+    throw SerializationException("Geometry array '" + array.name_ + "' is compressed, but Voreen "
+                                 "was compiled without zlib support (zip module)");
+#endif
+}
+
+std::string BinaryGeometryFile::getHash() const {
+    // hash the array hashes together with the array descriptions
+    std::ostringstream hashes;
+    hashes << geometryType_;
+    std::vector<char> buffer;
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        const Array& array = arrays_[i];
+        const void* data = 0;
+        if (!array.data_.empty()) {
+            data = &array.data_[0];
+        }
+        else if (array.count_ > 0) {
+            buffer.resize(array.getNumBytes());
+            copyArray(array, &buffer[0]);
+            data = &buffer[0];
+        }
+        hashes << array.name_ << array.type_ << array.components_ << array.count_
+               << VoreenHash::getChunkedHash(data, array.getNumBytes());
+    }
+    return VoreenHash::getHash(hashes.str());
+}
+
+void BinaryGeometryFile::write(const std::string& filename, bool compress) const throw (tgt::FileException) {
+#ifndef VRN_MODULE_ZIP
+    if (compress)
+        LWARNING("Voreen was compiled without zlib support (zip module), writing uncompressed geometry arrays");
+    compress = false;
+#endif
+
+    // gather the stored data of all arrays
+    std::vector<std::vector<char> > compressedData(arrays_.size());
+    std::vector<const char*> storedData(arrays_.size(), 0);
+    std::vector<size_t> storedBytes(arrays_.size(), 0);
+    std::vector<char> buffer;
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        const Array& array = arrays_[i];
+        size_t numBytes = array.getNumBytes();
+        const char* data = 0;
+        if (!array.data_.empty()) {
+            data = &array.data_[0];
+        }
+        else if (numBytes > 0) {
+            // array of a read file
+            buffer.resize(numBytes);
+            try {
+                copyArray(array, &buffer[0]);
+            }
+            catch (SerializationException& e) {
+                throw tgt::CorruptedFileException(e.what(), filename_);
+            }
+            compressedData[i] = buffer;
+            data = &compressedData[i][0];
+        }
+        storedData[i] = data;
+        storedBytes[i] = numBytes;
+
+#ifdef VRN_MODULE_ZIP
+        if (compress && numBytes > 0) {
+            uLongf compressedSize = compressBound(static_cast<uLong>(numBytes));
+            std::vector<char> compressedArray(compressedSize);
+            if (compress2(reinterpret_cast<Bytef*>(&compressedArray[0]), &compressedSize,
+                          reinterpret_cast<const Bytef*>(data), static_cast<uLong>(numBytes), Z_DEFAULT_COMPRESSION) != Z_OK)
+            {
+                throw tgt::IOException("Failed to compress geometry array '" + array.name_ + "'", filename);
+            }
+            compressedArray.resize(compressedSize);
+            compressedData[i].swap(compressedArray);
+            storedData[i] = &compressedData[i][0];
+            storedBytes[i] = compressedSize;
+        }
+#endif
+    }
+
+    std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+    if (stream.fail())
+        throw tgt::IOException("Unable to open geometry file for writing", filename);
+
+    // header
+    stream.write(SIGNATURE, sizeof(SIGNATURE));
+    writeValue(stream, FORMAT_VERSION);
+    writeValue(stream, BYTE_ORDER_MARK);
+    writeString(stream, geometryType_);
+    writeValue(stream, static_cast<uint32_t>(compress ? 1 : 0));
+    writeValue(stream, static_cast<uint32_t>(arrays_.size()));
+
+    // array table, offsets are relative to the data section
+    size_t offset = 0;
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        const Array& array = arrays_[i];
+        writeString(stream, array.name_);
+        writeValue(stream, static_cast<uint32_t>(array.type_));
+        writeValue(stream, static_cast<uint32_t>(array.components_));
+        writeValue(stream, static_cast<uint64_t>(array.count_));
+        writeValue(stream, static_cast<uint64_t>(offset));
+        writeValue(stream, static_cast<uint64_t>(storedBytes[i]));
+        offset = alignOffset(offset + storedBytes[i]);
+    }
+    writeValue(stream, static_cast<uint64_t>(offset));
+
+    // the data section starts at an aligned position
+    size_t headerSize = static_cast<size_t>(stream.tellp());
+    std::vector<char> padding(ALIGNMENT, 0);
+    stream.write(&padding[0], alignOffset(headerSize) - headerSize);
+
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        if (storedBytes[i] > 0)
+            stream.write(storedData[i], storedBytes[i]);
+        stream.write(&padding[0], alignOffset(storedBytes[i]) - storedBytes[i]);
+    }
+
+    if (stream.fail())
+        throw tgt::IOException("Failed to write geometry file", filename);
+}
+
+void BinaryGeometryFile::read(const std::string& filename) throw (tgt::FileException) {
+    arrays_.clear();
+    geometryType_.clear();
+    delete mapping_;
+    mapping_ = 0;
+    fileData_.clear();
+    filename_ = filename;
+
+    std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+    if (stream.fail())
+        throw tgt::IOException("Unable to open geometry file for reading", filename);
+
+    char signature[sizeof(SIGNATURE)];
+    stream.read(signature, sizeof(signature));
+    if (!stream.good() || memcmp(signature, SIGNATURE, sizeof(SIGNATURE)) != 0)
+        throw tgt::CorruptedFileException("Not a binary geometry file", filename);
+    uint32_t version = readValue<uint32_t>(stream);
+    if (version > FORMAT_VERSION)
+        throw tgt::FileException("Unsupported binary geometry file version", filename);
+    if (readValue<uint32_t>(stream) != BYTE_ORDER_MARK)
+        throw tgt::FileException("Byte order of binary geometry file does not match", filename);
+
+    geometryType_ = readString(stream);
+    bool compressed = (readValue<uint32_t>(stream) != 0);
+    uint32_t numArrays = readValue<uint32_t>(stream);
+    if (!stream.good())
+        throw tgt::CorruptedFileException("Failed to read header of binary geometry file", filename);
+
+    for (uint32_t i = 0; i < numArrays; i++) {
+        Array array;
+        array.name_ = readString(stream);
+        array.type_ = static_cast<ElementType>(readValue<uint32_t>(stream));
+        array.components_ = readValue<uint32_t>(stream);
+        array.count_ = static_cast<size_t>(readValue<uint64_t>(stream));
+        array.offset_ = static_cast<size_t>(readValue<uint64_t>(stream));
+        array.storedBytes_ = static_cast<size_t>(readValue<uint64_t>(stream));
+        array.elementSize_ = array.components_ * (array.type_ == UINT8 ? 1 : 4);
+        array.compressed_ = compressed;
+        if (!stream.good() || array.type_ > FLOAT32 || (!compressed && array.storedBytes_ != array.getNumBytes()))
+            throw tgt::CorruptedFileException("Invalid array table in binary geometry file", filename);
+        arrays_.push_back(array);
+    }
+    size_t dataSize = static_cast<size_t>(readValue<uint64_t>(stream));
+    if (!stream.good())
+        throw tgt::CorruptedFileException("Failed to read array table of binary geometry file", filename);
+    for (size_t i = 0; i < arrays_.size(); i++) {
+        if (arrays_[i].offset_ + arrays_[i].storedBytes_ > dataSize)
+            throw tgt::CorruptedFileException("Invalid array table in binary geometry file", filename);
+    }
+
+    size_t dataOffset = alignOffset(static_cast<size_t>(stream.tellg()));
+    if (dataSize == 0)
+        return;
+
+    if (MappedFile::isSupported()) {
+        try {
+            mapping_ = new MappedFile(filename, static_cast<int64_t>(dataOffset), dataSize);
+            return;
+        }
+        catch (tgt::IOException& e) {
+            LWARNING("Failed to map geometry file, reading it instead: " << e.what());
+        }
+    }
+
+    fileData_.resize(dataSize);
+    stream.seekg(dataOffset);
+    stream.read(&fileData_[0], dataSize);
+    if (stream.fail())
+        throw tgt::CorruptedFileException("Failed to read data section of binary geometry file", filename);
+}
+
+bool BinaryGeometryFile::isBinaryGeometryFile(const std::string& filename) {
+    std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+    char signature[sizeof(SIGNATURE)];
+    stream.read(signature, sizeof(signature));
+    return (stream.good() && memcmp(signature, SIGNATURE, sizeof(SIGNATURE)) == 0);
+}
+
+void BinaryGeometryFile::writeGeometry(const Geometry* geometry, const std::string& filename, bool compress)
+    throw (tgt::FileException)
+{
+    tgtAssert(geometry, "null pointer passed");
+
+    BinaryGeometryFile file;
+    file.setGeometryType(GeometryFactory().getTypeString(typeid(*geometry)));
+    if (file.getGeometryType().empty() || !geometry->serializeBinary(file))
+        throw tgt::FileException("Geometry type does not support binary serialization", filename);
+    file.write(filename, compress);
+}
+
+Geometry* BinaryGeometryFile::readGeometry(const std::string& filename) throw (tgt::FileException) {
+    BinaryGeometryFile file;
+    file.read(filename);
+
+    Geometry* geometry = dynamic_cast<Geometry*>(GeometryFactory().createType(file.getGeometryType()));
+    if (!geometry)
+        throw tgt::FileException("Unknown geometry type '" + file.getGeometryType() + "'", filename);
+
+    try {
+        if (!geometry->deserializeBinary(file))
+            throw tgt::FileException("Geometry type '" + file.getGeometryType() + "' does not support binary serialization", filename);
+    }
+    catch (SerializationException& e) {
+        delete geometry;
+        throw tgt::CorruptedFileException(e.what(), filename);
+    }
+    catch (...) {
+        delete geometry;
+        throw;
+    }
+    return geometry;
+}
+
+} // namespace voreen
@@ -211,9 +211,17 @@ VolumeCollection* DatVolumeReader::readMetaFile(const std::string &fileName, siz
         else if (type == "Checksum:") {
             std::string checksumStr;
             args >> checksumStr;
-            LDEBUG(type << " " << checksumStr);
-            if(checksumStr.length() == 32)
+            // optional version of the hash algorithm (missing for legacy MD5 checksums)
+            int checksumVersion = 1;
+            if (!(args >> checksumVersion)) {
+                checksumVersion = 1;
+                args.clear();
+            }
+            LDEBUG(type << " " << checksumStr << " " << checksumVersion);
+            if(checksumStr.length() == 32) {
                 h.hash_ = checksumStr;
+                h.hashVersion_ = checksumVersion;
+            }
         }
         else if (type == "TimeStep:") {
             args >> h.timeStep_;
@@ -290,7 +298,7 @@ VolumeCollection* DatVolumeReader::readMetaFile(const std::string &fileName, siz
                 oldVolumePosition(vh);
 
                 if(!h.hash_.empty())
-                    vh->setHash(h.hash_);
+                    vh->setHash(h.hash_, h.hashVersion_);
 
                 toReturn->add(volumeCollection->first());
             }
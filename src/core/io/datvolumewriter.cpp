@@ -28,11 +28,15 @@
 
 #include "voreen/core/io/datvolumewriter.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/mappedvolume.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/volumehash.h"
 
 #include "tgt/filesystem.h"
 #include "tgt/matrix.h"
 
+#include <memory>
+
 namespace voreen {
 
 const std::string DatVolumeWriter::loggerCat_("voreen.io.DatVolumeWriter");
@@ -56,6 +60,11 @@ void DatVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
     std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
     LINFO("saving " << datname << " and " << rawname);
 
+    // a volume mapped from the raw file would lose its data when the file is truncated
+    std::auto_ptr<Volume> volumeCopy(MappedVolumeBase::copyIfMappedFrom(volume, rawname));
+    if (volumeCopy.get())
+        volume = volumeCopy.get();
+
     std::fstream datout(datname.c_str(), std::ios::out);
     std::fstream rawout(rawname.c_str(), std::ios::out | std::ios::binary);
 
@@ -281,7 +290,7 @@ std::string DatVolumeWriter::getDatFileString(const VolumeHandleBase* const volu
     datout << "Format:\t\t" << format << std::endl;
     datout << "ObjectModel:\t" << model << std::endl;
     datout << "Modality:\t" << volumeHandle->getModality() << std::endl;
-    datout << "Checksum:\t" << volumeHandle->getHash() << std::endl;
+    datout << "Checksum:\t" << volumeHandle->getHash() << " " << VolumeHash::CURRENT_VERSION << std::endl;
 
     // write transformation matrix unless it is the identity matrix
     tgt::mat4 transformation = volumeHandle->getPhysicalToWorldMatrix();
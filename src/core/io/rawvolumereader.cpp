@@ -59,6 +59,7 @@ RawVolumeReader::ReadHints::ReadHints(tgt::ivec3 dimensions, tgt::vec3 spacing,
       transformation_(tgt::mat4::identity),
       modality_(Modality::MODALITY_UNKNOWN),
       hash_(""),
+      hashVersion_(1),
       timeStep_(-1.f),
       spreadMin_(0.f),
       spreadMax_(0.f),
@@ -544,7 +545,7 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
     }
 
     if(!h.hash_.empty())
-        volumeHandle->setHash(h.hash_);
+        volumeHandle->setHash(h.hash_, h.hashVersion_);
 
     volumeHandle->setOrigin(VolumeOrigin("raw", fileName, encodeReadHintsIntoSearchString(hints_)));
 
@@ -0,0 +1,269 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/io/serialization/xmlbinaryformat.h"
+#include "voreen/core/io/serialization/xmlserializationconstants.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <map>
+
+namespace voreen {
+
+namespace {
+
+const char SIGNATURE[8] = { 'V', 'R', 'N', 'B', 'X', 'M', 'L', '\0' };
+const unsigned char FORMAT_VERSION = 1;
+
+enum Tag {
+    TAG_ELEMENT = 1,    ///< element name, attribute count, attribute name/value pairs; followed by the children
+    TAG_END     = 2,    ///< end of the children of the current element
+    TAG_TEXT    = 3,    ///< text
+    TAG_CDATA   = 4,    ///< text to be written as CDATA section
+    TAG_COMMENT = 5     ///< comment
+};
+
+void writeVarint(std::ostream& stream, size_t value) {
+    while (value >= 0x80) {
+        stream.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    stream.put(static_cast<char>(value));
+}
+
+size_t readVarint(std::istream& stream) throw (SerializationException) {
+    size_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = stream.get();
+        if (byte == std::char_traits<char>::eof())
+            throw XmlSerializationFormatException("Unexpected end of binary XML document.");
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    throw XmlSerializationFormatException("Invalid integer in binary XML document.");
+}
+
+/**
+ * Reads the strings interned by the StringTable. The strings are kept in a deque,
+ * so references to previously read strings stay valid while further strings are read.
+ */
+class StringReader {
+public:
+    explicit StringReader(std::istream& stream)
+        : streamEnd_(-1)
+    {
+        // the size of the stream is used to reject corrupt string lengths before allocating
+        std::streampos position = stream.tellg();
+        if (position != std::streampos(-1)) {
+            stream.seekg(0, std::ios::end);
+            streamEnd_ = stream.tellg();
+            stream.clear();
+            stream.seekg(position);
+        }
+    }
+
+    const std::string& read(std::istream& stream) throw (SerializationException) {
+        size_t index = readVarint(stream);
+        if (index > 0) {
+            if (index > strings_.size())
+                throw XmlSerializationFormatException("Invalid string reference in binary XML document.");
+            return strings_[index - 1];
+        }
+
+        size_t length = readVarint(stream);
+        if (streamEnd_ != std::streampos(-1) && static_cast<std::streamoff>(length) > streamEnd_ - stream.tellg())
+            throw XmlSerializationFormatException("Invalid string length in binary XML document.");
+
+        // the string is read in chunks, so that a corrupt length in a stream of unknown size
+        // runs into the end of the stream instead of a huge allocation
+        strings_.push_back(std::string());
+        std::string& str = strings_.back();
+        char buffer[4096];
+        while (length > 0) {
+            size_t chunk = std::min(length, sizeof(buffer));
+            stream.read(buffer, chunk);
+            if (stream.fail())
+                throw XmlSerializationFormatException("Unexpected end of binary XML document.");
+            str.append(buffer, chunk);
+            length -= chunk;
+        }
+        return str;
+    }
+
+private:
+    std::deque<std::string> strings_;
+    std::streampos streamEnd_;    ///< end of the stream, -1 if unknown
+};
+
+} // namespace
+
+/// Interns the strings written to a binary document: index 0 introduces a new string.
+class XmlBinaryFormat::StringTable {
+public:
+    void write(std::ostream& stream, const std::string& str) {
+        std::map<std::string, size_t>::iterator it = indices_.find(str);
+        if (it != indices_.end()) {
+            writeVarint(stream, it->second);
+            return;
+        }
+
+        indices_.insert(std::make_pair(str, indices_.size() + 1));
+        writeVarint(stream, 0);
+        writeVarint(stream, str.size());
+        stream.write(str.c_str(), str.size());
+    }
+
+private:
+    std::map<std::string, size_t> indices_;
+};
+
+void XmlBinaryFormat::write(const TiXmlDocument& document, std::ostream& stream) {
+    stream.write(SIGNATURE, sizeof(SIGNATURE));
+    stream.put(static_cast<char>(FORMAT_VERSION));
+
+    StringTable strings;
+    for (const TiXmlNode* node = document.FirstChild(); node != 0; node = node->NextSibling())
+        writeNode(node, stream, strings);
+    stream.put(static_cast<char>(TAG_END));
+}
+
+void XmlBinaryFormat::writeNode(const TiXmlNode* node, std::ostream& stream, StringTable& strings) {
+    switch (node->Type()) {
+        case TiXmlNode::ELEMENT: {
+            const TiXmlElement* element = node->ToElement();
+            stream.put(static_cast<char>(TAG_ELEMENT));
+            strings.write(stream, element->ValueStr());
+
+            size_t numAttributes = 0;
+            for (const TiXmlAttribute* attribute = element->FirstAttribute(); attribute != 0; attribute = attribute->Next())
+                numAttributes++;
+            writeVarint(stream, numAttributes);
+            for (const TiXmlAttribute* attribute = element->FirstAttribute(); attribute != 0; attribute = attribute->Next()) {
+                strings.write(stream, attribute->NameTStr());
+                strings.write(stream, attribute->ValueStr());
+            }
+
+            for (const TiXmlNode* child = element->FirstChild(); child != 0; child = child->NextSibling())
+                writeNode(child, stream, strings);
+            stream.put(static_cast<char>(TAG_END));
+            break;
+        }
+        case TiXmlNode::TEXT:
+            stream.put(static_cast<char>(node->ToText()->CDATA() ? TAG_CDATA : TAG_TEXT));
+            strings.write(stream, node->ValueStr());
+            break;
+        case TiXmlNode::COMMENT:
+            stream.put(static_cast<char>(TAG_COMMENT));
+            strings.write(stream, node->ValueStr());
+            break;
+        default:
+            // declarations and unknown nodes are not needed for deserialization
+            break;
+    }
+}
+
+void XmlBinaryFormat::read(std::istream& stream, TiXmlDocument& document,
+                           std::set<std::string>* ids, std::set<std::string>* references)
+    throw (SerializationException)
+{
+    char signature[sizeof(SIGNATURE)];
+    stream.read(signature, sizeof(signature));
+    if (stream.fail() || memcmp(signature, SIGNATURE, sizeof(SIGNATURE)) != 0)
+        throw XmlSerializationFormatException("Not a binary XML document.");
+    int version = stream.get();
+    if (version == std::char_traits<char>::eof() || version > FORMAT_VERSION)
+        throw XmlSerializationFormatException("Unsupported binary XML document version.");
+
+    document.LinkEndChild(new TiXmlDeclaration(
+        XmlSerializationConstants::XMLVERSION,
+        XmlSerializationConstants::XMLENCODING,
+        XmlSerializationConstants::XMLSTANDALONE));
+
+    StringReader strings(stream);
+    TiXmlNode* parent = &document;
+    while (parent) {
+        int tag = stream.get();
+        switch (tag) {
+            case TAG_ELEMENT: {
+                TiXmlElement* element = new TiXmlElement(strings.read(stream));
+                parent->LinkEndChild(element);
+
+                size_t numAttributes = readVarint(stream);
+                for (size_t i = 0; i < numAttributes; i++) {
+                    const std::string& name = strings.read(stream);
+                    const std::string& value = strings.read(stream);
+                    element->SetAttribute(name, value);
+
+                    // collect reference ids while reading, so the document does not need to be traversed again
+                    if (ids && name == XmlSerializationConstants::IDATTRIBUTE)
+                        ids->insert(value);
+                    else if (references && name == XmlSerializationConstants::REFERENCEATTRIBUTE)
+                        references->insert(value);
+                }
+                parent = element;
+                break;
+            }
+            case TAG_END:
+                parent = (parent == &document ? 0 : parent->Parent());
+                break;
+            case TAG_TEXT:
+            case TAG_CDATA: {
+                TiXmlText* text = new TiXmlText(strings.read(stream));
+                text->SetCDATA(tag == TAG_CDATA);
+                parent->LinkEndChild(text);
+                break;
+            }
+            case TAG_COMMENT: {
+                TiXmlComment* comment = new TiXmlComment();
+                comment->SetValue(strings.read(stream));
+                parent->LinkEndChild(comment);
+                break;
+            }
+            default:
+                if (tag == std::char_traits<char>::eof())
+                    throw XmlSerializationFormatException("Unexpected end of binary XML document.");
+                else
+                    throw XmlSerializationFormatException("Invalid token in binary XML document.");
+        }
+    }
+}
+
+bool XmlBinaryFormat::isBinary(std::istream& stream) {
+    std::streampos position = stream.tellg();
+    char signature[sizeof(SIGNATURE)];
+    stream.read(signature, sizeof(signature));
+    bool binary = !stream.fail() && memcmp(signature, SIGNATURE, sizeof(SIGNATURE)) == 0;
+
+    stream.clear();
+    stream.seekg(position);
+    return binary;
+}
+
+} // namespace
@@ -27,6 +27,7 @@
  **********************************************************************/
 
 #include "voreen/core/io/serialization/xmldeserializer.h"
+#include "voreen/core/io/serialization/xmlbinaryformat.h"
 #include "voreen/core/voreenapplication.h"
 #include "voreen/core/voreenmodule.h"
 
@@ -283,12 +284,15 @@ void XmlDeserializer::deserialize(const std::string& key, Serializable& data)
 TiXmlElement* XmlDeserializer::getNextXmlElement(const std::string& key)
     throw (SerializationException)
 {
-    TiXmlElement* element = node_->FirstChildElement(key);
+    // Continue behind the last returned element, instead of scanning all visited siblings again...
+    TiXmlElement*& lastElement = lastVisitedElements_[std::make_pair(static_cast<TiXmlNode*>(node_), key)];
+    TiXmlElement* element = (lastElement ? lastElement->NextSiblingElement(key) : node_->FirstChildElement(key));
     while (element) {
         // Was node not visited before?
         if (visitedNodes_.find(element) == visitedNodes_.end())
         {
             visitedNodes_.insert(element);
+            lastElement = element;
             return element;
         }
 
@@ -299,6 +303,27 @@ TiXmlElement* XmlDeserializer::getNextXmlElement(const std::string& key)
     return 0;
 }
 
+void XmlDeserializer::markUnvisited(TiXmlNode* element) {
+    visitedNodes_.erase(element);
+
+    LastVisitedElementMapType::iterator it = lastVisitedElements_.find(std::make_pair(element->Parent(), element->ValueStr()));
+    if (it == lastVisitedElements_.end() || !it->second)
+        return;
+
+    // Nothing to do, if the element lies behind the last visited element (usually, it is the last visited element itself)...
+    TiXmlNode* node = element;
+    while (node && node != it->second)
+        node = node->NextSibling(element->ValueStr());
+    if (!node)
+        return;
+
+    // ...otherwise, continue at the element by moving back to its preceding sibling with the same key
+    TiXmlNode* previous = element->PreviousSibling(element->ValueStr());
+    while (previous && !previous->ToElement())
+        previous = previous->PreviousSibling(element->ValueStr());
+    it->second = (previous ? previous->ToElement() : 0);
+}
+
 void XmlDeserializer::findUnresolvableReferences(
     TiXmlElement* node,
     ReferenceIdSetType& references,
@@ -335,17 +360,32 @@ XmlDeserializer::ReferenceIdListType XmlDeserializer::findUnresolvableReferences
 void XmlDeserializer::read(std::istream& stream, XmlProcessor* xmlProcessor)
     throw (SerializationException)
 {
-    // Read input stream...
-    std::stringbuf buffer;
-    do
-    {
-        // Use 0 character instead of '\n' to minimize the number of get-calls...
-        stream.get(buffer, 0);
-    } while (stream.good() && !stream.eof()
-        && (buffer.sputc(stream.get()) != std::stringbuf::traits_type::eof()));
+    // Reference ids are gathered while decoding binary documents...
+    bool binary = XmlBinaryFormat::isBinary(stream);
+    ReferenceIdSetType references;
+    ReferenceIdSetType resolvableReferences;
+
+    if (binary) {
+        try {
+            XmlBinaryFormat::read(stream, document_, &resolvableReferences, &references);
+        }
+        catch (XmlSerializationFormatException& e) {
+            raise(e);
+        }
+    }
+    else {
+        // Read input stream...
+        std::stringbuf buffer;
+        do
+        {
+            // Use 0 character instead of '\n' to minimize the number of get-calls...
+            stream.get(buffer, 0);
+        } while (stream.good() && !stream.eof()
+            && (buffer.sputc(stream.get()) != std::stringbuf::traits_type::eof()));
 
-    // Parse input...
-    document_.Parse(buffer.str().c_str());
+        // Parse input...
+        document_.Parse(buffer.str().c_str());
+    }
 
     TiXmlElement* root = document_.RootElement();
 
@@ -375,7 +415,16 @@ void XmlDeserializer::read(std::istream& stream, XmlProcessor* xmlProcessor)
     if (xmlProcessor)
         xmlProcessor->process(document_);
 
-    std::vector<std::string> unresolvableReferences = findUnresolvableReferences();
+    std::vector<std::string> unresolvableReferences;
+    if (binary && !xmlProcessor) {
+        for (ReferenceIdSetType::const_iterator it = references.begin(); it != references.end(); ++it)
+            if (resolvableReferences.find(*it) == resolvableReferences.end())
+                unresolvableReferences.push_back(*it);
+    }
+    else {
+        // The preprocessor may have changed the document, so it has to be searched...
+        unresolvableReferences = findUnresolvableReferences();
+    }
     if (!unresolvableReferences.empty()) {
         std::stringstream idStream;
         for (ReferenceIdListType::iterator it = unresolvableReferences.begin(); it != unresolvableReferences.end(); ++it)
@@ -27,6 +27,7 @@
  **********************************************************************/
 
 #include "voreen/core/io/serialization/xmlserializer.h"
+#include "voreen/core/io/serialization/xmlbinaryformat.h"
 #include "voreen/core/voreenapplication.h"
 #include "voreen/core/voreenmodule.h"
 
@@ -76,6 +77,14 @@ std::string XmlSerializer::getDocumentPath() const {
     return documentPath_;
 }
 
+void XmlSerializer::addReferencedFile(const std::string& filename) {
+    referencedFiles_.insert(filename);
+}
+
+const std::set<std::string>& XmlSerializer::getReferencedFiles() const {
+    return referencedFiles_;
+}
+
 void XmlSerializer::checkAttributeKey(const std::string& key)
     throw (SerializationException)
 {
@@ -424,4 +433,10 @@ void XmlSerializer::write(std::ostream& stream) {
     stream << printer.Str();
 }
 
+void XmlSerializer::writeBinary(std::ostream& stream) {
+    resolveUnresolvedReferences();
+
+    XmlBinaryFormat::write(document_, stream);
+}
+
 } // namespace
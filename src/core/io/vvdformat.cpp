@@ -28,6 +28,7 @@
 
 #include "voreen/core/io/vvdformat.h"
 #include "voreen/core/datastructures/volume/volumehash.h"
+#include "voreen/core/datastructures/volume/volumepyramid.h"
 #include "voreen/core/datastructures/volume/volumefactory.h"
 #include "voreen/core/io/serialization/meta/primitivemetadata.h"
 
@@ -64,6 +65,18 @@ void VvdRawDataObject::deserialize(XmlDeserializer& s) {
 }
 
 VvdObject::VvdObject(const VolumeHandleBase* vh, std::string rawFilename) : rawData_(vh->getRepresentation<Volume>(), rawFilename) {
+    copyMetaData(vh);
+    derivedData_.insert(vh->getDerivedData<VolumeHash>());
+    if (vh->hasDerivedData<VolumePyramid>())
+        derivedData_.insert(vh->getDerivedData<VolumePyramid>());
+}
+
+void VvdObject::addDerivedData(VolumeDerivedData* data) {
+    tgtAssert(data, "no derived data");
+    derivedData_.insert(data);
+}
+
+void VvdObject::copyMetaData(const VolumeHandleBase* vh) {
     std::vector<std::string> keys = vh->getMetaDataKeys();
     for(size_t i=0; i<keys.size(); i++) {
         const MetaDataBase* md = vh->getMetaData(keys[i]);
@@ -107,8 +120,6 @@ VvdObject::VvdObject(const VolumeHandleBase* vh, std::string rawFilename) : rawD
             }
         }
     }
-
-    derivedData_.insert(vh->getDerivedData<VolumeHash>());
 }
 
 VolumeHandle* VvdObject::createVolume(std::string directory) {
@@ -117,6 +128,16 @@ VolumeHandle* VvdObject::createVolume(std::string directory) {
 
     VolumeHandle* vh = new VolumeHandle(volume, &metaData_); //TODO: derived data
 
+    // attach a stored pyramid, so that a coarse level can be displayed before the full volume is loaded
+    for (std::set<VolumeDerivedData*>::iterator it = derivedData_.begin(); it != derivedData_.end(); ++it) {
+        VolumePyramid* pyramid = dynamic_cast<VolumePyramid*>(*it);
+        if (pyramid && pyramid->getNumLevels() > 0) {
+            vh->addDerivedData(pyramid);
+            derivedData_.erase(it);
+            break;
+        }
+    }
+
     return vh;
 }
 
@@ -136,15 +157,18 @@ void renameMetaData(MetaDataContainer& mdc, std::string from, std::string to) {
     }
 }
 
-void VvdObject::deserialize(XmlDeserializer& s) {
-    s.deserialize("RawData", rawData_);
-    metaData_.deserialize(s);
-
+void VvdObject::renameLegacyMetaData() {
     metaData_.renameMetaData("transformation", "Transformation");
     metaData_.renameMetaData("timestep", "Timestep");
     metaData_.renameMetaData("modality", "Modality");
     metaData_.renameMetaData("spacing", "Spacing");
     metaData_.renameMetaData("offset", "Offset");
+}
+
+void VvdObject::deserialize(XmlDeserializer& s) {
+    s.deserialize("RawData", rawData_);
+    metaData_.deserialize(s);
+    renameLegacyMetaData();
 
     s.deserialize("DerivedData", derivedData_, "DerivedItem");
 }
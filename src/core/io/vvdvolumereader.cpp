@@ -29,8 +29,11 @@
 #include "voreen/core/io/vvdvolumereader.h"
 #include "voreen/core/io/vvdformat.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <sstream>
 
 #include "tgt/exception.h"
 #include "tgt/vector.h"
@@ -38,6 +41,7 @@
 #include "voreen/core/utils/stringconversion.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/diskrepresentation.h"
+#include "voreen/core/datastructures/volume/volumepyramid.h"
 
 using tgt::vec3;
 using tgt::ivec3;
@@ -93,9 +97,26 @@ VolumeCollection* VvdVolumeReader::read(const std::string &url)
         throw tgt::FileException("Deserialization from file '" + fileName + "' failed (unknown exception).");
     }
 
+    std::string level = origin.getSearchParameter("level");
+
     VolumeCollection* vc = new VolumeCollection();
     for(size_t i=0; i<vec.size(); i++) {
         VolumeHandle* vh = vec[i].createVolume(tgt::FileSystem::dirName(fileName));
+        if (!level.empty()) {
+            VolumeHandle* levelVolume = 0;
+            try {
+                levelVolume = createLevelVolume(vh, level);
+            }
+            catch (tgt::FileException&) {
+                delete vh;
+                delete vc;
+                throw;
+            }
+            if (levelVolume) {
+                delete vh;
+                vh = levelVolume;
+            }
+        }
         vh->setOrigin(origin);
         vc->add(vh);
     }
@@ -103,6 +124,40 @@ VolumeCollection* VvdVolumeReader::read(const std::string &url)
     return vc;
 }
 
+VolumeHandle* VvdVolumeReader::createLevelVolume(const VolumeHandle* volume, const std::string& level) const
+    throw (tgt::FileException)
+{
+    size_t index = 0;
+    if (level != "coarsest") {
+        std::istringstream levelStream(level);
+        int n = -1;
+        levelStream >> n;
+        if (levelStream.fail() || !levelStream.eof() || n < 0)
+            throw tgt::FileException("Invalid pyramid level '" + level + "'");
+        index = static_cast<size_t>(n);
+    }
+    else
+        index = std::numeric_limits<size_t>::max();
+
+    if (index == 0)
+        return 0;
+    if (!volume->hasDerivedData<VolumePyramid>()) {
+        LWARNING("No pyramid stored: reading full resolution");
+        return 0;
+    }
+
+    const VolumePyramid* pyramid = volume->getDerivedData<VolumePyramid>();
+    const VolumeHandle* levelHandle = pyramid->getLevel(std::min(index, pyramid->getNumLevels()) - 1);
+    if (!levelHandle->hasRepresentation<DiskRepresentation>())
+        return 0;
+
+    // the level volume takes the meta data of the full resolution, except for the changed spacing
+    VolumeHandle* levelVolume = new VolumeHandle(new DiskRepresentation(levelHandle->getRepresentation<DiskRepresentation>()), volume);
+    levelVolume->setSpacing(levelHandle->getSpacing());
+    levelVolume->setOffset(levelHandle->getOffset());
+    return levelVolume;
+}
+
 VolumeReader* VvdVolumeReader::create(ProgressBar* progress) const {
     return new VvdVolumeReader(progress);
 }
@@ -29,19 +29,34 @@
 #include "voreen/core/io/vvdvolumewriter.h"
 #include "voreen/core/io/vvdformat.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/mappedvolume.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/volumepyramid.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorhalfsample.h"
 
 #include "tgt/filesystem.h"
 #include "tgt/matrix.h"
 
+#include <memory>
+
 namespace voreen {
 
 const std::string VvdVolumeWriter::loggerCat_("voreen.io.VvdVolumeWriter");
 
-VvdVolumeWriter::VvdVolumeWriter() {
+VvdVolumeWriter::VvdVolumeWriter()
+    : writePyramid_(true)
+{
     extensions_.push_back("vvd");
 }
 
+void VvdVolumeWriter::setWritePyramid(bool enabled) {
+    writePyramid_ = enabled;
+}
+
+bool VvdVolumeWriter::getWritePyramid() const {
+    return writePyramid_;
+}
+
 void VvdVolumeWriter::write(const std::string& filename, const VolumeHandleBase* volumeHandle)
     throw (tgt::IOException)
 {
@@ -56,12 +71,29 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
     std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
     LINFO("saving " << vvdname << " and " << rawname);
 
+    // a volume mapped from the raw file would lose its data when the file is truncated
+    std::auto_ptr<Volume> volumeCopy(MappedVolumeBase::copyIfMappedFrom(volume, rawname));
+    if (volumeCopy.get())
+        volume = volumeCopy.get();
+
     // VVD: ---------------------------
 
     XmlSerializer s(vvdname);
     s.setUseAttributes(true);
 
+    std::auto_ptr<VolumePyramid> pyramid;
+    if (writePyramid_ && !volumeHandle->hasDerivedData<VolumePyramid>()) {
+        try {
+            pyramid.reset(new VolumePyramid(volumeHandle));
+        }
+        catch (VolumeOperatorUnsupportedTypeException&) {
+            LWARNING("Volume type not supported by halfsampling: no pyramid written");
+        }
+    }
+
     VvdObject o = VvdObject(volumeHandle, tgt::FileSystem::fileName(rawname));
+    if (pyramid.get())
+        o.addDerivedData(pyramid.get());
     std::vector<VvdObject> vec;
     vec.push_back(o);
 
@@ -119,7 +151,9 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
 }
 
 VolumeWriter* VvdVolumeWriter::create(ProgressBar* /*progress*/) const {
-    return new VvdVolumeWriter();
+    VvdVolumeWriter* writer = new VvdVolumeWriter();
+    writer->setWritePyramid(writePyramid_);
+    return writer;
 }
 
 } // namespace voreen
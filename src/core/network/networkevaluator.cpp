@@ -33,12 +33,19 @@
 #include "voreen/core/network/networkgraph.h"
 #include "voreen/core/utils/exception.h"
 #include "voreen/core/processors/canvasrenderer.h"
+#include "voreen/core/ports/volumeport.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
 
 #include "tgt/textureunit.h"
 #include "tgt/framebufferobject.h"
 
+#include <algorithm>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using std::vector;
 
 namespace voreen {
@@ -54,6 +61,7 @@ NetworkEvaluator::NetworkEvaluator(tgt::GLCanvas* sharedContext)
     , networkChanged_(false)
     , locked_(false)
     , processPending_(false)
+    , parallelProcessing_(true)
 {
 
 #ifdef VRN_DEBUG
@@ -199,6 +207,7 @@ void NetworkEvaluator::onNetworkChange() {
         PROFILING_BLOCK("onNetworkChange");
 
         renderingOrder_.clear();
+        processingStages_.clear();
         loopPortMap_.clear();
 
         // nothing more to do, if no network is present
@@ -270,62 +279,284 @@ void NetworkEvaluator::process() {
         processWrappers_[j]->beforeNetworkProcess();
     LGL_ERROR;
 
-    // Iterate over processing in rendering order
+    // process independent branches concurrently, if possible
+    bool completed;
+    if (parallelProcessing_ && !processingStages_.empty())
+        completed = processStages(processed);
+    else
+        completed = processSequential(processed);
+
+    // break if network topology has changed (due to changes in loop port configurations)
+    if (!completed) {
+        unlock();
+
+        for (size_t j = 0; j < processWrappers_.size(); ++j)
+            processWrappers_[j]->afterNetworkProcess();
+        LGL_ERROR;
+
+        onNetworkChange();
+        return;
+    }
+
+    LGL_ERROR;
+
+    // assumption: a processor is valid after calling process(), except ports or processor itself is invalid
+    for (std::set<Processor*>::iterator iter = processed.begin(); iter != processed.end(); ++iter)
+        if ((*iter)->getInvalidationLevel() < Processor::INVALID_PORTS)
+            (*iter)->setValid();
+    LGL_ERROR;
+
+    unlock();
+
+    // notify process wrappers
+    for (size_t j = 0; j < processWrappers_.size(); ++j)
+        processWrappers_[j]->afterNetworkProcess();
+    LGL_ERROR;
+
+    if (processPending_) {
+        // make sure that canvases are repainted, if their update has been blocked by the locked evaluator
+        processPending_ = false;
+        updateCanvases();
+    }
+}
+
+bool NetworkEvaluator::needsProcessing(Processor* processor) const {
+    // all processors should have been initialized at this point
+    if (!processor->isInitialized()) {
+        LWARNING("process(): Skipping uninitialized processor '" << processor->getName()
+                 << "' (" << processor->getClassName() << ")");
+        return false;
+    }
+
+    return (!processor->isValid() && processor->isReady());
+}
+
+bool NetworkEvaluator::processSequential(std::set<Processor*>& processed) {
     for (size_t i = 0; i < renderingOrder_.size(); ++i) {
         Processor* const currentProcessor = renderingOrder_[i];
-
-        // all processors should have been initialized at this point
-        if (!currentProcessor->isInitialized()) {
-            LWARNING("process(): Skipping uninitialized processor '" << currentProcessor->getName()
-                     << "' (" << currentProcessor->getClassName() << ")");
+        if (!needsProcessing(currentProcessor))
             continue;
+
+        processSingle(currentProcessor, processed);
+
+        // break loop if network topology has changed (due to changes in loop port configurations)
+        if (checkForInvalidPorts())
+            return false;
+    }
+    return true;
+}
+
+bool NetworkEvaluator::processStages(std::set<Processor*>& processed) {
+    for (size_t i = 0; i < processingStages_.size(); ++i) {
+        const std::vector<Processor*>& stage = processingStages_[i];
+
+        // distribute the processors of the stage onto the worker threads and the main thread
+        std::vector<Processor*> concurrent;
+        std::vector<Processor*> sequential;
+        for (size_t j = 0; j < stage.size(); ++j) {
+            Processor* processor = stage[j];
+            if (!needsProcessing(processor))
+                continue;
+
+            // co-processors are called from within process() and are therefore never processed concurrently
+            if (processor->isThreadSafe() && processor->getCoProcessorInports().empty()
+                    && processor->getCoProcessorOutports().empty())
+                concurrent.push_back(processor);
+            else
+                sequential.push_back(processor);
+        }
+        if (concurrent.size() == 1) {
+            sequential.insert(sequential.begin(), concurrent.front());
+            concurrent.clear();
         }
 
-        bool needsProcessing = true;
-        if (currentProcessor->isValid())
-            needsProcessing = false;
+        if (!concurrent.empty()) {
+            processConcurrently(concurrent, processed);
+            if (checkForInvalidPorts())
+                return false;
+        }
 
-        // run the processor, if it needs processing and is ready
-        if (needsProcessing && currentProcessor->isReady()) {
+        for (size_t j = 0; j < sequential.size(); ++j) {
+            processSingle(sequential[j], processed);
+            if (checkForInvalidPorts())
+                return false;
+        }
+    }
+    return true;
+}
 
-            // increase iteration counters
-            for (size_t j=0; j<loopPortMap_[currentProcessor].size(); ++j) {
-                Port* port = loopPortMap_[currentProcessor][j];
-                // note: modulo is required for nested loops
-                port->setLoopIteration((port->getLoopIteration()+1) % port->getNumLoopIterations());
-            }
+void NetworkEvaluator::processSingle(Processor* currentProcessor, std::set<Processor*>& processed) {
+    // increase iteration counters
+    for (size_t j=0; j<loopPortMap_[currentProcessor].size(); ++j) {
+        Port* port = loopPortMap_[currentProcessor][j];
+        // note: modulo is required for nested loops
+        port->setLoopIteration((port->getLoopIteration()+1) % port->getNumLoopIterations());
+    }
 
-            // notify process wrappers
-            for (size_t j=0; j < processWrappers_.size(); ++j)
-                processWrappers_[j]->beforeProcess(currentProcessor);
-            LGL_ERROR;
+    // notify process wrappers
+    for (size_t j=0; j < processWrappers_.size(); ++j)
+        processWrappers_[j]->beforeProcess(currentProcessor);
+    LGL_ERROR;
 
-            try {
-                currentProcessor->performanceRecord_.setName(currentProcessor->getName());
+    try {
+        currentProcessor->performanceRecord_.setName(currentProcessor->getName());
 
-                if (sharedContext_)
-                    sharedContext_->getGLFocus();
-                {
-                    ProfilingBlock block("beforeprocess", currentProcessor->performanceRecord_);
-                    currentProcessor->beforeProcess();
-                }
-                if (sharedContext_)
-                    sharedContext_->getGLFocus();
+        if (sharedContext_)
+            sharedContext_->getGLFocus();
+        {
+            ProfilingBlock block("beforeprocess", currentProcessor->performanceRecord_);
+            currentProcessor->beforeProcess();
+        }
+        if (sharedContext_)
+            sharedContext_->getGLFocus();
 #ifdef VRN_PRINT_PROFILING
-                currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
+        currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
 #endif
-                LGL_ERROR;
-                if (!currentProcessor->isValid())
-                {
-                    ProfilingBlock block("process", currentProcessor->performanceRecord_);
-                    currentProcessor->process();
-                }
-                if (sharedContext_)
-                    sharedContext_->getGLFocus();
+        LGL_ERROR;
+        if (!currentProcessor->isValid())
+        {
+            ProfilingBlock block("process", currentProcessor->performanceRecord_);
+            currentProcessor->process();
+        }
+        if (sharedContext_)
+            sharedContext_->getGLFocus();
 #ifdef VRN_PRINT_PROFILING
-                currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
+        currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
 #endif
-                LGL_ERROR;
+        LGL_ERROR;
+        {
+            ProfilingBlock block("afterprocess", currentProcessor->performanceRecord_);
+            currentProcessor->afterProcess();
+        }
+#ifdef VRN_PRINT_PROFILING
+        currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
+#endif
+        LGL_ERROR;
+        // mark processor as processed during this rendering pass
+        processed.insert(currentProcessor);
+    }
+    catch (VoreenException& e) {
+        LERROR("process(): VoreenException from "
+            << currentProcessor->getClassName()
+            << " (" << currentProcessor->getName() << "): " << e.what());
+    }
+    catch (std::exception& e) {
+        LERROR("process(): Exception from "
+            << currentProcessor->getClassName()
+            << " (" << currentProcessor->getName() << "): " << e.what());
+    }
+
+    if (sharedContext_)
+        sharedContext_->getGLFocus();
+    // notify process wrappers
+    for (size_t j = 0; j < processWrappers_.size(); ++j)
+        processWrappers_[j]->afterProcess(currentProcessor);
+    LGL_ERROR;
+}
+
+void NetworkEvaluator::processConcurrently(const std::vector<Processor*>& processors, std::set<Processor*>& processed) {
+    const int numProcessors = static_cast<int>(processors.size());
+
+    // error messages are collected and logged on the main thread afterwards
+    std::vector<std::string> errors(processors.size());
+
+    // progress bars are usually GUI elements and must not be updated from the worker threads
+    std::vector<ProgressBar*> progressBars(processors.size(), 0);
+
+    for (int i = 0; i < numProcessors; ++i) {
+        Processor* const currentProcessor = processors[i];
+
+        // notify process wrappers
+        for (size_t j=0; j < processWrappers_.size(); ++j)
+            processWrappers_[j]->beforeProcess(currentProcessor);
+        LGL_ERROR;
+
+        try {
+            currentProcessor->performanceRecord_.setName(currentProcessor->getName());
+
+            if (sharedContext_)
+                sharedContext_->getGLFocus();
+            {
+                ProfilingBlock block("beforeprocess", currentProcessor->performanceRecord_);
+                currentProcessor->beforeProcess();
+            }
+            LGL_ERROR;
+            {
+                ProfilingBlock block("transferdata", currentProcessor->performanceRecord_);
+                prepareConcurrentProcessing(currentProcessor);
+            }
+        }
+        catch (VoreenException& e) {
+            errors[i] = "process(): VoreenException from " + currentProcessor->getClassName()
+                + " (" + currentProcessor->getName() + "): " + e.what();
+        }
+        catch (std::exception& e) {
+            errors[i] = "process(): Exception from " + currentProcessor->getClassName()
+                + " (" + currentProcessor->getName() + "): " + e.what();
+        }
+
+        progressBars[i] = currentProcessor->progressBar_;
+        currentProcessor->progressBar_ = 0;
+    }
+
+    // only the computation is done on the worker threads, since assigning data to the outports
+    // deletes the previous data and thereby notifies observers, which may be GUI elements
+    std::vector<int> computed(processors.size(), 0);
+    for (int i = 0; i < numProcessors; ++i)
+        computed[i] = (errors[i].empty() && !processors[i]->isValid()) ? 1 : 0;
+
+#ifdef _OPENMP
+    // The computations are usually parallelized themselves: the threads are split among
+    // the processors and nested parallelism is enabled, since the inner parallel regions
+    // would otherwise run on a single thread each.
+    const int maxThreads = omp_get_max_threads();
+    const int numComputed = static_cast<int>(std::count(computed.begin(), computed.end(), 1));
+    const int numWorkers = std::max(1, std::min(numComputed, maxThreads));
+    const int threadsPerWorker = std::max(1, maxThreads / numWorkers);
+    const int wasNested = omp_get_nested();
+    omp_set_nested(1);
+#endif
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(numWorkers)
+    for (int i = 0; i < numProcessors; ++i) {
+        Processor* const currentProcessor = processors[i];
+        if (!computed[i])
+            continue;
+#ifdef _OPENMP
+        omp_set_num_threads(threadsPerWorker);
+#endif
+
+        try {
+            ProfilingBlock block("process", currentProcessor->performanceRecord_);
+            currentProcessor->computeResults();
+        }
+        catch (VoreenException& e) {
+            errors[i] = "process(): VoreenException from " + currentProcessor->getClassName()
+                + " (" + currentProcessor->getName() + "): " + e.what();
+        }
+        catch (std::exception& e) {
+            errors[i] = "process(): Exception from " + currentProcessor->getClassName()
+                + " (" + currentProcessor->getName() + "): " + e.what();
+        }
+    }
+
+#ifdef _OPENMP
+    omp_set_nested(wasNested);
+#endif
+
+    for (int i = 0; i < numProcessors; ++i) {
+        Processor* const currentProcessor = processors[i];
+        currentProcessor->progressBar_ = progressBars[i];
+
+        if (errors[i].empty()) {
+            try {
+                // replacing the previous output data may require the context
+                if (sharedContext_)
+                    sharedContext_->getGLFocus();
+                if (computed[i]) {
+                    ProfilingBlock block("publishresults", currentProcessor->performanceRecord_);
+                    currentProcessor->publishResults();
+                }
                 {
                     ProfilingBlock block("afterprocess", currentProcessor->performanceRecord_);
                     currentProcessor->afterProcess();
@@ -338,58 +569,43 @@ void NetworkEvaluator::process() {
                 processed.insert(currentProcessor);
             }
             catch (VoreenException& e) {
-                LERROR("process(): VoreenException from "
-                    << currentProcessor->getClassName()
-                    << " (" << currentProcessor->getName() << "): " << e.what());
-             }
-             catch (std::exception& e) {
-                LERROR("process(): Exception from "
-                    << currentProcessor->getClassName()
-                    << " (" << currentProcessor->getName() << "): " << e.what());
-             }
-
-             if (sharedContext_)
-                 sharedContext_->getGLFocus();
-             // notify process wrappers
-             for (size_t j = 0; j < processWrappers_.size(); ++j)
-                processWrappers_[j]->afterProcess(currentProcessor);
-             LGL_ERROR;
-
-             // break loop if network topology has changed (due to changes in loop port configurations)
-             if (checkForInvalidPorts()) {
-                 unlock();
-
-                 for (size_t j = 0; j < processWrappers_.size(); ++j)
-                     processWrappers_[j]->afterNetworkProcess();
-                 LGL_ERROR;
-
-                 onNetworkChange();
-                 return;
-             }
+                errors[i] = "process(): VoreenException from " + currentProcessor->getClassName()
+                    + " (" + currentProcessor->getName() + "): " + e.what();
+            }
+            catch (std::exception& e) {
+                errors[i] = "process(): Exception from " + currentProcessor->getClassName()
+                    + " (" + currentProcessor->getName() + "): " + e.what();
+            }
         }
+        if (!errors[i].empty())
+            LERROR(errors[i]);
+
+        if (sharedContext_)
+            sharedContext_->getGLFocus();
+        // notify process wrappers
+        for (size_t j = 0; j < processWrappers_.size(); ++j)
+            processWrappers_[j]->afterProcess(currentProcessor);
+        LGL_ERROR;
+    }
+}
 
-    }   // for (rendering order)
-
-    LGL_ERROR;
-
-    // assumption: a processor is valid after calling process(), except ports or processor itself is invalid
-    for (std::set<Processor*>::iterator iter = processed.begin(); iter != processed.end(); ++iter)
-        if ((*iter)->getInvalidationLevel() < Processor::INVALID_PORTS)
-            (*iter)->setValid();
-    LGL_ERROR;
-
-    unlock();
+void NetworkEvaluator::prepareConcurrentProcessing(Processor* processor) {
+    // representations must not be converted concurrently, and conversions
+    // from OpenGL textures require the context
+    const std::vector<Port*>& inports = processor->getInports();
+    for (size_t i = 0; i < inports.size(); ++i) {
+        VolumePort* port = dynamic_cast<VolumePort*>(inports[i]);
+        if (port && port->hasData())
+            port->getData()->getRepresentation<Volume>();
+    }
+}
 
-    // notify process wrappers
-    for (size_t j = 0; j < processWrappers_.size(); ++j)
-        processWrappers_[j]->afterNetworkProcess();
-    LGL_ERROR;
+void NetworkEvaluator::setParallelProcessing(bool enabled) {
+    parallelProcessing_ = enabled;
+}
 
-    if (processPending_) {
-        // make sure that canvases are repainted, if their update has been blocked by the locked evaluator
-        processPending_ = false;
-        updateCanvases();
-    }
+bool NetworkEvaluator::getParallelProcessing() const {
+    return parallelProcessing_;
 }
 
 void NetworkEvaluator::removeProcessWrapper(const ProcessWrapper* w)  {
@@ -486,6 +702,34 @@ void NetworkEvaluator::defineRenderingOrder() {
         }
     }
 
+    // group the processors into stages of mutually independent processors,
+    // networks containing loops are always processed sequentially
+    processingStages_.clear();
+    bool hasLoops = (std::set<Processor*>(renderingOrder_.begin(), renderingOrder_.end()).size() != renderingOrder_.size());
+    for (std::map<Processor*, std::vector<Port*> >::const_iterator it = loopPortMap_.begin(); it != loopPortMap_.end(); ++it)
+        hasLoops |= !it->second.empty();
+    if (!hasLoops) {
+        std::map<Processor*, size_t> stageMap;
+        for (size_t i=0; i<renderingOrder_.size(); ++i) {
+            Processor* processor = renderingOrder_[i];
+            std::set<Processor*> processorSet;
+            processorSet.insert(processor);
+            std::set<Processor*> predecessors = netGraph.getPredecessors(processorSet);
+
+            // the rendering order is sorted topologically, so all predecessors have already been assigned
+            size_t stage = 0;
+            for (std::set<Processor*>::const_iterator it = predecessors.begin(); it != predecessors.end(); ++it) {
+                std::map<Processor*, size_t>::const_iterator predStage = stageMap.find(*it);
+                if (*it != processor && predStage != stageMap.end())
+                    stage = std::max(stage, predStage->second + 1);
+            }
+            stageMap[processor] = stage;
+            if (stage >= processingStages_.size())
+                processingStages_.resize(stage + 1);
+            processingStages_[stage].push_back(processor);
+        }
+    }
+
     // reduce processors' invalidation level in order to prevent
     // a continuous re-analysis of the network
     for (size_t i=0; i<network_->getProcessors().size(); ++i) {
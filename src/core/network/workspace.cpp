@@ -263,7 +263,8 @@ void Workspace::load(const std::string& filename)
     throw (SerializationException)
 {
     // open file for reading
-    std::fstream fileStream(filename.c_str(), std::ios_base::in);
+    // (binary mode, since the file may contain a binary serialized workspace)
+    std::fstream fileStream(filename.c_str(), std::ios_base::in | std::ios_base::binary);
     if (fileStream.fail()) {
         //LERROR("Failed to open file '" << tgt::FileSystem::absolutePath(filename) << "' for reading.");
         throw SerializationException("Failed to open workspace file '" + tgt::FileSystem::absolutePath(filename) + "' for reading.");
@@ -312,11 +313,17 @@ void Workspace::save(const std::string& filename, bool overwrite)
     s.serialize("Workspace", *this);
     errorList_ = s.getErrors();
 
+    // workspaces with the extension .vwb are written in the binary encoding
+    bool binary = (tgt::FileSystem::fileExtension(filename, true) == "vwb");
+
     // write serialization data to temporary string stream
     std::ostringstream textStream;
 
     try {
-        s.write(textStream);
+        if (binary)
+            s.writeBinary(textStream);
+        else
+            s.write(textStream);
         if (textStream.fail())
             throw SerializationException("Failed to write serialization data to string stream.");
     }
@@ -332,7 +339,7 @@ void Workspace::save(const std::string& filename, bool overwrite)
     // For added data security we write to a temporary file and afterwards move it into place
     // (which should be an atomic operation).
     const std::string tmpfilename = filename + ".tmp";
-    std::fstream fileStream(tmpfilename.c_str(), std::ios_base::out);
+    std::fstream fileStream(tmpfilename.c_str(), binary ? std::ios_base::out | std::ios_base::binary : std::ios_base::out);
     if (fileStream.fail())
         throw SerializationException("Failed to open file '" + tmpfilename + "' for writing.");
 
@@ -107,6 +107,9 @@ void GeometryPort::saveData(const std::string& path) const throw (VoreenExceptio
             + filename + "' (unknown exception).");
     }
     fileStream.close();
+
+    // binary files written by earlier saves of this document are no longer referenced
+    Geometry::removeUnreferencedBinaryFiles(s);
 }
 
 void GeometryPort::loadData(const std::string& path) throw (VoreenException) {
@@ -50,6 +50,10 @@
 
 #include <sstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using tgt::vec3;
 using tgt::vec4;
 using tgt::Color;
@@ -58,6 +62,27 @@ using std::string;
 using std::map;
 using std::vector;
 
+#ifdef _OPENMP
+namespace {
+
+// Guards the propagation of invalidations, which may be triggered concurrently
+// by processors running on worker threads. The lock has to be nestable,
+// since invalidations are propagated recursively.
+class InvalidationLock {
+public:
+    InvalidationLock() { omp_init_nest_lock(&lock_); }
+    ~InvalidationLock() { omp_destroy_nest_lock(&lock_); }
+    void set() { omp_set_nest_lock(&lock_); }
+    void unset() { omp_unset_nest_lock(&lock_); }
+private:
+    omp_nest_lock_t lock_;
+};
+
+InvalidationLock invalidationLock;
+
+}
+#endif
+
 namespace voreen {
 
 const std::string Processor::loggerCat_("voreen.Processor");
@@ -323,6 +348,16 @@ void Processor::resetPerformanceRecord() {
 }
 
 void Processor::invalidate(int inv) {
+#ifdef _OPENMP
+    invalidationLock.set();
+    invalidateInternal(inv);
+    invalidationLock.unset();
+#else
+    invalidateInternal(inv);
+#endif
+}
+
+void Processor::invalidateInternal(int inv) {
     PropertyOwner::invalidate(inv);
 
     if (inv == Processor::VALID)
@@ -340,7 +375,13 @@ void Processor::invalidate(int inv) {
         for (size_t i=0; i<coProcessorOutports_.size(); ++i)
             coProcessorOutports_[i]->invalidate();
 
-        if (isEndProcessor()) {
+        // processors running on worker threads must not schedule an update: their successors
+        // are processed by the evaluator within the same pass anyway
+        bool onWorkerThread = false;
+#ifdef _OPENMP
+        onWorkerThread = (omp_in_parallel() != 0);
+#endif
+        if (isEndProcessor() && !onWorkerThread) {
             tgtAssert(VoreenApplication::app(), "VoreenApplication not instantiated");
             // triggers non-blocking network update
             VoreenApplication::app()->scheduleNetworkProcessing();
@@ -426,6 +467,16 @@ bool Processor::isEndProcessor() const {
     return (outports_.empty() && coProcessorOutports_.empty());
 }
 
+bool Processor::isThreadSafe() const {
+    return false;
+}
+
+void Processor::computeResults() {
+}
+
+void Processor::publishResults() {
+}
+
 void Processor::serialize(XmlSerializer& s) const {
     // meta data
     metaDataContainer_.serialize(s);
@@ -28,12 +28,21 @@
 
 #include "voreen/core/processors/profiling.h"
 #include <iomanip>
+#include <algorithm>
 #include "tgt/tgt_gl.h"
 #include "tgt/logmanager.h"
 
 #ifdef _MSC_VER  // high-performance counter
 #include <windows.h>
 #include <winbase.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
 #endif
 
 namespace voreen {
@@ -41,13 +50,14 @@ namespace voreen {
 //const std::string ProfilingBlock::loggerCat_ = "voreen.ProfilingBlock";
 const std::string PerformanceSample::loggerCat_ = "voreen.PerformanceSample";
 
-PerformanceSample::PerformanceSample() : parent_(NULL), name_(""), time_(-1.0f) {
+PerformanceSample::PerformanceSample() : parent_(NULL), name_(""), time_(-1.0f), startTime_(0), threadId_(0) {
 }
 
-PerformanceSample::PerformanceSample(PerformanceSample* sample) : parent_(sample->getParent()), name_(sample->getName()), time_(sample->getTime()), measurements_(sample->getMeasurementCount()) {
+PerformanceSample::PerformanceSample(PerformanceSample* sample) : parent_(sample->getParent()), name_(sample->getName()), time_(sample->getTime()),
+    startTime_(sample->getStartTime()), threadId_(sample->getThreadId()), measurements_(sample->getMeasurementCount()) {
 }
 
-PerformanceSample::PerformanceSample(PerformanceSample* parent, std::string name) : parent_(parent), name_(name), time_(-1.0f), measurements_(1) {
+PerformanceSample::PerformanceSample(PerformanceSample* parent, std::string name) : parent_(parent), name_(name), time_(-1.0f), startTime_(0), threadId_(0), measurements_(1) {
 }
 
 PerformanceSample* PerformanceSample::addChild(std::string name) {
@@ -124,6 +134,22 @@ float PerformanceSample::getTime() const {
     return time_;
 }
 
+void PerformanceSample::setStartTime(uint64_t startTime) {
+    startTime_ = startTime;
+}
+
+uint64_t PerformanceSample::getStartTime() const {
+    return startTime_;
+}
+
+void PerformanceSample::setThreadId(int threadId) {
+    threadId_ = threadId;
+}
+
+int PerformanceSample::getThreadId() const {
+    return threadId_;
+}
+
 std::string PerformanceSample::getName() const {
     return name_;
 }
@@ -164,7 +190,7 @@ void PerformanceSample::normalize(){
 
 //----------------------------------------------------------------
 
-PerformanceRecord::PerformanceRecord() : current_(0) {
+PerformanceRecord::PerformanceRecord(size_t capacity) : current_(0), firstSample_(0), capacity_(std::max<size_t>(capacity, 1)) {
 }
 
 PerformanceRecord::~PerformanceRecord() {
@@ -177,25 +203,41 @@ void PerformanceRecord::startBlock(const ProfilingBlock* const pb) {
     else {
         current_ = current_->addChild(pb->getName());
     }
+    current_->setStartTime(pb->getStartTime());
+#ifdef _OPENMP
+    current_->setThreadId(omp_get_thread_num());
+#endif
 }
 
 void PerformanceRecord::endBlock(const ProfilingBlock* const pb) {
     current_->setTime(pb->getTime());
-    if(current_->getParent() == 0)
-        samples_.push_back(current_);
+    if(current_->getParent() == 0) {
+        if (samples_.size() < capacity_)
+            samples_.push_back(current_);
+        else {
+            // overwrite the oldest sample
+            delete samples_[firstSample_];
+            samples_[firstSample_] = current_;
+            firstSample_ = (firstSample_ + 1) % samples_.size();
+        }
+    }
 
     current_ = current_->getParent();
 }
 
 const std::vector<PerformanceSample*> PerformanceRecord::getSamples() const {
-    return samples_;
+    std::vector<PerformanceSample*> samples;
+    samples.reserve(samples_.size());
+    samples.insert(samples.end(), samples_.begin() + firstSample_, samples_.end());
+    samples.insert(samples.end(), samples_.begin(), samples_.begin() + firstSample_);
+    return samples;
 }
 
 PerformanceSample* PerformanceRecord::getLastSample() const {
     if(samples_.empty())
         return 0;
     else
-        return samples_.back();
+        return samples_[(firstSample_ + samples_.size() - 1) % samples_.size()];
 }
 
 void PerformanceRecord::deleteSamples() {
@@ -203,6 +245,76 @@ void PerformanceRecord::deleteSamples() {
         delete samples_.back();
         samples_.pop_back();
     }
+    firstSample_ = 0;
+}
+
+void PerformanceRecord::setCapacity(size_t capacity) {
+    capacity = std::max<size_t>(capacity, 1);
+
+    // keep the most recent samples in chronological order
+    std::vector<PerformanceSample*> samples = getSamples();
+    size_t numDeleted = (samples.size() > capacity ? samples.size() - capacity : 0);
+    for (size_t i = 0; i < numDeleted; i++)
+        delete samples[i];
+
+    samples_.assign(samples.begin() + numDeleted, samples.end());
+    firstSample_ = 0;
+    capacity_ = capacity;
+}
+
+size_t PerformanceRecord::getCapacity() const {
+    return capacity_;
+}
+
+namespace {
+
+std::string escapeJson(const std::string& str) {
+    std::string result;
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '"' || str[i] == '\\')
+            result += '\\';
+        if (static_cast<unsigned char>(str[i]) >= 0x20)
+            result += str[i];
+    }
+    return result;
+}
+
+void writeTraceEvent(PerformanceSample* sample, const std::string& category, std::ostream& stream, bool& first) {
+    if (!first)
+        stream << ",\n";
+    first = false;
+
+    // timestamps and durations are given in microseconds
+    stream << "{\"name\":\"" << escapeJson(category + "." + sample->getName()) << "\",\"cat\":\"" << escapeJson(category)
+           << "\",\"ph\":\"X\",\"ts\":" << static_cast<double>(sample->getStartTime()) / 1000.0
+           << ",\"dur\":" << static_cast<double>(sample->getTime()) * 1000000.0
+           << ",\"pid\":0,\"tid\":" << sample->getThreadId() << "}";
+
+    std::vector<PerformanceSample*> children = sample->getChildren();
+    for (size_t i = 0; i < children.size(); i++)
+        writeTraceEvent(children[i], category, stream, first);
+}
+
+} // namespace
+
+void PerformanceRecord::writeChromeTrace(const std::vector<const PerformanceRecord*>& records, std::ostream& stream) {
+    std::streamsize precision = stream.precision();
+    std::ios_base::fmtflags flags = stream.flags();
+    stream << std::fixed << std::setprecision(3);
+
+    stream << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (!records[i])
+            continue;
+        std::vector<PerformanceSample*> samples = records[i]->getSamples();
+        for (size_t j = 0; j < samples.size(); j++)
+            writeTraceEvent(samples[j], records[i]->getName(), stream, first);
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    stream.precision(precision);
+    stream.flags(flags);
 }
 
 void PerformanceRecord::setName(std::string str){
@@ -215,46 +327,45 @@ std::string PerformanceRecord::getName() const {
 
 //----------------------------------------------------------------
 
-ProfilingBlock::ProfilingBlock(std::string name, PerformanceRecord& pr) : name_(name), pr_(pr) {
+ProfilingBlock::ProfilingBlock(std::string name, PerformanceRecord& pr) : name_(name), pr_(pr), end_(0) {
     //LINFO("Starting Block " << name);
+    start_ = getTimestamp();
     pr_.startBlock((const ProfilingBlock* const) this);
     //glFinish();
-
-#ifdef _MSC_VER  // use high-performance counter on windows, if available
-    if (QueryPerformanceFrequency(&hpfTicksPerSecond_) && QueryPerformanceCounter(&hpfStart_)) {
-        useHpf_ = true;
-    }
-    else { // hpf not available
-        useHpf_ = false;
-        start_ = clock();
-    }
-#else
-    start_ = clock();
-#endif
 }
 
 ProfilingBlock::~ProfilingBlock() {
     //glFinish();
-#ifdef _MSC_VER
-    if (useHpf_)
-        QueryPerformanceCounter(&hpfEnd_);
-    else
-        end_ = clock();
-#else
-    end_ = clock();
-#endif
+    end_ = getTimestamp();
     //LINFO("Finishing Block " << name_);
     pr_.endBlock((const ProfilingBlock* const)this);
 }
 
 float ProfilingBlock::getTime() const {
-#ifdef _MSC_VER
-    if (useHpf_)
-        return ((hpfEnd_.QuadPart-hpfStart_.QuadPart) / static_cast<float>(hpfTicksPerSecond_.QuadPart));
-    else
-        return ((end_-start_) / static_cast<float>(CLOCKS_PER_SEC));
+    return static_cast<float>(static_cast<double>(end_ - start_) * 1.0e-9);
+}
+
+uint64_t ProfilingBlock::getStartTime() const {
+    return start_;
+}
+
+uint64_t ProfilingBlock::getTimestamp() {
+#ifdef _MSC_VER  // high-performance counter
+    static LARGE_INTEGER ticksPerSecond = { 0 };
+    if (ticksPerSecond.QuadPart == 0)
+        QueryPerformanceFrequency(&ticksPerSecond);
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter(&ticks);
+    return static_cast<uint64_t>(static_cast<double>(ticks.QuadPart) * 1.0e9 / static_cast<double>(ticksPerSecond.QuadPart));
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom;
 #else
-    return ((end_-start_) / static_cast<float>(CLOCKS_PER_SEC));
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + static_cast<uint64_t>(ts.tv_nsec);
 #endif
 }
 
@@ -29,15 +29,100 @@
 #include "voreen/core/properties/link/linkevaluatorid.h"
 #include "voreen/core/utils/variant.h"
 
-#include "voreen/core/properties/property.h"
+#include "voreen/core/properties/boolproperty.h"
+#include "voreen/core/properties/cameraproperty.h"
+#include "voreen/core/properties/floatproperty.h"
+#include "voreen/core/properties/intproperty.h"
+#include "voreen/core/properties/matrixproperty.h"
+#include "voreen/core/properties/stringproperty.h"
+#include "voreen/core/properties/transfuncproperty.h"
+#include "voreen/core/properties/vectorproperty.h"
+#include "voreen/core/datastructures/transfunc/transfunc.h"
+
+namespace {
+
+using namespace voreen;
+
+// equivalent to setVariant(getVariant()) without the conversion
+template<class P>
+void assignValue(Property* src, Property* dst) {
+    static_cast<P*>(dst)->set(static_cast<const P*>(src)->get());
+}
+
+// the destination property takes ownership of the transfer function, so it has to be cloned
+void assignTransFunc(Property* src, Property* dst) {
+    TransFunc* tf = static_cast<TransFuncProperty*>(src)->get();
+    if (!tf)
+        throw VoreenException("Source property has no transfer function");
+    TransFuncProperty* dstProperty = static_cast<TransFuncProperty*>(dst);
+    dstProperty->set(tf->clone());
+    dstProperty->notifyChange();
+}
+
+} // namespace
 
 namespace voreen {
 
+LinkEvaluatorId::LinkEvaluatorId()
+    : assign_(0)
+{}
+
 void LinkEvaluatorId::eval(Property* src, Property* dst) throw (VoreenException) {
+    // the evaluator may be shared by both directions of a link, which have the same types
+    if (assign_ && typeid(*src) == typeid(*dst)) {
+        assign_(src, dst);
+        return;
+    }
+
     const Variant& srcVar = src->getVariant();
     dst->setVariant(srcVar);
 }
 
+void LinkEvaluatorId::propertiesChanged(Property* src, Property* dst) {
+    LinkEvaluatorBase::propertiesChanged(src, dst);
+
+    // subclasses may override setVariant, so only the exact types are assigned directly
+    if (typeid(*src) == typeid(*dst))
+        assign_ = getAssignFunction(typeid(*src));
+    else
+        assign_ = 0;
+}
+
+LinkEvaluatorId::AssignFunction LinkEvaluatorId::getAssignFunction(const std::type_info& type) {
+    if (type == typeid(BoolProperty))
+        return &assignValue<BoolProperty>;
+    else if (type == typeid(IntProperty))
+        return &assignValue<IntProperty>;
+    else if (type == typeid(FloatProperty))
+        return &assignValue<FloatProperty>;
+    else if (type == typeid(StringProperty))
+        return &assignValue<StringProperty>;
+    else if (type == typeid(IntVec2Property))
+        return &assignValue<IntVec2Property>;
+    else if (type == typeid(IntVec3Property))
+        return &assignValue<IntVec3Property>;
+    else if (type == typeid(IntVec4Property))
+        return &assignValue<IntVec4Property>;
+    else if (type == typeid(FloatVec2Property))
+        return &assignValue<FloatVec2Property>;
+    else if (type == typeid(FloatVec3Property))
+        return &assignValue<FloatVec3Property>;
+    else if (type == typeid(FloatVec4Property))
+        return &assignValue<FloatVec4Property>;
+    else if (type == typeid(FloatMat2Property))
+        return &assignValue<FloatMat2Property>;
+    else if (type == typeid(FloatMat3Property))
+        return &assignValue<FloatMat3Property>;
+    else if (type == typeid(FloatMat4Property))
+        return &assignValue<FloatMat4Property>;
+    else if (type == typeid(CameraProperty))
+        return &assignValue<CameraProperty>;
+    else if (type == typeid(TransFuncProperty))
+        return &assignTransFunc;
+    else
+        return 0;
+}
+
 std::string LinkEvaluatorId::getClassName() const {
     return "LinkEvaluatorId";
 }
@@ -100,7 +100,7 @@ namespace voreen {
 
 const std::string PropertyLink::loggerCat_("voreen.PropertyLink");
 
-std::vector<Property*> PropertyLink::visitedProperties_;
+std::set<Property*> PropertyLink::visitedProperties_;
 
 PropertyLink::PropertyLink(Property* src, Property* dest, LinkEvaluatorBase* linkEvaluator)
     : src_(src)
@@ -174,14 +174,12 @@ void PropertyLink::onChange() throw (VoreenException) {
 
     bool isInitiator = visitedProperties_.empty();
     if (isInitiator) {
-        visitedProperties_.push_back(src_);
+        visitedProperties_.insert(src_);
     }
-    else if (std::find(visitedProperties_.begin(), visitedProperties_.end(), dest_) != visitedProperties_.end()) {
+    else if (!visitedProperties_.insert(dest_).second) {
+        // dest has already been visited
         return;
     }
-    else {
-        visitedProperties_.push_back(dest_);
-    }
 
     try {
         evaluator_->eval(src_, dest_);
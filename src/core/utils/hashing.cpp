@@ -27,12 +27,124 @@
  **********************************************************************/
 
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
 
 #include "voreen/core/utils/hashing.h"
 #include "md5/md5.c"
 
+#include "tgt/types.h"
+
 namespace voreen {
 
+namespace {
+
+// MurmurHash3 (x64, 128 bit variant) by Austin Appleby, placed in the public domain.
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// blocks are read as little-endian, so that hashes do not depend on the host byte order
+inline uint64_t getBlock64(const unsigned char* p) {
+    uint64_t block = 0;
+    for (int i=7; i>=0; i--)
+        block = (block << 8) | uint64_t(p[i]);
+    return block;
+}
+
+inline void putBlock64(uint64_t block, unsigned char* p) {
+    for (int i=0; i<8; i++)
+        p[i] = static_cast<unsigned char>(block >> (8*i));
+}
+
+void murmurHash3_x64_128(const void* key, size_t len, uint64_t seed, uint64_t out[2]) {
+    const unsigned char* data = static_cast<const unsigned char*>(key);
+    const size_t nblocks = len / 16;
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    // body
+    for (size_t i = 0; i < nblocks; i++) {
+        uint64_t k1 = getBlock64(data + 16*i);
+        uint64_t k2 = getBlock64(data + 16*i + 8);
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1*5 + 0x52dce729;
+
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2*5 + 0x38495ab5;
+    }
+
+    // tail
+    const unsigned char* tail = data + nblocks*16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+
+    switch (len & 15) {
+    case 15: k2 ^= uint64_t(tail[14]) << 48;
+    case 14: k2 ^= uint64_t(tail[13]) << 40;
+    case 13: k2 ^= uint64_t(tail[12]) << 32;
+    case 12: k2 ^= uint64_t(tail[11]) << 24;
+    case 11: k2 ^= uint64_t(tail[10]) << 16;
+    case 10: k2 ^= uint64_t(tail[ 9]) << 8;
+    case  9: k2 ^= uint64_t(tail[ 8]) << 0;
+             k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+
+    case  8: k1 ^= uint64_t(tail[ 7]) << 56;
+    case  7: k1 ^= uint64_t(tail[ 6]) << 48;
+    case  6: k1 ^= uint64_t(tail[ 5]) << 40;
+    case  5: k1 ^= uint64_t(tail[ 4]) << 32;
+    case  4: k1 ^= uint64_t(tail[ 3]) << 24;
+    case  3: k1 ^= uint64_t(tail[ 2]) << 16;
+    case  2: k1 ^= uint64_t(tail[ 1]) << 8;
+    case  1: k1 ^= uint64_t(tail[ 0]) << 0;
+             k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    };
+
+    // finalization
+    h1 ^= static_cast<uint64_t>(len);
+    h2 ^= static_cast<uint64_t>(len);
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    out[0] = h1;
+    out[1] = h2;
+}
+
+std::string toHexString(const unsigned char* bytes, size_t numBytes) {
+    std::vector<char> output(2 * numBytes + 1);
+    for (size_t i=0; i<numBytes; i++) {
+        sprintf(&output[2 * i], "%02x", bytes[i]);
+    }
+    output[2 * numBytes] = '\0';
+
+    return std::string(&output[0]);
+}
+
+} // namespace
+
 std::string VoreenHash::getHash(const void* data, size_t size) {
     MD5_CTX ctx;
     MD5_Init(&ctx);
@@ -40,17 +152,54 @@ std::string VoreenHash::getHash(const void* data, size_t size) {
     unsigned char result[16];
     MD5_Final(result, &ctx);
 
-    unsigned char output[2 * 16 + 1];
-    for (int i=0; i<16; i++) {
-        sprintf((char *) output + (2 * i), "%02x", result[i]);
-    }
-    output[2 * 16 ] = '\0';
-
-    return std::string((const char*)output);
+    return toHexString(result, 16);
 }
 
 std::string VoreenHash::getHash(const std::string& s) {
     return getHash(s.c_str(), s.length());
 }
 
+std::string VoreenHash::getHash(const void* data, size_t size, Algorithm algorithm) {
+    switch (algorithm) {
+    case CHUNKED_MURMUR3:
+        return getChunkedHash(data, size);
+    case MD5:
+    default:
+        return getHash(data, size);
+    }
+}
+
+std::string VoreenHash::getChunkedHash(const void* data, size_t size, size_t chunkSize) {
+    if (chunkSize == 0)
+        chunkSize = DEFAULT_CHUNK_SIZE;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const int numChunks = static_cast<int>((size + chunkSize - 1) / chunkSize);
+
+    // leaf hashes of all chunks, followed by the data size
+    std::vector<uint64_t> leaves(2 * numChunks + 1);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+        size_t offset = static_cast<size_t>(chunk) * chunkSize;
+        size_t length = std::min(chunkSize, size - offset);
+        murmurHash3_x64_128(bytes + offset, length, static_cast<uint64_t>(chunk), &leaves[2*chunk]);
+    }
+    leaves[2 * numChunks] = static_cast<uint64_t>(size);
+
+    // root hash over the little-endian encoding of the leaves
+    std::vector<unsigned char> leafBytes(leaves.size() * 8);
+    for (size_t i=0; i<leaves.size(); i++)
+        putBlock64(leaves[i], &leafBytes[8*i]);
+    uint64_t root[2];
+    murmurHash3_x64_128(&leafBytes[0], leafBytes.size(), 0, root);
+
+    unsigned char result[16];
+    for (int i=0; i<8; i++) {
+        result[i] = static_cast<unsigned char>(root[0] >> (56 - 8*i));
+        result[8 + i] = static_cast<unsigned char>(root[1] >> (56 - 8*i));
+    }
+    return toHexString(result, 16);
+}
+
 } // namespace
@@ -32,6 +32,7 @@
 #include "voreen/core/version.h"
 #include "voreen/core/utils/cmdparser/commandlineparser.h"
 #include "voreen/core/utils/stringconversion.h"
+#include "voreen/core/datastructures/volume/diskrepresentation.h"
 #include "voreen/core/network/networkevaluator.h"
 #include "voreen/core/processors/processor.h"
 #include "voreen/core/processors/processorwidget.h"
@@ -190,6 +191,7 @@ VoreenApplication::VoreenApplication(const std::string& name, const std::string&
     , remoteController_(0)
 #endif
     , logLevel_(tgt::Info)
+    , useMemoryMapping_(false)
     , initialized_(false)
     , initializedGL_(false)
     , networkEvaluator_(0)
@@ -221,6 +223,10 @@ void VoreenApplication::prepareCommandParser() {
     cmdParser_.addCommand(new SingleCommand<std::string>(&overrideGLSLVersion_,
         "--glslVersion", "",
         "Overrides the detected GLSL version", "<1.10|1.20|1.30|1.40|1.50|3.30|4.00>"));
+
+    cmdParser_.addCommand(new SingleCommandZeroArguments(&useMemoryMapping_,
+        "--useMemoryMapping", "",
+        "Maps volume files into memory instead of reading them (files must not be changed while in use)"));
 }
 
 void VoreenApplication::initialize() {
@@ -236,6 +242,9 @@ void VoreenApplication::initialize() {
     prepareCommandParser();
     cmdParser_.execute();
 
+    if (useMemoryMapping_)
+        RepresentationConverterLoadFromDisk::setUseMemoryMapping(true);
+
     //
     // tgt initialization
     //
@@ -194,6 +194,7 @@ SOURCES += \
     datastructures/geometry/facegeometry.cpp \
     datastructures/geometry/geometry.cpp \
     datastructures/geometry/geometryfactory.cpp \
+    datastructures/geometry/indexedmeshgeometry.cpp \
     datastructures/geometry/meshgeometry.cpp \
     datastructures/geometry/meshlistgeometry.cpp \
     datastructures/geometry/vertexgeometry.cpp \
@@ -215,11 +216,16 @@ SOURCES += \
     datastructures/volume/volumefactory.cpp \
     datastructures/volume/volumegl.cpp \
     datastructures/volume/diskrepresentation.cpp \
+    datastructures/volume/distancetransform.cpp \
+    datastructures/volume/mappedvolume.cpp \
     datastructures/volume/volumehandle.cpp \
     datastructures/volume/volumehandledecorator.cpp \
     datastructures/volume/volumehash.cpp \
+    datastructures/volume/volumeminmaxoctree.cpp \
+    datastructures/volume/volumepyramid.cpp \
     datastructures/volume/volumerepresentation.cpp \
-    datastructures/volume/volumetexture.cpp 
+    datastructures/volume/volumetexture.cpp \
+    datastructures/volume/voxelexpression.cpp
 
 SOURCES += \
     interaction/booltoggleinteractionhandler.cpp \
@@ -235,6 +241,7 @@ SOURCES += \
     interaction/trackballnavigation.cpp \
     interaction/voreentrackball.cpp
 SOURCES += \
+    io/binarygeometryfile.cpp \
     io/datvolumereader.cpp \
     io/datvolumewriter.cpp \
     io/progressbar.cpp \
@@ -250,6 +257,7 @@ SOURCES += \
     io/vvdformat.cpp \
     io/vvdvolumereader.cpp \
     io/vvdvolumewriter.cpp \
+    io/serialization/xmlbinaryformat.cpp \
     io/serialization/xmldeserializer.cpp \
     io/serialization/xmlserializationconstants.cpp \
     io/serialization/xmlserializer.cpp \
@@ -460,6 +468,7 @@ HEADERS += \
     ../../include/voreen/core/datastructures/geometry/facegeometry.h \
     ../../include/voreen/core/datastructures/geometry/geometry.h \
     ../../include/voreen/core/datastructures/geometry/geometryfactory.h \
+    ../../include/voreen/core/datastructures/geometry/indexedmeshgeometry.h \
     ../../include/voreen/core/datastructures/geometry/meshgeometry.h \
     ../../include/voreen/core/datastructures/geometry/meshlistgeometry.h \
     ../../include/voreen/core/datastructures/geometry/pointgeometry.h \
@@ -487,12 +496,17 @@ HEADERS += \
     ../../include/voreen/core/datastructures/volume/volumefusion.h \
     ../../include/voreen/core/datastructures/volume/volumegl.h \
     ../../include/voreen/core/datastructures/volume/diskrepresentation.h \
+    ../../include/voreen/core/datastructures/volume/distancetransform.h \
+    ../../include/voreen/core/datastructures/volume/mappedvolume.h \
     ../../include/voreen/core/datastructures/volume/volumehandle.h \
     ../../include/voreen/core/datastructures/volume/volumehandledecorator.h \
     ../../include/voreen/core/datastructures/volume/volumehash.h \
+    ../../include/voreen/core/datastructures/volume/volumeminmaxoctree.h \
+    ../../include/voreen/core/datastructures/volume/volumepyramid.h \
     ../../include/voreen/core/datastructures/volume/volumeoperator.h \
     ../../include/voreen/core/datastructures/volume/volumerepresentation.h \
     ../../include/voreen/core/datastructures/volume/volumetexture.h \
+    ../../include/voreen/core/datastructures/volume/voxelexpression.h \
     ../../include/voreen/core/datastructures/volume/operators/volumeoperatorcalcerror.h \
     ../../include/voreen/core/datastructures/volume/operators/volumeoperatorconvert.h \
     ../../include/voreen/core/datastructures/volume/operators/volumeoperatorhalfsample.h \
@@ -525,6 +539,7 @@ HEADERS += \
     ../../include/voreen/core/interaction/trackballnavigation.h \
     ../../include/voreen/core/interaction/voreentrackball.h
 HEADERS += \
+    ../../include/voreen/core/io/binarygeometryfile.h \
     ../../include/voreen/core/io/datvolumereader.h \
     ../../include/voreen/core/io/datvolumewriter.h \
     ../../include/voreen/core/io/progressbar.h \
@@ -546,6 +561,7 @@ HEADERS += \
     ../../include/voreen/core/io/serialization/serializablefactory.h \
     ../../include/voreen/core/io/serialization/serialization.h \
     ../../include/voreen/core/io/serialization/serializationexceptions.h \
+    ../../include/voreen/core/io/serialization/xmlbinaryformat.h \
     ../../include/voreen/core/io/serialization/xmldeserializer.h \
     ../../include/voreen/core/io/serialization/xmlprocessor.h \
     ../../include/voreen/core/io/serialization/xmlserializationconstants.h \
@@ -38,6 +38,7 @@
 #include <QAction>
 #include <QApplication>
 #include <QContextMenuEvent>
+#include <QFileDialog>
 #include <QHeaderView>
 #include <QMenu>
 #include <QMessageBox>
@@ -50,6 +51,8 @@
 #include <QMap>
 #include <QList>
 
+#include <fstream>
+
 namespace {
     QString whatsThisInfo = "<h3>Performance Record Widget</h3><p>This widget allows access to the performance data stored in each \
                             processor. Every processor in the network is listed here with timings. On the top level of the tree \
@@ -111,6 +114,7 @@ PerformanceRecordWidget::PerformanceRecordWidget(QWidget* parent)
     clearTreeWhenRecordsUpdate_->setCheckable(true);
 
     resetPerformanceRecords_ = new QAction("Clear All Performance Records", this);
+    exportTrace_ = new QAction("Export Chrome Trace...", this);
 
     loadSettings();
 
@@ -306,6 +310,7 @@ void PerformanceRecordWidget::sortMenu() {
     menu->addSeparator();
 
     menu->addAction(resetPerformanceRecords_);
+    menu->addAction(exportTrace_);
 
     QAction* action = menu->exec(QCursor::pos());
     if (action) {
@@ -342,10 +347,29 @@ void PerformanceRecordWidget::sortMenu() {
         if (action == resetPerformanceRecords_) {
             emit clearRecords();
         }
+        if (action == exportTrace_) {
+            exportTrace();
+        }
         saveSettings();
     }
 }
 
+void PerformanceRecordWidget::exportTrace() {
+    QString filename = QFileDialog::getSaveFileName(this, tr("Export Chrome Trace..."), QDir::homePath(),
+                                                    "Chrome trace files (*.json)");
+    if (filename.isEmpty())
+        return;
+    if (!filename.endsWith(".json"))
+        filename += ".json";
+
+    std::ofstream stream(filename.toStdString().c_str());
+    if (stream.fail()) {
+        QMessageBox::critical(this, tr("Export Chrome Trace"), tr("Failed to open file '%1' for writing.").arg(filename));
+        return;
+    }
+    PerformanceRecord::writeChromeTrace(collectPerformanceRecords(), stream);
+}
+
 void PerformanceRecordWidget::resetSettings() {
     QSettings settings;
     settings.remove("PerformanceRecordWidget");
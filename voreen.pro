@@ -24,6 +24,7 @@ contains(VRN_PROJECTS, itk_wrapper):  SUBDIRS += sub_itk_wrapper
 contains(VRN_PROJECTS, descriptiontest):  SUBDIRS += sub_descriptiontest
 contains(VRN_PROJECTS, coveragetest):  SUBDIRS += sub_coveragetest
 contains(VRN_PROJECTS, varianttest): SUBDIRS += sub_varianttest
+contains(VRN_PROJECTS, binaryxmltest): SUBDIRS += sub_binaryxmltest
 
 sub_tgt.file = ext/tgt/tgt.pro
 
@@ -72,6 +73,9 @@ sub_itk_wrapper.depends =sub_tgt  sub_core
 sub_varianttest.file = apps/tests/varianttest/varianttest.pro
 sub_varianttest.depends = sub_tgt sub_core
 
+sub_binaryxmltest.file = apps/tests/binaryxmltest/binaryxmltest.pro
+sub_binaryxmltest.depends = sub_tgt sub_core
+
 unix {
   # update browser file for the emacs class hierarchy browser
   ebrowse.target = ebrowse